@@ -0,0 +1,927 @@
+/**
+ * @file bench.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 模拟i2c与spi的主机基准：在仿真gpio/总线上逐个调用各公开接口，
+ * 按消息长度、标志组合、端口形式（misaka_soft_i2c_t/共享操作表）与回调开销输出json，
+ * 每项给出每次传输的时间、每字节的时间与周期数（x86上以tsc计）以及每字节的回调次数；
+ * 软件spi模板在仿真从机（虚拟gpio）上按模式、位序与收发方向给出每秒位数；
+ * spi flash驱动在仿真flash上按读线宽、写入与擦除长度给出每次操作的时间、总线字节数与状态查询次数；
+ * sd卡驱动在仿真sd卡上按crc开关与块数给出每次读写的时间、总线字节数、命令数与轮询次数。
+ *
+ * 用法：misaka_bench [--quick]，--quick每项只运行少量迭代，用于冒烟测试
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sim_bus.h"
+#include "sim_soft_spi.h"
+#include "misaka_device/spi_flash.h"
+#include "misaka_device/spi_sd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MISAKA_BENCH_CYCLES()   __rdtsc()
+#define MISAKA_BENCH_HAS_CYCLES 1
+#else
+#define MISAKA_BENCH_CYCLES()   0ULL
+#define MISAKA_BENCH_HAS_CYCLES 0
+#endif
+
+#define MISAKA_BENCH_TARGET_NS  20000000ULL                 /**< 每项的目标运行时间 */
+#define MISAKA_BENCH_MAX_ITERS  200000UL
+#define MISAKA_BENCH_BUF_SIZE   4096
+
+#define MISAKA_BENCH_I2C_TRANSFER           0
+#define MISAKA_BENCH_I2C_SEND               1
+#define MISAKA_BENCH_I2C_RECV               2
+#define MISAKA_BENCH_I2C_SEND_THEN_RECV     3
+#define MISAKA_BENCH_I2C_SEND_THEN_SEND     4
+
+#define MISAKA_BENCH_SPI_MESSAGE            0
+#define MISAKA_BENCH_SPI_SEND               1
+#define MISAKA_BENCH_SPI_TRANSFER           2
+#define MISAKA_BENCH_SPI_SEND_THEN_RECV     3
+#define MISAKA_BENCH_SPI_SEND_THEN_SEND     4
+
+#define MISAKA_BENCH_SOFT_SPI_SEND_RECV     0
+#define MISAKA_BENCH_SOFT_SPI_SEND          1
+#define MISAKA_BENCH_SOFT_SPI_RECV          2
+#define MISAKA_BENCH_SOFT_SPI_SIZE          256
+
+#define MISAKA_BENCH_FLASH_READ             0
+#define MISAKA_BENCH_FLASH_WRITE            1
+#define MISAKA_BENCH_FLASH_ERASE            2
+#define MISAKA_BENCH_FLASH_SIZE             (256UL * 1024UL)
+#define MISAKA_BENCH_FLASH_BUSY_POLLS       2
+
+#define MISAKA_BENCH_SD_READ                0
+#define MISAKA_BENCH_SD_WRITE               1
+#define MISAKA_BENCH_SD_BLOCKS              1024
+#define MISAKA_BENCH_SD_BUSY_BYTES          16
+
+struct misaka_bench_flags_struct
+{
+	const char *name;
+	uint16_t flags;
+};
+
+struct misaka_bench_i2c_struct
+{
+	uint8_t legacy;/**< 1:misaka_soft_i2c_t 0:共享操作表 */
+	misaka_soft_i2c_t i2c;
+	misaka_soft_i2c_bus_t bus;
+	misaka_sim_gpio_t gpio;
+	misaka_soft_i2c_statistics_t stat;
+};
+
+struct misaka_bench_spi_struct
+{
+	uint8_t legacy;/**< 1:不带上下文的总线函数 0:共享操作表 */
+	misaka_spi_bus_t bus;
+	misaka_spi_t device;
+	misaka_sim_spi_t sim;
+};
+
+struct misaka_bench_flash_struct
+{
+	uint8_t single;/**< 1:控制器只支持单线 0:支持双线/四线 */
+	misaka_spi_bus_t bus;
+	misaka_spi_bus_ops_t ops;/**< 单线时去掉多线收发的操作表 */
+	misaka_spi_t device;
+	misaka_spi_flash_t flash;
+};
+
+struct misaka_bench_sd_struct
+{
+	misaka_spi_t device;
+	misaka_spi_sd_t sd;
+};
+
+struct misaka_bench_result_struct
+{
+	uint32_t iterations;
+	uint64_t ns;
+	uint64_t cycles;
+};
+
+static uint8_t s_txbuf[MISAKA_BENCH_BUF_SIZE];
+static uint8_t s_rxbuf[MISAKA_BENCH_BUF_SIZE];
+static uint8_t s_slave_rxbuf[MISAKA_BENCH_BUF_SIZE];
+static uint8_t s_quick;
+static uint8_t s_first;
+
+static misaka_sim_spi_slave_t s_slave;
+
+#define MISAKA_SOFT_SPI_NAME            misaka_bench_soft_spi
+#define MISAKA_SOFT_SPI_SET_SCK(s)      misaka_sim_spi_slave_set_sck(&s_slave, (uint8_t) (s))
+#define MISAKA_SOFT_SPI_SET_MOSI(s)     misaka_sim_spi_slave_set_mosi(&s_slave, (uint8_t) (s))
+#define MISAKA_SOFT_SPI_GET_MISO()      misaka_sim_spi_slave_get_miso(&s_slave)
+#include "misaka_device/soft_spi.h"
+
+static const char *const s_i2c_api[] = {
+	"transfer",
+	"master_send",
+	"master_recv",
+	"master_send_then_recv",
+	"master_send_then_send",
+};
+
+static const char *const s_spi_api[] = {
+	"misaka_spi_transfer_message",
+	"misaka_spi_send",
+	"misaka_spi_transfer",
+	"misaka_spi_send_then_recv",
+	"misaka_spi_send_then_send",
+};
+
+static const char *const s_flash_api[] = {
+	"misaka_spi_flash_read",
+	"misaka_spi_flash_write",
+	"misaka_spi_flash_erase",
+};
+
+static const char *const s_sd_api[] = {
+	"misaka_spi_sd_read",
+	"misaka_spi_sd_write",
+};
+
+static const char *const s_soft_spi_api[] = {
+	"send_recv",
+	"send",
+	"recv",
+};
+
+static const struct misaka_bench_flags_struct s_send_flags[] = {
+	{"WR",          MISAKA_SOFT_I2C_WR},
+	{"IGNORE_NACK", MISAKA_SOFT_I2C_IGNORE_NACK},
+	{"ADDR_10BIT",  MISAKA_SOFT_I2C_ADDR_10BIT},
+};
+
+static const struct misaka_bench_flags_struct s_recv_flags[] = {
+	{"RD",                  MISAKA_SOFT_I2C_RD},
+	{"RD|NO_READ_ACK",      MISAKA_SOFT_I2C_RD | MISAKA_SOFT_I2C_NO_READ_ACK},
+	{"RD|ADDR_10BIT",       MISAKA_SOFT_I2C_RD | MISAKA_SOFT_I2C_ADDR_10BIT},
+};
+
+static const struct misaka_bench_flags_struct s_none_flags[] = {
+	{"-", 0},
+};
+
+static const uint32_t s_i2c_sizes[] = {1, 16, 256};
+static const uint32_t s_i2c_costs[] = {0, 32, 256};
+static const uint32_t s_spi_sizes[] = {1, 16, 256, 4096};
+static const uint32_t s_spi_costs[] = {0, 256};
+static const uint32_t s_flash_read_sizes[] = {16, 256, 4096};
+static const uint32_t s_flash_write_sizes[] = {256, 4096};
+static const uint32_t s_flash_erase_sizes[] = {4096, 65536};
+
+static const uint32_t s_sd_counts[] = {1, 8};
+
+static uint8_t s_flash_mem[MISAKA_BENCH_FLASH_SIZE];
+static uint8_t s_sd_mem[MISAKA_BENCH_SD_BLOCKS * MISAKA_SPI_SD_BLOCK_SIZE];
+
+/**
+ * @brief 获取单调时间
+ * @return uint64_t @c ns
+ */
+static uint64_t misaka_bench_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief 仿真sd卡初始化时的毫秒延时，无需等待
+ * @param ms 毫秒
+ */
+static void misaka_bench_delay_ms(uint32_t ms)
+{
+	(void) ms;
+}
+
+/**
+ * @brief 执行一次模拟i2c传输
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_I2C_x
+ * @param flags 标志
+ * @param size 数据长度
+ * @return uint32_t @c 负载字节数
+ */
+static uint32_t misaka_bench_i2c_once(struct misaka_bench_i2c_struct *b, uint8_t api, uint16_t flags, uint32_t size)
+{
+	misaka_soft_i2c_message msgs[2];
+	uint16_t addr = (flags & MISAKA_SOFT_I2C_ADDR_10BIT) ? 0x2A5 : 0x50;
+
+	switch (api)
+	{
+	case MISAKA_BENCH_I2C_TRANSFER:
+		/** < 寄存器地址与数据分开存放，数据段以NO_START接在地址之后 */
+		msgs[0].addr = addr;
+		msgs[0].flags = MISAKA_SOFT_I2C_WR;
+		msgs[0].buf = s_txbuf;
+		msgs[0].len = 2;
+		msgs[1].addr = addr;
+		msgs[1].flags = MISAKA_SOFT_I2C_WR | MISAKA_SOFT_I2C_NO_START;
+		msgs[1].buf = s_txbuf + 2;
+		msgs[1].len = size;
+		if (b->legacy)
+		{
+			misaka_soft_i2c_transfer(&b->i2c, msgs, 2);
+		}
+		else
+		{
+			misaka_soft_i2c_bus_transfer(&b->bus, msgs, 2);
+		}
+		return size + 2;
+	case MISAKA_BENCH_I2C_SEND:
+		if (b->legacy)
+		{
+			misaka_soft_i2c_master_send(&b->i2c, addr, flags, s_txbuf, size);
+		}
+		else
+		{
+			misaka_soft_i2c_bus_master_send(&b->bus, addr, flags, s_txbuf, size);
+		}
+		return size;
+	case MISAKA_BENCH_I2C_RECV:
+		if (b->legacy)
+		{
+			misaka_soft_i2c_master_recv(&b->i2c, addr, flags, s_rxbuf, size);
+		}
+		else
+		{
+			misaka_soft_i2c_bus_master_recv(&b->bus, addr, flags, s_rxbuf, size);
+		}
+		return size;
+	case MISAKA_BENCH_I2C_SEND_THEN_RECV:
+		if (b->legacy)
+		{
+			misaka_soft_i2c_master_send_then_recv(&b->i2c, addr, s_txbuf, 2, s_rxbuf, size);
+		}
+		else
+		{
+			misaka_soft_i2c_bus_master_send_then_recv(&b->bus, addr, s_txbuf, 2, s_rxbuf, size);
+		}
+		return size + 2;
+	default:
+		if (b->legacy)
+		{
+			misaka_soft_i2c_master_send_then_send(&b->i2c, addr, s_txbuf, 2, s_txbuf + 2, size);
+		}
+		else
+		{
+			misaka_soft_i2c_bus_master_send_then_send(&b->bus, addr, s_txbuf, 2, s_txbuf + 2, size);
+		}
+		return size + 2;
+	}
+}
+
+/**
+ * @brief 执行一次spi传输
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_SPI_x
+ * @param size 数据长度
+ * @return uint32_t @c 负载字节数
+ */
+static uint32_t misaka_bench_spi_once(struct misaka_bench_spi_struct *b, uint8_t api, uint32_t size)
+{
+	misaka_spi_message_t msgs[3];
+
+	switch (api)
+	{
+	case MISAKA_BENCH_SPI_MESSAGE:
+		/** < 典型的存储器读：1字节指令、3字节地址、数据 */
+		memset(msgs, 0, sizeof(msgs));
+		msgs[0].send_buf = s_txbuf;
+		msgs[0].length = 1;
+		msgs[0].cs_take = 1;
+		msgs[0].next = &msgs[1];
+		msgs[1].send_buf = s_txbuf + 1;
+		msgs[1].length = 3;
+		msgs[1].next = &msgs[2];
+		msgs[2].recv_buf = s_rxbuf;
+		msgs[2].length = size;
+		msgs[2].cs_release = 1;
+		misaka_spi_transfer_message(&b->device, msgs);
+		return size + 4;
+	case MISAKA_BENCH_SPI_SEND:
+		misaka_spi_send(&b->device, s_txbuf, size);
+		return size;
+	case MISAKA_BENCH_SPI_TRANSFER:
+		misaka_spi_transfer(&b->device, s_txbuf, s_rxbuf, size);
+		return size;
+	case MISAKA_BENCH_SPI_SEND_THEN_RECV:
+		misaka_spi_send_then_recv(&b->device, s_txbuf, 4, s_rxbuf, size);
+		return size + 4;
+	default:
+		misaka_spi_send_then_send(&b->device, s_txbuf, 4, s_txbuf + 4, size);
+		return size + 4;
+	}
+}
+
+/**
+ * @brief 输出一项结果的公共部分
+ * @param r 结果
+ * @param bytes 每次传输的负载字节数
+ * @param callbacks 回调总次数
+ */
+static void misaka_bench_print_result(const struct misaka_bench_result_struct *r, uint32_t bytes, uint32_t callbacks)
+{
+	double total_bytes = (double) bytes * r->iterations;
+
+	printf("\"iterations\": %u, \"bytes_per_transaction\": %u, ", r->iterations, bytes);
+	printf("\"ns_per_transaction\": %.1f, \"ns_per_byte\": %.2f, ",
+	       (double) r->ns / r->iterations, (double) r->ns / total_bytes);
+	if (MISAKA_BENCH_HAS_CYCLES)
+	{
+		printf("\"cycles_per_byte\": %.1f, ", (double) r->cycles / total_bytes);
+	}
+	else
+	{
+		printf("\"cycles_per_byte\": null, ");
+	}
+	printf("\"callbacks_per_byte\": %.2f", (double) callbacks / total_bytes);
+}
+
+/**
+ * @brief 输出分隔符
+ */
+static void misaka_bench_separator(void)
+{
+	printf(s_first ? "\n    " : ",\n    ");
+	s_first = 0;
+}
+
+/**
+ * @brief 测量一项模拟i2c接口
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_I2C_x
+ * @param flags 标志
+ * @param size 数据长度
+ */
+static void misaka_bench_i2c_case(struct misaka_bench_i2c_struct *b, uint8_t api, const struct misaka_bench_flags_struct *flags, uint32_t size)
+{
+	struct misaka_bench_result_struct r;
+	uint64_t ns, cycles;
+	uint32_t i, bytes;
+
+	/** < 先运行一次，按耗时确定迭代次数 */
+	ns = misaka_bench_ns();
+	bytes = misaka_bench_i2c_once(b, api, flags->flags, size);
+	ns = misaka_bench_ns() - ns;
+	r.iterations = s_quick ? 2 : (uint32_t) (MISAKA_BENCH_TARGET_NS / (ns + 1));
+	if (r.iterations < 2)
+	{
+		r.iterations = 2;
+	}
+	if (r.iterations > MISAKA_BENCH_MAX_ITERS)
+	{
+		r.iterations = MISAKA_BENCH_MAX_ITERS;
+	}
+
+	b->gpio.callbacks = 0;
+	misaka_soft_i2c_reset_statistics(&b->stat);
+	ns = misaka_bench_ns();
+	cycles = MISAKA_BENCH_CYCLES();
+	for (i = 0; i < r.iterations; i++)
+	{
+		misaka_bench_i2c_once(b, api, flags->flags, size);
+	}
+	r.cycles = MISAKA_BENCH_CYCLES() - cycles;
+	r.ns = misaka_bench_ns() - ns;
+
+	misaka_bench_separator();
+	printf("{\"api\": \"misaka_soft_i2c_%s%s\", \"port\": \"%s\", \"flags\": \"%s\", \"size\": %u, \"pin_cost\": %u, ",
+	       b->legacy ? "" : "bus_", s_i2c_api[api], b->legacy ? "legacy" : "ops", flags->name, size, b->gpio.cost);
+	misaka_bench_print_result(&r, bytes, b->gpio.callbacks);
+	printf(", \"pin_calls_per_bus_byte\": %.2f, \"delay_calls_per_bus_byte\": %.2f}",
+	       (double) b->stat.pin_calls / b->stat.bytes, (double) b->stat.delay_calls / b->stat.bytes);
+}
+
+/**
+ * @brief 测量一项spi接口
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_SPI_x
+ * @param size 数据长度
+ */
+static void misaka_bench_spi_case(struct misaka_bench_spi_struct *b, uint8_t api, uint32_t size)
+{
+	struct misaka_bench_result_struct r;
+	uint64_t ns, cycles;
+	uint32_t i, bytes;
+
+	ns = misaka_bench_ns();
+	bytes = misaka_bench_spi_once(b, api, size);
+	ns = misaka_bench_ns() - ns;
+	r.iterations = s_quick ? 2 : (uint32_t) (MISAKA_BENCH_TARGET_NS / (ns + 1));
+	if (r.iterations < 2)
+	{
+		r.iterations = 2;
+	}
+	if (r.iterations > MISAKA_BENCH_MAX_ITERS)
+	{
+		r.iterations = MISAKA_BENCH_MAX_ITERS;
+	}
+
+	b->sim.callbacks = 0;
+	b->sim.cs_toggles = 0;
+	ns = misaka_bench_ns();
+	cycles = MISAKA_BENCH_CYCLES();
+	for (i = 0; i < r.iterations; i++)
+	{
+		misaka_bench_spi_once(b, api, size);
+	}
+	r.cycles = MISAKA_BENCH_CYCLES() - cycles;
+	r.ns = misaka_bench_ns() - ns;
+
+	misaka_bench_separator();
+	printf("{\"api\": \"%s\", \"port\": \"%s\", \"size\": %u, \"callback_cost\": %u, ",
+	       s_spi_api[api], b->legacy ? "legacy" : "ops", size, b->sim.cost);
+	misaka_bench_print_result(&r, bytes, b->sim.callbacks);
+	printf(", \"cs_toggles_per_transaction\": %.2f}", (double) b->sim.cs_toggles / r.iterations);
+}
+
+/**
+ * @brief 执行一次flash操作，写入与擦除等待完成
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_FLASH_x
+ * @param size 数据长度
+ */
+static void misaka_bench_flash_once(struct misaka_bench_flash_struct *b, uint8_t api, uint32_t size)
+{
+	if (api == MISAKA_BENCH_FLASH_READ)
+	{
+		misaka_spi_flash_read(&b->flash, 0x100, s_rxbuf, size);
+	}
+	else if (api == MISAKA_BENCH_FLASH_WRITE)
+	{
+		misaka_spi_flash_write(&b->flash, 0, s_txbuf, size);
+		misaka_spi_flash_sync(&b->flash);
+	}
+	else
+	{
+		misaka_spi_flash_erase(&b->flash, 0, size);
+		misaka_spi_flash_sync(&b->flash);
+	}
+}
+
+/**
+ * @brief 测量一项flash操作
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_FLASH_x
+ * @param size 数据长度
+ */
+static void misaka_bench_flash_case(struct misaka_bench_flash_struct *b, uint8_t api, uint32_t size)
+{
+	struct misaka_bench_result_struct r;
+	uint64_t ns, cycles;
+	uint32_t i, cs, status_reads, bus_bytes, cs0, status_reads0, bus_bytes0;
+	double total_bytes;
+
+	ns = misaka_bench_ns();
+	misaka_bench_flash_once(b, api, size);
+	ns = misaka_bench_ns() - ns;
+	r.iterations = s_quick ? 2 : (uint32_t) (MISAKA_BENCH_TARGET_NS / (ns + 1));
+	if (r.iterations < 2)
+	{
+		r.iterations = 2;
+	}
+	if (r.iterations > MISAKA_BENCH_MAX_ITERS)
+	{
+		r.iterations = MISAKA_BENCH_MAX_ITERS;
+	}
+
+	misaka_spi_flash_sim_stat(&cs0, &status_reads0, &bus_bytes0);
+	ns = misaka_bench_ns();
+	cycles = MISAKA_BENCH_CYCLES();
+	for (i = 0; i < r.iterations; i++)
+	{
+		misaka_bench_flash_once(b, api, size);
+	}
+	r.cycles = MISAKA_BENCH_CYCLES() - cycles;
+	r.ns = misaka_bench_ns() - ns;
+	misaka_spi_flash_sim_stat(&cs, &status_reads, &bus_bytes);
+	total_bytes = (double) size * r.iterations;
+
+	misaka_bench_separator();
+	printf("{\"api\": \"%s\", \"lines\": %u, \"size\": %u, \"iterations\": %u, ",
+	       s_flash_api[api], api == MISAKA_BENCH_FLASH_READ ? b->flash.read_lines : MISAKA_SPI_LINES_SINGLE, size, r.iterations);
+	printf("\"ns_per_transaction\": %.1f, \"ns_per_byte\": %.2f, ",
+	       (double) r.ns / r.iterations, (double) r.ns / total_bytes);
+	if (MISAKA_BENCH_HAS_CYCLES)
+	{
+		printf("\"cycles_per_byte\": %.1f, ", (double) r.cycles / total_bytes);
+	}
+	else
+	{
+		printf("\"cycles_per_byte\": null, ");
+	}
+	printf("\"bus_bytes_per_transaction\": %.1f, \"cs_per_transaction\": %.2f, \"status_reads_per_transaction\": %.2f}",
+	       (double) (bus_bytes - bus_bytes0) / r.iterations, (double) (cs - cs0) / r.iterations,
+	       (double) (status_reads - status_reads0) / r.iterations);
+}
+
+/**
+ * @brief 执行一次sd卡读写，写入等待完成
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_SD_x
+ * @param count 块数
+ */
+static void misaka_bench_sd_once(struct misaka_bench_sd_struct *b, uint8_t api, uint32_t count)
+{
+	if (api == MISAKA_BENCH_SD_READ)
+	{
+		misaka_spi_sd_read(&b->sd, 16, s_rxbuf, count);
+	}
+	else
+	{
+		misaka_spi_sd_write(&b->sd, 16, s_txbuf, count);
+		misaka_spi_sd_sync(&b->sd);
+	}
+}
+
+/**
+ * @brief 测量一项sd卡读写
+ * @param b 基准对象
+ * @param api MISAKA_BENCH_SD_x
+ * @param count 块数
+ */
+static void misaka_bench_sd_case(struct misaka_bench_sd_struct *b, uint8_t api, uint32_t count)
+{
+	struct misaka_bench_result_struct r;
+	uint64_t ns, cycles;
+	uint32_t i, commands, bus_bytes, polls, commands0, bus_bytes0, polls0;
+	double total_bytes;
+
+	ns = misaka_bench_ns();
+	misaka_bench_sd_once(b, api, count);
+	ns = misaka_bench_ns() - ns;
+	r.iterations = s_quick ? 2 : (uint32_t) (MISAKA_BENCH_TARGET_NS / (ns + 1));
+	if (r.iterations < 2)
+	{
+		r.iterations = 2;
+	}
+	if (r.iterations > MISAKA_BENCH_MAX_ITERS)
+	{
+		r.iterations = MISAKA_BENCH_MAX_ITERS;
+	}
+
+	misaka_spi_sd_sim_stat(&commands0, &bus_bytes0);
+	polls0 = b->sd.polls;
+	ns = misaka_bench_ns();
+	cycles = MISAKA_BENCH_CYCLES();
+	for (i = 0; i < r.iterations; i++)
+	{
+		misaka_bench_sd_once(b, api, count);
+	}
+	r.cycles = MISAKA_BENCH_CYCLES() - cycles;
+	r.ns = misaka_bench_ns() - ns;
+	misaka_spi_sd_sim_stat(&commands, &bus_bytes);
+	polls = b->sd.polls;
+	total_bytes = (double) count * MISAKA_SPI_SD_BLOCK_SIZE * r.iterations;
+
+	misaka_bench_separator();
+	printf("{\"api\": \"%s\", \"crc\": %u, \"blocks\": %u, \"iterations\": %u, ",
+	       s_sd_api[api], b->sd.use_crc, count, r.iterations);
+	printf("\"ns_per_transaction\": %.1f, \"ns_per_byte\": %.2f, ",
+	       (double) r.ns / r.iterations, (double) r.ns / total_bytes);
+	if (MISAKA_BENCH_HAS_CYCLES)
+	{
+		printf("\"cycles_per_byte\": %.1f, ", (double) r.cycles / total_bytes);
+	}
+	else
+	{
+		printf("\"cycles_per_byte\": null, ");
+	}
+	printf("\"bus_bytes_per_transaction\": %.1f, \"commands_per_transaction\": %.2f, \"polls_per_transaction\": %.2f}",
+	       (double) (bus_bytes - bus_bytes0) / r.iterations, (double) (commands - commands0) / r.iterations,
+	       (double) (polls - polls0) / r.iterations);
+}
+
+/**
+ * @brief 执行一次软件spi传输
+ * @param bus spi总线
+ * @param api MISAKA_BENCH_SOFT_SPI_x
+ * @param mode 模式
+ */
+static void misaka_bench_soft_spi_once(misaka_spi_bus_t *bus, uint8_t api, uint8_t mode)
+{
+	misaka_sim_spi_slave_reset(&s_slave, mode, s_txbuf, s_slave_rxbuf, MISAKA_BENCH_SOFT_SPI_SIZE);
+	if (api == MISAKA_BENCH_SOFT_SPI_SEND_RECV)
+	{
+		bus->ops->send_recv(bus->ctx, s_txbuf, s_rxbuf, MISAKA_BENCH_SOFT_SPI_SIZE);
+	}
+	else if (api == MISAKA_BENCH_SOFT_SPI_SEND)
+	{
+		bus->ops->send(bus->ctx, s_txbuf, MISAKA_BENCH_SOFT_SPI_SIZE);
+	}
+	else
+	{
+		bus->ops->recv(bus->ctx, s_rxbuf, MISAKA_BENCH_SOFT_SPI_SIZE);
+	}
+}
+
+/**
+ * @brief 测量一项软件spi收发
+ * @param bus spi总线
+ * @param api MISAKA_BENCH_SOFT_SPI_x
+ * @param mode 模式
+ */
+static void misaka_bench_soft_spi_case(misaka_spi_bus_t *bus, uint8_t api, uint8_t mode)
+{
+	misaka_spi_configuration_t cfg = {0};
+	struct misaka_bench_result_struct r;
+	uint64_t ns, cycles;
+	uint32_t i, pin_calls = 0;
+	double bits;
+
+	cfg.mode = mode;
+	cfg.data_width = 8;
+	bus->ops->configure(bus->ctx, NULL, &cfg);
+
+	ns = misaka_bench_ns();
+	misaka_bench_soft_spi_once(bus, api, mode);
+	ns = misaka_bench_ns() - ns;
+	r.iterations = s_quick ? 2 : (uint32_t) (MISAKA_BENCH_TARGET_NS / (ns + 1));
+	if (r.iterations < 2)
+	{
+		r.iterations = 2;
+	}
+	if (r.iterations > MISAKA_BENCH_MAX_ITERS)
+	{
+		r.iterations = MISAKA_BENCH_MAX_ITERS;
+	}
+
+	ns = misaka_bench_ns();
+	cycles = MISAKA_BENCH_CYCLES();
+	for (i = 0; i < r.iterations; i++)
+	{
+		misaka_bench_soft_spi_once(bus, api, mode);
+		pin_calls += s_slave.pin_calls;
+	}
+	r.cycles = MISAKA_BENCH_CYCLES() - cycles;
+	r.ns = misaka_bench_ns() - ns;
+	bits = (double) MISAKA_BENCH_SOFT_SPI_SIZE * 8 * r.iterations;
+
+	misaka_bench_separator();
+	printf("{\"api\": \"%s\", \"mode\": %u, \"first\": \"%s\", \"size\": %u, \"iterations\": %u, ",
+	       s_soft_spi_api[api], mode & (MISAKA_SPI_CPOL | MISAKA_SPI_CPHA), (mode & MISAKA_SPI_MSB) ? "msb" : "lsb",
+	       MISAKA_BENCH_SOFT_SPI_SIZE, r.iterations);
+	printf("\"bits_per_second\": %.0f, \"ns_per_bit\": %.2f, ", bits * 1e9 / (double) r.ns, (double) r.ns / bits);
+	if (MISAKA_BENCH_HAS_CYCLES)
+	{
+		printf("\"cycles_per_bit\": %.1f, ", (double) r.cycles / bits);
+	}
+	else
+	{
+		printf("\"cycles_per_bit\": null, ");
+	}
+	printf("\"pin_calls_per_bit\": %.2f}", (double) pin_calls / bits);
+}
+
+/**
+ * @brief 遍历软件spi的收发方向、模式与位序
+ */
+static void misaka_bench_soft_spi(void)
+{
+	static misaka_spi_bus_t bus;
+	uint8_t api, mode;
+
+	misaka_bench_soft_spi_bus_init(&bus, NULL);
+	for (api = MISAKA_BENCH_SOFT_SPI_SEND_RECV; api <= MISAKA_BENCH_SOFT_SPI_RECV; api++)
+	{
+		for (mode = 0; mode <= MISAKA_SPI_MODE_MASK; mode++)
+		{
+			misaka_bench_soft_spi_case(&bus, api, mode);
+		}
+	}
+}
+
+/**
+ * @brief 遍历模拟i2c的接口、标志、长度与引脚开销
+ * @param legacy 1:misaka_soft_i2c_t 0:共享操作表
+ */
+static void misaka_bench_i2c(uint8_t legacy)
+{
+	static struct misaka_bench_i2c_struct b;
+	const struct misaka_bench_flags_struct *flags;
+	uint32_t c, s, f, nflags;
+	uint8_t api;
+
+	memset(&b, 0, sizeof(b));
+	b.legacy = legacy;
+	misaka_sim_i2c_legacy_init(&b.i2c, &b.gpio, 1);
+	misaka_sim_i2c_bus_init(&b.bus, &b.gpio, 1);
+	b.i2c.stat = &b.stat;
+	b.bus.stat = &b.stat;
+
+	for (c = 0; c < sizeof(s_i2c_costs) / sizeof(s_i2c_costs[0]); c++)
+	{
+		b.gpio.cost = s_i2c_costs[c];
+		for (api = MISAKA_BENCH_I2C_TRANSFER; api <= MISAKA_BENCH_I2C_SEND_THEN_SEND; api++)
+		{
+			if (api == MISAKA_BENCH_I2C_SEND)
+			{
+				flags = s_send_flags;
+				nflags = sizeof(s_send_flags) / sizeof(s_send_flags[0]);
+			}
+			else if (api == MISAKA_BENCH_I2C_RECV)
+			{
+				flags = s_recv_flags;
+				nflags = sizeof(s_recv_flags) / sizeof(s_recv_flags[0]);
+			}
+			else
+			{
+				flags = s_none_flags;
+				nflags = 1;
+			}
+
+			for (f = 0; f < nflags; f++)
+			{
+				for (s = 0; s < sizeof(s_i2c_sizes) / sizeof(s_i2c_sizes[0]); s++)
+				{
+					misaka_bench_i2c_case(&b, api, &flags[f], s_i2c_sizes[s]);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief 遍历spi的接口、长度与回调开销
+ * @param legacy 1:不带上下文的总线函数 0:共享操作表
+ */
+static void misaka_bench_spi(uint8_t legacy)
+{
+	static struct misaka_bench_spi_struct b;
+	uint32_t c, s;
+	uint8_t api;
+
+	memset(&b, 0, sizeof(b));
+	b.legacy = legacy;
+	if (legacy)
+	{
+		misaka_sim_spi_legacy_init(&b.bus, &b.device, &b.sim);
+	}
+	else
+	{
+		misaka_sim_spi_bus_init(&b.bus, &b.device, &b.sim);
+	}
+
+	for (c = 0; c < sizeof(s_spi_costs) / sizeof(s_spi_costs[0]); c++)
+	{
+		b.sim.cost = s_spi_costs[c];
+		for (api = MISAKA_BENCH_SPI_MESSAGE; api <= MISAKA_BENCH_SPI_SEND_THEN_SEND; api++)
+		{
+			for (s = 0; s < sizeof(s_spi_sizes) / sizeof(s_spi_sizes[0]); s++)
+			{
+				misaka_bench_spi_case(&b, api, s_spi_sizes[s]);
+			}
+		}
+	}
+}
+
+/**
+ * @brief 遍历flash的读线宽、写入与擦除长度
+ * @param single 1:控制器只支持单线 0:支持双线/四线
+ */
+static void misaka_bench_flash(uint8_t single)
+{
+	static struct misaka_bench_flash_struct b;
+	uint32_t s;
+
+	memset(&b, 0, sizeof(b));
+	b.single = single;
+	b.bus = *misaka_spi_flash_sim_init(s_flash_mem, MISAKA_BENCH_FLASH_SIZE, MISAKA_BENCH_FLASH_BUSY_POLLS);
+	if (single)
+	{
+		b.ops = *b.bus.ops;
+		b.ops.send_lines = NULL;
+		b.ops.recv_lines = NULL;
+		b.bus.ops = &b.ops;
+	}
+	b.device.cs_ops = &misaka_spi_flash_sim_cs_ops;
+	b.device.bus = &b.bus;
+	b.device.config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	b.device.config.data_width = 8;
+	b.flash.spi = &b.device;
+	if (misaka_spi_flash_init(&b.flash) != 0)
+	{
+		return;
+	}
+
+	for (s = 0; s < sizeof(s_flash_read_sizes) / sizeof(s_flash_read_sizes[0]); s++)
+	{
+		misaka_bench_flash_case(&b, MISAKA_BENCH_FLASH_READ, s_flash_read_sizes[s]);
+	}
+	if (single)
+	{
+		return;
+	}
+	for (s = 0; s < sizeof(s_flash_write_sizes) / sizeof(s_flash_write_sizes[0]); s++)
+	{
+		misaka_bench_flash_case(&b, MISAKA_BENCH_FLASH_WRITE, s_flash_write_sizes[s]);
+	}
+	for (s = 0; s < sizeof(s_flash_erase_sizes) / sizeof(s_flash_erase_sizes[0]); s++)
+	{
+		misaka_bench_flash_case(&b, MISAKA_BENCH_FLASH_ERASE, s_flash_erase_sizes[s]);
+	}
+}
+
+/**
+ * @brief 遍历sd卡的读写与块数
+ * @param use_crc 1:开启crc
+ */
+static void misaka_bench_sd(uint8_t use_crc)
+{
+	static struct misaka_bench_sd_struct b;
+	uint32_t c;
+	uint8_t api;
+
+	memset(&b, 0, sizeof(b));
+	b.device.cs_ops = &misaka_spi_sd_sim_cs_ops;
+	b.device.bus = misaka_spi_sd_sim_init(s_sd_mem, MISAKA_BENCH_SD_BLOCKS, MISAKA_BENCH_SD_BUSY_BYTES);
+	b.device.config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	b.device.config.data_width = 8;
+	b.sd.spi = &b.device;
+	b.sd.delay_ms = misaka_bench_delay_ms;
+	b.sd.init_hz = 400000;
+	b.sd.max_hz = 25000000;
+	b.sd.use_crc = use_crc;
+	if (misaka_spi_sd_init(&b.sd) != 0)
+	{
+		return;
+	}
+
+	for (api = MISAKA_BENCH_SD_READ; api <= MISAKA_BENCH_SD_WRITE; api++)
+	{
+		for (c = 0; c < sizeof(s_sd_counts) / sizeof(s_sd_counts[0]); c++)
+		{
+			misaka_bench_sd_case(&b, api, s_sd_counts[c]);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t i;
+
+	s_quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	for (i = 0; i < MISAKA_BENCH_BUF_SIZE; i++)
+	{
+		s_txbuf[i] = (uint8_t) (i * 37 + 11);
+	}
+
+	printf("{\n  \"version\": 1,\n  \"cycles\": \"%s\",\n", MISAKA_BENCH_HAS_CYCLES ? "tsc" : "none");
+
+	printf("  \"i2c\": [");
+	s_first = 1;
+	misaka_bench_i2c(1);
+	misaka_bench_i2c(0);
+	printf("\n  ],\n");
+
+	printf("  \"spi\": [");
+	s_first = 1;
+	misaka_bench_spi(1);
+	misaka_bench_spi(0);
+	printf("\n  ],\n");
+
+	printf("  \"soft_spi\": [");
+	s_first = 1;
+	misaka_bench_soft_spi();
+	printf("\n  ],\n");
+
+	printf("  \"spi_flash\": [");
+	s_first = 1;
+	misaka_bench_flash(0);
+	misaka_bench_flash(1);
+	printf("\n  ],\n");
+
+	printf("  \"spi_sd\": [");
+	s_first = 1;
+	misaka_bench_sd(0);
+	misaka_bench_sd(1);
+	printf("\n  ]\n}\n");
+
+	return 0;
+}
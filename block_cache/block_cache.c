@@ -0,0 +1,464 @@
+/**
+ * @file block_cache.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include <string.h>
+#include "misaka_device/block_cache.h"
+
+/**
+ * @brief 获取缓存块的数据
+ * @param cache 缓存
+ * @param index 缓存块序号
+ * @return uint8_t* @c 数据
+ */
+static uint8_t *misaka_block_cache_data(misaka_block_cache_t *cache, uint32_t index)
+{
+	return cache->arena + index * cache->block_size;
+}
+
+/**
+ * @brief 查找块
+ * @param cache 缓存
+ * @param block 块号
+ * @return int32_t @c 缓存块序号，-1为未命中
+ */
+static int32_t misaka_block_cache_lookup(misaka_block_cache_t *cache, uint32_t block)
+{
+	uint32_t i;
+
+	for (i = 0; i < cache->block_num; i++)
+	{
+		if (cache->entries[i].valid && cache->entries[i].block == block)
+		{
+			return (int32_t) i;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @brief 标记访问
+ * @param cache 缓存
+ * @param index 缓存块序号
+ */
+static void misaka_block_cache_touch(misaka_block_cache_t *cache, uint32_t index)
+{
+	cache->entries[index].age = ++cache->tick;
+	cache->entries[index].ref = 1;
+}
+
+/**
+ * @brief 写回脏块
+ * @param cache 缓存
+ * @param index 缓存块序号
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_block_cache_writeback(misaka_block_cache_t *cache, uint32_t index)
+{
+	misaka_block_cache_entry_t *entry = &cache->entries[index];
+
+	if (!entry->valid || !entry->dirty)
+	{
+		return 0;
+	}
+
+	cache->device_writes++;
+	if (cache->write(cache->device, entry->block * cache->block_size, misaka_block_cache_data(cache, index), cache->block_size) != 0)
+	{
+		return 1;
+	}
+	entry->dirty = 0;
+
+	return 0;
+}
+
+/**
+ * @brief 选择替换的缓存块
+ * @param cache 缓存
+ * @return uint32_t @c 缓存块序号
+ */
+static uint32_t misaka_block_cache_victim(misaka_block_cache_t *cache)
+{
+	uint32_t i, victim = 0;
+
+	for (i = 0; i < cache->block_num; i++)
+	{
+		if (!cache->entries[i].valid)
+		{
+			return i;
+		}
+	}
+
+	if (cache->policy == MISAKA_BLOCK_CACHE_CLOCK)
+	{
+		while (cache->entries[cache->hand].ref)
+		{
+			cache->entries[cache->hand].ref = 0;
+			cache->hand = (uint16_t) ((cache->hand + 1) % cache->block_num);
+		}
+		victim = cache->hand;
+		cache->hand = (uint16_t) ((cache->hand + 1) % cache->block_num);
+		return victim;
+	}
+
+	for (i = 1; i < cache->block_num; i++)
+	{
+		if ((int32_t) (cache->entries[i].age - cache->entries[victim].age) < 0)
+		{
+			victim = i;
+		}
+	}
+
+	return victim;
+}
+
+/**
+ * @brief 缓存块能否被预读覆盖：空闲，或按替换策略已是冷块（CLOCK为访问位已清除，LRU为最久未访问的count个之一）
+ * @param cache 缓存
+ * @param index 缓存块序号
+ * @param count 预读块数
+ * @return 1:能 0:不能
+ */
+static uint8_t misaka_block_cache_cold(misaka_block_cache_t *cache, uint32_t index, uint32_t count)
+{
+	misaka_block_cache_entry_t *entry = &cache->entries[index];
+	uint32_t i, older = 0;
+
+	if (!entry->valid)
+	{
+		return 1;
+	}
+
+	if (cache->policy == MISAKA_BLOCK_CACHE_CLOCK)
+	{
+		return entry->ref == 0;
+	}
+
+	for (i = 0; i < cache->block_num && older < count; i++)
+	{
+		if (cache->entries[i].valid && (int32_t) (cache->entries[i].age - entry->age) < 0)
+		{
+			older++;
+		}
+	}
+
+	return older < count;
+}
+
+/**
+ * @brief 将块读入缓存，顺序访问时从替换策略选中的缓存块起连续预读，整段一次读取
+ * @param cache 缓存
+ * @param block 块号
+ * @return int32_t @c 缓存块序号，-1为失败
+ */
+static int32_t misaka_block_cache_load(misaka_block_cache_t *cache, uint32_t block)
+{
+	uint32_t i, index, count = 1;
+
+	index = misaka_block_cache_victim(cache);
+
+	if (cache->sequential >= 2 && cache->readahead > 1)
+	{
+		count = cache->readahead < cache->block_num - index ? cache->readahead : cache->block_num - index;
+		/** < 预读只占用其后的空闲块与冷块，热块不被挤出；已缓存的后续块不再重复读入，也不越过存储末尾 */
+		for (i = 1; i < count; i++)
+		{
+			if ((cache->capacity != 0 && (block + i + 1) * cache->block_size > cache->capacity)
+				|| misaka_block_cache_lookup(cache, block + i) >= 0
+				|| !misaka_block_cache_cold(cache, index + i, cache->readahead))
+			{
+				break;
+			}
+		}
+		count = i;
+	}
+
+	for (i = index; i < index + count; i++)
+	{
+		if (misaka_block_cache_writeback(cache, i) != 0)
+		{
+			return -1;
+		}
+		cache->entries[i].valid = 0;
+	}
+
+	cache->device_reads++;
+	if (cache->read(cache->device, block * cache->block_size, misaka_block_cache_data(cache, index), count * cache->block_size) != 0)
+	{
+		return -1;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		cache->entries[index + i].block = block + i;
+		cache->entries[index + i].valid = 1;
+		cache->entries[index + i].dirty = 0;
+		cache->entries[index + i].ref = 0;
+		cache->entries[index + i].age = cache->tick;
+	}
+	cache->readahead_blocks += count - 1;
+	misaka_block_cache_touch(cache, index);
+	if (cache->policy == MISAKA_BLOCK_CACHE_CLOCK && count > 1)
+	{
+		/** < 指针越过整段，下一次从最久未扫过的缓存块开始 */
+		cache->hand = (uint16_t) ((index + count) % cache->block_num);
+	}
+
+	return (int32_t) index;
+}
+
+/**
+ * @brief 查找块，未命中时读入
+ * @param cache 缓存
+ * @param block 块号
+ * @return int32_t @c 缓存块序号，-1为失败
+ */
+static int32_t misaka_block_cache_get(misaka_block_cache_t *cache, uint32_t block)
+{
+	int32_t index = misaka_block_cache_lookup(cache, block);
+
+	if (index >= 0)
+	{
+		cache->hits++;
+		misaka_block_cache_touch(cache, (uint32_t) index);
+		return index;
+	}
+
+	cache->misses++;
+
+	return misaka_block_cache_load(cache, block);
+}
+
+/**
+ * @brief 更新顺序访问检测
+ * @param cache 缓存
+ * @param addr 地址
+ * @param len 数据长度
+ */
+static void misaka_block_cache_detect(misaka_block_cache_t *cache, uint32_t addr, uint32_t len)
+{
+	if (addr == cache->next_addr)
+	{
+		if (cache->sequential < 0xFF)
+		{
+			cache->sequential++;
+		}
+	}
+	else
+	{
+		cache->sequential = 0;
+	}
+	cache->next_addr = addr + len;
+}
+
+/**
+ * @brief 初始化，清空所有缓存块与统计
+ * @param cache 缓存
+ */
+void misaka_block_cache_init(misaka_block_cache_t *cache)
+{
+	misaka_block_cache_assert(cache != NULL);
+	misaka_block_cache_assert(cache->read != NULL);
+	misaka_block_cache_assert(cache->arena != NULL);
+	misaka_block_cache_assert(cache->entries != NULL);
+	misaka_block_cache_assert(cache->block_num != 0);
+
+	misaka_block_cache_invalidate(cache);
+	misaka_block_cache_reset_stat(cache);
+	cache->tick = 0;
+	cache->hand = 0;
+	cache->sequential = 0;
+	cache->next_addr = 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief 读数据，命中的块直接从内存复制，顺序访问未命中时一次读入多个块
+ * @param cache 缓存
+ * @param addr 地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_block_cache_read(misaka_block_cache_t *cache, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	int32_t index;
+	uint32_t offset, size;
+
+	misaka_block_cache_assert(cache != NULL);
+
+	misaka_block_cache_detect(cache, addr, len);
+
+	while (len)
+	{
+		offset = addr % cache->block_size;
+		size = cache->block_size - offset;
+		if (size > len)
+		{
+			size = len;
+		}
+
+		index = misaka_block_cache_get(cache, addr / cache->block_size);
+		if (index < 0)
+		{
+			return 1;
+		}
+		memcpy(buf, misaka_block_cache_data(cache, (uint32_t) index) + offset, size);
+
+		addr += size;
+		buf += size;
+		len -= size;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 写数据，写穿透时只更新已缓存的块，写回时不足一块的写入先读入该块
+ * @param cache 缓存
+ * @param addr 地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_block_cache_write(misaka_block_cache_t *cache, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	int32_t index;
+	uint32_t offset, size;
+
+	misaka_block_cache_assert(cache != NULL);
+
+	if (cache->write == NULL)
+	{
+		return 1;
+	}
+
+	if (cache->write_mode == MISAKA_BLOCK_CACHE_WRITE_THROUGH)
+	{
+		cache->device_writes++;
+		if (cache->write(cache->device, addr, buf, len) != 0)
+		{
+			return 1;
+		}
+	}
+
+	while (len)
+	{
+		offset = addr % cache->block_size;
+		size = cache->block_size - offset;
+		if (size > len)
+		{
+			size = len;
+		}
+
+		if (cache->write_mode == MISAKA_BLOCK_CACHE_WRITE_THROUGH)
+		{
+			index = misaka_block_cache_lookup(cache, addr / cache->block_size);
+		}
+		else if (size == cache->block_size && misaka_block_cache_lookup(cache, addr / cache->block_size) < 0)
+		{
+			/** < 整块覆盖无需读入 */
+			index = (int32_t) misaka_block_cache_victim(cache);
+			if (misaka_block_cache_writeback(cache, (uint32_t) index) != 0)
+			{
+				return 1;
+			}
+			cache->entries[index].block = addr / cache->block_size;
+			cache->entries[index].valid = 1;
+			misaka_block_cache_touch(cache, (uint32_t) index);
+		}
+		else
+		{
+			index = misaka_block_cache_get(cache, addr / cache->block_size);
+			if (index < 0)
+			{
+				return 1;
+			}
+		}
+
+		if (index >= 0)
+		{
+			memcpy(misaka_block_cache_data(cache, (uint32_t) index) + offset, buf, size);
+			if (cache->write_mode == MISAKA_BLOCK_CACHE_WRITE_BACK)
+			{
+				cache->entries[index].dirty = 1;
+			}
+		}
+
+		addr += size;
+		buf += size;
+		len -= size;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 将所有脏块写回存储设备
+ * @param cache 缓存
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_block_cache_flush(misaka_block_cache_t *cache)
+{
+	uint32_t i;
+	uint8_t result = 0;
+
+	misaka_block_cache_assert(cache != NULL);
+
+	for (i = 0; i < cache->block_num; i++)
+	{
+		if (misaka_block_cache_writeback(cache, i) != 0)
+		{
+			result = 1;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * @brief 丢弃所有缓存块（不写回），存储设备被旁路修改后调用
+ * @param cache 缓存
+ */
+void misaka_block_cache_invalidate(misaka_block_cache_t *cache)
+{
+	uint32_t i;
+
+	misaka_block_cache_assert(cache != NULL);
+
+	for (i = 0; i < cache->block_num; i++)
+	{
+		cache->entries[i].valid = 0;
+		cache->entries[i].dirty = 0;
+		cache->entries[i].ref = 0;
+	}
+}
+
+/**
+ * @brief 清零命中统计
+ * @param cache 缓存
+ */
+void misaka_block_cache_reset_stat(misaka_block_cache_t *cache)
+{
+	misaka_block_cache_assert(cache != NULL);
+
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->readahead_blocks = 0;
+	cache->device_reads = 0;
+	cache->device_writes = 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file block_cache_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/block_cache.h"
+#include "misaka_device/spi_flash.h"
+
+#define BLOCK_CACHE_BLOCK_SIZE      256
+#define BLOCK_CACHE_BLOCK_NUM       16
+
+static uint8_t s_block_cache_arena[BLOCK_CACHE_BLOCK_SIZE * BLOCK_CACHE_BLOCK_NUM];
+static misaka_block_cache_entry_t s_block_cache_entries[BLOCK_CACHE_BLOCK_NUM];
+static misaka_block_cache_t s_misaka_block_cache_obj;
+misaka_block_cache_t *misaka_block_cache_obj = NULL;
+
+/**
+ * @brief 读存储设备
+ * @param device 存储设备
+ * @param addr 地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t device_read(void *device, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return misaka_spi_flash_read((misaka_spi_flash_t *) device, addr, buf, len);
+}
+
+/**
+ * @brief 写存储设备，nor flash需由上层保证目标区域已擦除
+ * @param device 存储设备
+ * @param addr 地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t device_write(void *device, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	return misaka_spi_flash_write((misaka_spi_flash_t *) device, addr, buf, len);
+}
+
+static int misaka_block_cache_port_init(misaka_spi_flash_t *flash)
+{
+	s_misaka_block_cache_obj.device = flash;
+	s_misaka_block_cache_obj.read = device_read;
+	s_misaka_block_cache_obj.write = device_write;
+	s_misaka_block_cache_obj.capacity = flash->capacity;
+	s_misaka_block_cache_obj.arena = s_block_cache_arena;
+	s_misaka_block_cache_obj.entries = s_block_cache_entries;
+	s_misaka_block_cache_obj.block_size = BLOCK_CACHE_BLOCK_SIZE;
+	s_misaka_block_cache_obj.block_num = BLOCK_CACHE_BLOCK_NUM;
+	s_misaka_block_cache_obj.readahead = 4;
+	s_misaka_block_cache_obj.policy = MISAKA_BLOCK_CACHE_CLOCK;
+	s_misaka_block_cache_obj.write_mode = MISAKA_BLOCK_CACHE_WRITE_THROUGH;
+
+	misaka_block_cache_init(&s_misaka_block_cache_obj);
+	misaka_block_cache_obj = &s_misaka_block_cache_obj;
+
+	return 1;
+}
@@ -0,0 +1,283 @@
+/**
+ * @file bus_executor.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 提交方经无锁队列投递请求，唤醒只在工作线程空闲等待时经互斥量与条件变量；
+ * 工作线程每次被唤醒后取完队列中的全部请求，完成时经执行器的条件变量通知等待方。
+ */
+
+#include "misaka_device/bus_executor.h"
+
+/**
+ * @brief 投递后唤醒工作线程，在提交方线程中调用
+ * @param ctx 工作线程
+ */
+static void misaka_bus_executor_notify(void *ctx)
+{
+	misaka_bus_worker_t *w = (misaka_bus_worker_t *) ctx;
+
+	pthread_mutex_lock(&w->mutex);
+	w->signals++;
+	pthread_cond_signal(&w->cond);
+	pthread_mutex_unlock(&w->mutex);
+}
+
+/**
+ * @brief 请求完成后通知等待方，在工作线程中调用
+ * @param ctx 工作线程
+ * @param request 请求
+ */
+static void misaka_bus_executor_complete(void *ctx, misaka_bus_request_t *request)
+{
+	misaka_bus_executor_t *exec = ((misaka_bus_worker_t *) ctx)->executor;
+
+	(void) request;
+
+	pthread_mutex_lock(&exec->mutex);
+	exec->pending--;
+	pthread_cond_broadcast(&exec->cond);
+	pthread_mutex_unlock(&exec->mutex);
+}
+
+/**
+ * @brief 工作线程：等待唤醒，执行队列中的请求，停止时执行完剩余请求后退出
+ * @param arg 工作线程
+ * @return void* @c NULL
+ */
+static void *misaka_bus_executor_worker(void *arg)
+{
+	misaka_bus_worker_t *w = (misaka_bus_worker_t *) arg;
+	uint8_t stop;
+
+	for (;;)
+	{
+		pthread_mutex_lock(&w->mutex);
+		while (w->signals == 0 && !w->stop)
+		{
+			pthread_cond_wait(&w->cond, &w->mutex);
+		}
+		w->signals = 0;
+		stop = w->stop;
+		pthread_mutex_unlock(&w->mutex);
+
+		misaka_bus_queue_process(&w->queue);
+		if (stop)
+		{
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 查找请求所在总线的工作线程
+ * @param exec 执行器
+ * @param request 请求
+ * @return misaka_bus_worker_t* @c 工作线程，NULL为没有对应的工作线程
+ */
+static misaka_bus_worker_t *misaka_bus_executor_find(misaka_bus_executor_t *exec, misaka_bus_request_t *request)
+{
+	const void *bus;
+	uint32_t i;
+
+	if (request->type == MISAKA_BUS_REQUEST_I2C)
+	{
+		bus = request->i2c;
+	}
+	else
+	{
+		bus = request->spi != NULL ? request->spi->bus : NULL;
+	}
+
+	for (i = 0; i < exec->count; i++)
+	{
+		if (exec->workers[i].bus == bus)
+		{
+			return &exec->workers[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 停止前n个工作线程
+ * @param exec 执行器
+ * @param n 工作线程数
+ */
+static void misaka_bus_executor_join(misaka_bus_executor_t *exec, uint32_t n)
+{
+	misaka_bus_worker_t *w;
+	uint32_t i;
+
+	for (i = 0; i < n; i++)
+	{
+		w = &exec->workers[i];
+		pthread_mutex_lock(&w->mutex);
+		w->stop = 1;
+		pthread_cond_signal(&w->cond);
+		pthread_mutex_unlock(&w->mutex);
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		w = &exec->workers[i];
+		pthread_join(w->thread, NULL);
+		pthread_cond_destroy(&w->cond);
+		pthread_mutex_destroy(&w->mutex);
+	}
+}
+
+/**
+ * @brief 初始化队列并启动各总线的工作线程
+ * @param exec 执行器
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_executor_start(misaka_bus_executor_t *exec)
+{
+	misaka_bus_worker_t *w;
+	uint32_t i;
+
+	misaka_bus_executor_assert(exec != NULL);
+	misaka_bus_executor_assert(exec->workers != NULL);
+
+	for (i = 0; i < exec->count; i++)
+	{
+		w = &exec->workers[i];
+		w->queue.cells = w->cells;
+		w->queue.size = w->size;
+		w->queue.notify = misaka_bus_executor_notify;
+		w->queue.complete = misaka_bus_executor_complete;
+		w->queue.ctx = w;
+		if (misaka_bus_queue_init(&w->queue) != 0)
+		{
+			return 1;
+		}
+		w->executor = exec;
+		w->signals = 0;
+		w->stop = 0;
+	}
+
+	pthread_mutex_init(&exec->mutex, NULL);
+	pthread_cond_init(&exec->cond, NULL);
+	exec->pending = 0;
+
+	for (i = 0; i < exec->count; i++)
+	{
+		w = &exec->workers[i];
+		pthread_mutex_init(&w->mutex, NULL);
+		pthread_cond_init(&w->cond, NULL);
+		if (pthread_create(&w->thread, NULL, misaka_bus_executor_worker, w) != 0)
+		{
+			pthread_cond_destroy(&w->cond);
+			pthread_mutex_destroy(&w->mutex);
+			misaka_bus_executor_join(exec, i);
+			pthread_cond_destroy(&exec->cond);
+			pthread_mutex_destroy(&exec->mutex);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 提交请求到其所在总线的队列，不阻塞，可在多个线程中并发调用
+ * @param exec 执行器
+ * @param request 请求
+ * @return 0:成功 1:没有对应总线的工作线程、队列已满或请求尚未完成
+ */
+uint8_t misaka_bus_executor_submit(misaka_bus_executor_t *exec, misaka_bus_request_t *request)
+{
+	misaka_bus_worker_t *w;
+
+	misaka_bus_executor_assert(exec != NULL);
+	misaka_bus_executor_assert(request != NULL);
+
+	w = misaka_bus_executor_find(exec, request);
+	if (w == NULL)
+	{
+		return 1;
+	}
+
+	/** < 先计数再投递，请求可能在投递返回前就已完成 */
+	pthread_mutex_lock(&exec->mutex);
+	exec->pending++;
+	pthread_mutex_unlock(&exec->mutex);
+
+	if (misaka_bus_queue_post(&w->queue, request) != 0)
+	{
+		pthread_mutex_lock(&exec->mutex);
+		exec->pending--;
+		pthread_cond_broadcast(&exec->cond);
+		pthread_mutex_unlock(&exec->mutex);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 等待请求完成
+ * @param exec 执行器
+ * @param request 请求
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_executor_wait(misaka_bus_executor_t *exec, misaka_bus_request_t *request)
+{
+	misaka_bus_executor_assert(exec != NULL);
+	misaka_bus_executor_assert(request != NULL);
+
+	pthread_mutex_lock(&exec->mutex);
+	while (__atomic_load_n(&request->busy, __ATOMIC_ACQUIRE) != 0)
+	{
+		pthread_cond_wait(&exec->cond, &exec->mutex);
+	}
+	pthread_mutex_unlock(&exec->mutex);
+
+	return request->result;
+}
+
+/**
+ * @brief 等待全部已提交的请求完成，包括回调中再次提交的请求
+ * @param exec 执行器
+ */
+void misaka_bus_executor_wait_all(misaka_bus_executor_t *exec)
+{
+	misaka_bus_executor_assert(exec != NULL);
+
+	pthread_mutex_lock(&exec->mutex);
+	while (exec->pending != 0)
+	{
+		pthread_cond_wait(&exec->cond, &exec->mutex);
+	}
+	pthread_mutex_unlock(&exec->mutex);
+}
+
+/**
+ * @brief 执行完已提交的请求后停止各工作线程
+ * @param exec 执行器
+ */
+void misaka_bus_executor_stop(misaka_bus_executor_t *exec)
+{
+	misaka_bus_executor_assert(exec != NULL);
+
+	misaka_bus_executor_wait_all(exec);
+	misaka_bus_executor_join(exec, exec->count);
+	pthread_cond_destroy(&exec->cond);
+	pthread_mutex_destroy(&exec->mutex);
+}
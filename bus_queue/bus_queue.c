@@ -0,0 +1,231 @@
+/**
+ * @file bus_queue.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/bus_queue.h"
+
+/**
+ * 原子操作：GNU兼容编译器使用内建原子操作，多核同样适用；
+ * 其他编译器读写32位对齐变量本身是原子的，比较交换与自增在临界区中完成（仅适用于单核）
+ */
+#if defined(__GNUC__)
+#define misaka_bus_queue_load(ptr)          __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define misaka_bus_queue_store(ptr, value)  __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#else
+#define misaka_bus_queue_load(ptr)          (*(ptr))
+#define misaka_bus_queue_store(ptr, value)  do { *(ptr) = (value); } while (0)
+#endif
+
+/**
+ * @brief 比较交换
+ * @param q 队列
+ * @param ptr 变量
+ * @param expected 期望值，失败时更新为当前值
+ * @param desired 新值
+ * @return 1:成功 0:失败
+ */
+static uint8_t misaka_bus_queue_cas(misaka_bus_queue_t *q, volatile uint32_t *ptr, uint32_t *expected, uint32_t desired)
+{
+#if defined(__GNUC__)
+	(void) q;
+	return __atomic_compare_exchange_n(ptr, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#else
+	uint8_t ret = 0;
+
+	q->critical_enter();
+	if (*ptr == *expected)
+	{
+		*ptr = desired;
+		ret = 1;
+	}
+	else
+	{
+		*expected = *ptr;
+	}
+	q->critical_exit();
+
+	return ret;
+#endif
+}
+
+/**
+ * @brief 原子自增
+ * @param q 队列
+ * @param ptr 变量
+ */
+static void misaka_bus_queue_inc(misaka_bus_queue_t *q, volatile uint32_t *ptr)
+{
+#if defined(__GNUC__)
+	(void) q;
+	__atomic_fetch_add(ptr, 1, __ATOMIC_RELAXED);
+#else
+	q->critical_enter();
+	(*ptr)++;
+	q->critical_exit();
+#endif
+}
+
+/**
+ * @brief 执行一个请求
+ * @param request 请求
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_bus_queue_execute(misaka_bus_request_t *request)
+{
+	if (request->type == MISAKA_BUS_REQUEST_I2C)
+	{
+		return misaka_soft_i2c_bus_transfer(request->i2c, request->msgs, request->num) == request->num ? 0 : 1;
+	}
+
+	return misaka_spi_transfer_message(request->spi, request->message);
+}
+
+/**
+ * @brief 初始化队列
+ * @param q 队列
+ * @return 0:成功 1:槽位数不是2的幂
+ */
+uint8_t misaka_bus_queue_init(misaka_bus_queue_t *q)
+{
+	uint32_t i;
+
+	misaka_bus_queue_assert(q != NULL);
+	misaka_bus_queue_assert(q->cells != NULL);
+
+	if (q->size == 0 || (q->size & (q->size - 1)) != 0)
+	{
+		return 1;
+	}
+
+	for (i = 0; i < q->size; i++)
+	{
+		q->cells[i].seq = i;
+		q->cells[i].request = NULL;
+	}
+	q->enqueue_pos = 0;
+	q->dequeue_pos = 0;
+	q->overflows = 0;
+	q->duplicates = 0;
+	q->processed = 0;
+
+	return 0;
+}
+
+/**
+ * @brief 投递请求，不阻塞，可在中断与多个任务中并发调用
+ * @param q 队列
+ * @param request 请求
+ * @return 0:成功 1:队列已满或请求尚未完成
+ */
+uint8_t misaka_bus_queue_post(misaka_bus_queue_t *q, misaka_bus_request_t *request)
+{
+	misaka_bus_queue_cell_t *cell;
+	uint32_t pos, seq, idle = 0;
+	int32_t diff;
+
+	misaka_bus_queue_assert(q != NULL);
+	misaka_bus_queue_assert(request != NULL);
+
+	if (!misaka_bus_queue_cas(q, &request->busy, &idle, 1))
+	{
+		misaka_bus_queue_inc(q, &q->duplicates);
+		return 1;
+	}
+
+	pos = misaka_bus_queue_load(&q->enqueue_pos);
+	for (;;)
+	{
+		cell = &q->cells[pos & (q->size - 1)];
+		seq = misaka_bus_queue_load(&cell->seq);
+		diff = (int32_t) (seq - pos);
+		if (diff == 0)
+		{
+			/** < 槽位空闲，领取成功后独占该槽位；失败时pos被更新为最新的投递位置 */
+			if (misaka_bus_queue_cas(q, &q->enqueue_pos, &pos, pos + 1))
+			{
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			/** < 槽位尚未被处理方释放，队列已满 */
+			misaka_bus_queue_store(&request->busy, 0);
+			misaka_bus_queue_inc(q, &q->overflows);
+			return 1;
+		}
+		else
+		{
+			pos = misaka_bus_queue_load(&q->enqueue_pos);
+		}
+	}
+
+	cell->request = request;
+	misaka_bus_queue_store(&cell->seq, pos + 1);
+
+	if (q->notify != NULL)
+	{
+		q->notify(q->ctx);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 依次执行已投递的请求并调用回调，只能由一个处理方调用
+ * @param q 队列
+ * @return uint32_t @c 本次处理的请求数
+ */
+uint32_t misaka_bus_queue_process(misaka_bus_queue_t *q)
+{
+	misaka_bus_queue_cell_t *cell;
+	misaka_bus_request_t *request;
+	uint32_t pos, count = 0;
+	uint8_t result;
+
+	misaka_bus_queue_assert(q != NULL);
+
+	for (;;)
+	{
+		pos = q->dequeue_pos;
+		cell = &q->cells[pos & (q->size - 1)];
+		if (misaka_bus_queue_load(&cell->seq) != pos + 1)
+		{
+			/** < 队列为空，或该槽位的投递方尚未发布 */
+			break;
+		}
+
+		request = cell->request;
+		misaka_bus_queue_store(&cell->seq, pos + q->size);
+		q->dequeue_pos = pos + 1;
+
+		result = misaka_bus_queue_execute(request);
+		request->result = result;
+		misaka_bus_queue_store(&request->busy, 0);
+		if (request->callback != NULL)
+		{
+			request->callback(request, result);
+		}
+		if (q->complete != NULL)
+		{
+			q->complete(q->ctx, request);
+		}
+		count++;
+	}
+	q->processed += count;
+
+	return count;
+}
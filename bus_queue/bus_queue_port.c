@@ -0,0 +1,107 @@
+/**
+ * @file bus_queue_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/bus_queue.h"
+
+#define BUS_QUEUE_SIZE      8
+
+static misaka_bus_queue_cell_t s_bus_queue_cells[BUS_QUEUE_SIZE];
+static misaka_bus_queue_t s_misaka_bus_queue_obj;
+misaka_bus_queue_t *misaka_bus_queue_obj = NULL;
+
+static uint8_t s_accel_reg = 0x28;
+static uint8_t s_accel_data[6];
+static misaka_soft_i2c_message s_accel_msgs[2];
+static misaka_bus_request_t s_accel_request;
+
+/**
+ * @brief 唤醒处理任务，如释放信号量；裸机时可置标志由主循环处理
+ * @param ctx 上下文
+ */
+static void notify(void *ctx)
+{
+
+}
+
+static void critical_enter(void)
+{
+
+}
+
+static void critical_exit(void)
+{
+
+}
+
+/**
+ * @brief 读取完成，在处理方上下文中调用
+ * @param request 请求
+ * @param result 0:成功 1:失败
+ */
+static void accel_done(misaka_bus_request_t *request, uint8_t result)
+{
+
+}
+
+/**
+ * 加速度计数据就绪中断：只投递预先构建的读取请求，不访问总线
+ */
+void accel_data_ready_irq_handler(void)
+{
+	misaka_bus_queue_post(&s_misaka_bus_queue_obj, &s_accel_request);
+}
+
+/**
+ * 处理任务或主循环：被notify唤醒后执行所有已投递的请求
+ */
+void misaka_bus_queue_port_worker(void)
+{
+	misaka_bus_queue_process(&s_misaka_bus_queue_obj);
+}
+
+static int misaka_bus_queue_port_init(const misaka_soft_i2c_bus_t *i2c)
+{
+	s_misaka_bus_queue_obj.cells = s_bus_queue_cells;
+	s_misaka_bus_queue_obj.size = BUS_QUEUE_SIZE;
+	s_misaka_bus_queue_obj.notify = notify;
+	s_misaka_bus_queue_obj.ctx = NULL;
+	s_misaka_bus_queue_obj.critical_enter = critical_enter;
+	s_misaka_bus_queue_obj.critical_exit = critical_exit;
+	if (misaka_bus_queue_init(&s_misaka_bus_queue_obj) != 0)
+	{
+		return 0;
+	}
+
+	s_accel_msgs[0].addr = 0x19;
+	s_accel_msgs[0].flags = MISAKA_SOFT_I2C_WR;
+	s_accel_msgs[0].buf = &s_accel_reg;
+	s_accel_msgs[0].len = 1;
+	s_accel_msgs[1].addr = 0x19;
+	s_accel_msgs[1].flags = MISAKA_SOFT_I2C_RD;
+	s_accel_msgs[1].buf = s_accel_data;
+	s_accel_msgs[1].len = sizeof(s_accel_data);
+
+	s_accel_request.type = MISAKA_BUS_REQUEST_I2C;
+	s_accel_request.i2c = i2c;
+	s_accel_request.msgs = s_accel_msgs;
+	s_accel_request.num = 2;
+	s_accel_request.callback = accel_done;
+	misaka_bus_queue_obj = &s_misaka_bus_queue_obj;
+
+	return 1;
+}
@@ -0,0 +1,1406 @@
+/**
+ * @file bus_trace.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+/**
+ * spi总线与使用共享操作表的i2c总线挂接后以轨迹为上下文，不同轨迹可同时挂接到不同总线；
+ * misaka_soft_i2c_t的引脚函数没有上下文参数，以此方式挂接的轨迹同一时刻只能有一个。
+ * spi与i2c可同时挂接到同一轨迹，记录在同一时间线上。spi挂接时替换的是整条总线的操作，
+ * 按占用总线的设备过滤，只记录或回放挂接的设备，同一总线上其他设备的操作原样转发。
+ * 挂接后总线的可选操作与原总线一致，回放时需与记录时一致，否则核心层选择的传输路径不同，接收数据会错位。
+ * 回放时spi接收数据按记录顺序作为字节流提供，发送数据与记录的字节流比较；i2c每个字节对应一条记录。
+ */
+
+#include "misaka_device/bus_trace.h"
+
+static misaka_bus_trace_t *s_trace = NULL;
+
+/**
+ * 转发到挂接前的i2c引脚操作：使用共享操作表的总线或misaka_soft_i2c_t
+ */
+#define misaka_bus_trace_i2c_forward(trace, hook, ...)  ((trace)->i2c_bus != NULL ? (trace)->i2c_saved.ops->hook((trace)->i2c_saved.ctx, __VA_ARGS__) : (trace)->pins.hook(__VA_ARGS__))
+#define misaka_bus_trace_i2c_forward0(trace, hook)      ((trace)->i2c_bus != NULL ? (trace)->i2c_saved.ops->hook((trace)->i2c_saved.ctx) : (trace)->pins.hook())
+
+/**
+ * @brief 线数编码
+ * @param lines 线数
+ * @return uint8_t @c 编码
+ */
+static uint8_t misaka_bus_trace_lines_encode(uint8_t lines)
+{
+	return lines == MISAKA_SPI_LINES_QUAD ? 2 : (lines == MISAKA_SPI_LINES_DUAL ? 1 : 0);
+}
+
+/**
+ * @brief 追加一个字节，缓冲区已满时置溢出标志
+ * @param trace 轨迹
+ * @param byte 字节
+ */
+static void misaka_bus_trace_put(misaka_bus_trace_t *trace, uint8_t byte)
+{
+	if (trace->length < trace->size)
+	{
+		trace->buf[trace->length++] = byte;
+	}
+	else
+	{
+		trace->overflow = 1;
+	}
+}
+
+/**
+ * @brief 追加变长整数
+ * @param trace 轨迹
+ * @param value 值
+ */
+static void misaka_bus_trace_put_varint(misaka_bus_trace_t *trace, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		misaka_bus_trace_put(trace, (uint8_t) (value | 0x80));
+		value >>= 7;
+	}
+	misaka_bus_trace_put(trace, (uint8_t) value);
+}
+
+/**
+ * @brief 追加数据
+ * @param trace 轨迹
+ * @param buf 数据
+ * @param length 数据长度
+ */
+static void misaka_bus_trace_put_buf(misaka_bus_trace_t *trace, const uint8_t *buf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		misaka_bus_trace_put(trace, buf[i]);
+	}
+}
+
+/**
+ * @brief 读取变长整数
+ * @param trace 轨迹
+ * @param pos 位置，读取后更新
+ * @param value 值
+ * @return 0:成功 1:越界
+ */
+static uint8_t misaka_bus_trace_get_varint(misaka_bus_trace_t *trace, uint32_t *pos, uint32_t *value)
+{
+	uint8_t shift = 0;
+	uint8_t byte;
+
+	*value = 0;
+	do
+	{
+		if (*pos >= trace->length || shift > 28)
+		{
+			return 1;
+		}
+		byte = trace->buf[(*pos)++];
+		*value |= (uint32_t) (byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	return 0;
+}
+
+/**
+ * @brief 按位数计算总线时间
+ * @param bits 位数
+ * @param hz 时钟
+ * @return uint64_t @c 时间（ns）
+ */
+static uint64_t misaka_bus_trace_bits_ns(uint64_t bits, uint32_t hz)
+{
+	return hz ? bits * 1000000000ULL / hz : 0;
+}
+
+/**
+ * @brief 统计一条记录
+ * @param trace 轨迹，提供时钟与开销参数
+ * @param stat 统计
+ * @param record 记录
+ */
+static void misaka_bus_trace_account(misaka_bus_trace_t *trace, misaka_bus_trace_stat_t *stat, const misaka_bus_trace_record_t *record)
+{
+	switch (record->type)
+	{
+	case MISAKA_BUS_TRACE_SPI_XFER:
+		stat->ops++;
+		if (record->flags & MISAKA_BUS_TRACE_FLAG_TX)
+		{
+			stat->tx_bytes += record->length;
+		}
+		if (record->flags & MISAKA_BUS_TRACE_FLAG_RX)
+		{
+			stat->rx_bytes += record->length;
+		}
+		if (record->flags & MISAKA_BUS_TRACE_FLAG_FAIL)
+		{
+			stat->failures++;
+		}
+		stat->time_ns += misaka_bus_trace_bits_ns((uint64_t) record->length * 8 / record->lines, stat->spi_hz) + trace->op_overhead_ns;
+		break;
+	case MISAKA_BUS_TRACE_SPI_DUMMY:
+		stat->ops++;
+		if (record->flags & MISAKA_BUS_TRACE_FLAG_FAIL)
+		{
+			stat->failures++;
+		}
+		stat->time_ns += misaka_bus_trace_bits_ns(record->length, stat->spi_hz) + trace->op_overhead_ns;
+		break;
+	case MISAKA_BUS_TRACE_SPI_CS:
+		if (!(record->flags & MISAKA_BUS_TRACE_FLAG_LEVEL))
+		{
+			stat->cs_asserts++;
+		}
+		break;
+	case MISAKA_BUS_TRACE_SPI_CONFIG:
+		stat->spi_hz = record->max_hz;
+		break;
+	case MISAKA_BUS_TRACE_I2C_START:
+		stat->ops++;
+		stat->i2c_starts++;
+		stat->time_ns += misaka_bus_trace_bits_ns(1, trace->i2c_hz) + trace->op_overhead_ns;
+		break;
+	case MISAKA_BUS_TRACE_I2C_STOP:
+		stat->time_ns += misaka_bus_trace_bits_ns(1, trace->i2c_hz);
+		break;
+	case MISAKA_BUS_TRACE_I2C_WRITE:
+		stat->tx_bytes++;
+		if (!(record->flags & MISAKA_BUS_TRACE_FLAG_ACK))
+		{
+			stat->nacks++;
+		}
+		stat->time_ns += misaka_bus_trace_bits_ns(9, trace->i2c_hz);
+		break;
+	case MISAKA_BUS_TRACE_I2C_READ:
+		stat->rx_bytes++;
+		stat->time_ns += misaka_bus_trace_bits_ns((record->flags & MISAKA_BUS_TRACE_FLAG_NO_ACK) ? 8 : 9, trace->i2c_hz);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief 记录时把一条记录写入轨迹，缓冲区不足时丢弃整条记录，接收数据在操作完成后由misaka_bus_trace_commit补写
+ * @param trace 轨迹
+ * @param record 记录
+ */
+static void misaka_bus_trace_write(misaka_bus_trace_t *trace, const misaka_bus_trace_record_t *record)
+{
+	uint32_t start, tick;
+	uint8_t flags = record->flags;
+
+	if (trace->mode != MISAKA_BUS_TRACE_MODE_RECORD || trace->overflow)
+	{
+		return;
+	}
+
+	start = trace->length;
+	if (trace->get_tick_us != NULL)
+	{
+		flags |= MISAKA_BUS_TRACE_FLAG_TIME;
+	}
+	misaka_bus_trace_put(trace, (uint8_t) (record->type | flags));
+	if (trace->get_tick_us != NULL)
+	{
+		tick = trace->get_tick_us();
+		misaka_bus_trace_put_varint(trace, tick - trace->last_tick);
+		trace->last_tick = tick;
+	}
+
+	switch (record->type)
+	{
+	case MISAKA_BUS_TRACE_SPI_XFER:
+		misaka_bus_trace_put_varint(trace, record->length << 2 | misaka_bus_trace_lines_encode(record->lines));
+		if (flags & MISAKA_BUS_TRACE_FLAG_TX)
+		{
+			misaka_bus_trace_put_buf(trace, record->tx, record->length);
+		}
+		if (flags & MISAKA_BUS_TRACE_FLAG_RX)
+		{
+			/** < 先占位，接收缓冲区可能与发送缓冲区相同 */
+			misaka_bus_trace_put_buf(trace, record->rx, record->length);
+		}
+		break;
+	case MISAKA_BUS_TRACE_SPI_DUMMY:
+		misaka_bus_trace_put_varint(trace, record->length << 2 | misaka_bus_trace_lines_encode(record->lines));
+		break;
+	case MISAKA_BUS_TRACE_SPI_CONFIG:
+		misaka_bus_trace_put(trace, record->data);
+		misaka_bus_trace_put(trace, record->data_width);
+		misaka_bus_trace_put_varint(trace, record->max_hz);
+		break;
+	case MISAKA_BUS_TRACE_I2C_WRITE:
+	case MISAKA_BUS_TRACE_I2C_READ:
+		misaka_bus_trace_put(trace, record->data);
+		break;
+	default:
+		break;
+	}
+
+	if (trace->overflow)
+	{
+		/** < 轨迹中只保留完整的记录 */
+		trace->length = start;
+	}
+}
+
+/**
+ * @brief 解析一条记录
+ * @param trace 轨迹
+ * @param pos 记录位置，首条记录位于MISAKA_BUS_TRACE_HEADER_SIZE
+ * @param record 记录
+ * @return uint32_t @c 下一条记录的位置，0表示已到末尾或记录损坏
+ */
+uint32_t misaka_bus_trace_parse(misaka_bus_trace_t *trace, uint32_t pos, misaka_bus_trace_record_t *record)
+{
+	uint32_t value;
+	uint8_t head;
+
+	misaka_spi_assert(trace != NULL);
+	misaka_spi_assert(record != NULL);
+
+	if (pos >= trace->length)
+	{
+		return 0;
+	}
+
+	head = trace->buf[pos++];
+	record->type = head & 0x0F;
+	record->flags = head & 0xF0;
+	record->delta_us = 0;
+	record->length = 0;
+	record->lines = MISAKA_SPI_LINES_SINGLE;
+	record->tx = NULL;
+	record->rx = NULL;
+
+	if ((head & MISAKA_BUS_TRACE_FLAG_TIME) && misaka_bus_trace_get_varint(trace, &pos, &record->delta_us) != 0)
+	{
+		return 0;
+	}
+
+	switch (record->type)
+	{
+	case MISAKA_BUS_TRACE_SPI_XFER:
+	case MISAKA_BUS_TRACE_SPI_DUMMY:
+		if (misaka_bus_trace_get_varint(trace, &pos, &value) != 0)
+		{
+			return 0;
+		}
+		record->length = value >> 2;
+		record->lines = (uint8_t) (1 << (value & 0x03));
+		if (record->type == MISAKA_BUS_TRACE_SPI_DUMMY)
+		{
+			break;
+		}
+		if (record->flags & MISAKA_BUS_TRACE_FLAG_TX)
+		{
+			if (trace->length - pos < record->length)
+			{
+				return 0;
+			}
+			record->tx = &trace->buf[pos];
+			pos += record->length;
+		}
+		if (record->flags & MISAKA_BUS_TRACE_FLAG_RX)
+		{
+			if (trace->length - pos < record->length)
+			{
+				return 0;
+			}
+			record->rx = &trace->buf[pos];
+			pos += record->length;
+		}
+		break;
+	case MISAKA_BUS_TRACE_SPI_CONFIG:
+		if (trace->length - pos < 2)
+		{
+			return 0;
+		}
+		record->data = trace->buf[pos++];
+		record->data_width = trace->buf[pos++];
+		if (misaka_bus_trace_get_varint(trace, &pos, &record->max_hz) != 0)
+		{
+			return 0;
+		}
+		break;
+	case MISAKA_BUS_TRACE_I2C_WRITE:
+	case MISAKA_BUS_TRACE_I2C_READ:
+		if (pos >= trace->length)
+		{
+			return 0;
+		}
+		record->data = trace->buf[pos++];
+		break;
+	case MISAKA_BUS_TRACE_SPI_CS:
+	case MISAKA_BUS_TRACE_I2C_START:
+	case MISAKA_BUS_TRACE_I2C_STOP:
+		break;
+	default:
+		return 0;
+	}
+
+	return pos;
+}
+
+/**
+ * @brief 操作完成后提交一条记录：补写接收数据与失败标志并计入统计
+ * @param trace 轨迹
+ * @param pos 该记录在轨迹中的位置，提交后指向下一条记录
+ * @param end 操作前写入的记录的结束位置，pos到达end说明该记录因缓冲区不足未写入
+ * @param record 记录
+ * @param state 底层返回值
+ */
+static void misaka_bus_trace_commit(misaka_bus_trace_t *trace, uint32_t *pos, uint32_t end, misaka_bus_trace_record_t *record, uint8_t state)
+{
+	misaka_bus_trace_record_t written;
+	uint32_t next, i;
+
+	if (state != 0)
+	{
+		record->flags |= MISAKA_BUS_TRACE_FLAG_FAIL;
+	}
+	misaka_bus_trace_account(trace, &trace->stat, record);
+
+	if (*pos >= end || (next = misaka_bus_trace_parse(trace, *pos, &written)) == 0)
+	{
+		return;
+	}
+	trace->buf[*pos] |= record->flags & MISAKA_BUS_TRACE_FLAG_FAIL;
+	if (written.rx != NULL)
+	{
+		for (i = 0; i < written.length; i++)
+		{
+			trace->buf[written.rx - trace->buf + i] = record->rx[i];
+		}
+	}
+	*pos = next;
+}
+
+/**
+ * @brief 产生一条不依赖操作结果的记录
+ * @param trace 轨迹
+ * @param record 记录
+ */
+static void misaka_bus_trace_emit(misaka_bus_trace_t *trace, misaka_bus_trace_record_t *record)
+{
+	uint32_t pos = trace->length;
+
+	misaka_bus_trace_write(trace, record);
+	misaka_bus_trace_commit(trace, &pos, trace->length, record, 0);
+}
+
+/**
+ * @brief 清空统计与内部状态
+ * @param trace 轨迹
+ * @param mode 模式
+ */
+static void misaka_bus_trace_reset(misaka_bus_trace_t *trace, uint8_t mode)
+{
+	misaka_bus_trace_stat_t stat = {0};
+
+	if (trace->spi_hz == 0)
+	{
+		trace->spi_hz = 1000000;
+	}
+	if (trace->i2c_hz == 0)
+	{
+		trace->i2c_hz = 100000;
+	}
+
+	trace->stat = stat;
+	trace->stat.spi_hz = trace->spi_hz;
+	trace->overflow = 0;
+	trace->mode = mode;
+	trace->last_tick = trace->get_tick_us != NULL ? trace->get_tick_us() : 0;
+	trace->rx_pos = MISAKA_BUS_TRACE_HEADER_SIZE;
+	trace->rx_offset = 0;
+	trace->tx_pos = MISAKA_BUS_TRACE_HEADER_SIZE;
+	trace->tx_offset = 0;
+	trace->i2c_pos = MISAKA_BUS_TRACE_HEADER_SIZE;
+
+	trace->scl = 1;
+	trace->sda = 1;
+	trace->clocked = 0;
+	trace->sampled = 0;
+	trace->sample = 1;
+	trace->bits = 0;
+	trace->shift = 0;
+	trace->reading = 0;
+}
+
+/**
+ * @brief 开始记录，写入轨迹头并清空统计
+ * @param trace 轨迹
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_trace_record_init(misaka_bus_trace_t *trace)
+{
+	misaka_spi_assert(trace != NULL);
+
+	if (trace->buf == NULL || trace->size < MISAKA_BUS_TRACE_HEADER_SIZE)
+	{
+		return 1;
+	}
+
+	misaka_bus_trace_reset(trace, MISAKA_BUS_TRACE_MODE_RECORD);
+	trace->length = 0;
+	misaka_bus_trace_put(trace, (uint8_t) (MISAKA_BUS_TRACE_MAGIC));
+	misaka_bus_trace_put(trace, (uint8_t) (MISAKA_BUS_TRACE_MAGIC >> 8));
+	misaka_bus_trace_put(trace, (uint8_t) (MISAKA_BUS_TRACE_MAGIC >> 16));
+	misaka_bus_trace_put(trace, (uint8_t) (MISAKA_BUS_TRACE_MAGIC >> 24));
+
+	return 0;
+}
+
+/**
+ * @brief 校验轨迹头
+ * @param trace 轨迹
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_bus_trace_check(misaka_bus_trace_t *trace)
+{
+	if (trace->buf == NULL || trace->length < MISAKA_BUS_TRACE_HEADER_SIZE)
+	{
+		return 1;
+	}
+
+	return (trace->buf[0] | trace->buf[1] << 8 | (uint32_t) trace->buf[2] << 16 | (uint32_t) trace->buf[3] << 24) != MISAKA_BUS_TRACE_MAGIC;
+}
+
+/**
+ * @brief 开始回放，校验轨迹头并清空统计
+ * @param trace 轨迹
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_trace_replay_init(misaka_bus_trace_t *trace)
+{
+	misaka_spi_assert(trace != NULL);
+
+	if (misaka_bus_trace_check(trace) != 0)
+	{
+		return 1;
+	}
+
+	misaka_bus_trace_reset(trace, MISAKA_BUS_TRACE_MODE_REPLAY);
+
+	return 0;
+}
+
+/**
+ * @brief 离线统计整条轨迹，与记录过程中的统计一致，可用于对比两次记录
+ * @param trace 轨迹
+ * @param stat 统计
+ * @return 0:成功 1:轨迹损坏
+ */
+uint8_t misaka_bus_trace_analyze(misaka_bus_trace_t *trace, misaka_bus_trace_stat_t *stat)
+{
+	misaka_bus_trace_stat_t zero = {0};
+	misaka_bus_trace_record_t record = {0};
+	uint32_t pos = MISAKA_BUS_TRACE_HEADER_SIZE;
+
+	misaka_spi_assert(trace != NULL);
+	misaka_spi_assert(stat != NULL);
+
+	*stat = zero;
+	stat->spi_hz = trace->spi_hz;
+
+	if (misaka_bus_trace_check(trace) != 0)
+	{
+		return 1;
+	}
+
+	while (pos < trace->length)
+	{
+		pos = misaka_bus_trace_parse(trace, pos, &record);
+		if (pos == 0)
+		{
+			return 1;
+		}
+		misaka_bus_trace_account(trace, stat, &record);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 回放：按记录顺序提供接收数据，记录耗尽时补0xFF
+ * @param trace 轨迹
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ */
+static void misaka_bus_trace_replay_rx(misaka_bus_trace_t *trace, uint8_t *rxbuf, uint32_t length)
+{
+	misaka_bus_trace_record_t record = {0};
+	uint32_t next, n;
+
+	while (length > 0)
+	{
+		next = misaka_bus_trace_parse(trace, trace->rx_pos, &record);
+		if (next == 0)
+		{
+			trace->stat.mismatches++;
+			while (length-- > 0)
+			{
+				*rxbuf++ = 0xFF;
+			}
+			return;
+		}
+		if (record.type != MISAKA_BUS_TRACE_SPI_XFER || record.rx == NULL || trace->rx_offset >= record.length)
+		{
+			trace->rx_pos = next;
+			trace->rx_offset = 0;
+			continue;
+		}
+
+		n = record.length - trace->rx_offset;
+		n = n < length ? n : length;
+		for (next = 0; next < n; next++)
+		{
+			rxbuf[next] = record.rx[trace->rx_offset + next];
+		}
+		trace->rx_offset += n;
+		rxbuf += n;
+		length -= n;
+	}
+}
+
+/**
+ * @brief 回放：与记录的发送数据比较，不一致时计入mismatches
+ * @param trace 轨迹
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ */
+static void misaka_bus_trace_replay_tx(misaka_bus_trace_t *trace, const uint8_t *txbuf, uint32_t length)
+{
+	misaka_bus_trace_record_t record = {0};
+	uint32_t next, n, i;
+	uint8_t same = 1;
+
+	while (length > 0)
+	{
+		next = misaka_bus_trace_parse(trace, trace->tx_pos, &record);
+		if (next == 0)
+		{
+			same = 0;
+			break;
+		}
+		if (record.type != MISAKA_BUS_TRACE_SPI_XFER || record.tx == NULL || trace->tx_offset >= record.length)
+		{
+			trace->tx_pos = next;
+			trace->tx_offset = 0;
+			continue;
+		}
+
+		n = record.length - trace->tx_offset;
+		n = n < length ? n : length;
+		for (i = 0; i < n; i++)
+		{
+			if (txbuf[i] != record.tx[trace->tx_offset + i])
+			{
+				same = 0;
+			}
+		}
+		trace->tx_offset += n;
+		txbuf += n;
+		length -= n;
+	}
+
+	if (!same)
+	{
+		trace->stat.mismatches++;
+	}
+}
+
+/**
+ * @brief 设备时钟与上次记录的不同时产生SPI_CONFIG记录，核心层只在时钟改变后才调用configure，因此以设备配置为准
+ * @param trace 轨迹
+ */
+static void misaka_bus_trace_spi_config(misaka_bus_trace_t *trace)
+{
+	misaka_bus_trace_record_t record = {0};
+
+	if (trace->spi->config.max_hz == trace->stat.spi_hz)
+	{
+		return;
+	}
+
+	record.type = MISAKA_BUS_TRACE_SPI_CONFIG;
+	record.flags = 0;
+	record.data = trace->spi->config.mode;
+	record.data_width = trace->spi->config.data_width;
+	record.max_hz = trace->spi->config.max_hz;
+	misaka_bus_trace_emit(trace, &record);
+}
+
+/**
+ * @brief 填写spi传输或空周期记录，回放时比较发送数据
+ * @param trace 轨迹
+ * @param record 记录
+ * @param type 类型
+ * @param txbuf 发送数据，NULL表示不发送
+ * @param rxbuf 接收数据，NULL表示不接收
+ * @param length 数据长度或空周期数
+ * @param lines 线数
+ */
+static void misaka_bus_trace_spi_fill(misaka_bus_trace_t *trace, misaka_bus_trace_record_t *record, uint8_t type,
+									  uint8_t *txbuf, uint8_t *rxbuf, uint32_t length, uint8_t lines)
+{
+	record->type = type;
+	record->flags = (txbuf != NULL ? MISAKA_BUS_TRACE_FLAG_TX : 0) | (rxbuf != NULL ? MISAKA_BUS_TRACE_FLAG_RX : 0);
+	record->length = length;
+	record->lines = lines ? lines : MISAKA_SPI_LINES_SINGLE;
+	record->tx = txbuf;
+	record->rx = rxbuf;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_REPLAY && txbuf != NULL)
+	{
+		misaka_bus_trace_replay_tx(trace, txbuf, length);
+	}
+}
+
+/**
+ * @brief 提交spi记录，回放时先由轨迹提供接收数据
+ * @param trace 轨迹
+ * @param pos 记录位置
+ * @param end 操作前写入的记录的结束位置
+ * @param record 记录
+ * @param state 底层返回值
+ */
+static void misaka_bus_trace_spi_commit(misaka_bus_trace_t *trace, uint32_t *pos, uint32_t end, misaka_bus_trace_record_t *record, uint8_t state)
+{
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_REPLAY && record->rx != NULL)
+	{
+		misaka_bus_trace_replay_rx(trace, (uint8_t *) record->rx, record->length);
+	}
+	misaka_bus_trace_commit(trace, pos, end, record, state);
+}
+
+
+/**
+ * @brief 当前占用总线的是否为挂接的设备，同一总线上其他设备的操作直接转发，不记录也不回放
+ * @param trace 轨迹
+ * @return 1:是 0:否
+ */
+static uint8_t misaka_bus_trace_spi_traced(misaka_bus_trace_t *trace)
+{
+	return trace->spi->bus->owner == trace->spi;
+}
+
+/**
+ * @brief 开始一次spi操作：发送数据在操作前写入，避免收发共用缓冲区时被接收数据覆盖
+ * @param trace 轨迹
+ * @param record 记录
+ * @param type 类型
+ * @param txbuf 发送数据
+ * @param rxbuf 接收数据
+ * @param length 数据长度或空周期数
+ * @param lines 线数
+ * @return uint32_t @c 记录位置
+ */
+static uint32_t misaka_bus_trace_spi_begin(misaka_bus_trace_t *trace, misaka_bus_trace_record_t *record, uint8_t type,
+                                           uint8_t *txbuf, uint8_t *rxbuf, uint32_t length, uint8_t lines)
+{
+	uint32_t pos;
+
+	misaka_bus_trace_spi_config(trace);
+	misaka_bus_trace_spi_fill(trace, record, type, txbuf, rxbuf, length, lines);
+	pos = trace->length;
+	misaka_bus_trace_write(trace, record);
+
+	return pos;
+}
+
+/**
+ * @brief 结束一次spi操作
+ * @param trace 轨迹
+ * @param record 记录
+ * @param pos 记录位置
+ * @param state 底层返回值，回放时为0
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_bus_trace_spi_end(misaka_bus_trace_t *trace, misaka_bus_trace_record_t *record, uint32_t pos, uint8_t state)
+{
+	misaka_bus_trace_spi_commit(trace, &pos, trace->length, record, state);
+
+	return state;
+}
+
+static uint8_t misaka_bus_trace_spi_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t record = {0};
+	uint32_t pos;
+
+	if (!misaka_bus_trace_spi_traced(trace))
+	{
+		return trace->bus.ops->send_recv(trace->bus.ctx, txbuf, rxbuf, length);
+	}
+
+	pos = misaka_bus_trace_spi_begin(trace, &record, MISAKA_BUS_TRACE_SPI_XFER, txbuf, rxbuf, length, MISAKA_SPI_LINES_SINGLE);
+
+	return misaka_bus_trace_spi_end(trace, &record, pos, trace->mode == MISAKA_BUS_TRACE_MODE_RECORD ? trace->bus.ops->send_recv(trace->bus.ctx, txbuf, rxbuf, length) : 0);
+}
+
+static uint8_t misaka_bus_trace_spi_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t record = {0};
+	uint32_t pos;
+
+	if (!misaka_bus_trace_spi_traced(trace))
+	{
+		return trace->bus.ops->send(trace->bus.ctx, txbuf, length);
+	}
+
+	pos = misaka_bus_trace_spi_begin(trace, &record, MISAKA_BUS_TRACE_SPI_XFER, txbuf, NULL, length, MISAKA_SPI_LINES_SINGLE);
+
+	return misaka_bus_trace_spi_end(trace, &record, pos, trace->mode == MISAKA_BUS_TRACE_MODE_RECORD ? trace->bus.ops->send(trace->bus.ctx, txbuf, length) : 0);
+}
+
+static uint8_t misaka_bus_trace_spi_recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t record = {0};
+	uint32_t pos;
+
+	if (!misaka_bus_trace_spi_traced(trace))
+	{
+		return trace->bus.ops->recv(trace->bus.ctx, rxbuf, length);
+	}
+
+	pos = misaka_bus_trace_spi_begin(trace, &record, MISAKA_BUS_TRACE_SPI_XFER, NULL, rxbuf, length, MISAKA_SPI_LINES_SINGLE);
+
+	return misaka_bus_trace_spi_end(trace, &record, pos, trace->mode == MISAKA_BUS_TRACE_MODE_RECORD ? trace->bus.ops->recv(trace->bus.ctx, rxbuf, length) : 0);
+}
+
+static uint8_t misaka_bus_trace_spi_send_lines(void *ctx, uint8_t *txbuf, uint32_t length, uint8_t lines)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t record = {0};
+	uint32_t pos;
+
+	if (!misaka_bus_trace_spi_traced(trace))
+	{
+		return trace->bus.ops->send_lines(trace->bus.ctx, txbuf, length, lines);
+	}
+
+	pos = misaka_bus_trace_spi_begin(trace, &record, MISAKA_BUS_TRACE_SPI_XFER, txbuf, NULL, length, lines);
+
+	return misaka_bus_trace_spi_end(trace, &record, pos, trace->mode == MISAKA_BUS_TRACE_MODE_RECORD ? trace->bus.ops->send_lines(trace->bus.ctx, txbuf, length, lines) : 0);
+}
+
+static uint8_t misaka_bus_trace_spi_recv_lines(void *ctx, uint8_t *rxbuf, uint32_t length, uint8_t lines)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t record = {0};
+	uint32_t pos;
+
+	if (!misaka_bus_trace_spi_traced(trace))
+	{
+		return trace->bus.ops->recv_lines(trace->bus.ctx, rxbuf, length, lines);
+	}
+
+	pos = misaka_bus_trace_spi_begin(trace, &record, MISAKA_BUS_TRACE_SPI_XFER, NULL, rxbuf, length, lines);
+
+	return misaka_bus_trace_spi_end(trace, &record, pos, trace->mode == MISAKA_BUS_TRACE_MODE_RECORD ? trace->bus.ops->recv_lines(trace->bus.ctx, rxbuf, length, lines) : 0);
+}
+
+static uint8_t misaka_bus_trace_spi_dummy(void *ctx, uint8_t cycles, uint8_t lines)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t record = {0};
+	uint32_t pos;
+
+	if (!misaka_bus_trace_spi_traced(trace))
+	{
+		return trace->bus.ops->dummy(trace->bus.ctx, cycles, lines);
+	}
+
+	pos = misaka_bus_trace_spi_begin(trace, &record, MISAKA_BUS_TRACE_SPI_DUMMY, NULL, NULL, cycles, lines);
+
+	return misaka_bus_trace_spi_end(trace, &record, pos, trace->mode == MISAKA_BUS_TRACE_MODE_RECORD ? trace->bus.ops->dummy(trace->bus.ctx, cycles, lines) : 0);
+}
+
+static uint8_t misaka_bus_trace_spi_configure(void *ctx, misaka_spi_t *device, misaka_spi_configuration_t *cfg)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	if (device != trace->spi || trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		return trace->bus.ops->configure(trace->bus.ctx, device, cfg);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 消息链中一段对应的记录：cs选中、空周期、传输与cs释放
+ * @param trace 轨迹
+ * @param message 消息
+ * @param records 记录，最多4条
+ * @return uint8_t @c 记录数
+ */
+static uint8_t misaka_bus_trace_spi_segment(misaka_bus_trace_t *trace, misaka_spi_message_t *message, misaka_bus_trace_record_t *records)
+{
+	misaka_bus_trace_record_t zero = {0};
+	uint8_t num = 0;
+
+	/** < 记录数组逐段复用，cs记录不能带上一段传输的数据指针 */
+	records[0] = zero;
+	records[1] = zero;
+	records[2] = zero;
+	records[3] = zero;
+
+	if (message->cs_take)
+	{
+		records[num].type = MISAKA_BUS_TRACE_SPI_CS;
+		records[num++].flags = 0;
+	}
+	if (message->dummy_cycles)
+	{
+		misaka_bus_trace_spi_fill(trace, &records[num++], MISAKA_BUS_TRACE_SPI_DUMMY, NULL, NULL, message->dummy_cycles, message->lines);
+	}
+	if (message->length)
+	{
+		misaka_bus_trace_spi_fill(trace, &records[num++], MISAKA_BUS_TRACE_SPI_XFER, message->send_buf, message->recv_buf, message->length, message->lines);
+	}
+	if (message->cs_release)
+	{
+		records[num].type = MISAKA_BUS_TRACE_SPI_CS;
+		records[num++].flags = MISAKA_BUS_TRACE_FLAG_LEVEL;
+	}
+
+	return num;
+}
+
+/**
+ * @brief 整条消息链：先写入各段的记录，提交后补写接收数据；回放时逐段按记录处理
+ * @param ctx 轨迹
+ * @param device spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_bus_trace_spi_transfer_chain(void *ctx, misaka_spi_t *device, misaka_spi_message_t *message)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t records[4];
+	misaka_spi_message_t *index;
+	uint32_t pos, end;
+	uint8_t i, num, state = 0;
+
+	if (device != trace->spi)
+	{
+		return trace->bus.ops->transfer_chain(trace->bus.ctx, device, message);
+	}
+
+	misaka_bus_trace_spi_config(trace);
+
+	pos = trace->length;
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		for (index = message; index != NULL; index = index->next)
+		{
+			num = misaka_bus_trace_spi_segment(trace, index, records);
+			for (i = 0; i < num; i++)
+			{
+				misaka_bus_trace_write(trace, &records[i]);
+			}
+		}
+		state = trace->bus.ops->transfer_chain(trace->bus.ctx, device, message);
+	}
+	end = trace->length;
+
+	for (index = message; index != NULL; index = index->next)
+	{
+		num = misaka_bus_trace_spi_segment(trace, index, records);
+		for (i = 0; i < num; i++)
+		{
+			misaka_bus_trace_spi_commit(trace, &pos, end, &records[i], records[i].type == MISAKA_BUS_TRACE_SPI_CS ? 0 : state);
+		}
+	}
+
+	return state;
+}
+
+static void misaka_bus_trace_spi_mutex_take(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	trace->bus.ops->mutex_take(trace->bus.ctx);
+}
+
+static void misaka_bus_trace_spi_mutex_release(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	trace->bus.ops->mutex_release(trace->bus.ctx);
+}
+
+static void misaka_bus_trace_spi_critical_enter(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	trace->bus.ops->critical_enter(trace->bus.ctx);
+}
+
+static void misaka_bus_trace_spi_critical_exit(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	trace->bus.ops->critical_exit(trace->bus.ctx);
+}
+
+static void misaka_bus_trace_spi_set_cs(void *ctx, uint8_t state)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+	misaka_bus_trace_record_t record = {0};
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		trace->device.cs_ops->set_cs(trace->device.cs_ctx, state);
+	}
+
+	record.type = MISAKA_BUS_TRACE_SPI_CS;
+	record.flags = state ? MISAKA_BUS_TRACE_FLAG_LEVEL : 0;
+	misaka_bus_trace_emit(trace, &record);
+}
+
+static void misaka_bus_trace_spi_set_dc(void *ctx, uint8_t state)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		trace->device.cs_ops->set_dc(trace->device.cs_ctx, state);
+	}
+}
+
+/**
+ * @brief 挂接spi设备：总线改用以本轨迹为上下文的操作表，只记录或回放该设备的传输，
+ * 同一总线上其他设备的传输原样转发到原有的总线操作
+ * @param trace 轨迹
+ * @param spi spi设备，每个轨迹同一时刻挂接一个，不同总线可分别挂接到不同的轨迹
+ */
+void misaka_bus_trace_spi_attach(misaka_bus_trace_t *trace, misaka_spi_t *spi)
+{
+	misaka_spi_bus_ops_t *ops = &trace->spi_ops;
+	misaka_spi_bus_t *bus;
+
+	misaka_spi_assert(trace != NULL);
+	misaka_spi_assert(spi != NULL);
+	misaka_spi_assert(trace->spi == NULL);
+
+	bus = spi->bus;
+	trace->spi = spi;
+	trace->bus = *bus;
+	trace->device = *spi;
+
+	/** < 可选操作与原总线一致，核心层选择的传输路径不变 */
+	ops->send_recv = misaka_bus_trace_spi_send_recv;
+	ops->send = misaka_bus_trace_spi_send;
+	ops->recv = misaka_bus_trace_spi_recv;
+	ops->mutex_take = misaka_bus_trace_spi_mutex_take;
+	ops->mutex_release = misaka_bus_trace_spi_mutex_release;
+	ops->transfer_chain = trace->bus.ops->transfer_chain != NULL ? misaka_bus_trace_spi_transfer_chain : NULL;
+	ops->configure = trace->bus.ops->configure != NULL ? misaka_bus_trace_spi_configure : NULL;
+	ops->send_lines = trace->bus.ops->send_lines != NULL ? misaka_bus_trace_spi_send_lines : NULL;
+	ops->recv_lines = trace->bus.ops->recv_lines != NULL ? misaka_bus_trace_spi_recv_lines : NULL;
+	ops->dummy = trace->bus.ops->dummy != NULL ? misaka_bus_trace_spi_dummy : NULL;
+	ops->critical_enter = trace->bus.ops->critical_enter != NULL ? misaka_bus_trace_spi_critical_enter : NULL;
+	ops->critical_exit = trace->bus.ops->critical_exit != NULL ? misaka_bus_trace_spi_critical_exit : NULL;
+	bus->ops = ops;
+	bus->ctx = trace;
+
+	trace->cs_ops.set_cs = misaka_bus_trace_spi_set_cs;
+	trace->cs_ops.set_dc = trace->device.cs_ops->set_dc != NULL ? misaka_bus_trace_spi_set_dc : NULL;
+	spi->cs_ops = &trace->cs_ops;
+	spi->cs_ctx = trace;
+}
+
+/**
+ * @brief 找到i2c回放位置之后的第一条字节记录
+ * @param trace 轨迹
+ * @param record 记录
+ * @return uint32_t @c 下一条记录的位置，0表示记录已耗尽
+ */
+static uint32_t misaka_bus_trace_i2c_peek(misaka_bus_trace_t *trace, misaka_bus_trace_record_t *record)
+{
+	uint32_t pos = trace->i2c_pos;
+
+	while ((pos = misaka_bus_trace_parse(trace, pos, record)) != 0)
+	{
+		if (record->type == MISAKA_BUS_TRACE_I2C_WRITE || record->type == MISAKA_BUS_TRACE_I2C_READ)
+		{
+			break;
+		}
+	}
+
+	return pos;
+}
+
+/**
+ * @brief 解码完成一个字节
+ * @param trace 轨迹
+ * @param flags 应答标志
+ */
+static void misaka_bus_trace_i2c_byte(misaka_bus_trace_t *trace, uint8_t flags)
+{
+	misaka_bus_trace_record_t record = {0}, expect;
+	uint32_t next;
+
+	record.type = trace->reading ? MISAKA_BUS_TRACE_I2C_READ : MISAKA_BUS_TRACE_I2C_WRITE;
+	record.flags = flags;
+	record.data = trace->shift;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_REPLAY)
+	{
+		next = misaka_bus_trace_i2c_peek(trace, &expect);
+		if (next == 0 || expect.type != record.type
+			|| (record.type == MISAKA_BUS_TRACE_I2C_WRITE && expect.data != record.data))
+		{
+			trace->stat.mismatches++;
+		}
+		if (next != 0)
+		{
+			trace->i2c_pos = next;
+		}
+	}
+	misaka_bus_trace_emit(trace, &record);
+
+	trace->bits = 0;
+}
+
+/**
+ * @brief 产生起始或停止记录，未带应答位的读取字节在此结束
+ * @param trace 轨迹
+ * @param type 类型
+ */
+static void misaka_bus_trace_i2c_condition(misaka_bus_trace_t *trace, uint8_t type)
+{
+	misaka_bus_trace_record_t record = {0};
+
+	if (trace->bits == 8 && trace->reading)
+	{
+		misaka_bus_trace_i2c_byte(trace, MISAKA_BUS_TRACE_FLAG_NO_ACK);
+	}
+	trace->bits = 0;
+	trace->clocked = 0;
+
+	record.type = type;
+	record.flags = 0;
+	misaka_bus_trace_emit(trace, &record);
+}
+
+/**
+ * @brief 设置sda：记录时转发到原引脚，scl为高时sda变化即起始或停止信号
+ * @param trace 轨迹
+ * @param state 电平
+ */
+static void misaka_bus_trace_i2c_sda(misaka_bus_trace_t *trace, uint8_t state)
+{
+	state = state ? 1 : 0;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		misaka_bus_trace_i2c_forward(trace, set_sda, state);
+	}
+
+	if (trace->scl && trace->sda != state)
+	{
+		misaka_bus_trace_i2c_condition(trace, state ? MISAKA_BUS_TRACE_I2C_STOP : MISAKA_BUS_TRACE_I2C_START);
+	}
+	trace->sda = state;
+}
+
+/**
+ * @brief 设置scl：记录时转发到原引脚，下降沿结束一位
+ * @param trace 轨迹
+ * @param state 电平
+ */
+static void misaka_bus_trace_i2c_scl(misaka_bus_trace_t *trace, uint8_t state)
+{
+	uint8_t bit;
+
+	state = state ? 1 : 0;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		misaka_bus_trace_i2c_forward(trace, set_scl, state);
+	}
+
+	if (!trace->scl && state)
+	{
+		trace->clocked = 1;
+		trace->sampled = 0;
+	}
+	else if (trace->scl && !state && trace->clocked)
+	{
+		/** < 高电平期间读取过sda时该位由从机驱动，否则为主机输出的电平 */
+		bit = trace->sampled ? trace->sample : trace->sda;
+		if (trace->bits == 0)
+		{
+			trace->reading = trace->sampled;
+		}
+		if (trace->bits < 8)
+		{
+			trace->shift = (uint8_t) (trace->shift << 1 | bit);
+			trace->bits++;
+		}
+		else
+		{
+			misaka_bus_trace_i2c_byte(trace, bit ? 0 : MISAKA_BUS_TRACE_FLAG_ACK);
+		}
+	}
+	trace->scl = state;
+}
+
+/**
+ * @brief 读取sda：记录时读取原引脚，回放时由轨迹给出从机驱动的电平
+ * @param trace 轨迹
+ * @return uint8_t @c 电平
+ */
+static uint8_t misaka_bus_trace_i2c_get(misaka_bus_trace_t *trace)
+{
+	misaka_bus_trace_record_t record = {0};
+	uint8_t state = 1;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		state = misaka_bus_trace_i2c_forward0(trace, get_sda) ? 1 : 0;
+	}
+	else if (misaka_bus_trace_i2c_peek(trace, &record) != 0)
+	{
+		if (trace->bits < 8 && record.type == MISAKA_BUS_TRACE_I2C_READ)
+		{
+			state = (record.data >> (7 - trace->bits)) & 1;
+		}
+		else if (trace->bits == 8 && record.type == MISAKA_BUS_TRACE_I2C_WRITE)
+		{
+			state = (record.flags & MISAKA_BUS_TRACE_FLAG_ACK) ? 0 : 1;
+		}
+	}
+
+	trace->sampled = 1;
+	trace->sample = state;
+
+	return state;
+}
+
+static void misaka_bus_trace_i2c_set_sda(uint8_t state)
+{
+	misaka_bus_trace_i2c_sda(s_trace, state);
+}
+
+static void misaka_bus_trace_i2c_set_scl(uint8_t state)
+{
+	misaka_bus_trace_i2c_scl(s_trace, state);
+}
+
+static uint8_t misaka_bus_trace_i2c_get_sda(void)
+{
+	return misaka_bus_trace_i2c_get(s_trace);
+}
+
+static void misaka_bus_trace_i2c_delay_us(uint16_t us)
+{
+	(void) us;
+}
+
+static void misaka_bus_trace_i2c_nop()
+{
+
+}
+
+/**
+ * @brief 挂接软件i2c：替换其引脚操作，按引脚电平解码起始、停止、字节与应答，回放时由轨迹驱动sda；设置了xfer的设备不经过引脚，无法记录
+ * @param trace 轨迹
+ * @param i2c i2c设备，其引脚函数没有上下文参数，同一时刻只能有一个轨迹以此方式挂接
+ */
+void misaka_bus_trace_i2c_attach(misaka_bus_trace_t *trace, misaka_soft_i2c_t *i2c)
+{
+	misaka_spi_assert(trace != NULL);
+	misaka_spi_assert(i2c != NULL);
+	misaka_spi_assert(trace->i2c == NULL && trace->i2c_bus == NULL);
+	misaka_spi_assert(s_trace == NULL || s_trace == trace);
+
+	s_trace = trace;
+	trace->i2c = i2c;
+	trace->pins = *i2c;
+
+	i2c->set_sda = misaka_bus_trace_i2c_set_sda;
+	i2c->set_scl = misaka_bus_trace_i2c_set_scl;
+	i2c->get_sda = misaka_bus_trace_i2c_get_sda;
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_REPLAY)
+	{
+		/** < 回放时不访问引脚也不延时 */
+		i2c->delay_us = misaka_bus_trace_i2c_delay_us;
+		i2c->set_sda_out = misaka_bus_trace_i2c_nop;
+		i2c->set_sda_in = misaka_bus_trace_i2c_nop;
+	}
+}
+
+static void misaka_bus_trace_i2c_ops_set_sda(void *ctx, uint8_t state)
+{
+	misaka_bus_trace_i2c_sda((misaka_bus_trace_t *) ctx, state);
+}
+
+static void misaka_bus_trace_i2c_ops_set_scl(void *ctx, uint8_t state)
+{
+	misaka_bus_trace_i2c_scl((misaka_bus_trace_t *) ctx, state);
+}
+
+static uint8_t misaka_bus_trace_i2c_ops_get_sda(void *ctx)
+{
+	return misaka_bus_trace_i2c_get((misaka_bus_trace_t *) ctx);
+}
+
+static void misaka_bus_trace_i2c_ops_delay_us(void *ctx, uint16_t us)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	/** < 回放时不访问引脚也不延时 */
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		trace->i2c_saved.ops->delay_us(trace->i2c_saved.ctx, us);
+	}
+}
+
+static void misaka_bus_trace_i2c_ops_set_sda_out(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		trace->i2c_saved.ops->set_sda_out(trace->i2c_saved.ctx);
+	}
+}
+
+static void misaka_bus_trace_i2c_ops_set_sda_in(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	if (trace->mode == MISAKA_BUS_TRACE_MODE_RECORD)
+	{
+		trace->i2c_saved.ops->set_sda_in(trace->i2c_saved.ctx);
+	}
+}
+
+static void misaka_bus_trace_i2c_ops_mutex_take(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	trace->i2c_saved.ops->mutex_take(trace->i2c_saved.ctx);
+}
+
+static void misaka_bus_trace_i2c_ops_mutex_release(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	trace->i2c_saved.ops->mutex_release(trace->i2c_saved.ctx);
+}
+
+static void misaka_bus_trace_i2c_ops_error(void *ctx)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	trace->i2c_saved.ops->error(trace->i2c_saved.ctx);
+}
+
+static uint32_t misaka_bus_trace_i2c_ops_xfer(void *ctx, misaka_soft_i2c_message *msgs, uint32_t num)
+{
+	misaka_bus_trace_t *trace = (misaka_bus_trace_t *) ctx;
+
+	return trace->i2c_saved.ops->xfer(trace->i2c_saved.ctx, msgs, num);
+}
+
+/**
+ * @brief 挂接使用共享操作表的i2c总线：总线改用以本轨迹为上下文的操作表，解码与回放同misaka_bus_trace_i2c_attach；
+ * 操作表设置了xfer的总线不经过引脚，xfer原样转发，无法记录
+ * @param trace 轨迹
+ * @param bus i2c总线，每个轨迹同一时刻挂接一个
+ */
+void misaka_bus_trace_i2c_bus_attach(misaka_bus_trace_t *trace, misaka_soft_i2c_bus_t *bus)
+{
+	misaka_soft_i2c_ops_t *ops = &trace->i2c_ops;
+
+	misaka_spi_assert(trace != NULL);
+	misaka_spi_assert(bus != NULL);
+	misaka_spi_assert(trace->i2c == NULL && trace->i2c_bus == NULL);
+
+	trace->i2c_bus = bus;
+	trace->i2c_saved = *bus;
+
+	ops->set_sda = misaka_bus_trace_i2c_ops_set_sda;
+	ops->set_scl = misaka_bus_trace_i2c_ops_set_scl;
+	ops->get_sda = misaka_bus_trace_i2c_ops_get_sda;
+	ops->delay_us = misaka_bus_trace_i2c_ops_delay_us;
+	ops->set_sda_out = misaka_bus_trace_i2c_ops_set_sda_out;
+	ops->set_sda_in = misaka_bus_trace_i2c_ops_set_sda_in;
+	ops->mutex_take = misaka_bus_trace_i2c_ops_mutex_take;
+	ops->mutex_release = misaka_bus_trace_i2c_ops_mutex_release;
+	ops->error = bus->ops->error != NULL ? misaka_bus_trace_i2c_ops_error : NULL;
+	ops->xfer = bus->ops->xfer != NULL ? misaka_bus_trace_i2c_ops_xfer : NULL;
+	bus->ops = ops;
+	bus->ctx = trace;
+}
+
+/**
+ * @brief 解除挂接，恢复原有的总线与引脚操作
+ * @param trace 轨迹
+ */
+void misaka_bus_trace_detach(misaka_bus_trace_t *trace)
+{
+	misaka_spi_assert(trace != NULL);
+
+	if (trace->spi != NULL)
+	{
+		trace->spi->bus->ops = trace->bus.ops;
+		trace->spi->bus->ctx = trace->bus.ctx;
+		trace->spi->cs_ops = trace->device.cs_ops;
+		trace->spi->cs_ctx = trace->device.cs_ctx;
+		trace->spi = NULL;
+	}
+
+	if (trace->i2c != NULL)
+	{
+		trace->i2c->set_sda = trace->pins.set_sda;
+		trace->i2c->set_scl = trace->pins.set_scl;
+		trace->i2c->get_sda = trace->pins.get_sda;
+		trace->i2c->delay_us = trace->pins.delay_us;
+		trace->i2c->set_sda_out = trace->pins.set_sda_out;
+		trace->i2c->set_sda_in = trace->pins.set_sda_in;
+		trace->i2c = NULL;
+	}
+
+	if (trace->i2c_bus != NULL)
+	{
+		trace->i2c_bus->ops = trace->i2c_saved.ops;
+		trace->i2c_bus->ctx = trace->i2c_saved.ctx;
+		trace->i2c_bus = NULL;
+	}
+
+	if (s_trace == trace)
+	{
+		s_trace = NULL;
+	}
+}
@@ -0,0 +1,59 @@
+/**
+ * @file bus_trace_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/bus_trace.h"
+
+#define BUS_TRACE_SIZE          (64 * 1024)
+
+static uint8_t s_bus_trace_buf[BUS_TRACE_SIZE];
+static misaka_bus_trace_t s_misaka_bus_trace_obj;
+misaka_bus_trace_t *misaka_bus_trace_obj = NULL;
+
+/**
+ * @brief 获取us时间戳
+ * @return uint32_t @c 时间戳
+ */
+static uint32_t get_tick_us(void)
+{
+
+}
+
+/**
+ * 在目标板上记录：驱动运行结束后调用misaka_bus_trace_detach，把buf的前length字节保存为轨迹文件；
+ * 在主机上回放：读入轨迹文件，设置length后调用misaka_bus_trace_replay_init与attach，再运行同一或修改后的驱动，
+ * 比较两次的stat（ops、cs_asserts、time_ns等）即可发现多余的往返
+ */
+static int misaka_bus_trace_port_init(misaka_spi_t *spi, misaka_soft_i2c_t *i2c)
+{
+	s_misaka_bus_trace_obj.buf = s_bus_trace_buf;
+	s_misaka_bus_trace_obj.size = BUS_TRACE_SIZE;
+	s_misaka_bus_trace_obj.get_tick_us = get_tick_us;
+	s_misaka_bus_trace_obj.spi_hz = 1000000;
+	s_misaka_bus_trace_obj.i2c_hz = 100000;
+	s_misaka_bus_trace_obj.op_overhead_ns = 2000;
+
+	if (misaka_bus_trace_record_init(&s_misaka_bus_trace_obj) != 0)
+	{
+		return 0;
+	}
+	misaka_bus_trace_spi_attach(&s_misaka_bus_trace_obj, spi);
+	misaka_bus_trace_i2c_attach(&s_misaka_bus_trace_obj, i2c);
+	misaka_bus_trace_obj = &s_misaka_bus_trace_obj;
+
+	return 1;
+}
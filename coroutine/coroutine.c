@@ -0,0 +1,501 @@
+/**
+ * @file coroutine.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/coroutine.h"
+
+#define MISAKA_SOFT_I2C_COROUTINE_ADDR_DONE     0xff
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+#define MISAKA_SOFT_I2C_COROUTINE_COUNT(x, field, n)  do { if ((x)->bus->stat != NULL) { (x)->bus->stat->field += (n); } } while (0)
+#else
+#define MISAKA_SOFT_I2C_COROUTINE_COUNT(x, field, n)  ((void) 0)
+#endif
+
+/**
+ * 短于yield_us的延时直接忙等，让出的开销比延时本身还大；两种方式都按请求的延时统计，与时序引擎一致
+ */
+#define misaka_soft_i2c_coroutine_delay(x, co, us)                  \
+    do                                                              \
+    {                                                               \
+        MISAKA_SOFT_I2C_COROUTINE_COUNT(x, delay_calls, 1);         \
+        MISAKA_SOFT_I2C_COROUTINE_COUNT(x, delay_us, (us));         \
+        if ((us) < (x)->yield_us)                                   \
+        {                                                           \
+            (x)->bus->ops->delay_us((x)->bus->ctx, (us));           \
+        }                                                           \
+        else                                                        \
+        {                                                           \
+            MISAKA_COROUTINE_DELAY(co, (x)->get_tick_us, (us));     \
+        }                                                           \
+    } while (0)
+
+#define misaka_soft_i2c_coroutine_half(x)   (((x)->bus->us + 1) >> 1)
+
+/**
+ * 引脚操作经以下函数调用，便于统计；未开启统计时与直接调用相同
+ */
+static void misaka_soft_i2c_coroutine_set_sda(misaka_soft_i2c_coroutine_t *x, uint8_t state)
+{
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, pin_calls, 1);
+	x->bus->ops->set_sda(x->bus->ctx, state);
+}
+
+static void misaka_soft_i2c_coroutine_set_scl(misaka_soft_i2c_coroutine_t *x, uint8_t state)
+{
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, pin_calls, 1);
+	x->bus->ops->set_scl(x->bus->ctx, state);
+}
+
+static uint8_t misaka_soft_i2c_coroutine_get_sda(misaka_soft_i2c_coroutine_t *x)
+{
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, pin_calls, 1);
+	return x->bus->ops->get_sda(x->bus->ctx);
+}
+
+static void misaka_soft_i2c_coroutine_set_sda_out(misaka_soft_i2c_coroutine_t *x)
+{
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, pin_calls, 1);
+	x->bus->ops->set_sda_out(x->bus->ctx);
+}
+
+static void misaka_soft_i2c_coroutine_set_sda_in(misaka_soft_i2c_coroutine_t *x)
+{
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, pin_calls, 1);
+	x->bus->ops->set_sda_in(x->bus->ctx);
+}
+
+/**
+ * @brief 产生起始信号
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE
+ */
+static uint8_t misaka_soft_i2c_coroutine_start_signal(misaka_soft_i2c_coroutine_t *x)
+{
+	misaka_coroutine_t *co = &x->byte_co;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	misaka_soft_i2c_coroutine_set_sda_out(x);
+	misaka_soft_i2c_coroutine_set_sda(x, 0);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	misaka_soft_i2c_coroutine_set_scl(x, 0);
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 重复产生起始信号
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE
+ */
+static uint8_t misaka_soft_i2c_coroutine_restart(misaka_soft_i2c_coroutine_t *x)
+{
+	misaka_coroutine_t *co = &x->byte_co;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	misaka_soft_i2c_coroutine_set_sda_out(x);
+	misaka_soft_i2c_coroutine_set_sda(x, 1);
+	misaka_soft_i2c_coroutine_set_scl(x, 1);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	misaka_soft_i2c_coroutine_set_sda(x, 0);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	misaka_soft_i2c_coroutine_set_scl(x, 0);
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 产生停止信号
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE
+ */
+static uint8_t misaka_soft_i2c_coroutine_stop(misaka_soft_i2c_coroutine_t *x)
+{
+	misaka_coroutine_t *co = &x->byte_co;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	misaka_soft_i2c_coroutine_set_sda_out(x);
+	misaka_soft_i2c_coroutine_set_sda(x, 0);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	misaka_soft_i2c_coroutine_set_scl(x, 1);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	misaka_soft_i2c_coroutine_set_sda(x, 1);
+	misaka_soft_i2c_coroutine_delay(x, co, x->bus->us);
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 发送x->data并等待应答，应答结果写入x->ack
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE
+ */
+static uint8_t misaka_soft_i2c_coroutine_write_byte(misaka_soft_i2c_coroutine_t *x)
+{
+	misaka_coroutine_t *co = &x->byte_co;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	misaka_soft_i2c_coroutine_set_sda_out(x);
+	for (x->bit = 8; x->bit > 0; x->bit--)
+	{
+		misaka_soft_i2c_coroutine_set_scl(x, 0);
+		misaka_soft_i2c_coroutine_set_sda(x, (x->data >> (x->bit - 1)) & 1);
+		misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+		misaka_soft_i2c_coroutine_set_scl(x, 1);
+		misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	}
+	misaka_soft_i2c_coroutine_set_scl(x, 0);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+
+	misaka_soft_i2c_coroutine_set_sda_in(x);
+	misaka_soft_i2c_coroutine_set_sda(x, 1);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	misaka_soft_i2c_coroutine_set_scl(x, 1);
+	x->ack = !misaka_soft_i2c_coroutine_get_sda(x);
+	misaka_soft_i2c_coroutine_set_scl(x, 0);
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, bytes, 1);
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, nacks, !x->ack);
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 读取一个字节到x->data
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE
+ */
+static uint8_t misaka_soft_i2c_coroutine_read_byte(misaka_soft_i2c_coroutine_t *x)
+{
+	misaka_coroutine_t *co = &x->byte_co;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	misaka_soft_i2c_coroutine_set_sda_in(x);
+	misaka_soft_i2c_coroutine_set_sda(x, 1);
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	x->data = 0;
+	for (x->bit = 0; x->bit < 8; x->bit++)
+	{
+		x->data <<= 1;
+		misaka_soft_i2c_coroutine_set_scl(x, 1);
+		if (misaka_soft_i2c_coroutine_get_sda(x))
+		{
+			x->data |= 1;
+		}
+		misaka_soft_i2c_coroutine_set_scl(x, 0);
+		misaka_soft_i2c_coroutine_delay(x, co, x->bus->us);
+	}
+	MISAKA_SOFT_I2C_COROUTINE_COUNT(x, bytes, 1);
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 产生ACK应答，x->ack为0时不产生
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE
+ */
+static uint8_t misaka_soft_i2c_coroutine_send_ack(misaka_soft_i2c_coroutine_t *x)
+{
+	misaka_coroutine_t *co = &x->byte_co;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	misaka_soft_i2c_coroutine_set_sda_out(x);
+	if (x->ack)
+	{
+		misaka_soft_i2c_coroutine_set_sda(x, 0);
+	}
+	misaka_soft_i2c_coroutine_delay(x, co, misaka_soft_i2c_coroutine_half(x));
+	misaka_soft_i2c_coroutine_set_scl(x, 1);
+	misaka_soft_i2c_coroutine_set_scl(x, 0);
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 当前地址阶段要发送的字节
+ * @param x 传输对象
+ * @param msg 消息对象
+ * @return uint8_t @c 地址字节
+ */
+static uint8_t misaka_soft_i2c_coroutine_address_byte(misaka_soft_i2c_coroutine_t *x, misaka_soft_i2c_message_t msg)
+{
+	/** < 10位地址：高位字节（可重试）、低位字节、读时重复起始后再发高位字节|1 */
+	if (!(msg->flags & MISAKA_SOFT_I2C_ADDR_10BIT))
+	{
+		return (uint8_t) (msg->addr << 1) | ((msg->flags & MISAKA_SOFT_I2C_RD) ? 1 : 0);
+	}
+	if (x->phase == 1)
+	{
+		return msg->addr & 0xff;
+	}
+
+	return 0xf0 | ((msg->addr >> 7) & 0x06) | (x->phase == 2 ? 1 : 0);
+}
+
+/**
+ * @brief 发送当前消息的从机地址（含10位地址与重试），结束后x->ack为1表示可以继续
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE
+ */
+static uint8_t misaka_soft_i2c_coroutine_address(misaka_soft_i2c_coroutine_t *x)
+{
+	misaka_soft_i2c_message_t msg = &x->msgs[x->index];
+	uint16_t ignore_nack = msg->flags & MISAKA_SOFT_I2C_IGNORE_NACK;
+	misaka_coroutine_t *co = &x->addr_co;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	for (x->phase = 0; x->phase != MISAKA_SOFT_I2C_COROUTINE_ADDR_DONE;)
+	{
+		x->data = misaka_soft_i2c_coroutine_address_byte(x, msg);
+		x->tries = (ignore_nack || x->phase == 1) ? 0 : 1;
+
+		for (;;)
+		{
+			MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_write_byte(x));
+			if (x->ack || x->tries == 0)
+			{
+				break;
+			}
+			x->tries--;
+			MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_stop(x));
+			misaka_soft_i2c_coroutine_delay(x, co, x->bus->us);
+			MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_start_signal(x));
+			x->data = misaka_soft_i2c_coroutine_address_byte(x, msg);
+		}
+
+		if (!x->ack && !ignore_nack)
+		{
+			MISAKA_COROUTINE_EXIT(co);
+		}
+
+		if (!(msg->flags & MISAKA_SOFT_I2C_ADDR_10BIT) || x->phase == 2)
+		{
+			x->phase = MISAKA_SOFT_I2C_COROUTINE_ADDR_DONE;
+		}
+		else if (x->phase == 1 && (msg->flags & MISAKA_SOFT_I2C_RD))
+		{
+			MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_restart(x));
+			x->phase = 2;
+		}
+		else
+		{
+			x->phase = x->phase == 0 ? 1 : MISAKA_SOFT_I2C_COROUTINE_ADDR_DONE;
+		}
+	}
+	x->ack = 1;
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 准备模拟i2c传输
+ * @param x 传输对象
+ * @param msgs 消息对象
+ * @param num 消息数量
+ */
+void misaka_soft_i2c_coroutine_start(misaka_soft_i2c_coroutine_t *x, misaka_soft_i2c_message *msgs, uint32_t num)
+{
+	misaka_coroutine_assert(x != NULL);
+	misaka_coroutine_assert(x->bus != NULL);
+	misaka_coroutine_assert(x->get_tick_us != NULL || x->yield_us > 0);
+
+	x->msgs = msgs;
+	x->num = num;
+	x->ret = 0;
+	MISAKA_COROUTINE_INIT(&x->co);
+}
+
+/**
+ * @brief 推进模拟i2c传输
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING:未结束 MISAKA_COROUTINE_DONE:结束，完成的消息数见x->ret
+ */
+uint8_t misaka_soft_i2c_coroutine_poll(misaka_soft_i2c_coroutine_t *x)
+{
+	const misaka_soft_i2c_ops_t *ops = x->bus->ops;
+	void *ctx = x->bus->ctx;
+	misaka_coroutine_t *co = &x->co;
+	misaka_soft_i2c_message_t msg;
+
+	MISAKA_COROUTINE_BEGIN(co);
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	if (x->bus->stat != NULL && x->bus->stat->get_tick_us != NULL)
+	{
+		x->tick = x->bus->stat->get_tick_us();
+	}
+#endif
+	if (x->lock != NULL)
+	{
+		MISAKA_COROUTINE_LOCK(co, x->lock);
+	}
+	ops->mutex_take(ctx);
+
+	if (ops->xfer != NULL)
+	{
+		/** < 传输后端一次完成，不经过时序 */
+		x->ret = ops->xfer(ctx, x->msgs, x->num);
+	}
+	else
+	{
+		MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_start_signal(x));
+		for (x->index = 0; x->index < x->num; x->index++)
+		{
+			msg = &x->msgs[x->index];
+			if (!(msg->flags & MISAKA_SOFT_I2C_NO_START))
+			{
+				if (x->index)
+				{
+					MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_restart(x));
+				}
+				MISAKA_COROUTINE_SPAWN(co, &x->addr_co, misaka_soft_i2c_coroutine_address(x));
+				if (!x->ack)
+				{
+					/** < 地址未应答：返回已完成的消息数 */
+					x->ret = x->index;
+					break;
+				}
+			}
+
+			msg = &x->msgs[x->index];
+			if (msg->flags & MISAKA_SOFT_I2C_RD)
+			{
+				for (x->pos = 0; x->pos < x->msgs[x->index].len; x->pos++)
+				{
+					MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_read_byte(x));
+					msg = &x->msgs[x->index];
+					msg->buf[x->pos] = x->data;
+					if (!(msg->flags & MISAKA_SOFT_I2C_NO_READ_ACK))
+					{
+						x->ack = x->pos + 1 < msg->len;
+						MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_send_ack(x));
+					}
+				}
+			}
+			else
+			{
+				for (x->pos = 0; x->pos < x->msgs[x->index].len; x->pos++)
+				{
+					x->data = x->msgs[x->index].buf[x->pos];
+					MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_write_byte(x));
+					if (!x->ack && !(x->msgs[x->index].flags & MISAKA_SOFT_I2C_IGNORE_NACK))
+					{
+						break;
+					}
+				}
+				if (x->pos < x->msgs[x->index].len)
+				{
+					/** < 数据未应答：与时序引擎相同，整组按0条计 */
+					x->ret = 0;
+					break;
+				}
+			}
+		}
+		if (x->index == x->num)
+		{
+			x->ret = x->num;
+		}
+
+		MISAKA_COROUTINE_SPAWN(co, &x->byte_co, misaka_soft_i2c_coroutine_stop(x));
+	}
+	ops->mutex_release(ctx);
+	if (x->lock != NULL)
+	{
+		MISAKA_COROUTINE_UNLOCK(x->lock);
+	}
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	if (x->bus->stat != NULL)
+	{
+		x->bus->stat->transfers++;
+		x->bus->stat->messages += x->ret;
+		if (x->bus->stat->get_tick_us != NULL)
+		{
+			x->tick = x->bus->stat->get_tick_us() - x->tick;
+			x->bus->stat->hold_us += x->tick;
+			if (x->tick > x->bus->stat->hold_max_us)
+			{
+				x->bus->stat->hold_max_us = x->tick;
+			}
+		}
+	}
+#endif
+
+	if (x->ret != x->num && ops->error != NULL)
+	{
+		ops->error(ctx);
+	}
+	MISAKA_COROUTINE_END(co);
+}
+
+/**
+ * @brief 准备spi传输
+ * @param x 传输对象
+ * @param message 消息链
+ */
+void misaka_spi_coroutine_start(misaka_spi_coroutine_t *x, misaka_spi_message_t *message)
+{
+	misaka_coroutine_assert(x != NULL);
+	misaka_coroutine_assert(x->spi != NULL);
+
+	x->message = message;
+	x->ret = 0;
+	MISAKA_COROUTINE_INIT(&x->co);
+}
+
+/**
+ * @brief 推进spi传输：会话内逐段提交，每段之后让出，cs按各段的cs_take/cs_release保持
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING:未结束 MISAKA_COROUTINE_DONE:结束，结果见x->ret
+ */
+uint8_t misaka_spi_coroutine_poll(misaka_spi_coroutine_t *x)
+{
+	misaka_coroutine_t *co = &x->co;
+	misaka_spi_message_t *next;
+
+	MISAKA_COROUTINE_BEGIN(co);
+	if (x->lock != NULL)
+	{
+		MISAKA_COROUTINE_LOCK(co, x->lock);
+	}
+
+	if (misaka_spi_session_open(x->spi) != 0)
+	{
+		x->ret = 1;
+	}
+	else
+	{
+		for (x->segment = x->message; x->segment != NULL; x->segment = x->segment->next)
+		{
+			/** < 暂时截断消息链，只提交当前段，提交后恢复 */
+			next = x->segment->next;
+			x->segment->next = NULL;
+			x->ret = misaka_spi_session_chain(x->spi, x->segment);
+			x->segment->next = next;
+			if (x->ret != 0)
+			{
+				break;
+			}
+			if (x->segment->next != NULL)
+			{
+				MISAKA_COROUTINE_YIELD(co);
+			}
+		}
+		if (misaka_spi_session_close(x->spi) != 0)
+		{
+			x->ret = 1;
+		}
+	}
+
+	if (x->lock != NULL)
+	{
+		MISAKA_COROUTINE_UNLOCK(x->lock);
+	}
+	MISAKA_COROUTINE_END(co);
+}
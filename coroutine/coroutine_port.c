@@ -0,0 +1,124 @@
+/**
+ * @file coroutine_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/coroutine.h"
+
+/**
+ * 两个传感器驱动以顺序代码编写：温湿度计在i2c总线上启动转换、等待20ms、读取结果，
+ * 气压计在spi总线上读取；主循环轮流调用，一个驱动等待时另一个继续推进
+ */
+struct sensor_i2c_struct
+{
+	misaka_coroutine_t co;
+	misaka_soft_i2c_coroutine_t xfer;
+	misaka_soft_i2c_message msgs[1];
+	uint8_t cmd[2];
+	uint8_t data[6];
+};
+
+struct sensor_spi_struct
+{
+	misaka_coroutine_t co;
+	misaka_spi_coroutine_t xfer;
+	misaka_spi_message_t msgs[2];
+	uint8_t cmd[1];
+	uint8_t data[3];
+};
+
+static struct sensor_i2c_struct s_sensor_i2c;
+static struct sensor_spi_struct s_sensor_spi;
+static misaka_coroutine_lock_t s_spi_lock;
+
+/**
+ * @brief 获取us时间戳
+ * @return uint32_t @c 时间戳
+ */
+static uint32_t get_tick_us(void)
+{
+	return 0;
+}
+
+static uint8_t sensor_i2c_thread(struct sensor_i2c_struct *s)
+{
+	MISAKA_COROUTINE_BEGIN(&s->co);
+	for (;;)
+	{
+		s->msgs[0].addr = 0x44;
+		s->msgs[0].flags = MISAKA_SOFT_I2C_WR;
+		s->msgs[0].buf = s->cmd;
+		s->msgs[0].len = sizeof(s->cmd);
+		MISAKA_SOFT_I2C_COROUTINE_TRANSFER(&s->co, &s->xfer, s->msgs, 1);
+
+		MISAKA_COROUTINE_DELAY(&s->co, get_tick_us, 20000);
+
+		s->msgs[0].flags = MISAKA_SOFT_I2C_RD;
+		s->msgs[0].buf = s->data;
+		s->msgs[0].len = sizeof(s->data);
+		MISAKA_SOFT_I2C_COROUTINE_TRANSFER(&s->co, &s->xfer, s->msgs, 1);
+
+		MISAKA_COROUTINE_DELAY(&s->co, get_tick_us, 100000);
+	}
+	MISAKA_COROUTINE_END(&s->co);
+}
+
+static uint8_t sensor_spi_thread(struct sensor_spi_struct *s)
+{
+	MISAKA_COROUTINE_BEGIN(&s->co);
+	for (;;)
+	{
+		MISAKA_SPI_COROUTINE_TRANSFER(&s->co, &s->xfer, s->msgs);
+		MISAKA_COROUTINE_DELAY(&s->co, get_tick_us, 10000);
+	}
+	MISAKA_COROUTINE_END(&s->co);
+}
+
+static int misaka_coroutine_port_init(const misaka_soft_i2c_bus_t *i2c, misaka_spi_t *spi)
+{
+	s_sensor_i2c.xfer.bus = i2c;
+	s_sensor_i2c.xfer.get_tick_us = get_tick_us;
+	s_sensor_i2c.xfer.yield_us = 0;
+	s_sensor_i2c.cmd[0] = 0x24;
+	s_sensor_i2c.cmd[1] = 0x00;
+	MISAKA_COROUTINE_INIT(&s_sensor_i2c.co);
+
+	s_sensor_spi.xfer.spi = spi;
+	s_sensor_spi.xfer.lock = &s_spi_lock;/**< 同一spi总线上的其他协程共用此锁 */
+	s_sensor_spi.cmd[0] = 0xf7 | 0x80;
+	s_sensor_spi.msgs[0].send_buf = s_sensor_spi.cmd;
+	s_sensor_spi.msgs[0].length = sizeof(s_sensor_spi.cmd);
+	s_sensor_spi.msgs[0].cs_take = 1;
+	s_sensor_spi.msgs[0].next = &s_sensor_spi.msgs[1];
+	s_sensor_spi.msgs[1].recv_buf = s_sensor_spi.data;
+	s_sensor_spi.msgs[1].length = sizeof(s_sensor_spi.data);
+	s_sensor_spi.msgs[1].cs_release = 1;
+	MISAKA_COROUTINE_INIT(&s_sensor_spi.co);
+
+	return 1;
+}
+
+/**
+ * 主循环
+ */
+static void misaka_coroutine_port_loop(void)
+{
+	for (;;)
+	{
+		sensor_i2c_thread(&s_sensor_i2c);
+		sensor_spi_thread(&s_sensor_spi);
+	}
+}
@@ -0,0 +1,490 @@
+/**
+ * @file decode.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/decode.h"
+
+/**
+ * NEON/Helium内核尚未在目标上编译验证，需定义MISAKA_DECODE_USING_ARM_SIMD才启用，否则ARM上使用标量循环
+ */
+#if !defined(MISAKA_DECODE_NO_SIMD)
+#if defined(__ARM_FEATURE_MVE) && defined(MISAKA_DECODE_USING_ARM_SIMD)
+#include <arm_mve.h>
+#define MISAKA_DECODE_USING_MVE
+#if (__ARM_FEATURE_MVE & 2)
+#define MISAKA_DECODE_USING_MVE_FLOAT
+#endif
+#elif defined(__ARM_NEON) && defined(MISAKA_DECODE_USING_ARM_SIMD)
+#include <arm_neon.h>
+#define MISAKA_DECODE_USING_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MISAKA_DECODE_USING_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define MISAKA_DECODE_USING_SSSE3
+#endif
+#endif
+#endif
+
+/**
+ * 以下各SIMD函数处理n个连续样本中向量宽度的整数倍部分，返回已处理的样本数，剩余部分由标量循环完成；
+ * 对应指令集不可用时返回0。swap为1表示大端（需要交换字节）。
+ */
+
+#if defined(MISAKA_DECODE_USING_SSE2)
+static __m128i misaka_decode_sse2_s16(const uint8_t *in, uint8_t swap, __m128i shift)
+{
+	__m128i v = _mm_loadu_si128((const __m128i *) in);
+
+	if (swap)
+	{
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	}
+
+	return _mm_sra_epi16(v, shift);
+}
+#endif
+
+#if defined(MISAKA_DECODE_USING_NEON) || defined(MISAKA_DECODE_USING_MVE)
+static int16x8_t misaka_decode_arm_s16(const uint8_t *in, uint8_t swap, int16x8_t shift)
+{
+	uint8x16_t b = vld1q_u8(in);
+
+	if (swap)
+	{
+		b = vrev16q_u8(b);
+	}
+
+	return vshlq_s16(vreinterpretq_s16_u8(b), shift);
+}
+#endif
+
+/**
+ * @brief 16位有符号样本解码为16位，输入与输出可以是同一块内存
+ */
+static uint32_t misaka_decode_simd_s16_s16(const uint8_t *in, int16_t *out, uint32_t n, uint8_t swap, uint8_t shift)
+{
+	uint32_t i = 0;
+
+#if defined(MISAKA_DECODE_USING_SSE2)
+	__m128i count = _mm_cvtsi32_si128(shift);
+
+	for (; i + 8 <= n; i += 8)
+	{
+		_mm_storeu_si128((__m128i *) &out[i], misaka_decode_sse2_s16(&in[i * 2], swap, count));
+	}
+#elif defined(MISAKA_DECODE_USING_NEON) || defined(MISAKA_DECODE_USING_MVE)
+	int16x8_t count = vdupq_n_s16((int16_t) -shift);
+
+	for (; i + 8 <= n; i += 8)
+	{
+		vst1q_s16(&out[i], misaka_decode_arm_s16(&in[i * 2], swap, count));
+	}
+#else
+	(void) in;
+	(void) out;
+	(void) n;
+	(void) swap;
+	(void) shift;
+#endif
+
+	return i;
+}
+
+/**
+ * @brief 16位有符号样本解码为32位
+ */
+static uint32_t misaka_decode_simd_s16_s32(const uint8_t *in, int32_t *out, uint32_t n, uint8_t swap, uint8_t shift)
+{
+	uint32_t i = 0;
+
+#if defined(MISAKA_DECODE_USING_SSE2)
+	__m128i count = _mm_cvtsi32_si128(shift);
+	__m128i v;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		v = misaka_decode_sse2_s16(&in[i * 2], swap, count);
+		_mm_storeu_si128((__m128i *) &out[i], _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+		_mm_storeu_si128((__m128i *) &out[i + 4], _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+	}
+#elif defined(MISAKA_DECODE_USING_NEON)
+	int16x8_t count = vdupq_n_s16((int16_t) -shift);
+	int16x8_t v;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		v = misaka_decode_arm_s16(&in[i * 2], swap, count);
+		vst1q_s32(&out[i], vmovl_s16(vget_low_s16(v)));
+		vst1q_s32(&out[i + 4], vmovl_s16(vget_high_s16(v)));
+	}
+#elif defined(MISAKA_DECODE_USING_MVE)
+	int16x8_t count = vdupq_n_s16((int16_t) -shift);
+	int16x8_t v;
+	int32x4x2_t w;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		/** < Helium按偶/奇通道扩展，交织存储后恢复原顺序 */
+		v = misaka_decode_arm_s16(&in[i * 2], swap, count);
+		w.val[0] = vmovlbq_s16(v);
+		w.val[1] = vmovltq_s16(v);
+		vst2q_s32(&out[i], w);
+	}
+#else
+	(void) in;
+	(void) out;
+	(void) n;
+	(void) swap;
+	(void) shift;
+#endif
+
+	return i;
+}
+
+/**
+ * @brief 16位有符号样本解码为浮点
+ */
+static uint32_t misaka_decode_simd_s16_f32(const uint8_t *in, float *out, uint32_t n, uint8_t swap, uint8_t shift, float scale)
+{
+	uint32_t i = 0;
+
+#if defined(MISAKA_DECODE_USING_SSE2)
+	__m128i count = _mm_cvtsi32_si128(shift);
+	__m128 k = _mm_set1_ps(scale);
+	__m128i v;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		v = misaka_decode_sse2_s16(&in[i * 2], swap, count);
+		_mm_storeu_ps(&out[i], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), k));
+		_mm_storeu_ps(&out[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), k));
+	}
+#elif defined(MISAKA_DECODE_USING_NEON)
+	int16x8_t count = vdupq_n_s16((int16_t) -shift);
+	int16x8_t v;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		v = misaka_decode_arm_s16(&in[i * 2], swap, count);
+		vst1q_f32(&out[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+		vst1q_f32(&out[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+	}
+#elif defined(MISAKA_DECODE_USING_MVE_FLOAT)
+	int16x8_t count = vdupq_n_s16((int16_t) -shift);
+	int16x8_t v;
+	float32x4x2_t w;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		v = misaka_decode_arm_s16(&in[i * 2], swap, count);
+		w.val[0] = vmulq_n_f32(vcvtq_f32_s32(vmovlbq_s16(v)), scale);
+		w.val[1] = vmulq_n_f32(vcvtq_f32_s32(vmovltq_s16(v)), scale);
+		vst2q_f32(&out[i], w);
+	}
+#else
+	(void) in;
+	(void) out;
+	(void) n;
+	(void) swap;
+	(void) shift;
+	(void) scale;
+#endif
+
+	return i;
+}
+
+#if defined(MISAKA_DECODE_USING_NEON)
+/**
+ * @brief 解开的24位样本各字节平面组合为有符号32位，一次8个
+ */
+static void misaka_decode_neon_s24(uint8x8x3_t b, uint8_t swap, int32x4_t shift, int32x4_t *lo, int32x4_t *hi)
+{
+	uint8x8_t msb = swap ? b.val[0] : b.val[2];
+	uint8x8_t lsb = swap ? b.val[2] : b.val[0];
+	int16x8_t top = vreinterpretq_s16_u16(vorrq_u16(vshll_n_u8(msb, 8), vmovl_u8(b.val[1])));
+	uint16x8_t low = vmovl_u8(lsb);
+
+	*lo = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(top)), 8), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+	*hi = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(top)), 8), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+	*lo = vshlq_s32(*lo, shift);
+	*hi = vshlq_s32(*hi, shift);
+}
+#endif
+
+#if defined(MISAKA_DECODE_USING_SSSE3)
+/**
+ * @brief 4个24位样本搬到32位通道的高3字节，算术右移完成符号扩展；读取16字节，调用者保证不越界
+ */
+static __m128i misaka_decode_ssse3_s24(const uint8_t *in, __m128i mask, __m128i shift)
+{
+	return _mm_sra_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) in), mask), shift);
+}
+
+static __m128i misaka_decode_ssse3_s24_mask(uint8_t swap)
+{
+	if (swap)
+	{
+		return _mm_setr_epi8(-128, 2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9);
+	}
+
+	return _mm_setr_epi8(-128, 0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11);
+}
+#endif
+
+/**
+ * @brief 24位有符号样本解码为32位
+ */
+static uint32_t misaka_decode_simd_s24_s32(const uint8_t *in, int32_t *out, uint32_t n, uint8_t swap, uint8_t shift)
+{
+	uint32_t i = 0;
+
+#if defined(MISAKA_DECODE_USING_SSSE3)
+	__m128i mask = misaka_decode_ssse3_s24_mask(swap);
+	__m128i count = _mm_cvtsi32_si128(8 + shift);
+
+	/** < 每次处理4个（12字节）但读取16字节，留出余量 */
+	for (; i + 6 <= n; i += 4)
+	{
+		_mm_storeu_si128((__m128i *) &out[i], misaka_decode_ssse3_s24(&in[i * 3], mask, count));
+	}
+#elif defined(MISAKA_DECODE_USING_NEON)
+	int32x4_t count = vdupq_n_s32(-(int32_t) shift);
+	int32x4_t lo, hi;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		misaka_decode_neon_s24(vld3_u8(&in[i * 3]), swap, count, &lo, &hi);
+		vst1q_s32(&out[i], lo);
+		vst1q_s32(&out[i + 4], hi);
+	}
+#else
+	(void) in;
+	(void) out;
+	(void) n;
+	(void) swap;
+	(void) shift;
+#endif
+
+	return i;
+}
+
+/**
+ * @brief 24位有符号样本解码为浮点
+ */
+static uint32_t misaka_decode_simd_s24_f32(const uint8_t *in, float *out, uint32_t n, uint8_t swap, uint8_t shift, float scale)
+{
+	uint32_t i = 0;
+
+#if defined(MISAKA_DECODE_USING_SSSE3)
+	__m128i mask = misaka_decode_ssse3_s24_mask(swap);
+	__m128i count = _mm_cvtsi32_si128(8 + shift);
+	__m128 k = _mm_set1_ps(scale);
+
+	for (; i + 6 <= n; i += 4)
+	{
+		_mm_storeu_ps(&out[i], _mm_mul_ps(_mm_cvtepi32_ps(misaka_decode_ssse3_s24(&in[i * 3], mask, count)), k));
+	}
+#elif defined(MISAKA_DECODE_USING_NEON)
+	int32x4_t count = vdupq_n_s32(-(int32_t) shift);
+	int32x4_t lo, hi;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		misaka_decode_neon_s24(vld3_u8(&in[i * 3]), swap, count, &lo, &hi);
+		vst1q_f32(&out[i], vmulq_n_f32(vcvtq_f32_s32(lo), scale));
+		vst1q_f32(&out[i + 4], vmulq_n_f32(vcvtq_f32_s32(hi), scale));
+	}
+#else
+	(void) in;
+	(void) out;
+	(void) n;
+	(void) swap;
+	(void) shift;
+	(void) scale;
+#endif
+
+	return i;
+}
+
+/**
+ * @brief 标量解码一个样本
+ * @param f 格式
+ * @param p 样本
+ * @return int32_t @c 数值
+ */
+static int32_t misaka_decode_sample(const misaka_decode_format_t *f, const uint8_t *p)
+{
+	uint32_t raw = 0;
+	uint8_t i, unused = (uint8_t) (32 - f->width * 8);
+
+	if (f->endian == MISAKA_DECODE_BIG_ENDIAN)
+	{
+		for (i = 0; i < f->width; i++)
+		{
+			raw = (raw << 8) | p[i];
+		}
+	}
+	else
+	{
+		for (i = f->width; i > 0; i--)
+		{
+			raw = (raw << 8) | p[i - 1];
+		}
+	}
+
+	if (f->sign)
+	{
+		/** < 移到最高位后算术右移，完成符号扩展 */
+		return (int32_t) (raw << unused) >> (unused + f->shift);
+	}
+
+	return (int32_t) (raw >> f->shift);
+}
+
+/**
+ * @brief 帧间是否无间隙，可按连续样本处理
+ * @param f 格式
+ * @return 1:连续 0:有间隙
+ */
+static uint8_t misaka_decode_contiguous(const misaka_decode_format_t *f)
+{
+	uint8_t channels = f->channels ? f->channels : 1;
+
+	return f->stride == 0 || f->stride == f->width * channels;
+}
+
+/**
+ * @brief 解码为32位整数
+ * @param f 格式
+ * @param buf 接收缓冲区
+ * @param frames 帧数
+ * @param out 输出，frames * channels个，按帧内顺序交织
+ */
+void misaka_decode_int32(const misaka_decode_format_t *f, const uint8_t *buf, uint32_t frames, int32_t *out)
+{
+	uint8_t channels, c, swap;
+	uint32_t i = 0, n;
+
+	misaka_decode_assert(f != NULL);
+	misaka_decode_assert(f->width >= 1 && f->width <= 4);
+
+	channels = f->channels ? f->channels : 1;
+	swap = f->endian == MISAKA_DECODE_BIG_ENDIAN;
+
+	if (!misaka_decode_contiguous(f))
+	{
+		for (i = 0; i < frames; i++)
+		{
+			for (c = 0; c < channels; c++)
+			{
+				*out++ = misaka_decode_sample(f, &buf[i * f->stride + c * f->width]);
+			}
+		}
+		return;
+	}
+
+	n = frames * channels;
+	if (f->sign && f->width == 2)
+	{
+		i = misaka_decode_simd_s16_s32(buf, out, n, swap, f->shift);
+	}
+	else if (f->sign && f->width == 3)
+	{
+		i = misaka_decode_simd_s24_s32(buf, out, n, swap, f->shift);
+	}
+	for (; i < n; i++)
+	{
+		out[i] = misaka_decode_sample(f, &buf[i * f->width]);
+	}
+}
+
+/**
+ * @brief 解码并乘以scale转换为浮点
+ * @param f 格式
+ * @param buf 接收缓冲区
+ * @param frames 帧数
+ * @param out 输出，frames * channels个，按帧内顺序交织
+ */
+void misaka_decode_float(const misaka_decode_format_t *f, const uint8_t *buf, uint32_t frames, float *out)
+{
+	uint8_t channels, c, swap;
+	uint32_t i = 0, n;
+
+	misaka_decode_assert(f != NULL);
+	misaka_decode_assert(f->width >= 1 && f->width <= 4);
+
+	channels = f->channels ? f->channels : 1;
+	swap = f->endian == MISAKA_DECODE_BIG_ENDIAN;
+
+	if (!misaka_decode_contiguous(f))
+	{
+		for (i = 0; i < frames; i++)
+		{
+			for (c = 0; c < channels; c++)
+			{
+				*out++ = (float) misaka_decode_sample(f, &buf[i * f->stride + c * f->width]) * f->scale;
+			}
+		}
+		return;
+	}
+
+	n = frames * channels;
+	if (f->sign && f->width == 2)
+	{
+		i = misaka_decode_simd_s16_f32(buf, out, n, swap, f->shift, f->scale);
+	}
+	else if (f->sign && f->width == 3)
+	{
+		i = misaka_decode_simd_s24_f32(buf, out, n, swap, f->shift, f->scale);
+	}
+	for (; i < n; i++)
+	{
+		out[i] = (float) misaka_decode_sample(f, &buf[i * f->width]) * f->scale;
+	}
+}
+
+/**
+ * @brief 原地解码16位有符号样本，结果覆盖接收缓冲区，不需要额外的输出缓冲区
+ * @param f 格式，width须为2、sign须为1且帧间无间隙
+ * @param buf 接收缓冲区，须2字节对齐
+ * @param frames 帧数
+ * @return int16_t* @c 解码结果（即buf），NULL为格式不支持原地解码
+ */
+int16_t *misaka_decode_int16_inplace(const misaka_decode_format_t *f, uint8_t *buf, uint32_t frames)
+{
+	int16_t *out = (int16_t *) buf;
+	uint32_t i, n;
+
+	misaka_decode_assert(f != NULL);
+
+	if (f->width != 2 || !f->sign || !misaka_decode_contiguous(f) || ((uintptr_t) buf & 1) != 0)
+	{
+		return NULL;
+	}
+
+	n = frames * (f->channels ? f->channels : 1);
+	i = misaka_decode_simd_s16_s16(buf, out, n, f->endian == MISAKA_DECODE_BIG_ENDIAN, f->shift);
+	for (; i < n; i++)
+	{
+		/** < 每个样本先读后写同一位置的两个字节，可以原地进行 */
+		out[i] = (int16_t) misaka_decode_sample(f, &buf[i * 2]);
+	}
+
+	return out;
+}
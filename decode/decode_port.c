@@ -0,0 +1,72 @@
+/**
+ * @file decode_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/decode.h"
+
+#define DECODE_FIFO_FRAMES      32
+
+/**
+ * 陀螺仪FIFO：每帧x/y/z三轴，16位大端补码，±2000dps量程
+ */
+static const misaka_decode_format_t s_gyro_format = {
+	.width = 2,
+	.endian = MISAKA_DECODE_BIG_ENDIAN,
+	.sign = 1,
+	.shift = 0,
+	.channels = 3,
+	.stride = 0,
+	.scale = 2000.0f / 32768.0f,
+};
+
+/**
+ * 加速度计FIFO：每帧x/y/z三轴，20位数据左对齐于24位大端补码，只取z轴
+ */
+static const misaka_decode_format_t s_accel_z_format = {
+	.width = 3,
+	.endian = MISAKA_DECODE_BIG_ENDIAN,
+	.sign = 1,
+	.shift = 4,
+	.channels = 1,
+	.stride = 9,
+	.scale = 1.0f / 256000.0f,
+};
+
+static uint16_t s_gyro_fifo[DECODE_FIFO_FRAMES * 3];/**< 以uint16_t分配，保证原地解码所需的2字节对齐 */
+static float s_gyro_dps[DECODE_FIFO_FRAMES * 3];
+static uint8_t s_accel_fifo[DECODE_FIFO_FRAMES * 9];
+static float s_accel_z_g[DECODE_FIFO_FRAMES];
+
+/**
+ * 突发读取后直接在接收缓冲区上解码
+ */
+static int misaka_decode_port_init(void)
+{
+	int16_t *raw;
+
+	misaka_decode_float(&s_gyro_format, (const uint8_t *) s_gyro_fifo, DECODE_FIFO_FRAMES, s_gyro_dps);
+	misaka_decode_float(&s_accel_z_format, &s_accel_fifo[6], DECODE_FIFO_FRAMES, s_accel_z_g);
+
+	/** < 只需要整数时原地解码，不占用额外的缓冲区 */
+	raw = misaka_decode_int16_inplace(&s_gyro_format, (uint8_t *) s_gyro_fifo, DECODE_FIFO_FRAMES);
+	if (raw == NULL)
+	{
+		return 0;
+	}
+
+	return 1;
+}
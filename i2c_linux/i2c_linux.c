@@ -0,0 +1,233 @@
+/**
+ * @file i2c_linux.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * linux i2c-dev后端：整组消息转换为一次I2C_RDWR，起始、重复起始与停止由内核控制器驱动产生，
+ * 标志一一映射为i2c_msg的标志；超过MISAKA_I2C_LINUX_MESSAGE_MAX时分批提交，批次之间为停止与起始。
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "misaka_device/i2c_linux.h"
+
+/**
+ * @brief 默认ioctl，直接调用系统调用
+ * @param fd 文件描述符
+ * @param request 请求
+ * @param arg 参数
+ * @return int @c 系统调用返回值
+ */
+static int misaka_i2c_linux_sys_ioctl(int fd, unsigned long request, void *arg)
+{
+	return ioctl(fd, request, arg);
+}
+
+/**
+ * @brief 提交一批i2c_msg
+ * @param dev i2c-dev设备
+ * @param msgs 消息
+ * @param num 消息数量
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_i2c_linux_submit(misaka_i2c_linux_t *dev, struct i2c_msg *msgs, uint32_t num)
+{
+	struct i2c_rdwr_ioctl_data data;
+
+	data.msgs = msgs;
+	data.nmsgs = num;
+	dev->ioctls++;
+
+	return dev->ioctl(dev->fd, I2C_RDWR, &data) == (int) num ? 0 : 1;
+}
+
+/**
+ * @brief 整组消息转换为I2C_RDWR，超过MISAKA_I2C_LINUX_MESSAGE_MAX时在不带NO_START的消息处分批
+ * @param ctx i2c-dev设备
+ * @param msgs 消息对象
+ * @param num 消息数量
+ * @return uint32_t @c 完成的消息数，失败的批次整体不计
+ */
+static uint32_t misaka_i2c_linux_xfer(void *ctx, misaka_soft_i2c_message *msgs, uint32_t num)
+{
+	misaka_i2c_linux_t *dev = (misaka_i2c_linux_t *) ctx;
+	struct i2c_msg xfer[MISAKA_I2C_LINUX_MESSAGE_MAX];
+	uint32_t done = 0, count, i;
+	uint16_t flags;
+
+	while (done < num)
+	{
+		count = num - done;
+		if (count > MISAKA_I2C_LINUX_MESSAGE_MAX)
+		{
+			/** < 下一批不能以NO_START开头，否则其数据会接在新的起始信号之后 */
+			count = MISAKA_I2C_LINUX_MESSAGE_MAX;
+			while (count > 0 && (msgs[done + count].flags & MISAKA_SOFT_I2C_NO_START))
+			{
+				count--;
+			}
+			if (count == 0)
+			{
+				break;
+			}
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			if (msgs[done + i].len > 0xffff)
+			{
+				return done;
+			}
+
+			flags = 0;
+			if (msgs[done + i].flags & MISAKA_SOFT_I2C_RD)
+			{
+				flags |= I2C_M_RD;
+			}
+			if (msgs[done + i].flags & MISAKA_SOFT_I2C_ADDR_10BIT)
+			{
+				flags |= I2C_M_TEN;
+			}
+			if (msgs[done + i].flags & MISAKA_SOFT_I2C_NO_START)
+			{
+				flags |= I2C_M_NOSTART;
+			}
+			if (msgs[done + i].flags & MISAKA_SOFT_I2C_IGNORE_NACK)
+			{
+				flags |= I2C_M_IGNORE_NAK;
+			}
+			if (msgs[done + i].flags & MISAKA_SOFT_I2C_NO_READ_ACK)
+			{
+				flags |= I2C_M_NO_RD_ACK;
+			}
+
+			xfer[i].addr = msgs[done + i].addr;
+			xfer[i].flags = flags;
+			xfer[i].len = (uint16_t) msgs[done + i].len;
+			xfer[i].buf = msgs[done + i].buf;
+		}
+
+		if (misaka_i2c_linux_submit(dev, xfer, count) != 0)
+		{
+			break;
+		}
+		done += count;
+	}
+
+	return done;
+}
+
+/**
+ * @brief 获取互斥量
+ * @param ctx i2c-dev设备
+ */
+static void misaka_i2c_linux_mutex_take(void *ctx)
+{
+	pthread_mutex_lock(&((misaka_i2c_linux_t *) ctx)->mutex);
+}
+
+/**
+ * @brief 释放互斥量
+ * @param ctx i2c-dev设备
+ */
+static void misaka_i2c_linux_mutex_release(void *ctx)
+{
+	pthread_mutex_unlock(&((misaka_i2c_linux_t *) ctx)->mutex);
+}
+
+/**
+ * 所有i2c-dev设备共用的操作表，ctx为misaka_i2c_linux_t，传输均经xfer提交，不使用引脚操作
+ */
+static const misaka_soft_i2c_ops_t s_misaka_i2c_linux_ops = {
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	misaka_i2c_linux_mutex_take,
+	misaka_i2c_linux_mutex_release,
+	NULL,
+	misaka_i2c_linux_xfer,
+};
+
+/**
+ * @brief 以已打开的文件描述符初始化i2c-dev设备，可配合ioctl拦截函数在无硬件时测试
+ * @param dev i2c-dev设备
+ * @param fd 文件描述符
+ */
+void misaka_i2c_linux_attach(misaka_i2c_linux_t *dev, int fd)
+{
+	misaka_soft_i2c_assert(dev != NULL);
+
+	memset(&dev->bus, 0, sizeof(misaka_soft_i2c_bus_t));
+	dev->bus.ops = &s_misaka_i2c_linux_ops;
+	dev->bus.ctx = dev;
+	pthread_mutex_init(&dev->mutex, NULL);
+
+	if (dev->ioctl == NULL)
+	{
+		dev->ioctl = misaka_i2c_linux_sys_ioctl;
+	}
+	dev->fd = fd;
+	dev->ioctls = 0;
+
+	misaka_soft_i2c_bus_init(&dev->bus);
+}
+
+/**
+ * @brief 打开i2c-dev设备，打开后使用dev->bus进行传输
+ * @param dev i2c-dev设备，ioctl为NULL时使用系统调用
+ * @param path 设备路径，如 /dev/i2c-1
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_i2c_linux_open(misaka_i2c_linux_t *dev, const char *path)
+{
+	int fd;
+
+	misaka_soft_i2c_assert(dev != NULL);
+	misaka_soft_i2c_assert(path != NULL);
+
+	fd = open(path, O_RDWR);
+	if (fd < 0)
+	{
+		return 1;
+	}
+
+	misaka_i2c_linux_attach(dev, fd);
+
+	return 0;
+}
+
+/**
+ * @brief 关闭i2c-dev设备
+ * @param dev i2c-dev设备
+ */
+void misaka_i2c_linux_close(misaka_i2c_linux_t *dev)
+{
+	misaka_soft_i2c_assert(dev != NULL);
+
+	if (dev->fd >= 0)
+	{
+		close(dev->fd);
+		dev->fd = -1;
+	}
+	pthread_mutex_destroy(&dev->mutex);
+}
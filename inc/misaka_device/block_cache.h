@@ -0,0 +1,119 @@
+/**
+ * @file block_cache.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_BLOCK_CACHE_H__
+#define __MISAKA_BLOCK_CACHE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define misaka_block_cache_assert(expr)  ((void)0U)
+
+#define MISAKA_BLOCK_CACHE_LRU          0               /**< 最近最少使用替换 */
+#define MISAKA_BLOCK_CACHE_CLOCK        1               /**< 时钟替换 */
+
+#define MISAKA_BLOCK_CACHE_WRITE_THROUGH    0           /**< 写穿透，写入立即下发存储设备 */
+#define MISAKA_BLOCK_CACHE_WRITE_BACK       1           /**< 写回，脏块在替换或flush时下发 */
+
+struct misaka_block_cache_entry_struct
+{
+	uint32_t block;/**< 缓存的块号 */
+	uint32_t age;/**< LRU时间戳 */
+	unsigned valid: 1;
+	unsigned dirty: 1;
+	unsigned ref: 1;/**< CLOCK访问位 */
+};
+
+typedef struct misaka_block_cache_entry_struct misaka_block_cache_entry_t;
+
+struct misaka_block_cache_struct
+{
+	void *device;/**< 存储设备，作为read/write的第一个参数 */
+	uint8_t (*read)(void *device, uint32_t addr, uint8_t *buf, uint32_t len);/**< 读存储设备，0:成功 1:失败 */
+	uint8_t (*write)(void *device, uint32_t addr, uint8_t *buf, uint32_t len);/**< 写存储设备（可选，NULL为只读），0:成功 1:失败 */
+
+	uint32_t capacity;/**< 存储设备容量（可选，0为不限制），预读不越过末尾 */
+
+	uint8_t *arena;/**< 缓存区，大小为block_size * block_num，由调用者静态分配 */
+	misaka_block_cache_entry_t *entries;/**< 块描述，block_num个，由调用者静态分配 */
+	uint32_t block_size;/**< 块大小 */
+	uint16_t block_num;/**< 块数量 */
+	uint8_t readahead;/**< 检测到顺序访问时一次预读的块数上限（含当前块），只占用空闲块与冷块，0或1为不预读 */
+	uint8_t policy;/**< 替换策略，MISAKA_BLOCK_CACHE_LRU或MISAKA_BLOCK_CACHE_CLOCK */
+	uint8_t write_mode;/**< 写策略，MISAKA_BLOCK_CACHE_WRITE_THROUGH或MISAKA_BLOCK_CACHE_WRITE_BACK */
+
+	uint32_t hits;/**< 命中次数（按块） */
+	uint32_t misses;/**< 未命中次数（按块） */
+	uint32_t readahead_blocks;/**< 预读进缓存的块数 */
+	uint32_t device_reads;/**< 存储设备读次数 */
+	uint32_t device_writes;/**< 存储设备写次数 */
+
+	uint32_t tick;/**< LRU时钟 */
+	uint16_t hand;/**< CLOCK指针 */
+	uint8_t sequential;/**< 连续顺序访问次数 */
+	uint32_t next_addr;/**< 顺序访问时下一次的预期地址 */
+};
+
+typedef struct misaka_block_cache_struct misaka_block_cache_t;
+
+/**
+ * @brief 初始化，清空所有缓存块与统计
+ * @param cache 缓存
+ */
+void misaka_block_cache_init(misaka_block_cache_t *cache);
+
+/**
+ * @brief 读数据，命中的块直接从内存复制，顺序访问未命中时一次读入多个块
+ * @param cache 缓存
+ * @param addr 地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_block_cache_read(misaka_block_cache_t *cache, uint32_t addr, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 写数据
+ * @param cache 缓存
+ * @param addr 地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_block_cache_write(misaka_block_cache_t *cache, uint32_t addr, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 将所有脏块写回存储设备
+ * @param cache 缓存
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_block_cache_flush(misaka_block_cache_t *cache);
+
+/**
+ * @brief 丢弃所有缓存块（不写回），存储设备被旁路修改后调用
+ * @param cache 缓存
+ */
+void misaka_block_cache_invalidate(misaka_block_cache_t *cache);
+
+/**
+ * @brief 清零命中统计
+ * @param cache 缓存
+ */
+void misaka_block_cache_reset_stat(misaka_block_cache_t *cache);
+
+#endif //__MISAKA_BLOCK_CACHE_H__
@@ -0,0 +1,101 @@
+/**
+ * @file bus_executor.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_BUS_EXECUTOR_H__
+#define __MISAKA_BUS_EXECUTOR_H__
+
+#include <pthread.h>
+#include "misaka_device/bus_queue.h"
+
+#define misaka_bus_executor_assert(expr)  ((void)0U)
+
+struct misaka_bus_executor_struct;
+
+/**
+ * 每条总线一个工作线程与一个提交队列，同一总线上的请求按提交顺序执行，不同总线并行
+ */
+struct misaka_bus_worker_struct
+{
+	const void *bus;/**< 总线，spi请求为request->spi->bus，i2c请求为request->i2c */
+	misaka_bus_queue_cell_t *cells;/**< 队列槽位，由调用者分配 */
+	uint32_t size;/**< 槽位数，需为2的幂 */
+
+	misaka_bus_queue_t queue;/**< 提交队列，内部使用 */
+	struct misaka_bus_executor_struct *executor;/**< 所属执行器，内部使用 */
+	pthread_t thread;/**< 工作线程，内部使用 */
+	pthread_mutex_t mutex;/**< 唤醒互斥量，内部使用 */
+	pthread_cond_t cond;/**< 唤醒条件变量，内部使用 */
+	uint32_t signals;/**< 未处理的唤醒次数，内部使用 */
+	uint8_t stop;/**< 退出标志，内部使用 */
+};
+
+typedef struct misaka_bus_worker_struct misaka_bus_worker_t;
+
+/**
+ * linux多总线执行器：请求沿用misaka_bus_request_t，提交后立即返回，
+ * 可以misaka_bus_executor_wait等待单个请求（future），或由请求的callback在工作线程中通知，
+ * misaka_bus_executor_wait_all等待全部请求，跨总线的扇出读取耗时取决于最慢的总线而不是各总线之和
+ */
+struct misaka_bus_executor_struct
+{
+	misaka_bus_worker_t *workers;/**< 工作线程，由调用者分配并设置bus、cells与size */
+	uint32_t count;/**< 工作线程数 */
+
+	pthread_mutex_t mutex;/**< 完成互斥量，内部使用 */
+	pthread_cond_t cond;/**< 完成条件变量，内部使用 */
+	uint32_t pending;/**< 已提交未完成的请求数，内部使用 */
+};
+
+typedef struct misaka_bus_executor_struct misaka_bus_executor_t;
+
+/**
+ * @brief 初始化队列并启动各总线的工作线程
+ * @param exec 执行器
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_executor_start(misaka_bus_executor_t *exec);
+
+/**
+ * @brief 提交请求到其所在总线的队列，不阻塞，可在多个线程中并发调用
+ * @param exec 执行器
+ * @param request 请求
+ * @return 0:成功 1:没有对应总线的工作线程、队列已满或请求尚未完成
+ */
+uint8_t misaka_bus_executor_submit(misaka_bus_executor_t *exec, misaka_bus_request_t *request);
+
+/**
+ * @brief 等待请求完成
+ * @param exec 执行器
+ * @param request 请求
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_executor_wait(misaka_bus_executor_t *exec, misaka_bus_request_t *request);
+
+/**
+ * @brief 等待全部已提交的请求完成，包括回调中再次提交的请求
+ * @param exec 执行器
+ */
+void misaka_bus_executor_wait_all(misaka_bus_executor_t *exec);
+
+/**
+ * @brief 执行完已提交的请求后停止各工作线程
+ * @param exec 执行器
+ */
+void misaka_bus_executor_stop(misaka_bus_executor_t *exec);
+
+#endif //__MISAKA_BUS_EXECUTOR_H__
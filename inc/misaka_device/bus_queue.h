@@ -0,0 +1,105 @@
+/**
+ * @file bus_queue.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_BUS_QUEUE_H__
+#define __MISAKA_BUS_QUEUE_H__
+
+#include "misaka_device/spi.h"
+#include "misaka_device/soft_i2c.h"
+
+#define misaka_bus_queue_assert(expr)  ((void)0U)
+
+#define MISAKA_BUS_REQUEST_SPI          0                   /**< spi消息链 */
+#define MISAKA_BUS_REQUEST_I2C          1                   /**< 模拟i2c消息数组 */
+
+/**
+ * 请求由调用者预先构建并静态分配，中断中只投递指针；同一请求在回调之前重复投递会被拒绝
+ */
+struct misaka_bus_request_struct
+{
+	uint8_t type;/**< MISAKA_BUS_REQUEST_x */
+	misaka_spi_t *spi;/**< spi设备 */
+	misaka_spi_message_t *message;/**< spi消息链 */
+	const misaka_soft_i2c_bus_t *i2c;/**< i2c总线 */
+	misaka_soft_i2c_message *msgs;/**< i2c消息对象 */
+	uint32_t num;/**< i2c消息数量 */
+	void (*callback)(struct misaka_bus_request_struct *request, uint8_t result);/**< 完成回调（可选），在处理方上下文中调用，result 0:成功 1:失败；回调中可以再次投递本请求 */
+	void *user_data;/**< 用户数据 */
+	uint8_t result;/**< 结果，完成后有效，0:成功 1:失败 */
+
+	volatile uint32_t busy;/**< 已投递未完成，内部使用 */
+};
+
+typedef struct misaka_bus_request_struct misaka_bus_request_t;
+
+struct misaka_bus_queue_cell_struct
+{
+	volatile uint32_t seq;/**< 槽位序号，内部使用 */
+	misaka_bus_request_t *request;/**< 请求，内部使用 */
+};
+
+typedef struct misaka_bus_queue_cell_struct misaka_bus_queue_cell_t;
+
+/**
+ * 多生产者单消费者的有界无锁队列：每个槽位带序号，投递方以比较交换领取槽位后写入请求再发布序号，
+ * 投递中途被更高优先级的中断打断时，打断方领取下一个槽位，不会等待被打断者；
+ * 处理方（任务、主循环或DMA完成中断）按顺序取出并执行，遇到尚未发布的槽位即停止，下次继续。
+ */
+struct misaka_bus_queue_struct
+{
+	misaka_bus_queue_cell_t *cells;/**< 槽位，由调用者静态分配 */
+	uint32_t size;/**< 槽位数，需为2的幂 */
+	void (*notify)(void *ctx);/**< 投递成功后调用（可选），如释放信号量唤醒处理任务；在投递方上下文（可能为中断）中调用 */
+	void (*complete)(void *ctx, misaka_bus_request_t *request);/**< 每个请求完成并调用其回调后调用（可选），在处理方上下文中调用 */
+	void *ctx;/**< notify与complete的参数 */
+	void (*critical_enter)(void);/**< 进入临界区，仅在编译器不支持GNU原子操作时使用 */
+	void (*critical_exit)(void);/**< 退出临界区 */
+
+	volatile uint32_t enqueue_pos;/**< 投递位置，内部使用 */
+	uint32_t dequeue_pos;/**< 处理位置，内部使用 */
+
+	volatile uint32_t overflows;/**< 队列已满而拒绝的投递数 */
+	volatile uint32_t duplicates;/**< 请求未完成又被投递而拒绝的次数 */
+	uint32_t processed;/**< 处理的请求数 */
+};
+
+typedef struct misaka_bus_queue_struct misaka_bus_queue_t;
+
+/**
+ * @brief 初始化队列
+ * @param q 队列
+ * @return 0:成功 1:槽位数不是2的幂
+ */
+uint8_t misaka_bus_queue_init(misaka_bus_queue_t *q);
+
+/**
+ * @brief 投递请求，不阻塞，可在中断与多个任务中并发调用
+ * @param q 队列
+ * @param request 请求
+ * @return 0:成功 1:队列已满或请求尚未完成
+ */
+uint8_t misaka_bus_queue_post(misaka_bus_queue_t *q, misaka_bus_request_t *request);
+
+/**
+ * @brief 依次执行已投递的请求并调用回调，只能由一个处理方调用
+ * @param q 队列
+ * @return uint32_t @c 本次处理的请求数
+ */
+uint32_t misaka_bus_queue_process(misaka_bus_queue_t *q);
+
+#endif //__MISAKA_BUS_QUEUE_H__
@@ -0,0 +1,189 @@
+/**
+ * @file bus_trace.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_BUS_TRACE_H__
+#define __MISAKA_BUS_TRACE_H__
+
+#include "misaka_device/spi.h"
+#include "misaka_device/soft_i2c.h"
+
+#define MISAKA_BUS_TRACE_MAGIC          0x0154424DUL        /**< 轨迹头"MBT"与版本1，小端存储 */
+#define MISAKA_BUS_TRACE_HEADER_SIZE    4
+
+#define MISAKA_BUS_TRACE_MODE_NONE      0
+#define MISAKA_BUS_TRACE_MODE_RECORD    1                   /**< 转发到真实总线并记录 */
+#define MISAKA_BUS_TRACE_MODE_REPLAY    2                   /**< 按记录的响应回放，不访问真实总线 */
+
+/**
+ * 记录格式：首字节低4位为类型，高4位为标志，带MISAKA_BUS_TRACE_FLAG_TIME时紧跟距上一条记录的us数（变长整数），
+ * 其后为各类型的内容，整数均为每字节7位、低位在前的变长整数
+ */
+#define MISAKA_BUS_TRACE_SPI_XFER       1                   /**< 变长(length << 2 | lines编码)，[发送数据]，[接收数据] */
+#define MISAKA_BUS_TRACE_SPI_DUMMY      2                   /**< 变长(cycles << 2 | lines编码) */
+#define MISAKA_BUS_TRACE_SPI_CS         3                   /**< FLAG_LEVEL为cs电平 */
+#define MISAKA_BUS_TRACE_SPI_CONFIG     4                   /**< mode，data_width，变长max_hz */
+#define MISAKA_BUS_TRACE_I2C_START      5                   /**< 起始或重复起始信号 */
+#define MISAKA_BUS_TRACE_I2C_STOP       6                   /**< 停止信号 */
+#define MISAKA_BUS_TRACE_I2C_WRITE      7                   /**< 主机写入的字节，FLAG_ACK为从机应答 */
+#define MISAKA_BUS_TRACE_I2C_READ       8                   /**< 主机读取的字节，FLAG_ACK为主机应答，FLAG_NO_ACK为没有应答位 */
+
+#define MISAKA_BUS_TRACE_FLAG_TX        0x10                /**< SPI_XFER: 带发送数据 */
+#define MISAKA_BUS_TRACE_FLAG_RX        0x20                /**< SPI_XFER: 带接收数据 */
+#define MISAKA_BUS_TRACE_FLAG_FAIL      0x40                /**< SPI_XFER/SPI_DUMMY: 底层返回失败 */
+#define MISAKA_BUS_TRACE_FLAG_LEVEL     0x10                /**< SPI_CS: 高电平 */
+#define MISAKA_BUS_TRACE_FLAG_ACK       0x10                /**< I2C_WRITE/I2C_READ: 应答 */
+#define MISAKA_BUS_TRACE_FLAG_NO_ACK    0x20                /**< I2C_READ: 没有应答位 */
+#define MISAKA_BUS_TRACE_FLAG_TIME      0x80                /**< 带时间间隔 */
+
+struct misaka_bus_trace_record_struct
+{
+	uint8_t type;/**< 类型，MISAKA_BUS_TRACE_x */
+	uint8_t flags;/**< 标志，MISAKA_BUS_TRACE_FLAG_x */
+	uint32_t delta_us;/**< 距上一条记录的时间 */
+	uint32_t length;/**< SPI_XFER: 字节数，SPI_DUMMY: 周期数 */
+	uint8_t lines;/**< SPI_XFER/SPI_DUMMY: 线数 */
+	const uint8_t *tx;/**< SPI_XFER: 发送数据，指向轨迹内部 */
+	const uint8_t *rx;/**< SPI_XFER: 接收数据，指向轨迹内部 */
+	uint8_t data;/**< I2C_WRITE/I2C_READ: 字节，SPI_CONFIG: mode */
+	uint8_t data_width;/**< SPI_CONFIG: 数据宽度 */
+	uint32_t max_hz;/**< SPI_CONFIG: 时钟 */
+};
+
+typedef struct misaka_bus_trace_record_struct misaka_bus_trace_record_t;
+
+struct misaka_bus_trace_stat_struct
+{
+	uint32_t ops;/**< 总线操作数：spi传输段与空周期段、i2c起始信号 */
+	uint32_t cs_asserts;/**< spi cs选中次数 */
+	uint32_t i2c_starts;/**< i2c起始信号数（含重复起始） */
+	uint32_t tx_bytes;/**< 发送字节数（spi发送、i2c写入，含地址） */
+	uint32_t rx_bytes;/**< 接收字节数（spi接收、i2c读取） */
+	uint32_t nacks;/**< i2c写入未应答次数 */
+	uint32_t failures;/**< spi底层返回失败次数 */
+	uint32_t mismatches;/**< 回放时与记录不一致的次数（发送字节不同、操作类型不同或记录耗尽） */
+	uint32_t spi_hz;/**< 当前spi时钟，由SPI_CONFIG更新 */
+	uint64_t time_ns;/**< 模拟的总线时间：按时钟计算的位时间加上每个操作的固定开销 */
+};
+
+typedef struct misaka_bus_trace_stat_struct misaka_bus_trace_stat_t;
+
+struct misaka_bus_trace_struct
+{
+	uint8_t *buf;/**< 轨迹缓冲区，由调用者分配，可直接写入文件保存 */
+	uint32_t size;/**< 缓冲区大小 */
+	uint32_t length;/**< 轨迹长度，记录时由本模块更新，回放时由调用者给出 */
+	uint32_t (*get_tick_us)(void);/**< 获取us时间戳（可选），记录时写入记录间隔 */
+	uint32_t spi_hz;/**< 未出现SPI_CONFIG前的spi时钟 */
+	uint32_t i2c_hz;/**< i2c时钟，用于模拟总线时间 */
+	uint32_t op_overhead_ns;/**< 每个总线操作的固定开销，用于体现多余的往返 */
+
+	misaka_bus_trace_stat_t stat;/**< 记录或回放过程的统计 */
+	uint8_t overflow;/**< 1: 缓冲区已满，之后的记录被丢弃 */
+
+	uint8_t mode;/**< MISAKA_BUS_TRACE_MODE_x，内部使用 */
+	uint32_t last_tick;/**< 上一条记录的时间，内部使用 */
+	uint32_t rx_pos;/**< 回放接收数据的记录位置，内部使用 */
+	uint32_t rx_offset;/**< 回放接收数据在记录内的偏移，内部使用 */
+	uint32_t tx_pos;/**< 回放比较发送数据的记录位置，内部使用 */
+	uint32_t tx_offset;/**< 回放比较发送数据在记录内的偏移，内部使用 */
+	uint32_t i2c_pos;/**< 回放i2c字节的记录位置，内部使用 */
+
+	uint8_t scl;/**< i2c解码：scl电平，内部使用 */
+	uint8_t sda;/**< i2c解码：主机驱动的sda电平，内部使用 */
+	uint8_t clocked;/**< i2c解码：起始信号后出现过scl上升沿，下降沿才是一位的结束，内部使用 */
+	uint8_t sampled;/**< i2c解码：本时钟高电平期间读取过sda，内部使用 */
+	uint8_t sample;/**< i2c解码：读取到的sda电平，内部使用 */
+	uint8_t bits;/**< i2c解码：当前字节已完成的位数，内部使用 */
+	uint8_t shift;/**< i2c解码：当前字节，内部使用 */
+	uint8_t reading;/**< i2c解码：当前字节由从机驱动，内部使用 */
+
+	misaka_spi_t *spi;/**< 挂接的spi设备，内部使用 */
+	misaka_spi_bus_t bus;/**< 挂接前的spi总线，内部使用 */
+	misaka_spi_t device;/**< 挂接前的spi设备（cs/dc操作），内部使用 */
+	misaka_spi_bus_ops_t spi_ops;/**< 挂接后的spi总线操作表，以轨迹为上下文，内部使用 */
+	misaka_spi_cs_ops_t cs_ops;/**< 挂接后的spi设备cs/dc操作表，以轨迹为上下文，内部使用 */
+	misaka_soft_i2c_t *i2c;/**< 挂接的i2c设备，内部使用 */
+	misaka_soft_i2c_t pins;/**< 挂接前的i2c引脚操作，内部使用 */
+	misaka_soft_i2c_bus_t *i2c_bus;/**< 挂接的i2c总线，内部使用 */
+	misaka_soft_i2c_bus_t i2c_saved;/**< 挂接前的i2c总线，内部使用 */
+	misaka_soft_i2c_ops_t i2c_ops;/**< 挂接后的i2c总线操作表，以轨迹为上下文，内部使用 */
+};
+
+typedef struct misaka_bus_trace_struct misaka_bus_trace_t;
+
+/**
+ * @brief 开始记录，写入轨迹头并清空统计
+ * @param trace 轨迹
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_trace_record_init(misaka_bus_trace_t *trace);
+
+/**
+ * @brief 开始回放，校验轨迹头并清空统计
+ * @param trace 轨迹
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_bus_trace_replay_init(misaka_bus_trace_t *trace);
+
+/**
+ * @brief 挂接spi设备：总线与设备改用以轨迹为上下文的操作表，记录时转发到原函数，回放时直接由轨迹提供接收数据；
+ * 只记录或回放该设备占用总线期间的操作，同一总线上其他设备的操作原样转发
+ * @param trace 轨迹
+ * @param spi spi设备，每个轨迹同一时刻挂接一个
+ */
+void misaka_bus_trace_spi_attach(misaka_bus_trace_t *trace, misaka_spi_t *spi);
+
+/**
+ * @brief 挂接软件i2c：替换其引脚操作，按引脚电平解码起始、停止、字节与应答，回放时由轨迹驱动sda；设置了xfer的设备不经过引脚，无法记录
+ * @param trace 轨迹
+ * @param i2c i2c设备，其引脚函数没有上下文参数，同一时刻只能有一个轨迹以此方式挂接
+ */
+void misaka_bus_trace_i2c_attach(misaka_bus_trace_t *trace, misaka_soft_i2c_t *i2c);
+
+/**
+ * @brief 挂接使用共享操作表的i2c总线：总线改用以轨迹为上下文的操作表，解码与回放同misaka_bus_trace_i2c_attach；
+ * 操作表设置了xfer的总线不经过引脚，xfer原样转发，无法记录
+ * @param trace 轨迹
+ * @param bus i2c总线，每个轨迹同一时刻挂接一个
+ */
+void misaka_bus_trace_i2c_bus_attach(misaka_bus_trace_t *trace, misaka_soft_i2c_bus_t *bus);
+
+/**
+ * @brief 解除挂接，恢复原有的总线与引脚操作
+ * @param trace 轨迹
+ */
+void misaka_bus_trace_detach(misaka_bus_trace_t *trace);
+
+/**
+ * @brief 解析一条记录
+ * @param trace 轨迹
+ * @param pos 记录位置，首条记录位于MISAKA_BUS_TRACE_HEADER_SIZE
+ * @param record 记录
+ * @return uint32_t @c 下一条记录的位置，0表示已到末尾或记录损坏
+ */
+uint32_t misaka_bus_trace_parse(misaka_bus_trace_t *trace, uint32_t pos, misaka_bus_trace_record_t *record);
+
+/**
+ * @brief 离线统计整条轨迹，与记录过程中的统计一致，可用于对比两次记录
+ * @param trace 轨迹
+ * @param stat 统计
+ * @return 0:成功 1:轨迹损坏
+ */
+uint8_t misaka_bus_trace_analyze(misaka_bus_trace_t *trace, misaka_bus_trace_stat_t *stat);
+
+#endif //__MISAKA_BUS_TRACE_H__
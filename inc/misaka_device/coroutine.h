@@ -0,0 +1,179 @@
+/**
+ * @file coroutine.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_COROUTINE_H__
+#define __MISAKA_COROUTINE_H__
+
+#include "misaka_device/spi.h"
+#include "misaka_device/soft_i2c.h"
+
+#define misaka_coroutine_assert(expr)  ((void)0U)
+
+#define MISAKA_COROUTINE_WAITING        0                   /**< 协程让出，需再次调用 */
+#define MISAKA_COROUTINE_DONE           1                   /**< 协程结束，再次调用将从头开始 */
+
+/**
+ * 无栈协程：协程是返回MISAKA_COROUTINE_WAITING/MISAKA_COROUTINE_DONE的普通函数，
+ * 以switch记录恢复位置，不需要RTOS与独立的栈，每个协程只占一个misaka_coroutine_t。
+ * 使用限制：
+ * 1. 局部变量在让出后不保留，跨越等待的状态需放在调用者提供的结构体中；
+ * 2. 协程函数体内不能使用switch语句；
+ * 3. 每行最多一个会让出的宏（以__LINE__作为恢复位置）。
+ */
+struct misaka_coroutine_struct
+{
+	uint16_t line;/**< 恢复位置，0为从头开始 */
+	uint32_t wake;/**< MISAKA_COROUTINE_DELAY的到期时刻 */
+};
+
+typedef struct misaka_coroutine_struct misaka_coroutine_t;
+
+/**
+ * 协作锁：同一条总线上的多个协程以此互斥，等待时让出而不是阻塞
+ */
+struct misaka_coroutine_lock_struct
+{
+	const void *owner;/**< 持有者，NULL为空闲 */
+};
+
+typedef struct misaka_coroutine_lock_struct misaka_coroutine_lock_t;
+
+#define MISAKA_COROUTINE_INIT(co)               do { (co)->line = 0; } while (0)
+
+#define MISAKA_COROUTINE_BEGIN(co)              switch ((co)->line) { case 0:
+
+#define MISAKA_COROUTINE_END(co)                } (co)->line = 0; return MISAKA_COROUTINE_DONE
+
+/**
+ * 让出一次，下次调用从此处继续
+ */
+#define MISAKA_COROUTINE_YIELD(co)              do { (co)->line = __LINE__; return MISAKA_COROUTINE_WAITING; case __LINE__:; } while (0)
+
+/**
+ * 条件不成立时让出，每次调用重新判断
+ */
+#define MISAKA_COROUTINE_WAIT_UNTIL(co, cond)   do { (co)->line = __LINE__; if (0) { case __LINE__:; } if (!(cond)) { return MISAKA_COROUTINE_WAITING; } } while (0)
+
+/**
+ * 延时期间让出，tick为获取us时间戳的函数
+ */
+#define MISAKA_COROUTINE_DELAY(co, tick, us)    do { (co)->wake = (tick)() + (us); MISAKA_COROUTINE_WAIT_UNTIL(co, (int32_t) ((tick)() - (co)->wake) >= 0); } while (0)
+
+/**
+ * 运行子协程直到结束，子协程让出时本协程一并让出
+ */
+#define MISAKA_COROUTINE_SPAWN(co, child, call) do { (child)->line = 0; MISAKA_COROUTINE_WAIT_UNTIL(co, (call) == MISAKA_COROUTINE_DONE); } while (0)
+
+/**
+ * 结束协程，下次调用从头开始
+ */
+#define MISAKA_COROUTINE_EXIT(co)               do { (co)->line = 0; return MISAKA_COROUTINE_DONE; } while (0)
+
+/**
+ * 获取协作锁，被其他协程持有时让出
+ */
+#define MISAKA_COROUTINE_LOCK(co, lock)         do { MISAKA_COROUTINE_WAIT_UNTIL(co, (lock)->owner == NULL || (lock)->owner == (co)); (lock)->owner = (co); } while (0)
+
+#define MISAKA_COROUTINE_UNLOCK(lock)           do { (lock)->owner = NULL; } while (0)
+
+/**
+ * 可恢复的模拟i2c传输：时序、返回值与统计均与misaka_soft_i2c_bus_transfer相同，半位延时处让出而不是忙等，
+ * 多条模拟i2c总线可在同一个主循环中交替推进；提供ops->xfer的总线由传输后端一次完成
+ */
+struct misaka_soft_i2c_coroutine_struct
+{
+	const misaka_soft_i2c_bus_t *bus;/**< i2c总线 */
+	uint32_t (*get_tick_us)(void);/**< 获取us时间戳 */
+	misaka_coroutine_lock_t *lock;/**< 同一总线上各协程共用的协作锁（可选，NULL为不加锁） */
+	uint16_t yield_us;/**< 不小于此值的延时让出，更短的调用ops->delay_us忙等；0为全部让出 */
+
+	misaka_soft_i2c_message *msgs;/**< 消息对象 */
+	uint32_t num;/**< 消息数量 */
+	uint32_t ret;/**< 结束后为完成的消息数 */
+
+	misaka_coroutine_t co;/**< 传输，内部使用 */
+	misaka_coroutine_t addr_co;/**< 地址阶段，内部使用 */
+	misaka_coroutine_t byte_co;/**< 字节与起止信号，内部使用 */
+	uint32_t index;/**< 当前消息，内部使用 */
+	uint32_t pos;/**< 当前字节，内部使用 */
+	uint8_t data;/**< 当前收发的字节，内部使用 */
+	uint8_t bit;/**< 当前位，内部使用 */
+	uint8_t ack;/**< 应答，内部使用 */
+	uint8_t tries;/**< 地址剩余重试次数，内部使用 */
+	uint8_t phase;/**< 地址阶段，内部使用 */
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	uint32_t tick;/**< 传输开始的时刻，统计用，内部使用 */
+#endif
+};
+
+typedef struct misaka_soft_i2c_coroutine_struct misaka_soft_i2c_coroutine_t;
+
+/**
+ * 可恢复的spi传输：按消息链提交，每段之间让出；段内由控制器完成，不可再分
+ */
+struct misaka_spi_coroutine_struct
+{
+	misaka_spi_t *spi;/**< spi设备 */
+	misaka_coroutine_lock_t *lock;/**< 同一总线上各协程共用的协作锁（可选，NULL为不加锁） */
+
+	misaka_spi_message_t *message;/**< 消息链，按各段自身的cs_take/cs_release提交 */
+	uint8_t ret;/**< 结束后为结果，0:成功 1:失败 */
+
+	misaka_coroutine_t co;/**< 传输，内部使用 */
+	misaka_spi_message_t *segment;/**< 当前段，内部使用 */
+};
+
+typedef struct misaka_spi_coroutine_struct misaka_spi_coroutine_t;
+
+/**
+ * 在协程中传输并等待结束，结果见x->ret
+ */
+#define MISAKA_SOFT_I2C_COROUTINE_TRANSFER(co, x, msgs, num)    do { misaka_soft_i2c_coroutine_start(x, msgs, num); MISAKA_COROUTINE_WAIT_UNTIL(co, misaka_soft_i2c_coroutine_poll(x) == MISAKA_COROUTINE_DONE); } while (0)
+
+#define MISAKA_SPI_COROUTINE_TRANSFER(co, x, message)           do { misaka_spi_coroutine_start(x, message); MISAKA_COROUTINE_WAIT_UNTIL(co, misaka_spi_coroutine_poll(x) == MISAKA_COROUTINE_DONE); } while (0)
+
+/**
+ * @brief 准备模拟i2c传输
+ * @param x 传输对象
+ * @param msgs 消息对象
+ * @param num 消息数量
+ */
+void misaka_soft_i2c_coroutine_start(misaka_soft_i2c_coroutine_t *x, misaka_soft_i2c_message *msgs, uint32_t num);
+
+/**
+ * @brief 推进模拟i2c传输
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING:未结束 MISAKA_COROUTINE_DONE:结束，完成的消息数见x->ret
+ */
+uint8_t misaka_soft_i2c_coroutine_poll(misaka_soft_i2c_coroutine_t *x);
+
+/**
+ * @brief 准备spi传输
+ * @param x 传输对象
+ * @param message 消息链
+ */
+void misaka_spi_coroutine_start(misaka_spi_coroutine_t *x, misaka_spi_message_t *message);
+
+/**
+ * @brief 推进spi传输
+ * @param x 传输对象
+ * @return MISAKA_COROUTINE_WAITING:未结束 MISAKA_COROUTINE_DONE:结束，结果见x->ret
+ */
+uint8_t misaka_spi_coroutine_poll(misaka_spi_coroutine_t *x);
+
+#endif //__MISAKA_COROUTINE_H__
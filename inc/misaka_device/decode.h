@@ -0,0 +1,77 @@
+/**
+ * @file decode.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_DECODE_H__
+#define __MISAKA_DECODE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define misaka_decode_assert(expr)  ((void)0U)
+
+#define MISAKA_DECODE_BIG_ENDIAN        0                   /**< 高字节在前 */
+#define MISAKA_DECODE_LITTLE_ENDIAN     1                   /**< 低字节在前 */
+
+/**
+ * 样本格式：第i帧从buf + i * stride开始，帧内依次为channels个交织的样本（如x/y/z轴），每个width字节；
+ * 只取其中一轴时令channels为1、buf指向该轴、stride为帧长即可。
+ * 样本左对齐存放时（如24位中的20位数据，低4位为0），以shift右移得到数值。
+ * 有符号、帧间无间隙（stride为0或width * channels）的16/24位格式使用SIMD（SSE2/SSSE3、NEON、Helium），其余为标量循环；
+ * 定义MISAKA_DECODE_NO_SIMD可强制使用标量循环；NEON/Helium内核尚未在目标上验证，默认关闭，定义MISAKA_DECODE_USING_ARM_SIMD启用。
+ */
+struct misaka_decode_format_struct
+{
+	uint8_t width;/**< 样本字节数，1~4 */
+	uint8_t endian;/**< MISAKA_DECODE_BIG_ENDIAN或MISAKA_DECODE_LITTLE_ENDIAN */
+	uint8_t sign;/**< 1:补码 0:无符号 */
+	uint8_t shift;/**< 右移位数 */
+	uint8_t channels;/**< 每帧交织的样本数，0视为1 */
+	uint16_t stride;/**< 帧字节数，0为width * channels */
+	float scale;/**< 转换为浮点时的比例，如每LSB对应的g或dps */
+};
+
+typedef struct misaka_decode_format_struct misaka_decode_format_t;
+
+/**
+ * @brief 解码为32位整数
+ * @param f 格式
+ * @param buf 接收缓冲区
+ * @param frames 帧数
+ * @param out 输出，frames * channels个，按帧内顺序交织
+ */
+void misaka_decode_int32(const misaka_decode_format_t *f, const uint8_t *buf, uint32_t frames, int32_t *out);
+
+/**
+ * @brief 解码并乘以scale转换为浮点
+ * @param f 格式
+ * @param buf 接收缓冲区
+ * @param frames 帧数
+ * @param out 输出，frames * channels个，按帧内顺序交织
+ */
+void misaka_decode_float(const misaka_decode_format_t *f, const uint8_t *buf, uint32_t frames, float *out);
+
+/**
+ * @brief 原地解码16位有符号样本，结果覆盖接收缓冲区，不需要额外的输出缓冲区
+ * @param f 格式，width须为2、sign须为1且帧间无间隙
+ * @param buf 接收缓冲区，须2字节对齐
+ * @param frames 帧数
+ * @return int16_t* @c 解码结果（即buf），NULL为格式不支持原地解码
+ */
+int16_t *misaka_decode_int16_inplace(const misaka_decode_format_t *f, uint8_t *buf, uint32_t frames);
+
+#endif //__MISAKA_DECODE_H__
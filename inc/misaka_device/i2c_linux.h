@@ -0,0 +1,61 @@
+/**
+ * @file i2c_linux.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_I2C_LINUX_H__
+#define __MISAKA_I2C_LINUX_H__
+
+#include <pthread.h>
+#include "misaka_device/soft_i2c.h"
+
+#ifndef MISAKA_I2C_LINUX_MESSAGE_MAX
+#define MISAKA_I2C_LINUX_MESSAGE_MAX    42                  /**< 单次I2C_RDWR最多携带的i2c_msg数，即内核的I2C_RDWR_IOCTL_MAX_MSGS */
+#endif
+
+struct misaka_i2c_linux_struct
+{
+	misaka_soft_i2c_bus_t bus;/**< i2c总线，使用传输后端，交给驱动使用 */
+	pthread_mutex_t mutex;/**< 本总线的互斥量 */
+	int fd;/**< /dev/i2c-X文件描述符 */
+	int (*ioctl)(int fd, unsigned long request, void *arg);/**< ioctl，默认为系统调用，测试时可替换为拦截函数 */
+	uint32_t ioctls;/**< 已发起的ioctl次数 */
+};
+
+typedef struct misaka_i2c_linux_struct misaka_i2c_linux_t;
+
+/**
+ * @brief 打开i2c-dev设备，打开后使用dev->bus进行传输
+ * @param dev i2c-dev设备，ioctl为NULL时使用系统调用
+ * @param path 设备路径，如 /dev/i2c-1
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_i2c_linux_open(misaka_i2c_linux_t *dev, const char *path);
+
+/**
+ * @brief 以已打开的文件描述符初始化i2c-dev设备，可配合ioctl拦截函数在无硬件时测试
+ * @param dev i2c-dev设备
+ * @param fd 文件描述符
+ */
+void misaka_i2c_linux_attach(misaka_i2c_linux_t *dev, int fd);
+
+/**
+ * @brief 关闭i2c-dev设备
+ * @param dev i2c-dev设备
+ */
+void misaka_i2c_linux_close(misaka_i2c_linux_t *dev);
+
+#endif //__MISAKA_I2C_LINUX_H__
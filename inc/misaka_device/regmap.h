@@ -0,0 +1,210 @@
+/**
+ * @file regmap.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_REGMAP_H__
+#define __MISAKA_REGMAP_H__
+
+#include "misaka_device/spi.h"
+#include "misaka_device/soft_i2c.h"
+
+#define misaka_regmap_assert(expr)  ((void)0U)
+
+#ifndef MISAKA_REGMAP_BURST_SIZE
+#define MISAKA_REGMAP_BURST_SIZE        32                  /**< 单次突发传输的最大数据字节数，超过时分段 */
+#endif
+
+#define MISAKA_REGMAP_VOLATILE          0x01                /**< 易变寄存器（状态、中断标志等），不缓存，每次读取都访问总线 */
+#define MISAKA_REGMAP_READ_ONLY         0x02                /**< 只读寄存器，写入返回失败 */
+#define MISAKA_REGMAP_WRITE_ONLY        0x04                /**< 只写寄存器，读取只能由缓存提供 */
+
+#define MISAKA_REGMAP_BIG_ENDIAN        0                   /**< 多字节寄存器地址与值高字节在前 */
+#define MISAKA_REGMAP_LITTLE_ENDIAN     1                   /**< 多字节寄存器地址与值低字节在前 */
+
+struct misaka_regmap_range_struct
+{
+	uint32_t first;/**< 起始寄存器 */
+	uint32_t last;/**< 结束寄存器（含） */
+	uint8_t flags;/**< MISAKA_REGMAP_VOLATILE等 */
+};
+
+typedef struct misaka_regmap_range_struct misaka_regmap_range_t;
+
+struct misaka_regmap_default_struct
+{
+	uint32_t reg;/**< 寄存器 */
+	uint32_t value;/**< 复位值 */
+};
+
+typedef struct misaka_regmap_default_struct misaka_regmap_default_t;
+
+struct misaka_regmap_struct
+{
+	void *bus;/**< 总线，i2c后端为misaka_soft_i2c_bus_t，spi后端为misaka_spi_t */
+	uint16_t addr;/**< i2c器件地址，spi后端不使用 */
+	uint8_t (*read)(struct misaka_regmap_struct *map, uint8_t *reg, uint8_t *buf, uint32_t len);/**< 从寄存器reg开始连续读取len字节，0:成功 1:失败 */
+	uint8_t (*write)(struct misaka_regmap_struct *map, uint8_t *reg, uint8_t *buf, uint32_t len);/**< 从寄存器reg开始连续写入len字节，0:成功 1:失败 */
+
+	uint8_t reg_bytes;/**< 寄存器地址字节数，1~4 */
+	uint8_t val_bytes;/**< 寄存器值字节数，1~4 */
+	uint8_t endian;/**< 地址与值的字节序，MISAKA_REGMAP_BIG_ENDIAN或MISAKA_REGMAP_LITTLE_ENDIAN */
+	uint8_t read_flag;/**< spi读命令时或入地址首字节的标志，如0x80 */
+	uint8_t write_flag;/**< spi写命令时或入地址首字节的标志 */
+	uint8_t burst_flag;/**< 多个寄存器连续访问时或入地址首字节的自增标志，如部分传感器的0x40 */
+	uint8_t burst;/**< 1: 器件支持地址自增，连续寄存器合并为一次传输 0: 逐个寄存器访问 */
+	uint32_t max_reg;/**< 最大寄存器 */
+
+	const misaka_regmap_range_t *ranges;/**< 寄存器属性表（可选），未列出的寄存器可读写且可缓存 */
+	uint16_t range_num;/**< 属性表项数 */
+	const misaka_regmap_default_t *defaults;/**< 复位值表（可选），初始化时填入缓存，同步时与复位值相同的寄存器无需重写 */
+	uint16_t default_num;/**< 复位值表项数 */
+
+	uint8_t *cache;/**< 缓存（可选，NULL为不缓存），(max_reg + 1) * val_bytes字节，由调用者静态分配 */
+	uint8_t *valid;/**< 缓存有效位图，max_reg / 8 + 1字节，由调用者静态分配 */
+	uint8_t *dirty;/**< 待同步位图，max_reg / 8 + 1字节，由调用者静态分配 */
+	uint8_t cache_only;/**< 1: 写入只更新缓存并置脏，由misaka_regmap_cache_sync合并下发，内部使用 */
+
+	uint32_t bus_reads;/**< 总线读传输次数 */
+	uint32_t bus_writes;/**< 总线写传输次数 */
+	uint32_t cache_hits;/**< 由缓存提供的寄存器读取次数 */
+	uint32_t writes_skipped;/**< 值未变化而省去的写入次数 */
+};
+
+typedef struct misaka_regmap_struct misaka_regmap_t;
+
+/**
+ * @brief 初始化，清空缓存并按复位值表填充
+ * @param map 寄存器映射
+ * @return 0:成功 1:配置错误
+ */
+uint8_t misaka_regmap_init(misaka_regmap_t *map);
+
+/**
+ * @brief 读一个寄存器，可缓存且缓存有效时不访问总线
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param value 值
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_read(misaka_regmap_t *map, uint32_t reg, uint32_t *value);
+
+/**
+ * @brief 写一个寄存器，写穿透：立即下发并更新缓存
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param value 值
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_write(misaka_regmap_t *map, uint32_t reg, uint32_t value);
+
+/**
+ * @brief 按掩码修改寄存器，缓存有效时省去读取，值不变时省去写入
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param mask 掩码
+ * @param value 值
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_update_bits(misaka_regmap_t *map, uint32_t reg, uint32_t mask, uint32_t value);
+
+/**
+ * @brief 连续读取多个寄存器，已缓存的部分不访问总线，其余合并为一次自增突发读取
+ * @param map 寄存器映射
+ * @param reg 起始寄存器
+ * @param values 值
+ * @param count 寄存器数量
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_bulk_read(misaka_regmap_t *map, uint32_t reg, uint32_t *values, uint32_t count);
+
+/**
+ * @brief 连续写入多个寄存器，合并为一次自增突发写入
+ * @param map 寄存器映射
+ * @param reg 起始寄存器
+ * @param values 值
+ * @param count 寄存器数量
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_bulk_write(misaka_regmap_t *map, uint32_t reg, const uint32_t *values, uint32_t count);
+
+/**
+ * @brief 设置仅缓存模式：器件断电期间或批量配置时写入只进入缓存，之后由misaka_regmap_cache_sync合并下发
+ * @param map 寄存器映射
+ * @param enable 1: 仅缓存 0: 写穿透
+ */
+void misaka_regmap_cache_only(misaka_regmap_t *map, uint8_t enable);
+
+/**
+ * @brief 器件复位后调用，将所有与复位值不同的缓存寄存器置脏
+ * @param map 寄存器映射
+ */
+void misaka_regmap_cache_mark_dirty(misaka_regmap_t *map);
+
+/**
+ * @brief 下发所有脏寄存器，连续的脏寄存器合并为一次突发写入
+ * @param map 寄存器映射
+ * @return 0:成功 1:失败，未下发的寄存器保持脏标记
+ */
+uint8_t misaka_regmap_cache_sync(misaka_regmap_t *map);
+
+/**
+ * @brief 丢弃所有缓存（不下发），器件被旁路修改后调用
+ * @param map 寄存器映射
+ */
+void misaka_regmap_cache_drop(misaka_regmap_t *map);
+
+/**
+ * @brief i2c后端读：写寄存器地址后重复起始读取
+ * @param map 寄存器映射，bus为misaka_soft_i2c_bus_t
+ * @param reg 寄存器地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_i2c_read(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief i2c后端写：寄存器地址与数据在同一次传输中写入
+ * @param map 寄存器映射，bus为misaka_soft_i2c_bus_t
+ * @param reg 寄存器地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_i2c_write(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief spi后端读：发送带read_flag的地址后接收
+ * @param map 寄存器映射，bus为misaka_spi_t
+ * @param reg 寄存器地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_spi_read(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief spi后端写：发送带write_flag的地址后发送数据
+ * @param map 寄存器映射，bus为misaka_spi_t
+ * @param reg 寄存器地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_spi_write(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len);
+
+#endif //__MISAKA_REGMAP_H__
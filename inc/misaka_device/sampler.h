@@ -0,0 +1,135 @@
+/**
+ * @file sampler.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SAMPLER_H__
+#define __MISAKA_SAMPLER_H__
+
+#include "misaka_device/transaction.h"
+
+#define misaka_sampler_assert(expr)  ((void)0U)
+
+#ifndef misaka_sampler_barrier
+#if defined(__GNUC__)
+#define misaka_sampler_barrier()        __asm volatile ("" ::: "memory")    /**< 环形缓冲区发布前的内存屏障，多核时需替换为硬件屏障 */
+#else
+#define misaka_sampler_barrier()        ((void)0U)
+#endif
+#endif
+
+#define MISAKA_SAMPLER_BUS_SPI          0                   /**< spi总线，通道各自提交spi事务 */
+#define MISAKA_SAMPLER_BUS_I2C          1                   /**< i2c总线，同批通道的消息合并为一次传输 */
+
+struct misaka_sampler_channel_struct
+{
+	misaka_spi_t *spi;/**< spi设备，spi总线使用 */
+	misaka_spi_transaction_t *spi_transaction;/**< 预先构建的读取事务，spi总线使用 */
+	misaka_soft_i2c_transaction_t *i2c_transaction;/**< 预先构建的读取事务，i2c总线使用 */
+	uint8_t *data;/**< 事务的接收缓冲区，提交成功后复制sample_size字节到环形缓冲区 */
+	uint16_t sample_size;/**< 每个样本的字节数 */
+	uint32_t period_us;/**< 采样周期 */
+	uint32_t tolerance_us;/**< 允许提前采样的时间，窗口内的通道与已到期的通道合并提交 */
+
+	uint8_t *ring;/**< 样本环形缓冲区，ring_size * sample_size字节，由调用者静态分配 */
+	uint32_t *stamps;/**< 样本时刻（us），ring_size个，由调用者静态分配 */
+	uint32_t ring_size;/**< 环形缓冲区样本数，需为2的幂 */
+	volatile uint32_t head;/**< 写位置，仅由调度方修改 */
+	volatile uint32_t tail;/**< 读位置，仅由读取方修改 */
+
+	uint32_t samples;/**< 写入的样本数 */
+	uint32_t overruns;/**< 缓冲区已满而丢弃的样本数 */
+	uint32_t misses;/**< 调度落后超过一个周期而跳过的采样数 */
+	uint32_t failures;/**< 传输失败次数 */
+	uint32_t jitter_max_us;/**< 采样时刻与计划时刻的最大偏差 */
+
+	uint32_t due;/**< 下一次计划采样时刻，内部使用 */
+	struct misaka_sampler_channel_struct *next;/**< 同一总线上的下一个通道，内部使用 */
+};
+
+typedef struct misaka_sampler_channel_struct misaka_sampler_channel_t;
+
+struct misaka_sampler_bus_struct
+{
+	uint8_t type;/**< MISAKA_SAMPLER_BUS_x */
+	const misaka_soft_i2c_bus_t *i2c;/**< i2c总线 */
+	misaka_soft_i2c_message *merge;/**< i2c合并提交的消息区（可选，NULL为逐个通道提交），由调用者静态分配 */
+	uint16_t merge_size;/**< 合并消息区可容纳的消息数 */
+
+	uint32_t batches;/**< 提交批次数 */
+	uint32_t transfers;/**< 总线传输次数（i2c合并后为一次） */
+
+	misaka_sampler_channel_t *channels;/**< 通道链表，内部使用 */
+	struct misaka_sampler_bus_struct *next;/**< 下一条总线，内部使用 */
+};
+
+typedef struct misaka_sampler_bus_struct misaka_sampler_bus_t;
+
+struct misaka_sampler_struct
+{
+	uint32_t (*get_tick_us)(void);/**< 获取us时间戳 */
+
+	misaka_sampler_bus_t *buses;/**< 总线链表，内部使用 */
+};
+
+typedef struct misaka_sampler_struct misaka_sampler_t;
+
+/**
+ * @brief 初始化调度器
+ * @param sampler 调度器
+ */
+void misaka_sampler_init(misaka_sampler_t *sampler);
+
+/**
+ * @brief 添加总线
+ * @param sampler 调度器
+ * @param bus 总线
+ */
+void misaka_sampler_add_bus(misaka_sampler_t *sampler, misaka_sampler_bus_t *bus);
+
+/**
+ * @brief 在总线上添加通道，首次采样在下一次misaka_sampler_poll时进行
+ * @param sampler 调度器
+ * @param bus 总线
+ * @param channel 通道
+ * @return 0:成功 1:参数错误
+ */
+uint8_t misaka_sampler_add(misaka_sampler_t *sampler, misaka_sampler_bus_t *bus, misaka_sampler_channel_t *channel);
+
+/**
+ * @brief 调度一次：每条总线上有通道到期时，将到期及处于提前窗口内的通道作为一批连续提交
+ * @param sampler 调度器
+ * @return uint32_t @c 距下一个通道到期的时间（us），可据此休眠或设置定时器
+ */
+uint32_t misaka_sampler_poll(misaka_sampler_t *sampler);
+
+/**
+ * @brief 可读取的样本数
+ * @param channel 通道
+ * @return uint32_t @c 样本数
+ */
+uint32_t misaka_sampler_available(misaka_sampler_channel_t *channel);
+
+/**
+ * @brief 读取一个样本，可与misaka_sampler_poll在不同任务/中断中无锁并发调用（单读单写）
+ * @param channel 通道
+ * @param stamp 样本时刻（可为NULL）
+ * @param sample 样本，sample_size字节
+ * @return 0:成功 1:没有样本
+ */
+uint8_t misaka_sampler_read(misaka_sampler_channel_t *channel, uint32_t *stamp, uint8_t *sample);
+
+#endif //__MISAKA_SAMPLER_H__
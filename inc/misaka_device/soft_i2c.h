@@ -19,6 +19,7 @@
 #ifndef __MISAKA_SOFT_I2C_H__
 #define __MISAKA_SOFT_I2C_H__
 
+#include "stddef.h"
 #include "stdint.h"
 
 #define misaka_soft_i2c_assert(expr)  ((void)0U)
@@ -40,6 +41,29 @@ typedef struct
 	uint8_t *buf;                                        /**< 读写数据缓冲区指针 */
 } misaka_soft_i2c_message, *misaka_soft_i2c_message_t;
 
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+/**
+ * 时序引擎的开销统计：pin_calls / bytes为每字节的回调次数，delay_us为按us计的位时间，
+ * 提供get_tick_us时hold_us为实测时间，两者之差即回调与引擎本身的开销
+ */
+struct misaka_soft_i2c_statistics_struct
+{
+	uint32_t (*get_tick_us)(void);                        /**< 获取us时间戳（可选），提供时统计每次传输的实测时间 */
+
+	uint32_t transfers;                                    /**< 传输次数 */
+	uint32_t messages;                                    /**< 完成的消息数 */
+	uint32_t bytes;                                        /**< 收发的字节数（含地址字节） */
+	uint32_t nacks;                                        /**< 写入未应答次数（含地址重试） */
+	uint32_t pin_calls;                                    /**< 引脚操作调用次数（set_sda/set_scl/get_sda/set_sda_out/set_sda_in） */
+	uint32_t delay_calls;                                /**< delay_us调用次数 */
+	uint32_t delay_us;                                    /**< 请求的延时总和 */
+	uint32_t hold_us;                                    /**< 传输的累计实测时间（含互斥量） */
+	uint32_t hold_max_us;                                /**< 单次传输的最长实测时间 */
+};
+
+typedef struct misaka_soft_i2c_statistics_struct misaka_soft_i2c_statistics_t;
+#endif
+
 struct misaka_soft_i2c_struct
 {
 	void (*set_sda)(uint8_t state);                        /**< 设置sda引脚电平 */
@@ -59,10 +83,62 @@ struct misaka_soft_i2c_struct
 	void (*mutex_release)();                            /**< 释放互斥量，如果为裸机系统，空函数即可 */
 
 	uint16_t us;                                        /**< us延时单位，决定了此模拟iic的速率 */
+
+	uint32_t (*xfer)(misaka_soft_i2c_message *msgs, uint32_t num);    /**< 传输后端（可选），不为NULL时整组消息交由硬件控制器等完成，不再使用引脚操作与us，返回完成的消息数 */
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	misaka_soft_i2c_statistics_t *stat;                    /**< 统计（可选，NULL为不统计） */
+#endif
 };
 
 typedef struct misaka_soft_i2c_struct misaka_soft_i2c_t;
 
+/**
+ * 共享操作表：同一种引脚驱动只需一份常量表（可放在ROM中），各总线通过ctx区分端口、引脚掩码与互斥量。
+ * 提供xfer时为其他传输后端：消息数组与标志原样交给后端，在mutex_take/mutex_release之间调用，
+ * 基于misaka_soft_i2c_master_x等接口编写的驱动无需修改即可切换到硬件i2c。
+ * 后端需按标志处理MISAKA_SOFT_I2C_RD/ADDR_10BIT/NO_START/IGNORE_NACK/NO_READ_ACK，不支持的标志应返回失败。
+ */
+struct misaka_soft_i2c_ops_struct
+{
+	void (*set_sda)(void *ctx, uint8_t state);                /**< 设置sda引脚电平 */
+
+	void (*set_scl)(void *ctx, uint8_t state);                /**< 设置scl引脚电平 */
+
+	uint8_t (*get_sda)(void *ctx);                            /**< 读取sda引脚电平 */
+
+	void (*delay_us)(void *ctx, uint16_t us);                /**< 延时us */
+
+	void (*set_sda_out)(void *ctx);                            /**< 设置sda引脚为输出模式（硬件无上拉时需要添加） */
+
+	void (*set_sda_in)(void *ctx);                            /**< 设置sda引脚为输入模式（硬件无上拉时需要添加） */
+
+	void (*mutex_take)(void *ctx);                            /**< 获取互斥量，如果为裸机系统，空函数即可 */
+
+	void (*mutex_release)(void *ctx);                        /**< 释放互斥量，如果为裸机系统，空函数即可 */
+
+	void (*error)(void *ctx);                                /**< 读写错误回调（可选） */
+
+	uint32_t (*xfer)(void *ctx, misaka_soft_i2c_message *msgs, uint32_t num);    /**< 传输后端（可选），不为NULL时整组消息交由硬件控制器、linux i2c-dev等完成，引脚操作可为NULL，返回完成的消息数 */
+};
+
+typedef struct misaka_soft_i2c_ops_struct misaka_soft_i2c_ops_t;
+
+struct misaka_soft_i2c_bus_struct
+{
+	const misaka_soft_i2c_ops_t *ops;                        /**< 共享操作表 */
+
+	void *ctx;                                                /**< 本总线的上下文，作为操作表各函数的第一个参数 */
+
+	uint16_t us;                                            /**< us延时单位，决定了此模拟iic的速率，共用操作表的各总线可不同 */
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	misaka_soft_i2c_statistics_t *stat;                        /**< 统计（可选，NULL为不统计） */
+#endif
+};
+
+typedef struct misaka_soft_i2c_bus_struct misaka_soft_i2c_bus_t;
+
 /**
  * @brief 产生起始信号
  * @param ops i2c设备
@@ -130,4 +206,73 @@ uint32_t misaka_soft_i2c_master_send_then_send(const misaka_soft_i2c_t *ops, uin
  */
 void misaka_soft_i2c_init(const misaka_soft_i2c_t *i2c_bus);
 
+/**
+ * @brief 外部操作函数（共享操作表）
+ * @param bus i2c总线
+ * @param msgs 消息对象
+ * @param num 消息数量
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_transfer(const misaka_soft_i2c_bus_t *bus, misaka_soft_i2c_message *msgs, uint32_t num);
+
+/**
+ * @brief 发送数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param flags 标志
+ * @param buf 待发送数据
+ * @param len 发送数据长度
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_send(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint16_t flags, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 接收数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param flags 标志
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_recv(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint16_t flags, uint8_t *rxbuf, uint32_t rxlen);
+
+/**
+ * @brief 发送数据后接收数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param txbuf 待发送数据
+ * @param txlen 发送数据长度
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_send_then_recv(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint8_t *txbuf, uint32_t txlen, uint8_t *rxbuf, uint32_t rxlen);
+
+/**
+ * @brief 发送数据后发送数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param txbuf1 待发送数据1
+ * @param txlen1 发送数据长度1
+ * @param txbuf2 待发送数据2
+ * @param txlen2 发送数据长度2
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_send_then_send(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint8_t *txbuf1, uint32_t txlen1, uint8_t *txbuf2, uint32_t txlen2);
+
+/**
+ * @brief 初始化函数（共享操作表）
+ * @param bus i2c总线
+ */
+void misaka_soft_i2c_bus_init(const misaka_soft_i2c_bus_t *bus);
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+/**
+ * @brief 清零统计，保留get_tick_us
+ * @param stat 统计
+ */
+void misaka_soft_i2c_reset_statistics(misaka_soft_i2c_statistics_t *stat);
+#endif
+
 #endif //__MISAKA_SOFT_I2C_H__
\ No newline at end of file
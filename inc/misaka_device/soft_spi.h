@@ -0,0 +1,310 @@
+/**
+ * @file soft_spi.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 软件模拟spi总线模板，引脚操作以宏的形式给出，编译器可将其内联进每一位的收发循环中。
+ * 每包含一次本文件即生成一条软件spi总线，包含前需定义：
+ *
+ * - MISAKA_SOFT_SPI_NAME          总线名，生成的函数以此为前缀
+ * - MISAKA_SOFT_SPI_SET_SCK(s)    设置sck引脚电平
+ * - MISAKA_SOFT_SPI_SET_MOSI(s)   设置mosi引脚电平
+ * - MISAKA_SOFT_SPI_GET_MISO()    读取miso引脚电平，返回0或1
+ * - MISAKA_SOFT_SPI_DELAY()       半个时钟周期的延时（可选，不定义时全速运行）
+ * - MISAKA_SOFT_SPI_MUTEX_TAKE(ctx)     获取互斥量（可选，不定义时为空，裸机系统即可）
+ * - MISAKA_SOFT_SPI_MUTEX_RELEASE(ctx)  释放互斥量（可选）
+ *
+ * 生成常量操作表 <name>_ops，<name>_bus_init(misaka_spi_bus_t *bus, void *ctx) 以其初始化总线，
+ * ctx只传给互斥量宏。
+ */
+
+#include <string.h>
+#include "misaka_device/spi.h"
+
+#ifndef __MISAKA_SOFT_SPI_H__
+#define __MISAKA_SOFT_SPI_H__
+
+#define MISAKA_SOFT_SPI_CONCAT_(a, b)  a##b
+#define MISAKA_SOFT_SPI_CONCAT(a, b)   MISAKA_SOFT_SPI_CONCAT_(a, b)
+
+/**
+ * @brief 字节位序翻转，用于低位在前的模式
+ * @param data 数据
+ * @return uint8_t @c 翻转后的数据
+ */
+static inline uint8_t misaka_soft_spi_reverse(uint8_t data)
+{
+	data = (uint8_t) ((data & 0xF0) >> 4 | (data & 0x0F) << 4);
+	data = (uint8_t) ((data & 0xCC) >> 2 | (data & 0x33) << 2);
+	data = (uint8_t) ((data & 0xAA) >> 1 | (data & 0x55) << 1);
+
+	return data;
+}
+
+#endif //__MISAKA_SOFT_SPI_H__
+
+#if !defined(MISAKA_SOFT_SPI_NAME) || !defined(MISAKA_SOFT_SPI_SET_SCK) \
+    || !defined(MISAKA_SOFT_SPI_SET_MOSI) || !defined(MISAKA_SOFT_SPI_GET_MISO)
+#error "MISAKA_SOFT_SPI_NAME/SET_SCK/SET_MOSI/GET_MISO must be defined before including soft_spi.h"
+#endif
+
+#ifndef MISAKA_SOFT_SPI_DELAY
+#define MISAKA_SOFT_SPI_DELAY()
+#endif
+
+#ifndef MISAKA_SOFT_SPI_MUTEX_TAKE
+#define MISAKA_SOFT_SPI_MUTEX_TAKE(ctx)     ((void) (ctx))
+#endif
+
+#ifndef MISAKA_SOFT_SPI_MUTEX_RELEASE
+#define MISAKA_SOFT_SPI_MUTEX_RELEASE(ctx)  ((void) (ctx))
+#endif
+
+#define MISAKA_SOFT_SPI_FN(suffix)  MISAKA_SOFT_SPI_CONCAT(MISAKA_SOFT_SPI_NAME, suffix)
+
+static uint8_t MISAKA_SOFT_SPI_FN(_mode) = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+
+/**
+ * @brief 收发一个字节（高位在前），tx/rx为常量时编译器会裁掉不需要的引脚操作
+ * @param data 待发送数据
+ * @param cpol 空闲时钟电平
+ * @param cpha 0: 第一个边沿采样 1: 第二个边沿采样
+ * @param tx 是否驱动mosi
+ * @param rx 是否采样miso
+ * @return uint8_t @c 接收到的数据
+ */
+static inline uint8_t MISAKA_SOFT_SPI_FN(_xfer_byte)(uint8_t data, uint8_t cpol, uint8_t cpha, uint8_t tx, uint8_t rx)
+{
+	uint8_t i;
+	uint8_t recv = 0;
+
+	for (i = 0; i < 8; i++)
+	{
+		if (cpha)
+		{
+			MISAKA_SOFT_SPI_SET_SCK(!cpol);
+		}
+		if (tx)
+		{
+			MISAKA_SOFT_SPI_SET_MOSI((data >> 7) & 1);
+		}
+		data <<= 1;
+		MISAKA_SOFT_SPI_DELAY();
+		MISAKA_SOFT_SPI_SET_SCK(cpha ? cpol : !cpol);
+		if (rx)
+		{
+			recv = (uint8_t) ((recv << 1) | (MISAKA_SOFT_SPI_GET_MISO() & 1));
+		}
+		MISAKA_SOFT_SPI_DELAY();
+		if (!cpha)
+		{
+			MISAKA_SOFT_SPI_SET_SCK(cpol);
+		}
+	}
+
+	return recv;
+}
+
+/**
+ * @brief 发送的时候接收数据
+ * @param ctx 总线上下文，未使用
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t MISAKA_SOFT_SPI_FN(_send_recv)(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	uint32_t i;
+	uint8_t mode = MISAKA_SOFT_SPI_FN(_mode);
+	uint8_t cpol = (mode & MISAKA_SPI_CPOL) ? 1 : 0;
+	uint8_t lsb = (mode & MISAKA_SPI_MSB) ? 0 : 1;
+
+	(void) ctx;
+
+	if (mode & MISAKA_SPI_CPHA)
+	{
+		for (i = 0; i < length; i++)
+		{
+			rxbuf[i] = MISAKA_SOFT_SPI_FN(_xfer_byte)(lsb ? misaka_soft_spi_reverse(txbuf[i]) : txbuf[i], cpol, 1, 1, 1);
+		}
+	}
+	else
+	{
+		for (i = 0; i < length; i++)
+		{
+			rxbuf[i] = MISAKA_SOFT_SPI_FN(_xfer_byte)(lsb ? misaka_soft_spi_reverse(txbuf[i]) : txbuf[i], cpol, 0, 1, 1);
+		}
+	}
+
+	if (lsb)
+	{
+		for (i = 0; i < length; i++)
+		{
+			rxbuf[i] = misaka_soft_spi_reverse(rxbuf[i]);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 发送数据，不采样miso
+ * @param ctx 总线上下文，未使用
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t MISAKA_SOFT_SPI_FN(_send)(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	uint32_t i;
+	uint8_t mode = MISAKA_SOFT_SPI_FN(_mode);
+	uint8_t cpol = (mode & MISAKA_SPI_CPOL) ? 1 : 0;
+	uint8_t lsb = (mode & MISAKA_SPI_MSB) ? 0 : 1;
+
+	(void) ctx;
+
+	if (mode & MISAKA_SPI_CPHA)
+	{
+		for (i = 0; i < length; i++)
+		{
+			MISAKA_SOFT_SPI_FN(_xfer_byte)(lsb ? misaka_soft_spi_reverse(txbuf[i]) : txbuf[i], cpol, 1, 1, 0);
+		}
+	}
+	else
+	{
+		for (i = 0; i < length; i++)
+		{
+			MISAKA_SOFT_SPI_FN(_xfer_byte)(lsb ? misaka_soft_spi_reverse(txbuf[i]) : txbuf[i], cpol, 0, 1, 0);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 接收数据，mosi保持高电平不再逐位驱动
+ * @param ctx 总线上下文，未使用
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t MISAKA_SOFT_SPI_FN(_recv)(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	uint32_t i;
+	uint8_t mode = MISAKA_SOFT_SPI_FN(_mode);
+	uint8_t cpol = (mode & MISAKA_SPI_CPOL) ? 1 : 0;
+
+	(void) ctx;
+
+	MISAKA_SOFT_SPI_SET_MOSI(1);
+
+	if (mode & MISAKA_SPI_CPHA)
+	{
+		for (i = 0; i < length; i++)
+		{
+			rxbuf[i] = MISAKA_SOFT_SPI_FN(_xfer_byte)(0xFF, cpol, 1, 0, 1);
+		}
+	}
+	else
+	{
+		for (i = 0; i < length; i++)
+		{
+			rxbuf[i] = MISAKA_SOFT_SPI_FN(_xfer_byte)(0xFF, cpol, 0, 0, 1);
+		}
+	}
+
+	if (!(mode & MISAKA_SPI_MSB))
+	{
+		for (i = 0; i < length; i++)
+		{
+			rxbuf[i] = misaka_soft_spi_reverse(rxbuf[i]);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 切换模式，时钟线随之切换到新的空闲电平
+ * @param ctx 总线上下文，未使用
+ * @param device spi设备
+ * @param cfg 配置
+ * @return 0:成功 1:失败
+ */
+static uint8_t MISAKA_SOFT_SPI_FN(_configure)(void *ctx, misaka_spi_t *device, misaka_spi_configuration_t *cfg)
+{
+	(void) ctx;
+	(void) device;
+
+	if (cfg->data_width != 0 && cfg->data_width != 8)
+	{
+		return 1;
+	}
+
+	MISAKA_SOFT_SPI_FN(_mode) = cfg->mode;
+	MISAKA_SOFT_SPI_SET_SCK((cfg->mode & MISAKA_SPI_CPOL) ? 1 : 0);
+
+	return 0;
+}
+
+static void MISAKA_SOFT_SPI_FN(_mutex_take)(void *ctx)
+{
+	MISAKA_SOFT_SPI_MUTEX_TAKE(ctx);
+}
+
+static void MISAKA_SOFT_SPI_FN(_mutex_release)(void *ctx)
+{
+	MISAKA_SOFT_SPI_MUTEX_RELEASE(ctx);
+}
+
+static const misaka_spi_bus_ops_t MISAKA_SOFT_SPI_FN(_ops) = {
+	MISAKA_SOFT_SPI_FN(_send_recv),
+	MISAKA_SOFT_SPI_FN(_send),
+	MISAKA_SOFT_SPI_FN(_recv),
+	MISAKA_SOFT_SPI_FN(_mutex_take),
+	MISAKA_SOFT_SPI_FN(_mutex_release),
+	NULL,
+	MISAKA_SOFT_SPI_FN(_configure),
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+
+/**
+ * @brief 以软件spi操作表初始化总线，引脚回到模式0的空闲电平
+ * @param bus spi总线
+ * @param ctx 总线上下文，传给互斥量宏
+ */
+static void MISAKA_SOFT_SPI_FN(_bus_init)(misaka_spi_bus_t *bus, void *ctx)
+{
+	memset(bus, 0, sizeof(misaka_spi_bus_t));
+	bus->ops = &MISAKA_SOFT_SPI_FN(_ops);
+	bus->ctx = ctx;
+
+	MISAKA_SOFT_SPI_SET_SCK(0);
+	MISAKA_SOFT_SPI_SET_MOSI(1);
+}
+
+#undef MISAKA_SOFT_SPI_FN
+#undef MISAKA_SOFT_SPI_NAME
+#undef MISAKA_SOFT_SPI_SET_SCK
+#undef MISAKA_SOFT_SPI_SET_MOSI
+#undef MISAKA_SOFT_SPI_GET_MISO
+#undef MISAKA_SOFT_SPI_DELAY
+#undef MISAKA_SOFT_SPI_MUTEX_TAKE
+#undef MISAKA_SOFT_SPI_MUTEX_RELEASE
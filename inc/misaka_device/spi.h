@@ -24,7 +24,120 @@
 
 #define misaka_spi_assert(expr)  ((void)0U)
 
+#define MISAKA_SPI_CPHA     (1 << 0)                        /**< 时钟相位，第二个边沿采样 */
+#define MISAKA_SPI_CPOL     (1 << 1)                        /**< 时钟极性，空闲时为高电平 */
+#define MISAKA_SPI_LSB      (0 << 2)                        /**< 低位在前 */
+#define MISAKA_SPI_MSB      (1 << 2)                        /**< 高位在前 */
+
+#define MISAKA_SPI_MODE_0   (0 | 0)                         /**< CPOL = 0, CPHA = 0 */
+#define MISAKA_SPI_MODE_1   (0 | MISAKA_SPI_CPHA)           /**< CPOL = 0, CPHA = 1 */
+#define MISAKA_SPI_MODE_2   (MISAKA_SPI_CPOL | 0)           /**< CPOL = 1, CPHA = 0 */
+#define MISAKA_SPI_MODE_3   (MISAKA_SPI_CPOL | MISAKA_SPI_CPHA) /**< CPOL = 1, CPHA = 1 */
+
+#define MISAKA_SPI_MODE_MASK    (MISAKA_SPI_CPHA | MISAKA_SPI_CPOL | MISAKA_SPI_MSB)
+
+#define MISAKA_SPI_LINES_SINGLE 1                           /**< 单线全双工 */
+#define MISAKA_SPI_LINES_DUAL   2                           /**< 双线半双工 */
+#define MISAKA_SPI_LINES_QUAD   4                           /**< 四线半双工 */
+
+#define MISAKA_SPI_DC_NONE      0                           /**< 不改变D/C引脚 */
+#define MISAKA_SPI_DC_COMMAND   1                           /**< D/C引脚为低，传输命令 */
+#define MISAKA_SPI_DC_DATA      2                           /**< D/C引脚为高，传输数据 */
+
+#ifndef MISAKA_SPI_PRIORITY_NUM
+#define MISAKA_SPI_PRIORITY_NUM         4                   /**< 设备优先级数，优先级为0~MISAKA_SPI_PRIORITY_NUM-1，数值越大越优先，不超过32 */
+#endif
+
+#if MISAKA_SPI_PRIORITY_NUM > 32
+#error "MISAKA_SPI_PRIORITY_NUM must not exceed 32"
+#endif
+
+#ifndef MISAKA_SPI_STATISTICS_BUCKETS
+#define MISAKA_SPI_STATISTICS_BUCKETS   16                  /**< 延时直方图桶数，第k桶统计[2^(k-1), 2^k)us，末桶包含更大的值 */
+#endif
+
+struct misaka_spi_struct;
+struct misaka_spi_message_struct;
+
+#ifdef MISAKA_SPI_USING_STATISTICS
+struct misaka_spi_statistics_struct
+{
+	uint32_t transfers;/**< 传输次数（消息链数） */
+	uint32_t segments;/**< 消息段数 */
+	uint32_t bytes;/**< 字节数 */
+	uint32_t failures;/**< 失败次数 */
+	uint32_t wait_us;/**< 等待互斥量的累计时间 */
+	uint32_t wait_max_us;/**< 等待互斥量的最长时间 */
+	uint32_t hold_us;/**< 占用总线的累计时间 */
+	uint32_t hold_max_us;/**< 占用总线的最长时间 */
+	uint32_t preemptions;/**< 为更高优先级设备让出总线的次数 */
+	uint32_t histogram[MISAKA_SPI_STATISTICS_BUCKETS];/**< 单次传输延时（等待+占用）的log2直方图 */
+};
+
+typedef struct misaka_spi_statistics_struct misaka_spi_statistics_t;
+#endif
+
+struct misaka_spi_configuration_struct
+{
+	uint8_t mode;/**< 模式，MISAKA_SPI_MODE_x与MISAKA_SPI_MSB/MISAKA_SPI_LSB组合 */
+	uint8_t data_width;/**< 数据位宽，一般为8 */
+	uint32_t max_hz;/**< 最大时钟频率 */
+};
+
+typedef struct misaka_spi_configuration_struct misaka_spi_configuration_t;
+
+/**
+ * 共享操作表：同一种控制器或引脚驱动只需一份常量表（可放在ROM中），各总线/设备通过ctx区分寄存器基址、引脚掩码与互斥量
+ */
+struct misaka_spi_bus_ops_struct
+{
+	uint8_t (*send_recv)(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length);/**< 发送的时候接收数据 */
+	uint8_t (*send)(void *ctx, uint8_t *txbuf, uint32_t length);/**< 发送数据 */
+	uint8_t (*recv)(void *ctx, uint8_t *rxbuf, uint32_t length);/**< 接收数据 */
+	void (*mutex_take)(void *ctx);/**< 获取互斥量，如果为裸机系统，空函数即可 */
+	void (*mutex_release)(void *ctx);/**< 释放互斥量，如果为裸机系统，空函数即可 */
+	uint8_t (*transfer_chain)(void *ctx, struct misaka_spi_struct *device, struct misaka_spi_message_struct *message);/**< 整条消息链一次提交（可选，为NULL时逐段调用send_recv/send/recv），需自行处理cs_take/cs_release与dc，0:成功 1:失败 */
+	uint8_t (*configure)(void *ctx, struct misaka_spi_struct *device, misaka_spi_configuration_t *cfg);/**< 配置控制器模式与速率（可选），0:成功 1:失败 */
+	uint8_t (*send_lines)(void *ctx, uint8_t *txbuf, uint32_t length, uint8_t lines);/**< 以双线/四线发送数据（可选），0:成功 1:失败 */
+	uint8_t (*recv_lines)(void *ctx, uint8_t *rxbuf, uint32_t length, uint8_t lines);/**< 以双线/四线接收数据（可选），0:成功 1:失败 */
+	uint8_t (*dummy)(void *ctx, uint8_t cycles, uint8_t lines);/**< 产生空时钟周期（可选，为NULL时单线且周期数为8的整数倍可用send代替），0:成功 1:失败 */
+	void (*critical_enter)(void *ctx);/**< 进入临界区，保护等待计数，chunk_size非0时必须提供，裸机系统空函数即可 */
+	void (*critical_exit)(void *ctx);/**< 退出临界区（chunk_size非0时必须提供） */
+};
+
+typedef struct misaka_spi_bus_ops_struct misaka_spi_bus_ops_t;
+
+struct misaka_spi_cs_ops_struct
+{
+	void (*set_cs)(void *ctx, uint8_t state);/**< 设置cs引脚电平 */
+	void (*set_dc)(void *ctx, uint8_t state);/**< 设置D/C引脚电平（可选） */
+};
+
+typedef struct misaka_spi_cs_ops_struct misaka_spi_cs_ops_t;
+
 struct misaka_spi_bus_struct
+{
+	const misaka_spi_bus_ops_t *ops;/**< 共享操作表，多条总线可共用一份；不带上下文的旧式函数经misaka_spi_legacy_bus_init接入 */
+	void *ctx;/**< 本总线的上下文，作为操作表各函数的第一个参数 */
+	struct misaka_spi_struct *owner;/**< 最近一次完成配置的设备，由框架维护，初始化为NULL即可 */
+	uint32_t chunk_size;/**< 仲裁分块大小，0为不仲裁；非0时可抢占设备的段按此字节数分块，块间与cs释放处有更高优先级设备等待则让出总线，没有更高优先级的设备获取过本总线时整条提交 */
+	volatile uint16_t waiting[MISAKA_SPI_PRIORITY_NUM];/**< 各优先级等待总线的设备数，chunk_size非0时由框架维护，初始化为0即可 */
+	volatile uint32_t priorities;/**< 获取过本总线的设备优先级位图，chunk_size非0时由框架维护，初始化为0即可 */
+#ifdef MISAKA_SPI_USING_STATISTICS
+	uint32_t (*get_tick_us)(void);/**< 获取us时间戳（可选），提供时统计等待与占用时间及延时直方图 */
+	misaka_spi_statistics_t stat;/**< 总线统计 */
+	uint32_t stat_take_tick;/**< 本次获取总线的时刻，由框架维护 */
+	uint32_t stat_wait_us;/**< 本次等待互斥量的时间，由框架维护 */
+#endif
+};
+
+typedef struct misaka_spi_bus_struct misaka_spi_bus_t;
+
+/**
+ * 不带上下文的旧式总线函数，经misaka_spi_legacy_bus_init接到总线上，由spi核心内部的适配操作表转发；
+ * 只支持单线收发，需要多线、空周期、整链提交、配置或仲裁时请提供misaka_spi_bus_ops_t
+ */
+struct misaka_spi_legacy_bus_struct
 {
 	uint8_t (*send_recv)(uint8_t *txbuf, uint8_t *rxbuf, uint32_t length);/**< 发送的时候接收数据 */
 	uint8_t (*send)(uint8_t *txbuf, uint32_t length);/**< 发送数据 */
@@ -33,7 +146,17 @@ struct misaka_spi_bus_struct
 	void (*mutex_release)();/**< 释放互斥量，如果为裸机系统，空函数即可 */
 };
 
-typedef struct misaka_spi_bus_struct misaka_spi_bus_t;
+typedef struct misaka_spi_legacy_bus_struct misaka_spi_legacy_bus_t;
+
+/**
+ * 不带上下文的旧式cs函数，经misaka_spi_legacy_device_init接到设备上
+ */
+struct misaka_spi_legacy_cs_struct
+{
+	void (*set_cs)(uint8_t state);/**< 设置cs引脚电平 */
+};
+
+typedef struct misaka_spi_legacy_cs_struct misaka_spi_legacy_cs_t;
 
 struct misaka_spi_message_struct
 {
@@ -44,17 +167,38 @@ struct misaka_spi_message_struct
 
 	unsigned cs_take: 1;
 	unsigned cs_release: 1;
+
+	uint8_t lines;/**< 数据线宽度，MISAKA_SPI_LINES_x，0视为单线；多线时send_buf与recv_buf只能设置其一，以此区分方向 */
+	uint8_t dummy_cycles;/**< 数据阶段前的空时钟周期数，按lines的线宽产生 */
+	uint8_t dc;/**< D/C引脚状态，MISAKA_SPI_DC_x，用于显示屏等以D/C区分命令与数据的设备 */
 };
 typedef struct misaka_spi_message_struct misaka_spi_message_t;
 
 struct misaka_spi_struct
 {
-	void (*set_cs)(uint8_t state);                        /**< 设置cs引脚电平 */
+	const misaka_spi_cs_ops_t *cs_ops;                    /**< 共享cs/dc操作表，多个设备可共用一份；set_dc在消息dc不为MISAKA_SPI_DC_NONE时调用 */
+	void *cs_ctx;                                         /**< 本设备的cs上下文，如端口与引脚掩码，移植层在configure/transfer_chain中也可据此区分设备 */
 	misaka_spi_bus_t *bus;
+	misaka_spi_configuration_t config;                    /**< 设备配置，设备占用总线时按需下发 */
+	uint8_t priority;                                     /**< 优先级，0~MISAKA_SPI_PRIORITY_NUM-1，数值越大越优先 */
+	uint8_t preemptible;                                  /**< 可抢占，1时传输可在cs有效期间分块让出总线（设备需能容忍cs中途释放后继续传输，如显示屏写显存），0时只在cs释放处让出 */
+	uint8_t cs_active;                                    /**< cs当前是否有效，由框架维护（transfer_chain提交后按首段cs_take与末段cs_release更新），用于跳过重复的set_cs，初始化为0即可 */
+	uint8_t session;                                      /**< 会话状态，由框架维护，初始化为0即可 */
+#ifdef MISAKA_SPI_USING_STATISTICS
+	misaka_spi_statistics_t stat;                         /**< 设备统计 */
+#endif
 };
 
 typedef struct misaka_spi_struct misaka_spi_t;
 
+/**
+ * @brief 配置spi设备，在下一次传输时生效
+ * @param ops spi设备
+ * @param cfg 配置
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_configure(misaka_spi_t *ops, misaka_spi_configuration_t *cfg);
+
 /**
  * @brief 发送数据后发送数据
  * @param ops spi设备
@@ -104,4 +248,105 @@ uint8_t misaka_spi_transfer_message(misaka_spi_t *ops, misaka_spi_message_t *mes
  */
 uint8_t misaka_spi_send(misaka_spi_t *ops, uint8_t *txbuf, uint32_t length);
 
+/**
+ * @brief 打开会话：获取总线并保持到关闭，会话内的传输之间cs保持有效；会话期间不可调用misaka_spi_configure等其他接口
+ * @param ops spi设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_open(misaka_spi_t *ops);
+
+/**
+ * @brief 会话内发送数据
+ * @param ops spi设备
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_send(misaka_spi_t *ops, uint8_t *txbuf, uint32_t length);
+
+/**
+ * @brief 会话内接收数据
+ * @param ops spi设备
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_recv(misaka_spi_t *ops, uint8_t *rxbuf, uint32_t length);
+
+/**
+ * @brief 会话内传输数据
+ * @param ops spi设备
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_transfer(misaka_spi_t *ops, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length);
+
+/**
+ * @brief 会话内提交消息链，各段的cs_take/cs_release由会话改写为保持cs有效
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_message(misaka_spi_t *ops, misaka_spi_message_t *message);
+
+/**
+ * @brief 会话内按消息链自身的cs_take/cs_release提交，不改写消息，同一条链可反复提交
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_chain(misaka_spi_t *ops, misaka_spi_message_t *message);
+
+/**
+ * @brief 关闭会话：释放cs与总线
+ * @param ops spi设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_close(misaka_spi_t *ops);
+
+/**
+ * @brief 以不带上下文的旧式函数初始化总线，总线经内部的适配操作表调用这些函数
+ * @param bus spi总线
+ * @param legacy 旧式总线函数，需在总线使用期间保持有效
+ */
+void misaka_spi_legacy_bus_init(misaka_spi_bus_t *bus, misaka_spi_legacy_bus_t *legacy);
+
+/**
+ * @brief 以不带上下文的旧式cs函数初始化设备，配置为模式0、高位在前、8位，其余为0
+ * @param device spi设备
+ * @param bus spi总线
+ * @param cs 旧式cs函数，需在设备使用期间保持有效
+ */
+void misaka_spi_legacy_device_init(misaka_spi_t *device, misaka_spi_bus_t *bus, misaka_spi_legacy_cs_t *cs);
+
+#ifdef MISAKA_SPI_USING_STATISTICS
+/**
+ * @brief 获取设备统计快照
+ * @param ops spi设备
+ * @param stat 统计
+ */
+void misaka_spi_get_statistics(misaka_spi_t *ops, misaka_spi_statistics_t *stat);
+
+/**
+ * @brief 清零设备统计
+ * @param ops spi设备
+ */
+void misaka_spi_reset_statistics(misaka_spi_t *ops);
+
+/**
+ * @brief 获取总线统计快照
+ * @param bus spi总线
+ * @param stat 统计
+ */
+void misaka_spi_bus_get_statistics(misaka_spi_bus_t *bus, misaka_spi_statistics_t *stat);
+
+/**
+ * @brief 清零总线统计
+ * @param bus spi总线
+ */
+void misaka_spi_bus_reset_statistics(misaka_spi_bus_t *bus);
+#endif
+
 #endif //__SPI_H__
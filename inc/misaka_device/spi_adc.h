@@ -0,0 +1,120 @@
+/**
+ * @file spi_adc.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SPI_ADC_H__
+#define __MISAKA_SPI_ADC_H__
+
+#include "misaka_device/spi.h"
+
+#ifndef MISAKA_SPI_ADC_CHANNEL_MAX
+#define MISAKA_SPI_ADC_CHANNEL_MAX      16                  /**< 扫描表最大通道数 */
+#endif
+
+#ifndef MISAKA_SPI_ADC_FRAME_MAX
+#define MISAKA_SPI_ADC_FRAME_MAX        4                   /**< 单次转换帧的最大字节数 */
+#endif
+
+#ifndef misaka_spi_adc_barrier
+#if defined(__GNUC__)
+#define misaka_spi_adc_barrier()        __asm volatile ("" ::: "memory")    /**< 环形缓冲区发布前的内存屏障，多核时需替换为硬件屏障 */
+#else
+#define misaka_spi_adc_barrier()        ((void)0U)
+#endif
+#endif
+
+struct misaka_spi_adc_sample_struct
+{
+	uint32_t tick;/**< 所在扫描的开始时刻（us） */
+	uint16_t value;/**< 转换结果 */
+	uint8_t channel;/**< 通道 */
+};
+
+typedef struct misaka_spi_adc_sample_struct misaka_spi_adc_sample_t;
+
+struct misaka_spi_adc_struct
+{
+	misaka_spi_t *spi;/**< spi设备 */
+	uint32_t (*get_tick_us)(void);/**< 获取us时间戳（可选），为NULL时样本时刻为0 */
+	void (*encode)(uint8_t channel, uint8_t *frame);/**< 生成通道的转换命令帧，初始化时调用 */
+	uint16_t (*decode)(uint8_t channel, const uint8_t *frame);/**< 从接收帧中解出转换结果 */
+	uint8_t frame_size;/**< 每个通道一次转换的字节数，不超过MISAKA_SPI_ADC_FRAME_MAX */
+	uint8_t channel_num;/**< 扫描表通道数 */
+	uint8_t channels[MISAKA_SPI_ADC_CHANNEL_MAX];/**< 扫描表 */
+
+	misaka_spi_adc_sample_t *ring;/**< 样本环形缓冲区，由调用者静态分配 */
+	uint32_t ring_size;/**< 环形缓冲区大小，需为2的幂且不小于channel_num */
+	volatile uint32_t head;/**< 写位置，仅由采集方修改 */
+	volatile uint32_t tail;/**< 读位置，仅由读取方修改 */
+
+	uint32_t scans;/**< 成功写入的扫描次数 */
+	uint32_t overruns;/**< 缓冲区已满而丢弃的扫描次数 */
+	uint32_t failures;/**< 传输失败次数 */
+
+	uint8_t tx[MISAKA_SPI_ADC_CHANNEL_MAX * MISAKA_SPI_ADC_FRAME_MAX];/**< 预先生成的命令帧，内部使用 */
+	uint8_t rx[MISAKA_SPI_ADC_CHANNEL_MAX * MISAKA_SPI_ADC_FRAME_MAX];/**< 接收帧，内部使用 */
+	misaka_spi_message_t message[MISAKA_SPI_ADC_CHANNEL_MAX];/**< 每次扫描复用的消息链，内部使用 */
+};
+
+typedef struct misaka_spi_adc_struct misaka_spi_adc_t;
+
+/**
+ * @brief 初始化，生成扫描表的命令帧与消息链并清空环形缓冲区
+ * @param adc adc
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_adc_init(misaka_spi_adc_t *adc);
+
+/**
+ * @brief 扫描一次，整个扫描表在一条消息链中完成，结果写入环形缓冲区，缓冲区不足时丢弃本次扫描并计入overruns
+ * @param adc adc
+ * @return 0:成功 1:传输失败
+ */
+uint8_t misaka_spi_adc_scan(misaka_spi_adc_t *adc);
+
+/**
+ * @brief 可读取的样本数
+ * @param adc adc
+ * @return uint32_t @c 样本数
+ */
+uint32_t misaka_spi_adc_available(misaka_spi_adc_t *adc);
+
+/**
+ * @brief 读取样本，可与misaka_spi_adc_scan在不同任务/中断中无锁并发调用（单读单写）
+ * @param adc adc
+ * @param samples 样本
+ * @param num 最多读取的样本数
+ * @return uint32_t @c 读取的样本数
+ */
+uint32_t misaka_spi_adc_read(misaka_spi_adc_t *adc, misaka_spi_adc_sample_t *samples, uint32_t num);
+
+/**
+ * @brief MCP3204/MCP3208单端转换命令帧（3字节）
+ * @param channel 通道
+ * @param frame 命令帧
+ */
+void misaka_spi_adc_mcp3208_encode(uint8_t channel, uint8_t *frame);
+
+/**
+ * @brief MCP3204/MCP3208转换结果（12位）
+ * @param channel 通道
+ * @param frame 接收帧
+ * @return uint16_t @c 转换结果
+ */
+uint16_t misaka_spi_adc_mcp3208_decode(uint8_t channel, const uint8_t *frame);
+
+#endif //__MISAKA_SPI_ADC_H__
@@ -0,0 +1,97 @@
+/**
+ * @file spi_chain.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SPI_CHAIN_H__
+#define __MISAKA_SPI_CHAIN_H__
+
+#include "misaka_device/spi.h"
+
+struct misaka_spi_chain_struct
+{
+	misaka_spi_t *spi;/**< spi设备，cs上升沿锁存整条链（74HC595的RCLK、TLC59xx的LAT、MAX7219的LOAD） */
+	uint8_t *frame;/**< 整条链的帧，由调用者静态分配，device_num * device_size字节，同时作为各器件的影子状态 */
+	uint16_t device_num;/**< 级联的器件数 */
+	uint8_t device_size;/**< 每个器件移位寄存器的字节数 */
+
+	volatile uint8_t dirty;/**< 1: 影子状态已修改，尚未发送 */
+
+	uint32_t updates;/**< 改变了影子状态的更新次数 */
+	uint32_t frames;/**< 发送的帧数 */
+	uint32_t failures;/**< 发送失败次数 */
+};
+
+typedef struct misaka_spi_chain_struct misaka_spi_chain_t;
+
+/**
+ * @brief 初始化，清零影子状态并置脏，首次刷新时输出全0
+ * @param chain 级联链
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_chain_init(misaka_spi_chain_t *chain);
+
+/**
+ * @brief 获取器件的影子状态
+ * @param chain 级联链
+ * @param index 器件序号，0为最靠近主机（MOSI直连）的器件
+ * @return uint8_t* @c 影子状态，device_size字节，直接修改后需调用misaka_spi_chain_mark
+ */
+uint8_t *misaka_spi_chain_state(misaka_spi_chain_t *chain, uint16_t index);
+
+/**
+ * @brief 标记影子状态已被直接修改
+ * @param chain 级联链
+ */
+void misaka_spi_chain_mark(misaka_spi_chain_t *chain);
+
+/**
+ * @brief 写入器件的影子状态，内容不变时不置脏
+ * @param chain 级联链
+ * @param index 器件序号
+ * @param data 器件数据，device_size字节，按移位顺序排列
+ * @return 0:成功 1:序号越界
+ */
+uint8_t misaka_spi_chain_write(misaka_spi_chain_t *chain, uint16_t index, const uint8_t *data);
+
+/**
+ * @brief 按掩码修改器件影子状态中的一个字节，内容不变时不置脏
+ * @param chain 级联链
+ * @param index 器件序号
+ * @param offset 字节偏移
+ * @param mask 掩码
+ * @param value 值
+ * @return 0:成功 1:越界
+ */
+uint8_t misaka_spi_chain_update(misaka_spi_chain_t *chain, uint16_t index, uint8_t offset, uint8_t mask, uint8_t value);
+
+/**
+ * @brief 设置链上的一个输出位，pin按器件序号连续编号，器件内按字节偏移、位0~7编号
+ * @param chain 级联链
+ * @param pin 输出位
+ * @param level 0: 低电平 1: 高电平
+ * @return 0:成功 1:越界
+ */
+uint8_t misaka_spi_chain_write_pin(misaka_spi_chain_t *chain, uint32_t pin, uint8_t level);
+
+/**
+ * @brief 刷新，影子状态有变化时以一次传输发送整条链并由cs锁存，周期任务中调用可将多次更新合并为一帧
+ * @param chain 级联链
+ * @return 0:成功或无需发送 1:失败，保持脏标记以便下次重发
+ */
+uint8_t misaka_spi_chain_flush(misaka_spi_chain_t *chain);
+
+#endif //__MISAKA_SPI_CHAIN_H__
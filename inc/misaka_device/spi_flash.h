@@ -0,0 +1,123 @@
+/**
+ * @file spi_flash.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SPI_FLASH_H__
+#define __MISAKA_SPI_FLASH_H__
+
+#include "misaka_device/spi.h"
+
+#define MISAKA_SPI_FLASH_ERASE_TYPE_MAX     4               /**< sfdp最多描述4种擦除类型 */
+#define MISAKA_SPI_FLASH_POLL_MAX           0x00FFFFFFUL    /**< 等待空闲时最多读取状态寄存器的次数 */
+
+struct misaka_spi_flash_erase_struct
+{
+	uint8_t opcode;/**< 擦除指令 */
+	uint32_t size;/**< 擦除块大小，0表示不支持 */
+	uint32_t typ_us;/**< 典型擦除时间 */
+};
+
+typedef struct misaka_spi_flash_erase_struct misaka_spi_flash_erase_t;
+
+struct misaka_spi_flash_struct
+{
+	misaka_spi_t *spi;/**< spi设备 */
+	void (*delay_us)(uint32_t us);/**< 延时us（可选），提供时先等待典型时间再查询状态，减少状态读取次数 */
+
+	uint8_t jedec_id[3];/**< 厂商id，存储器类型，容量 */
+	uint32_t capacity;/**< 容量 */
+	uint32_t page_size;/**< 页大小 */
+	uint32_t program_typ_us;/**< 典型页编程时间 */
+	uint8_t addr_bytes;/**< 地址字节数，3或4 */
+
+	uint8_t read_opcode;/**< 读指令 */
+	uint8_t read_dummy;/**< 读指令的空周期数（含模式位） */
+	uint8_t read_lines;/**< 读数据线宽度 */
+
+	misaka_spi_flash_erase_t erase[MISAKA_SPI_FLASH_ERASE_TYPE_MAX];/**< 擦除类型，按块大小从小到大排列 */
+
+	unsigned busy: 1;/**< 编程或擦除尚未确认完成，下一次操作前等待 */
+};
+
+typedef struct misaka_spi_flash_struct misaka_spi_flash_t;
+
+/**
+ * @brief 初始化，读取jedec id并解析sfdp，无sfdp时使用通用参数
+ * @param flash flash设备，需已设置spi
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_init(misaka_spi_flash_t *flash);
+
+/**
+ * @brief 读数据，一条消息链完成指令、地址、空周期与数据阶段
+ * @param flash flash设备
+ * @param addr 地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_read(misaka_spi_flash_t *flash, uint32_t addr, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 写数据，按页拆分编程，最后一页发出后立即返回，由下一次操作或misaka_spi_flash_sync等待完成
+ * @param flash flash设备
+ * @param addr 地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_write(misaka_spi_flash_t *flash, uint32_t addr, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 擦除，每次选用能覆盖剩余区域的最大擦除块，地址与长度需按最小擦除块对齐
+ * @param flash flash设备
+ * @param addr 地址
+ * @param len 长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_erase(misaka_spi_flash_t *flash, uint32_t addr, uint32_t len);
+
+/**
+ * @brief 等待上一次编程或擦除完成
+ * @param flash flash设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_sync(misaka_spi_flash_t *flash);
+
+/**
+ * @brief 初始化仿真flash，返回的总线按指令解析读写mem，可用于在主机上测试与评估flash驱动
+ * @param mem 存储空间
+ * @param size 容量，需为2的整数次幂
+ * @param busy_polls 编程或擦除后状态寄存器保持忙的读取次数
+ * @return misaka_spi_bus_t* @c 仿真总线
+ */
+misaka_spi_bus_t *misaka_spi_flash_sim_init(uint8_t *mem, uint32_t size, uint32_t busy_polls);
+
+/**
+ * 仿真flash的cs操作表，作为misaka_spi_t的cs_ops使用，cs_ctx未使用
+ */
+extern const misaka_spi_cs_ops_t misaka_spi_flash_sim_cs_ops;
+
+/**
+ * @brief 仿真flash的统计，cs次数、指令数与总线字节数
+ * @param cs 选中次数
+ * @param status_reads 状态寄存器读取次数
+ * @param bytes 总线上传输的字节数
+ */
+void misaka_spi_flash_sim_stat(uint32_t *cs, uint32_t *status_reads, uint32_t *bytes);
+
+#endif //__MISAKA_SPI_FLASH_H__
@@ -0,0 +1,136 @@
+/**
+ * @file spi_lcd.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SPI_LCD_H__
+#define __MISAKA_SPI_LCD_H__
+
+#include "misaka_device/spi.h"
+
+#ifndef MISAKA_SPI_LCD_DIRTY_MAX
+#define MISAKA_SPI_LCD_DIRTY_MAX        8                   /**< 脏矩形数量上限，超出时与增加面积最小的矩形合并 */
+#endif
+
+#ifndef MISAKA_SPI_LCD_SEGMENT_MAX
+#define MISAKA_SPI_LCD_SEGMENT_MAX      32                  /**< 单条消息链的段数，窗口命令占5段，其余为像素行；超出时在会话内以多条消息链继续 */
+#endif
+
+#ifndef MISAKA_SPI_LCD_MERGE_SLACK
+#define MISAKA_SPI_LCD_MERGE_SLACK      64                  /**< 合并后允许多刷新的像素数，约为一次窗口命令的开销 */
+#endif
+
+#define MISAKA_SPI_LCD_CMD_SWRESET      0x01
+#define MISAKA_SPI_LCD_CMD_SLPOUT       0x11
+#define MISAKA_SPI_LCD_CMD_INVON        0x21
+#define MISAKA_SPI_LCD_CMD_DISPON       0x29
+#define MISAKA_SPI_LCD_CMD_CASET        0x2A
+#define MISAKA_SPI_LCD_CMD_RASET        0x2B
+#define MISAKA_SPI_LCD_CMD_RAMWR        0x2C
+#define MISAKA_SPI_LCD_CMD_MADCTL       0x36
+#define MISAKA_SPI_LCD_CMD_COLMOD       0x3A
+
+struct misaka_spi_lcd_rect_struct
+{
+	uint16_t x;
+	uint16_t y;
+	uint16_t w;
+	uint16_t h;
+};
+
+typedef struct misaka_spi_lcd_rect_struct misaka_spi_lcd_rect_t;
+
+struct misaka_spi_lcd_struct
+{
+	misaka_spi_t *spi;/**< spi设备，需提供set_dc */
+	void (*delay_ms)(uint32_t ms);/**< 毫秒延时，初始化序列使用 */
+
+	uint16_t *framebuffer;/**< 显存，width * height个像素，按屏幕字节序（高字节在前）存放RGB565，由调用者静态分配 */
+	uint16_t width;/**< 宽度 */
+	uint16_t height;/**< 高度 */
+	uint16_t x_offset;/**< 显存窗口列偏移，如240x240的ST7789为0 */
+	uint16_t y_offset;/**< 显存窗口行偏移 */
+	uint8_t madctl;/**< MADCTL，方向与RGB/BGR顺序 */
+	uint8_t invert;/**< 1: 初始化时打开反色（多数IPS屏需要） */
+
+	misaka_spi_lcd_rect_t dirty[MISAKA_SPI_LCD_DIRTY_MAX];/**< 脏矩形 */
+	uint8_t dirty_num;/**< 脏矩形数量 */
+
+	uint32_t flushes;/**< 刷新的矩形数 */
+	uint32_t chains;/**< 提交的消息链数 */
+	uint32_t pixels;/**< 刷新的像素数 */
+
+	uint8_t command[3];/**< 窗口命令，内部使用 */
+	uint8_t window[8];/**< 窗口参数，内部使用 */
+	misaka_spi_message_t message[MISAKA_SPI_LCD_SEGMENT_MAX];/**< 消息链，内部使用 */
+};
+
+typedef struct misaka_spi_lcd_struct misaka_spi_lcd_t;
+
+/**
+ * @brief 初始化屏幕（ST7789/ILI9341类），清空脏矩形并设置为RGB565
+ * @param lcd 屏幕
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_lcd_init(misaka_spi_lcd_t *lcd);
+
+/**
+ * @brief 转换为显存中的像素值（RGB565，高字节在前）
+ * @param r 红色，0~255
+ * @param g 绿色，0~255
+ * @param b 蓝色，0~255
+ * @return uint16_t @c 像素值
+ */
+uint16_t misaka_spi_lcd_color(uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief 标记区域需要刷新，直接修改显存后调用
+ * @param lcd 屏幕
+ * @param x 列
+ * @param y 行
+ * @param w 宽度
+ * @param h 高度
+ */
+void misaka_spi_lcd_invalidate(misaka_spi_lcd_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/**
+ * @brief 画点
+ * @param lcd 屏幕
+ * @param x 列
+ * @param y 行
+ * @param color 像素值，由misaka_spi_lcd_color得到
+ */
+void misaka_spi_lcd_set_pixel(misaka_spi_lcd_t *lcd, uint16_t x, uint16_t y, uint16_t color);
+
+/**
+ * @brief 填充矩形
+ * @param lcd 屏幕
+ * @param x 列
+ * @param y 行
+ * @param w 宽度
+ * @param h 高度
+ * @param color 像素值，由misaka_spi_lcd_color得到
+ */
+void misaka_spi_lcd_fill(misaka_spi_lcd_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
+/**
+ * @brief 刷新所有脏矩形，每个矩形的窗口命令与像素数据在一次cs选中期间发出
+ * @param lcd 屏幕
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_lcd_flush(misaka_spi_lcd_t *lcd);
+
+#endif //__MISAKA_SPI_LCD_H__
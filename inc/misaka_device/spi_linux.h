@@ -0,0 +1,65 @@
+/**
+ * @file spi_linux.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SPI_LINUX_H__
+#define __MISAKA_SPI_LINUX_H__
+
+#include <pthread.h>
+#include "misaka_device/spi.h"
+
+#ifndef MISAKA_SPI_LINUX_TRANSFER_MAX
+#define MISAKA_SPI_LINUX_TRANSFER_MAX   32                  /**< 单次SPI_IOC_MESSAGE最多携带的spi_ioc_transfer数 */
+#endif
+
+struct misaka_spi_linux_struct
+{
+	misaka_spi_t device;/**< spi设备，交给驱动使用 */
+	misaka_spi_bus_t bus;/**< 本设备的总线，使用共享操作表，ctx指向本结构体 */
+	pthread_mutex_t mutex;/**< 本设备的互斥量 */
+	int fd;/**< /dev/spidevX.Y文件描述符 */
+	uint32_t mode;/**< 已下发的SPI_IOC_WR_MODE32模式，含按需打开的SPI_TX/RX_DUAL/QUAD */
+	int (*ioctl)(int fd, unsigned long request, void *arg);/**< ioctl，默认为系统调用，测试时可替换为拦截函数 */
+	uint32_t ioctls;/**< 已发起的ioctl次数 */
+};
+
+typedef struct misaka_spi_linux_struct misaka_spi_linux_t;
+
+/**
+ * @brief 打开spidev设备，打开后使用dev->device进行传输
+ * @param dev spidev设备，ioctl为NULL时使用系统调用
+ * @param path 设备路径，如 /dev/spidev0.0
+ * @param cfg 设备配置，模式、位宽与速率在首次传输时下发
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_linux_open(misaka_spi_linux_t *dev, const char *path, misaka_spi_configuration_t *cfg);
+
+/**
+ * @brief 以已打开的文件描述符初始化spidev设备，可配合ioctl拦截函数在无硬件时测试
+ * @param dev spidev设备
+ * @param fd 文件描述符
+ * @param cfg 设备配置
+ */
+void misaka_spi_linux_attach(misaka_spi_linux_t *dev, int fd, misaka_spi_configuration_t *cfg);
+
+/**
+ * @brief 关闭spidev设备
+ * @param dev spidev设备
+ */
+void misaka_spi_linux_close(misaka_spi_linux_t *dev);
+
+#endif //__MISAKA_SPI_LINUX_H__
@@ -0,0 +1,136 @@
+/**
+ * @file spi_sd.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SPI_SD_H__
+#define __MISAKA_SPI_SD_H__
+
+#include "misaka_device/spi.h"
+
+#define MISAKA_SPI_SD_BLOCK_SIZE        512
+
+#define MISAKA_SPI_SD_TYPE_NONE         0                   /**< 未初始化 */
+#define MISAKA_SPI_SD_TYPE_SDV1         1                   /**< SD 1.x，字节寻址 */
+#define MISAKA_SPI_SD_TYPE_SDV2         2                   /**< SD 2.0标准容量，字节寻址 */
+#define MISAKA_SPI_SD_TYPE_SDHC         3                   /**< SDHC/SDXC，块寻址 */
+
+#ifndef MISAKA_SPI_SD_POLL_BURST
+#define MISAKA_SPI_SD_POLL_BURST        8                   /**< 轮询响应、令牌与忙状态时一次读取的字节数，多读的字节留给后续读取 */
+#endif
+
+#ifndef MISAKA_SPI_SD_TOKEN_POLL
+#define MISAKA_SPI_SD_TOKEN_POLL        100000UL            /**< 等待数据令牌的最大字节数 */
+#endif
+
+#ifndef MISAKA_SPI_SD_BUSY_POLL
+#define MISAKA_SPI_SD_BUSY_POLL         1000000UL           /**< 等待忙结束的最大字节数 */
+#endif
+
+struct misaka_spi_sd_struct
+{
+	misaka_spi_t *spi;/**< spi设备 */
+	void (*delay_ms)(uint32_t ms);/**< 毫秒延时，等待ACMD41时使用 */
+	uint32_t init_hz;/**< 初始化阶段的时钟，不超过400kHz */
+	uint32_t max_hz;/**< 初始化完成后的时钟 */
+	uint8_t use_crc;/**< 1: CMD59开启crc，读数据时校验CRC16 */
+
+	uint8_t type;/**< 卡类型，MISAKA_SPI_SD_TYPE_x */
+	uint32_t block_num;/**< 容量（块），由初始化读取CSD得到 */
+
+	uint32_t commands;/**< 发出的命令数 */
+	uint32_t polls;/**< 轮询突发读取次数 */
+	uint32_t crc_errors;/**< crc错误次数 */
+
+	uint8_t look_pos;/**< 预读缓冲读位置，内部使用 */
+	uint8_t look_len;/**< 预读缓冲长度，内部使用 */
+	uint8_t look[MISAKA_SPI_SD_POLL_BURST];/**< 预读缓冲，内部使用 */
+};
+
+typedef struct misaka_spi_sd_struct misaka_spi_sd_t;
+
+/**
+ * @brief 初始化：以init_hz完成上电时钟、CMD0/CMD8/ACMD41/CMD58，读取CSD得到容量，然后切换到max_hz
+ * @param sd sd卡
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_init(misaka_spi_sd_t *sd);
+
+/**
+ * @brief 读块，多块时使用CMD18连续读取
+ * @param sd sd卡
+ * @param block 起始块号
+ * @param buf 待接收数据，count * MISAKA_SPI_SD_BLOCK_SIZE字节
+ * @param count 块数
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_read(misaka_spi_sd_t *sd, uint32_t block, uint8_t *buf, uint32_t count);
+
+/**
+ * @brief 写块，多块时先以ACMD23预擦除再使用CMD25连续写入；最后的编程忙状态在下一条命令前等待
+ * @param sd sd卡
+ * @param block 起始块号
+ * @param buf 待写入数据，count * MISAKA_SPI_SD_BLOCK_SIZE字节
+ * @param count 块数
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_write(misaka_spi_sd_t *sd, uint32_t block, uint8_t *buf, uint32_t count);
+
+/**
+ * @brief 等待写入完成
+ * @param sd sd卡
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_sync(misaka_spi_sd_t *sd);
+
+/**
+ * @brief 计算CRC7（命令帧），结果位于高7位
+ * @param buf 数据
+ * @param len 数据长度
+ * @return uint8_t @c crc << 1
+ */
+uint8_t misaka_spi_sd_crc7(const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 计算CRC16-CCITT（数据块）
+ * @param buf 数据
+ * @param len 数据长度
+ * @return uint16_t @c crc
+ */
+uint16_t misaka_spi_sd_crc16(const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief 初始化仿真sd卡（SDHC），返回的总线按SPI模式协议读写mem，可用于在主机上测试与评估sd驱动
+ * @param mem 存储空间，block_num * MISAKA_SPI_SD_BLOCK_SIZE字节
+ * @param block_num 块数，需为1024的整数倍
+ * @param busy_bytes 写块后保持忙的字节数
+ * @return misaka_spi_bus_t* @c 仿真总线
+ */
+misaka_spi_bus_t *misaka_spi_sd_sim_init(uint8_t *mem, uint32_t block_num, uint32_t busy_bytes);
+
+/**
+ * 仿真sd卡的cs操作表，作为misaka_spi_t的cs_ops使用，cs_ctx未使用
+ */
+extern const misaka_spi_cs_ops_t misaka_spi_sd_sim_cs_ops;
+
+/**
+ * @brief 仿真sd卡的统计
+ * @param commands 收到的命令数
+ * @param bytes 总线上传输的字节数
+ */
+void misaka_spi_sd_sim_stat(uint32_t *commands, uint32_t *bytes);
+
+#endif //__MISAKA_SPI_SD_H__
@@ -0,0 +1,172 @@
+/**
+ * @file transaction.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_TRANSACTION_H__
+#define __MISAKA_TRANSACTION_H__
+
+#include "misaka_device/spi.h"
+#include "misaka_device/soft_i2c.h"
+
+#define MISAKA_TRANSACTION_CS_HOLD      0x01                /**< spi: 本步结束后不释放cs，与下一步处于同一次cs选中内 */
+
+#define MISAKA_SPI_TRANSACTION_DELAY    0xff                /**< spi延时标记：消息的lines取此值，length为延时us */
+#define MISAKA_SOFT_I2C_TRANSACTION_DELAY   (1u << 15)      /**< i2c延时标记：消息的flags取此值，len为延时us */
+
+/**
+ * 构建一次、反复提交：步骤追加到调用者提供的消息区中，直接生成spi消息链或i2c消息数组，
+ * 追加函数返回该步的（首条）消息，重新绑定缓冲区只需修改其send_buf/recv_buf/buf与长度，
+ * 提交时不再做任何填充。没有延时步骤时整个事务一次提交。
+ */
+struct misaka_spi_transaction_struct
+{
+	misaka_spi_message_t *arena;/**< 消息区，由调用者静态分配 */
+	uint16_t size;/**< 消息区可容纳的消息数 */
+	uint16_t num;/**< 已使用的消息数（含延时标记） */
+	uint16_t delays;/**< 延时步骤数 */
+	uint8_t hold;/**< 上一步保持cs，内部使用 */
+	uint8_t overflow;/**< 1: 消息区不足，之后的步骤被丢弃，提交时返回失败 */
+	void (*delay_us)(uint32_t us);/**< 延时（使用延时步骤时必须提供） */
+};
+
+typedef struct misaka_spi_transaction_struct misaka_spi_transaction_t;
+
+struct misaka_soft_i2c_transaction_struct
+{
+	misaka_soft_i2c_message *arena;/**< 消息区，由调用者静态分配 */
+	uint16_t size;/**< 消息区可容纳的消息数 */
+	uint16_t num;/**< 已使用的消息数（含延时标记） */
+	uint16_t delays;/**< 延时步骤数 */
+	uint8_t overflow;/**< 1: 消息区不足，之后的步骤被丢弃，提交时返回失败 */
+	void (*delay_us)(uint32_t us);/**< 延时（使用延时步骤时必须提供） */
+};
+
+typedef struct misaka_soft_i2c_transaction_struct misaka_soft_i2c_transaction_t;
+
+/**
+ * @brief 清空事务，开始构建
+ * @param t 事务
+ */
+void misaka_spi_transaction_init(misaka_spi_transaction_t *t);
+
+/**
+ * @brief 追加写步骤
+ * @param t 事务
+ * @param buf 待发送数据
+ * @param len 数据长度
+ * @param flags MISAKA_TRANSACTION_CS_HOLD或0
+ * @return misaka_spi_message_t* @c 该步的消息，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_write(misaka_spi_transaction_t *t, uint8_t *buf, uint32_t len, uint8_t flags);
+
+/**
+ * @brief 追加读步骤
+ * @param t 事务
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @param flags MISAKA_TRANSACTION_CS_HOLD或0
+ * @return misaka_spi_message_t* @c 该步的消息，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_read(misaka_spi_transaction_t *t, uint8_t *buf, uint32_t len, uint8_t flags);
+
+/**
+ * @brief 追加先写后读步骤，两段处于同一次cs选中内
+ * @param t 事务
+ * @param txbuf 待发送数据
+ * @param txlen 发送数据长度
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @param flags MISAKA_TRANSACTION_CS_HOLD或0
+ * @return misaka_spi_message_t* @c 写消息，读消息为其next，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_write_read(misaka_spi_transaction_t *t, uint8_t *txbuf, uint32_t txlen,
+                                                        uint8_t *rxbuf, uint32_t rxlen, uint8_t flags);
+
+/**
+ * @brief 追加延时步骤，上一步保持cs时延时期间cs保持有效
+ * @param t 事务
+ * @param us 延时
+ * @return misaka_spi_message_t* @c 延时标记，length为延时us，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_delay(misaka_spi_transaction_t *t, uint32_t us);
+
+/**
+ * @brief 提交事务：没有延时步骤且末步释放cs时为一次misaka_spi_transfer_message，否则在会话中逐段提交
+ * @param t 事务
+ * @param spi spi设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_transaction_issue(misaka_spi_transaction_t *t, misaka_spi_t *spi);
+
+/**
+ * @brief 清空事务，开始构建
+ * @param t 事务
+ */
+void misaka_soft_i2c_transaction_init(misaka_soft_i2c_transaction_t *t);
+
+/**
+ * @brief 追加写消息
+ * @param t 事务
+ * @param addr 地址
+ * @param buf 待发送数据
+ * @param len 数据长度
+ * @param flags MISAKA_SOFT_I2C_x标志，如MISAKA_SOFT_I2C_NO_START
+ * @return misaka_soft_i2c_message* @c 该步的消息，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_write(misaka_soft_i2c_transaction_t *t, uint16_t addr, uint8_t *buf, uint32_t len, uint16_t flags);
+
+/**
+ * @brief 追加读消息
+ * @param t 事务
+ * @param addr 地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @param flags MISAKA_SOFT_I2C_x标志
+ * @return misaka_soft_i2c_message* @c 该步的消息，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_read(misaka_soft_i2c_transaction_t *t, uint16_t addr, uint8_t *buf, uint32_t len, uint16_t flags);
+
+/**
+ * @brief 追加先写后读（重复起始）
+ * @param t 事务
+ * @param addr 地址
+ * @param txbuf 待发送数据
+ * @param txlen 发送数据长度
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @return misaka_soft_i2c_message* @c 写消息，读消息紧随其后，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_write_read(misaka_soft_i2c_transaction_t *t, uint16_t addr, uint8_t *txbuf, uint32_t txlen,
+                                                                uint8_t *rxbuf, uint32_t rxlen);
+
+/**
+ * @brief 追加延时步骤，之前的消息以停止信号结束，延时后以起始信号继续
+ * @param t 事务
+ * @param us 延时
+ * @return misaka_soft_i2c_message* @c 延时标记，len为延时us，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_delay(misaka_soft_i2c_transaction_t *t, uint32_t us);
+
+/**
+ * @brief 提交事务：没有延时步骤时为一次misaka_soft_i2c_bus_transfer，否则按延时分段提交
+ * @param t 事务
+ * @param bus i2c总线
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_soft_i2c_transaction_issue(misaka_soft_i2c_transaction_t *t, const misaka_soft_i2c_bus_t *bus);
+
+#endif //__MISAKA_TRANSACTION_H__
@@ -0,0 +1,722 @@
+/**
+ * @file regmap.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+/**
+ * 缓存按寄存器平铺，每个寄存器val_bytes字节（低字节在前），有效与脏标记各占一位。
+ * 脏寄存器的缓存值比器件中的值新，读取时以缓存为准。缓存不加锁，同一寄存器映射需在同一任务中使用，
+ * 或由调用者加锁；总线互斥由spi/i2c层负责。
+ */
+
+#include "misaka_device/regmap.h"
+
+/**
+ * @brief 查询寄存器属性
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @return uint8_t @c MISAKA_REGMAP_VOLATILE等的组合
+ */
+static uint8_t misaka_regmap_flags(misaka_regmap_t *map, uint32_t reg)
+{
+	uint16_t i;
+	uint8_t flags = 0;
+
+	for (i = 0; i < map->range_num; i++)
+	{
+		if (reg >= map->ranges[i].first && reg <= map->ranges[i].last)
+		{
+			flags |= map->ranges[i].flags;
+		}
+	}
+
+	return flags;
+}
+
+/**
+ * @brief 寄存器是否可缓存
+ * @param map 寄存器映射
+ * @param flags 寄存器属性
+ * @return 1:可缓存 0:不可缓存
+ */
+static uint8_t misaka_regmap_cacheable(misaka_regmap_t *map, uint8_t flags)
+{
+	return map->cache != NULL && !(flags & MISAKA_REGMAP_VOLATILE);
+}
+
+static uint8_t misaka_regmap_bit_get(uint8_t *bitmap, uint32_t reg)
+{
+	return (bitmap[reg >> 3] >> (reg & 0x07)) & 0x01;
+}
+
+static void misaka_regmap_bit_set(uint8_t *bitmap, uint32_t reg)
+{
+	bitmap[reg >> 3] |= (uint8_t) (1 << (reg & 0x07));
+}
+
+static void misaka_regmap_bit_clear(uint8_t *bitmap, uint32_t reg)
+{
+	bitmap[reg >> 3] &= (uint8_t) ~(1 << (reg & 0x07));
+}
+
+/**
+ * @brief 读取缓存值
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @return uint32_t @c 缓存值
+ */
+static uint32_t misaka_regmap_cache_get(misaka_regmap_t *map, uint32_t reg)
+{
+	uint8_t *p = &map->cache[reg * map->val_bytes];
+	uint32_t value = 0;
+	uint8_t i;
+
+	for (i = map->val_bytes; i > 0; i--)
+	{
+		value = (value << 8) | p[i - 1];
+	}
+
+	return value;
+}
+
+/**
+ * @brief 写入缓存值并置有效
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param value 值
+ */
+static void misaka_regmap_cache_put(misaka_regmap_t *map, uint32_t reg, uint32_t value)
+{
+	uint8_t *p = &map->cache[reg * map->val_bytes];
+	uint8_t i;
+
+	for (i = 0; i < map->val_bytes; i++)
+	{
+		p[i] = (uint8_t) (value >> (i * 8));
+	}
+	misaka_regmap_bit_set(map->valid, reg);
+}
+
+/**
+ * @brief 按字节序编码
+ * @param map 寄存器映射
+ * @param buf 输出
+ * @param value 值
+ * @param bytes 字节数
+ */
+static void misaka_regmap_encode(misaka_regmap_t *map, uint8_t *buf, uint32_t value, uint8_t bytes)
+{
+	uint8_t i;
+
+	for (i = 0; i < bytes; i++)
+	{
+		buf[map->endian == MISAKA_REGMAP_LITTLE_ENDIAN ? i : bytes - 1 - i] = (uint8_t) (value >> (i * 8));
+	}
+}
+
+/**
+ * @brief 按字节序解码
+ * @param map 寄存器映射
+ * @param buf 输入
+ * @param bytes 字节数
+ * @return uint32_t @c 值
+ */
+static uint32_t misaka_regmap_decode(misaka_regmap_t *map, const uint8_t *buf, uint8_t bytes)
+{
+	uint32_t value = 0;
+	uint8_t i;
+
+	for (i = 0; i < bytes; i++)
+	{
+		value = (value << 8) | buf[map->endian == MISAKA_REGMAP_LITTLE_ENDIAN ? bytes - 1 - i : i];
+	}
+
+	return value;
+}
+
+/**
+ * @brief 单次传输最多访问的寄存器数
+ * @param map 寄存器映射
+ * @return uint32_t @c 寄存器数
+ */
+static uint32_t misaka_regmap_burst_max(misaka_regmap_t *map)
+{
+	uint32_t num;
+
+	if (!map->burst)
+	{
+		return 1;
+	}
+	num = MISAKA_REGMAP_BURST_SIZE / map->val_bytes;
+
+	return num ? num : 1;
+}
+
+/**
+ * @brief 编码寄存器地址，多个寄存器时或入自增标志
+ * @param map 寄存器映射
+ * @param buf 输出，4字节
+ * @param reg 寄存器
+ * @param count 寄存器数
+ */
+static void misaka_regmap_encode_reg(misaka_regmap_t *map, uint8_t *buf, uint32_t reg, uint32_t count)
+{
+	misaka_regmap_encode(map, buf, reg, map->reg_bytes);
+	if (count > 1)
+	{
+		buf[0] |= map->burst_flag;
+	}
+}
+
+/**
+ * @brief 从总线连续读取寄存器并更新缓存，按突发大小分段
+ * @param map 寄存器映射
+ * @param reg 起始寄存器
+ * @param values 值
+ * @param count 寄存器数量
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_regmap_raw_read(misaka_regmap_t *map, uint32_t reg, uint32_t *values, uint32_t count)
+{
+	uint8_t regbuf[4];
+	uint8_t buf[MISAKA_REGMAP_BURST_SIZE > 4 ? MISAKA_REGMAP_BURST_SIZE : 4];
+	uint32_t i, num, max = misaka_regmap_burst_max(map);
+	uint8_t flags;
+
+	while (count > 0)
+	{
+		num = count > max ? max : count;
+		misaka_regmap_encode_reg(map, regbuf, reg, num);
+		map->bus_reads++;
+		if (map->read(map, regbuf, buf, num * map->val_bytes) != 0)
+		{
+			return 1;
+		}
+
+		for (i = 0; i < num; i++)
+		{
+			flags = misaka_regmap_flags(map, reg + i);
+			if (misaka_regmap_cacheable(map, flags) && misaka_regmap_bit_get(map->valid, reg + i)
+				&& (misaka_regmap_bit_get(map->dirty, reg + i) || (flags & MISAKA_REGMAP_WRITE_ONLY)))
+			{
+				/** < 脏寄存器尚未同步，只写寄存器读回的内容无意义，均以缓存为准 */
+				values[i] = misaka_regmap_cache_get(map, reg + i);
+				continue;
+			}
+
+			values[i] = misaka_regmap_decode(map, &buf[i * map->val_bytes], map->val_bytes);
+			if (misaka_regmap_cacheable(map, flags))
+			{
+				misaka_regmap_cache_put(map, reg + i, values[i]);
+			}
+		}
+
+		reg += num;
+		values += num;
+		count -= num;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 连续写入寄存器到总线并更新缓存，按突发大小分段
+ * @param map 寄存器映射
+ * @param reg 起始寄存器
+ * @param values 值
+ * @param count 寄存器数量
+ * @return 0:成功 1:失败，已写入的分段缓存有效
+ */
+static uint8_t misaka_regmap_raw_write(misaka_regmap_t *map, uint32_t reg, const uint32_t *values, uint32_t count)
+{
+	uint8_t regbuf[4];
+	uint8_t buf[MISAKA_REGMAP_BURST_SIZE > 4 ? MISAKA_REGMAP_BURST_SIZE : 4];
+	uint32_t i, num, max = misaka_regmap_burst_max(map);
+
+	while (count > 0)
+	{
+		num = count > max ? max : count;
+		misaka_regmap_encode_reg(map, regbuf, reg, num);
+		for (i = 0; i < num; i++)
+		{
+			misaka_regmap_encode(map, &buf[i * map->val_bytes], values[i], map->val_bytes);
+		}
+
+		map->bus_writes++;
+		if (map->write(map, regbuf, buf, num * map->val_bytes) != 0)
+		{
+			return 1;
+		}
+
+		for (i = 0; i < num; i++)
+		{
+			if (misaka_regmap_cacheable(map, misaka_regmap_flags(map, reg + i)))
+			{
+				misaka_regmap_cache_put(map, reg + i, values[i]);
+				misaka_regmap_bit_clear(map->dirty, reg + i);
+			}
+		}
+
+		reg += num;
+		values += num;
+		count -= num;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 初始化，清空缓存并按复位值表填充
+ * @param map 寄存器映射
+ * @return 0:成功 1:配置错误
+ */
+uint8_t misaka_regmap_init(misaka_regmap_t *map)
+{
+	uint32_t i;
+
+	misaka_regmap_assert(map != NULL);
+
+	if (map->read == NULL || map->write == NULL
+		|| map->reg_bytes == 0 || map->reg_bytes > 4 || map->val_bytes == 0 || map->val_bytes > 4)
+	{
+		return 1;
+	}
+	if (map->cache != NULL && (map->valid == NULL || map->dirty == NULL))
+	{
+		return 1;
+	}
+
+	map->cache_only = 0;
+	map->bus_reads = 0;
+	map->bus_writes = 0;
+	map->cache_hits = 0;
+	map->writes_skipped = 0;
+
+	misaka_regmap_cache_drop(map);
+	if (map->cache != NULL)
+	{
+		for (i = 0; i < map->default_num; i++)
+		{
+			if (map->defaults[i].reg <= map->max_reg
+				&& misaka_regmap_cacheable(map, misaka_regmap_flags(map, map->defaults[i].reg)))
+			{
+				misaka_regmap_cache_put(map, map->defaults[i].reg, map->defaults[i].value);
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 读一个寄存器，可缓存且缓存有效时不访问总线
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param value 值
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_read(misaka_regmap_t *map, uint32_t reg, uint32_t *value)
+{
+	misaka_regmap_assert(map != NULL);
+	misaka_regmap_assert(value != NULL);
+
+	return misaka_regmap_bulk_read(map, reg, value, 1);
+}
+
+/**
+ * @brief 写一个寄存器，写穿透：立即下发并更新缓存
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param value 值
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_write(misaka_regmap_t *map, uint32_t reg, uint32_t value)
+{
+	misaka_regmap_assert(map != NULL);
+
+	return misaka_regmap_bulk_write(map, reg, &value, 1);
+}
+
+/**
+ * @brief 按掩码修改寄存器，缓存有效时省去读取，值不变时省去写入
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param mask 掩码
+ * @param value 值
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_update_bits(misaka_regmap_t *map, uint32_t reg, uint32_t mask, uint32_t value)
+{
+	uint32_t old, data;
+
+	misaka_regmap_assert(map != NULL);
+
+	if (misaka_regmap_read(map, reg, &old) != 0)
+	{
+		return 1;
+	}
+
+	data = (old & ~mask) | (value & mask);
+	if (data == old)
+	{
+		map->writes_skipped++;
+		return 0;
+	}
+
+	return misaka_regmap_write(map, reg, data);
+}
+
+/**
+ * @brief 连续读取多个寄存器，已缓存的部分不访问总线，其余合并为一次自增突发读取
+ * @param map 寄存器映射
+ * @param reg 起始寄存器
+ * @param values 值
+ * @param count 寄存器数量
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_bulk_read(misaka_regmap_t *map, uint32_t reg, uint32_t *values, uint32_t count)
+{
+	uint32_t i, first = count, last = 0, hits = 0;
+	uint8_t flags;
+
+	misaka_regmap_assert(map != NULL);
+	misaka_regmap_assert(values != NULL);
+
+	if (count == 0 || reg > map->max_reg || count - 1 > map->max_reg - reg)
+	{
+		return 1;
+	}
+
+	/** < 先由缓存提供，记录需要访问总线的首尾寄存器 */
+	for (i = 0; i < count; i++)
+	{
+		flags = misaka_regmap_flags(map, reg + i);
+		if (misaka_regmap_cacheable(map, flags) && misaka_regmap_bit_get(map->valid, reg + i))
+		{
+			values[i] = misaka_regmap_cache_get(map, reg + i);
+			hits++;
+			continue;
+		}
+		if (flags & MISAKA_REGMAP_WRITE_ONLY)
+		{
+			return 1;
+		}
+		if (first == count)
+		{
+			first = i;
+		}
+		last = i;
+	}
+
+	if (first == count)
+	{
+		map->cache_hits += hits;
+		return 0;
+	}
+	if (map->cache_only)
+	{
+		return 1;
+	}
+
+	if (map->burst)
+	{
+		/** < 首尾之间的已缓存寄存器一并读取，多读几个字节比多一次传输便宜 */
+		map->cache_hits += count - (last - first + 1);
+		return misaka_regmap_raw_read(map, reg + first, &values[first], last - first + 1);
+	}
+	map->cache_hits += hits;
+
+	for (i = first; i <= last; i++)
+	{
+		flags = misaka_regmap_flags(map, reg + i);
+		if (misaka_regmap_cacheable(map, flags) && misaka_regmap_bit_get(map->valid, reg + i))
+		{
+			continue;
+		}
+		if (misaka_regmap_raw_read(map, reg + i, &values[i], 1) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 连续写入多个寄存器，合并为一次自增突发写入
+ * @param map 寄存器映射
+ * @param reg 起始寄存器
+ * @param values 值
+ * @param count 寄存器数量
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_bulk_write(misaka_regmap_t *map, uint32_t reg, const uint32_t *values, uint32_t count)
+{
+	uint32_t i;
+	uint8_t flags;
+
+	misaka_regmap_assert(map != NULL);
+	misaka_regmap_assert(values != NULL);
+
+	if (count == 0 || reg > map->max_reg || count - 1 > map->max_reg - reg)
+	{
+		return 1;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		flags = misaka_regmap_flags(map, reg + i);
+		if ((flags & MISAKA_REGMAP_READ_ONLY) || (map->cache_only && !misaka_regmap_cacheable(map, flags)))
+		{
+			return 1;
+		}
+	}
+
+	if (map->cache_only)
+	{
+		for (i = 0; i < count; i++)
+		{
+			misaka_regmap_cache_put(map, reg + i, values[i]);
+			misaka_regmap_bit_set(map->dirty, reg + i);
+		}
+		return 0;
+	}
+
+	return misaka_regmap_raw_write(map, reg, values, count);
+}
+
+/**
+ * @brief 设置仅缓存模式：器件断电期间或批量配置时写入只进入缓存，之后由misaka_regmap_cache_sync合并下发
+ * @param map 寄存器映射
+ * @param enable 1: 仅缓存 0: 写穿透
+ */
+void misaka_regmap_cache_only(misaka_regmap_t *map, uint8_t enable)
+{
+	misaka_regmap_assert(map != NULL);
+
+	map->cache_only = (map->cache != NULL && enable) ? 1 : 0;
+}
+
+/**
+ * @brief 查找寄存器的复位值
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @param value 复位值
+ * @return 1:有复位值 0:没有
+ */
+static uint8_t misaka_regmap_default(misaka_regmap_t *map, uint32_t reg, uint32_t *value)
+{
+	uint16_t i;
+
+	for (i = 0; i < map->default_num; i++)
+	{
+		if (map->defaults[i].reg == reg)
+		{
+			*value = map->defaults[i].value;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 器件复位后调用，将所有与复位值不同的缓存寄存器置脏
+ * @param map 寄存器映射
+ */
+void misaka_regmap_cache_mark_dirty(misaka_regmap_t *map)
+{
+	uint32_t reg, value;
+	uint8_t flags;
+
+	misaka_regmap_assert(map != NULL);
+
+	if (map->cache == NULL)
+	{
+		return;
+	}
+
+	for (reg = 0; reg <= map->max_reg; reg++)
+	{
+		flags = misaka_regmap_flags(map, reg);
+		if (!misaka_regmap_bit_get(map->valid, reg) || (flags & (MISAKA_REGMAP_VOLATILE | MISAKA_REGMAP_READ_ONLY)))
+		{
+			continue;
+		}
+		if (misaka_regmap_default(map, reg, &value) && value == misaka_regmap_cache_get(map, reg))
+		{
+			continue;
+		}
+		misaka_regmap_bit_set(map->dirty, reg);
+	}
+}
+
+/**
+ * @brief 寄存器能否作为同步时的填充：缓存有效、可缓存且可写，重写缓存值不改变器件状态
+ * @param map 寄存器映射
+ * @param reg 寄存器
+ * @return 1:可以 0:不可以
+ */
+static uint8_t misaka_regmap_fillable(misaka_regmap_t *map, uint32_t reg)
+{
+	uint8_t flags = misaka_regmap_flags(map, reg);
+
+	return misaka_regmap_bit_get(map->valid, reg) && !(flags & (MISAKA_REGMAP_VOLATILE | MISAKA_REGMAP_READ_ONLY));
+}
+
+/**
+ * @brief 下发所有脏寄存器，连续的脏寄存器合并为一次突发写入
+ * @param map 寄存器映射
+ * @return 0:成功 1:失败，未下发的寄存器保持脏标记
+ */
+uint8_t misaka_regmap_cache_sync(misaka_regmap_t *map)
+{
+	uint32_t values[MISAKA_REGMAP_BURST_SIZE];
+	uint32_t reg, end, gap, num, i, max;
+	uint8_t ret = 0;
+
+	misaka_regmap_assert(map != NULL);
+
+	if (map->cache == NULL)
+	{
+		return 0;
+	}
+
+	max = misaka_regmap_burst_max(map);
+	for (reg = 0; reg <= map->max_reg; reg++)
+	{
+		if (!misaka_regmap_bit_get(map->dirty, reg))
+		{
+			continue;
+		}
+
+		/**
+		 * < 向后扩展：连续的脏寄存器并入本次突发，中间的干净寄存器在重写代价不超过一次新传输的
+		 *   地址开销时作为填充一并写入
+		 */
+		end = reg;
+		for (i = reg + 1; i <= map->max_reg && i - reg < max; i++)
+		{
+			if (misaka_regmap_bit_get(map->dirty, i))
+			{
+				end = i;
+				continue;
+			}
+			if (!misaka_regmap_fillable(map, i))
+			{
+				break;
+			}
+			gap = i - end;
+			if (gap * map->val_bytes > (uint32_t) map->reg_bytes + 2)
+			{
+				break;
+			}
+		}
+
+		num = end - reg + 1;
+		for (i = 0; i < num; i++)
+		{
+			values[i] = misaka_regmap_cache_get(map, reg + i);
+		}
+		if (misaka_regmap_raw_write(map, reg, values, num) != 0)
+		{
+			ret = 1;
+		}
+		reg = end;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief 丢弃所有缓存（不下发），器件被旁路修改后调用
+ * @param map 寄存器映射
+ */
+void misaka_regmap_cache_drop(misaka_regmap_t *map)
+{
+	uint32_t i;
+
+	misaka_regmap_assert(map != NULL);
+
+	if (map->cache == NULL)
+	{
+		return;
+	}
+
+	for (i = 0; i <= map->max_reg / 8; i++)
+	{
+		map->valid[i] = 0;
+		map->dirty[i] = 0;
+	}
+}
+
+/**
+ * @brief i2c后端读：写寄存器地址后重复起始读取
+ * @param map 寄存器映射，bus为misaka_soft_i2c_bus_t
+ * @param reg 寄存器地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_i2c_read(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len)
+{
+	return misaka_soft_i2c_bus_master_send_then_recv((const misaka_soft_i2c_bus_t *) map->bus, map->addr,
+	                                                  reg, map->reg_bytes, buf, len) == 2 ? 0 : 1;
+}
+
+/**
+ * @brief i2c后端写：寄存器地址与数据在同一次传输中写入
+ * @param map 寄存器映射，bus为misaka_soft_i2c_bus_t
+ * @param reg 寄存器地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_i2c_write(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len)
+{
+	return misaka_soft_i2c_bus_master_send_then_send((const misaka_soft_i2c_bus_t *) map->bus, map->addr,
+	                                                  reg, map->reg_bytes, buf, len) == 2 ? 0 : 1;
+}
+
+/**
+ * @brief spi后端读：发送带read_flag的地址后接收
+ * @param map 寄存器映射，bus为misaka_spi_t
+ * @param reg 寄存器地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_spi_read(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len)
+{
+	reg[0] |= map->read_flag;
+
+	return misaka_spi_send_then_recv((misaka_spi_t *) map->bus, reg, map->reg_bytes, buf, len);
+}
+
+/**
+ * @brief spi后端写：发送带write_flag的地址后发送数据
+ * @param map 寄存器映射，bus为misaka_spi_t
+ * @param reg 寄存器地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_regmap_spi_write(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len)
+{
+	reg[0] |= map->write_flag;
+
+	return misaka_spi_send_then_send((misaka_spi_t *) map->bus, reg, map->reg_bytes, buf, len);
+}
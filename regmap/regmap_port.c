@@ -0,0 +1,69 @@
+/**
+ * @file regmap_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/regmap.h"
+
+#define REGMAP_MAX_REG      0x7f                    /**< 以常见的i2c传感器为例：8位地址、8位值、0x80为自增标志 */
+
+static uint8_t s_regmap_cache[REGMAP_MAX_REG + 1];
+static uint8_t s_regmap_valid[REGMAP_MAX_REG / 8 + 1];
+static uint8_t s_regmap_dirty[REGMAP_MAX_REG / 8 + 1];
+
+static const misaka_regmap_range_t s_regmap_ranges[] = {
+	{0x0f, 0x0f, MISAKA_REGMAP_READ_ONLY},          /**< WHO_AM_I */
+	{0x27, 0x2d, MISAKA_REGMAP_VOLATILE},           /**< 状态与数据输出 */
+};
+
+static const misaka_regmap_default_t s_regmap_defaults[] = {
+	{0x20, 0x07},
+	{0x23, 0x00},
+};
+
+static misaka_regmap_t s_misaka_regmap_obj;
+misaka_regmap_t *misaka_regmap_obj = NULL;
+
+static int misaka_regmap_port_init(misaka_soft_i2c_bus_t *i2c)
+{
+	s_misaka_regmap_obj.bus = i2c;
+	s_misaka_regmap_obj.addr = 0x19;
+	s_misaka_regmap_obj.read = misaka_regmap_i2c_read;/**< spi器件使用misaka_regmap_spi_read/misaka_regmap_spi_write，bus为misaka_spi_t */
+	s_misaka_regmap_obj.write = misaka_regmap_i2c_write;
+	s_misaka_regmap_obj.reg_bytes = 1;
+	s_misaka_regmap_obj.val_bytes = 1;
+	s_misaka_regmap_obj.endian = MISAKA_REGMAP_BIG_ENDIAN;
+	s_misaka_regmap_obj.read_flag = 0;/**< spi器件常为0x80 */
+	s_misaka_regmap_obj.write_flag = 0;
+	s_misaka_regmap_obj.burst_flag = 0x80;
+	s_misaka_regmap_obj.burst = 1;
+	s_misaka_regmap_obj.max_reg = REGMAP_MAX_REG;
+	s_misaka_regmap_obj.ranges = s_regmap_ranges;
+	s_misaka_regmap_obj.range_num = sizeof(s_regmap_ranges) / sizeof(s_regmap_ranges[0]);
+	s_misaka_regmap_obj.defaults = s_regmap_defaults;
+	s_misaka_regmap_obj.default_num = sizeof(s_regmap_defaults) / sizeof(s_regmap_defaults[0]);
+	s_misaka_regmap_obj.cache = s_regmap_cache;
+	s_misaka_regmap_obj.valid = s_regmap_valid;
+	s_misaka_regmap_obj.dirty = s_regmap_dirty;
+
+	if (misaka_regmap_init(&s_misaka_regmap_obj) != 0)
+	{
+		return 0;
+	}
+	misaka_regmap_obj = &s_misaka_regmap_obj;
+
+	return 1;
+}
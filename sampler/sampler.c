@@ -0,0 +1,404 @@
+/**
+ * @file sampler.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+/**
+ * 每个通道按计划时刻due推进（due += period），与实际采样时刻无关，因此不会累积漂移。
+ * 一条总线上有通道到期时，把所有处于提前窗口（due - tolerance之后）的通道作为一批背靠背提交，
+ * 低速通道顺带在高速通道的批次中完成，总线唤醒次数减少，空闲段合并为整段。
+ * i2c批次内各通道的消息拼接为一次传输：只获取一次互斥量，通道之间为重复起始而不是停止再起始；
+ * 带延时步骤的事务单独提交。spi各设备的cs与配置不同，批内逐个提交事务。
+ */
+
+#include "misaka_device/sampler.h"
+
+/**
+ * @brief 通道是否到期
+ * @param channel 通道
+ * @param now 当前时刻
+ * @return 1:到期 0:未到期
+ */
+static uint8_t misaka_sampler_due(misaka_sampler_channel_t *channel, uint32_t now)
+{
+	return (int32_t) (now - channel->due) >= 0;
+}
+
+/**
+ * @brief 通道是否处于提前窗口内
+ * @param channel 通道
+ * @param now 当前时刻
+ * @return 1:可以采样 0:太早
+ */
+static uint8_t misaka_sampler_window(misaka_sampler_channel_t *channel, uint32_t now)
+{
+	return (int32_t) (now - channel->due + channel->tolerance_us) >= 0;
+}
+
+/**
+ * @brief 完成一次采样：写入样本、统计偏差并推进计划时刻
+ * @param channel 通道
+ * @param result 传输结果
+ * @param stamp 采样时刻
+ */
+static void misaka_sampler_complete(misaka_sampler_channel_t *channel, uint8_t result, uint32_t stamp)
+{
+	uint32_t head, slot, i, jitter, late;
+	int32_t offset;
+
+	offset = (int32_t) (stamp - channel->due);
+	jitter = offset < 0 ? (uint32_t) -offset : (uint32_t) offset;
+	if (jitter > channel->jitter_max_us)
+	{
+		channel->jitter_max_us = jitter;
+	}
+
+	channel->due += channel->period_us;
+	if ((int32_t) (stamp - channel->due) >= 0)
+	{
+		/** < 落后超过一个周期，跳过错过的采样，重新对齐到计划时间线 */
+		late = (stamp - channel->due) / channel->period_us + 1;
+		channel->misses += late;
+		channel->due += late * channel->period_us;
+	}
+
+	if (result != 0)
+	{
+		channel->failures++;
+		return;
+	}
+
+	head = channel->head;
+	if (head - channel->tail >= channel->ring_size)
+	{
+		channel->overruns++;
+		return;
+	}
+
+	slot = head & (channel->ring_size - 1);
+	for (i = 0; i < channel->sample_size; i++)
+	{
+		channel->ring[slot * channel->sample_size + i] = channel->data[i];
+	}
+	channel->stamps[slot] = stamp;
+
+	misaka_sampler_barrier();
+	channel->head = head + 1;
+	channel->samples++;
+}
+
+/**
+ * @brief i2c通道能否参与合并
+ * @param bus 总线
+ * @param channel 通道
+ * @return 1:可以 0:单独提交
+ */
+static uint8_t misaka_sampler_mergeable(misaka_sampler_bus_t *bus, misaka_sampler_channel_t *channel)
+{
+	misaka_soft_i2c_transaction_t *t = channel->i2c_transaction;
+
+	return bus->merge != NULL && t->delays == 0 && !t->overflow && t->num > 0 && t->num <= bus->merge_size;
+}
+
+/**
+ * @brief 提交已拼接的i2c消息，并按完成的消息数判定[first, last)中各参与合并的通道
+ * @param sampler 调度器
+ * @param bus 总线
+ * @param first 首个通道
+ * @param last 结束通道（不含）
+ * @param num 消息数
+ * @param now 批次开始时刻
+ */
+static void misaka_sampler_i2c_flush(misaka_sampler_t *sampler, misaka_sampler_bus_t *bus, misaka_sampler_channel_t *first,
+                                     misaka_sampler_channel_t *last, uint16_t num, uint32_t now)
+{
+	misaka_sampler_channel_t *index;
+	uint32_t stamp, ret, end = 0;
+
+	if (num == 0)
+	{
+		return;
+	}
+
+	stamp = sampler->get_tick_us();
+	ret = misaka_soft_i2c_bus_transfer(bus->i2c, bus->merge, num);
+	bus->transfers++;
+
+	for (index = first; index != last; index = index->next)
+	{
+		if (!misaka_sampler_window(index, now) || !misaka_sampler_mergeable(bus, index))
+		{
+			continue;
+		}
+		end += index->i2c_transaction->num;
+		misaka_sampler_complete(index, end <= ret ? 0 : 1, stamp);
+	}
+}
+
+/**
+ * @brief 提交一批i2c通道
+ * @param sampler 调度器
+ * @param bus 总线
+ * @param now 批次开始时刻
+ */
+static void misaka_sampler_i2c_batch(misaka_sampler_t *sampler, misaka_sampler_bus_t *bus, uint32_t now)
+{
+	misaka_sampler_channel_t *index, *first = bus->channels;
+	misaka_soft_i2c_transaction_t *t;
+	uint32_t stamp;
+	uint16_t i, num = 0;
+
+	for (index = bus->channels; index != NULL; index = index->next)
+	{
+		if (!misaka_sampler_window(index, now))
+		{
+			continue;
+		}
+
+		t = index->i2c_transaction;
+		if (!misaka_sampler_mergeable(bus, index))
+		{
+			stamp = sampler->get_tick_us();
+			misaka_sampler_complete(index, misaka_soft_i2c_transaction_issue(t, bus->i2c), stamp);
+			bus->transfers++;
+			continue;
+		}
+
+		if (num + t->num > bus->merge_size)
+		{
+			misaka_sampler_i2c_flush(sampler, bus, first, index, num, now);
+			first = index;
+			num = 0;
+		}
+		for (i = 0; i < t->num; i++)
+		{
+			bus->merge[num++] = t->arena[i];
+		}
+	}
+
+	misaka_sampler_i2c_flush(sampler, bus, first, NULL, num, now);
+}
+
+/**
+ * @brief 提交一批spi通道
+ * @param sampler 调度器
+ * @param bus 总线
+ * @param now 批次开始时刻
+ */
+static void misaka_sampler_spi_batch(misaka_sampler_t *sampler, misaka_sampler_bus_t *bus, uint32_t now)
+{
+	misaka_sampler_channel_t *index;
+	uint32_t stamp;
+
+	for (index = bus->channels; index != NULL; index = index->next)
+	{
+		if (!misaka_sampler_window(index, now))
+		{
+			continue;
+		}
+
+		stamp = sampler->get_tick_us();
+		misaka_sampler_complete(index, misaka_spi_transaction_issue(index->spi_transaction, index->spi), stamp);
+		bus->transfers++;
+	}
+}
+
+/**
+ * @brief 初始化调度器
+ * @param sampler 调度器
+ */
+void misaka_sampler_init(misaka_sampler_t *sampler)
+{
+	misaka_sampler_assert(sampler != NULL);
+	misaka_sampler_assert(sampler->get_tick_us != NULL);
+
+	sampler->buses = NULL;
+}
+
+/**
+ * @brief 添加总线
+ * @param sampler 调度器
+ * @param bus 总线
+ */
+void misaka_sampler_add_bus(misaka_sampler_t *sampler, misaka_sampler_bus_t *bus)
+{
+	misaka_sampler_assert(sampler != NULL);
+	misaka_sampler_assert(bus != NULL);
+
+	bus->channels = NULL;
+	bus->batches = 0;
+	bus->transfers = 0;
+	bus->next = sampler->buses;
+	sampler->buses = bus;
+}
+
+/**
+ * @brief 在总线上添加通道，首次采样在下一次misaka_sampler_poll时进行
+ * @param sampler 调度器
+ * @param bus 总线
+ * @param channel 通道
+ * @return 0:成功 1:参数错误
+ */
+uint8_t misaka_sampler_add(misaka_sampler_t *sampler, misaka_sampler_bus_t *bus, misaka_sampler_channel_t *channel)
+{
+	misaka_sampler_channel_t **index;
+
+	misaka_sampler_assert(sampler != NULL);
+	misaka_sampler_assert(bus != NULL);
+	misaka_sampler_assert(channel != NULL);
+
+	if (channel->period_us == 0 || channel->sample_size == 0 || channel->data == NULL
+		|| channel->ring == NULL || channel->stamps == NULL
+		|| channel->ring_size == 0 || (channel->ring_size & (channel->ring_size - 1)) != 0)
+	{
+		return 1;
+	}
+	if (bus->type == MISAKA_SAMPLER_BUS_SPI && (channel->spi == NULL || channel->spi_transaction == NULL))
+	{
+		return 1;
+	}
+	if (bus->type == MISAKA_SAMPLER_BUS_I2C && (bus->i2c == NULL || channel->i2c_transaction == NULL))
+	{
+		return 1;
+	}
+
+	channel->head = 0;
+	channel->tail = 0;
+	channel->samples = 0;
+	channel->overruns = 0;
+	channel->misses = 0;
+	channel->failures = 0;
+	channel->jitter_max_us = 0;
+	channel->due = sampler->get_tick_us();
+	channel->next = NULL;
+
+	/** < 追加到链表末尾，批内按添加顺序提交 */
+	for (index = &bus->channels; *index != NULL; index = &(*index)->next)
+	{
+	}
+	*index = channel;
+
+	return 0;
+}
+
+/**
+ * @brief 调度一次：每条总线上有通道到期时，将到期及处于提前窗口内的通道作为一批连续提交
+ * @param sampler 调度器
+ * @return uint32_t @c 距下一个通道到期的时间（us），可据此休眠或设置定时器
+ */
+uint32_t misaka_sampler_poll(misaka_sampler_t *sampler)
+{
+	misaka_sampler_bus_t *bus;
+	misaka_sampler_channel_t *index;
+	uint32_t now, wait = 0xffffffffUL;
+	int32_t left;
+
+	misaka_sampler_assert(sampler != NULL);
+
+	for (bus = sampler->buses; bus != NULL; bus = bus->next)
+	{
+		now = sampler->get_tick_us();
+		for (index = bus->channels; index != NULL; index = index->next)
+		{
+			if (misaka_sampler_due(index, now))
+			{
+				break;
+			}
+		}
+		if (index == NULL)
+		{
+			continue;
+		}
+
+		bus->batches++;
+		if (bus->type == MISAKA_SAMPLER_BUS_I2C)
+		{
+			misaka_sampler_i2c_batch(sampler, bus, now);
+		}
+		else
+		{
+			misaka_sampler_spi_batch(sampler, bus, now);
+		}
+	}
+
+	now = sampler->get_tick_us();
+	for (bus = sampler->buses; bus != NULL; bus = bus->next)
+	{
+		for (index = bus->channels; index != NULL; index = index->next)
+		{
+			left = (int32_t) (index->due - now);
+			if (left <= 0)
+			{
+				return 0;
+			}
+			if ((uint32_t) left < wait)
+			{
+				wait = (uint32_t) left;
+			}
+		}
+	}
+
+	return wait;
+}
+
+/**
+ * @brief 可读取的样本数
+ * @param channel 通道
+ * @return uint32_t @c 样本数
+ */
+uint32_t misaka_sampler_available(misaka_sampler_channel_t *channel)
+{
+	misaka_sampler_assert(channel != NULL);
+
+	return channel->head - channel->tail;
+}
+
+/**
+ * @brief 读取一个样本，可与misaka_sampler_poll在不同任务/中断中无锁并发调用（单读单写）
+ * @param channel 通道
+ * @param stamp 样本时刻（可为NULL）
+ * @param sample 样本，sample_size字节
+ * @return 0:成功 1:没有样本
+ */
+uint8_t misaka_sampler_read(misaka_sampler_channel_t *channel, uint32_t *stamp, uint8_t *sample)
+{
+	uint32_t tail, slot, i;
+
+	misaka_sampler_assert(channel != NULL);
+	misaka_sampler_assert(sample != NULL);
+
+	tail = channel->tail;
+	if (channel->head == tail)
+	{
+		return 1;
+	}
+	misaka_sampler_barrier();
+
+	slot = tail & (channel->ring_size - 1);
+	for (i = 0; i < channel->sample_size; i++)
+	{
+		sample[i] = channel->ring[slot * channel->sample_size + i];
+	}
+	if (stamp != NULL)
+	{
+		*stamp = channel->stamps[slot];
+	}
+
+	misaka_sampler_barrier();
+	channel->tail = tail + 1;
+
+	return 0;
+}
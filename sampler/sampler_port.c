@@ -0,0 +1,112 @@
+/**
+ * @file sampler_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/sampler.h"
+
+#define SAMPLER_RING_SIZE       16
+#define SAMPLER_MERGE_NUM       8
+
+static misaka_sampler_t s_misaka_sampler_obj;
+misaka_sampler_t *misaka_sampler_obj = NULL;
+
+static misaka_soft_i2c_message s_i2c_merge[SAMPLER_MERGE_NUM];
+static misaka_sampler_bus_t s_i2c_bus = {
+	.type = MISAKA_SAMPLER_BUS_I2C,
+	.merge = s_i2c_merge,
+	.merge_size = SAMPLER_MERGE_NUM,
+};
+
+/** < 加速度计：1kHz，6字节 */
+static misaka_soft_i2c_message s_accel_arena[2];
+static misaka_soft_i2c_transaction_t s_accel_transaction = {
+	.arena = s_accel_arena,
+	.size = 2,
+};
+static uint8_t s_accel_reg = 0x28;
+static uint8_t s_accel_data[6];
+static uint8_t s_accel_ring[SAMPLER_RING_SIZE * 6];
+static uint32_t s_accel_stamps[SAMPLER_RING_SIZE];
+static misaka_sampler_channel_t s_accel_channel = {
+	.i2c_transaction = &s_accel_transaction,
+	.data = s_accel_data,
+	.sample_size = 6,
+	.period_us = 1000,
+	.tolerance_us = 50,
+	.ring = s_accel_ring,
+	.stamps = s_accel_stamps,
+	.ring_size = SAMPLER_RING_SIZE,
+};
+
+/** < 温度计：10Hz，2字节；容差覆盖一个加速度计周期，总是跟随加速度计批次一起读取 */
+static misaka_soft_i2c_message s_temp_arena[2];
+static misaka_soft_i2c_transaction_t s_temp_transaction = {
+	.arena = s_temp_arena,
+	.size = 2,
+};
+static uint8_t s_temp_reg = 0x00;
+static uint8_t s_temp_data[2];
+static uint8_t s_temp_ring[SAMPLER_RING_SIZE * 2];
+static uint32_t s_temp_stamps[SAMPLER_RING_SIZE];
+static misaka_sampler_channel_t s_temp_channel = {
+	.i2c_transaction = &s_temp_transaction,
+	.data = s_temp_data,
+	.sample_size = 2,
+	.period_us = 100000,
+	.tolerance_us = 1000,
+	.ring = s_temp_ring,
+	.stamps = s_temp_stamps,
+	.ring_size = SAMPLER_RING_SIZE,
+};
+
+/**
+ * @brief 获取us时间戳
+ * @return uint32_t @c 时间戳
+ */
+static uint32_t get_tick_us(void)
+{
+	return 0;
+}
+
+/**
+ * 主循环中调用misaka_sampler_poll，按返回值休眠；读取任务通过misaka_sampler_read取出样本
+ */
+static int misaka_sampler_port_init(const misaka_soft_i2c_bus_t *i2c)
+{
+	s_misaka_sampler_obj.get_tick_us = get_tick_us;
+	misaka_sampler_init(&s_misaka_sampler_obj);
+
+	s_i2c_bus.i2c = i2c;
+	misaka_sampler_add_bus(&s_misaka_sampler_obj, &s_i2c_bus);
+
+	misaka_soft_i2c_transaction_init(&s_accel_transaction);
+	misaka_soft_i2c_transaction_write_read(&s_accel_transaction, 0x19, &s_accel_reg, 1, s_accel_data, sizeof(s_accel_data));
+	misaka_soft_i2c_transaction_init(&s_temp_transaction);
+	misaka_soft_i2c_transaction_write_read(&s_temp_transaction, 0x48, &s_temp_reg, 1, s_temp_data, sizeof(s_temp_data));
+
+	if (misaka_sampler_add(&s_misaka_sampler_obj, &s_i2c_bus, &s_accel_channel) != 0)
+	{
+		return 0;
+	}
+	if (misaka_sampler_add(&s_misaka_sampler_obj, &s_i2c_bus, &s_temp_channel) != 0)
+	{
+		return 0;
+	}
+	misaka_sampler_obj = &s_misaka_sampler_obj;
+
+	return 1;
+}
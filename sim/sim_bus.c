@@ -0,0 +1,437 @@
+/**
+ * @file sim_bus.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 主机上的仿真gpio与spi总线，供基准与测试使用。
+ */
+
+#include <string.h>
+#include "sim_bus.h"
+
+static misaka_sim_gpio_t *s_misaka_sim_gpio;
+static misaka_sim_spi_t *s_misaka_sim_spi;
+static misaka_spi_legacy_bus_t s_misaka_sim_legacy_spi_bus;
+static misaka_spi_legacy_cs_t s_misaka_sim_legacy_spi_cs;
+
+/**
+ * @brief 空转，模拟回调开销
+ * @param n 次数
+ */
+static void misaka_sim_spin(uint32_t n)
+{
+	volatile uint32_t i;
+
+	for (i = 0; i < n; i++)
+	{
+	}
+}
+
+/**
+ * @brief 仿真环境下读写错误不做处理
+ * @param ops i2c设备
+ */
+void misaka_soft_i2c_error_callback(const misaka_soft_i2c_t *ops)
+{
+	(void) ops;
+}
+
+/**
+ * 从机模型状态
+ */
+#define MISAKA_SIM_SLAVE_IDLE       0                       /**< 等待起始信号 */
+#define MISAKA_SIM_SLAVE_ADDR       1                       /**< 接收地址 */
+#define MISAKA_SIM_SLAVE_WRITE      2                       /**< 接收数据 */
+#define MISAKA_SIM_SLAVE_READ       3                       /**< 发送数据 */
+
+/**
+ * @brief 从机模型：scl为高时sda变化为起始/停止信号
+ * @param gpio 仿真gpio
+ * @param state 新的sda电平
+ */
+static void misaka_sim_slave_sda(misaka_sim_gpio_t *gpio, uint8_t state)
+{
+	if (!gpio->scl || state == gpio->sda)
+	{
+		return;
+	}
+
+	gpio->slave_state = state ? MISAKA_SIM_SLAVE_IDLE : MISAKA_SIM_SLAVE_ADDR;
+	gpio->slave_bit = 0;
+	gpio->slave_shift = 0;
+	gpio->slave_sda = 1;
+}
+
+/**
+ * @brief 从机模型：上升沿采样主机驱动的位，下降沿按已完成的位数准备从机驱动的下一位
+ * @param gpio 仿真gpio
+ * @param state 新的scl电平
+ */
+static void misaka_sim_slave_scl(misaka_sim_gpio_t *gpio, uint8_t state)
+{
+	uint8_t addr, ack;
+
+	if (state == gpio->scl || gpio->slave_state == MISAKA_SIM_SLAVE_IDLE)
+	{
+		return;
+	}
+
+	if (state)
+	{
+		if (gpio->slave_bit < 8 && gpio->slave_state != MISAKA_SIM_SLAVE_READ)
+		{
+			gpio->slave_shift = (uint8_t) (gpio->slave_shift << 1 | gpio->sda);
+		}
+		else if (gpio->slave_bit == 8 && gpio->slave_state == MISAKA_SIM_SLAVE_READ && gpio->sda)
+		{
+			/** < 主机不应答，结束发送 */
+			gpio->slave_state = MISAKA_SIM_SLAVE_IDLE;
+		}
+		gpio->slave_bit++;
+		return;
+	}
+
+	gpio->slave_sda = 1;
+	addr = gpio->slave_shift >> 1;
+	ack = (gpio->present[addr >> 3] >> (addr & 7)) & 1;
+	if (gpio->slave_bit == 8)
+	{
+		if (gpio->slave_state == MISAKA_SIM_SLAVE_ADDR && ack)
+		{
+			gpio->slave_addr = addr;
+			gpio->slave_sda = 0;
+		}
+		else if (gpio->slave_state == MISAKA_SIM_SLAVE_WRITE)
+		{
+			gpio->slave_writes++;
+			gpio->slave_sda = 0;
+		}
+		return;
+	}
+	if (gpio->slave_bit == 9)
+	{
+		gpio->slave_bit = 0;
+		if (gpio->slave_state == MISAKA_SIM_SLAVE_ADDR)
+		{
+			gpio->slave_state = !ack ? MISAKA_SIM_SLAVE_IDLE : (gpio->slave_shift & 1) ? MISAKA_SIM_SLAVE_READ : MISAKA_SIM_SLAVE_WRITE;
+		}
+		gpio->slave_shift = 0;
+		if (gpio->slave_state == MISAKA_SIM_SLAVE_READ)
+		{
+			gpio->slave_shift = (uint8_t) (gpio->slave_addr + gpio->slave_reads++);
+		}
+	}
+	if (gpio->slave_state == MISAKA_SIM_SLAVE_READ && gpio->slave_bit < 8)
+	{
+		gpio->slave_sda = (gpio->slave_shift >> (7 - gpio->slave_bit)) & 1;
+	}
+}
+
+static void misaka_sim_gpio_set_sda(void *ctx, uint8_t state)
+{
+	misaka_sim_gpio_t *gpio = (misaka_sim_gpio_t *) ctx;
+
+	gpio->callbacks++;
+	if (gpio->present != NULL)
+	{
+		misaka_sim_slave_sda(gpio, state);
+	}
+	gpio->sda = state;
+	misaka_sim_spin(gpio->cost);
+}
+
+static void misaka_sim_gpio_set_scl(void *ctx, uint8_t state)
+{
+	misaka_sim_gpio_t *gpio = (misaka_sim_gpio_t *) ctx;
+
+	gpio->callbacks++;
+	if (gpio->present != NULL)
+	{
+		misaka_sim_slave_scl(gpio, state);
+	}
+	gpio->scl = state;
+	misaka_sim_spin(gpio->cost);
+}
+
+static uint8_t misaka_sim_gpio_get_sda(void *ctx)
+{
+	misaka_sim_gpio_t *gpio = (misaka_sim_gpio_t *) ctx;
+
+	gpio->callbacks++;
+	misaka_sim_spin(gpio->cost);
+
+	/** < 开漏：主机与从机任一方拉低即为低 */
+	return gpio->present != NULL ? (gpio->sda & gpio->slave_sda) : gpio->sda_in;
+}
+
+static void misaka_sim_gpio_delay_us(void *ctx, uint16_t us)
+{
+	misaka_sim_gpio_t *gpio = (misaka_sim_gpio_t *) ctx;
+
+	(void) us;
+
+	gpio->callbacks++;
+	misaka_sim_spin(gpio->cost);
+}
+
+static void misaka_sim_gpio_touch(void *ctx)
+{
+	misaka_sim_gpio_t *gpio = (misaka_sim_gpio_t *) ctx;
+
+	gpio->callbacks++;
+	misaka_sim_spin(gpio->cost);
+}
+
+const misaka_soft_i2c_ops_t misaka_sim_i2c_ops = {
+	misaka_sim_gpio_set_sda,
+	misaka_sim_gpio_set_scl,
+	misaka_sim_gpio_get_sda,
+	misaka_sim_gpio_delay_us,
+	misaka_sim_gpio_touch,
+	misaka_sim_gpio_touch,
+	misaka_sim_gpio_touch,
+	misaka_sim_gpio_touch,
+	NULL,
+	NULL,
+};
+
+static void misaka_sim_legacy_set_sda(uint8_t state)
+{
+	misaka_sim_gpio_set_sda(s_misaka_sim_gpio, state);
+}
+
+static void misaka_sim_legacy_set_scl(uint8_t state)
+{
+	misaka_sim_gpio_set_scl(s_misaka_sim_gpio, state);
+}
+
+static uint8_t misaka_sim_legacy_get_sda(void)
+{
+	return misaka_sim_gpio_get_sda(s_misaka_sim_gpio);
+}
+
+static void misaka_sim_legacy_delay_us(uint16_t us)
+{
+	misaka_sim_gpio_delay_us(s_misaka_sim_gpio, us);
+}
+
+static void misaka_sim_legacy_touch(void)
+{
+	misaka_sim_gpio_touch(s_misaka_sim_gpio);
+}
+
+/**
+ * @brief 以不带上下文的函数初始化misaka_soft_i2c_t，同一时刻只能有一个
+ * @param i2c i2c设备
+ * @param gpio 仿真gpio
+ * @param us us延时单位
+ */
+void misaka_sim_i2c_legacy_init(misaka_soft_i2c_t *i2c, misaka_sim_gpio_t *gpio, uint16_t us)
+{
+	s_misaka_sim_gpio = gpio;
+	gpio->scl = 1;
+	gpio->sda = 1;
+	gpio->slave_sda = 1;
+
+	memset(i2c, 0, sizeof(*i2c));
+	i2c->set_sda = misaka_sim_legacy_set_sda;
+	i2c->set_scl = misaka_sim_legacy_set_scl;
+	i2c->get_sda = misaka_sim_legacy_get_sda;
+	i2c->delay_us = misaka_sim_legacy_delay_us;
+	i2c->set_sda_out = misaka_sim_legacy_touch;
+	i2c->set_sda_in = misaka_sim_legacy_touch;
+	i2c->mutex_take = misaka_sim_legacy_touch;
+	i2c->mutex_release = misaka_sim_legacy_touch;
+	i2c->us = us;
+
+	misaka_soft_i2c_init(i2c);
+}
+
+/**
+ * @brief 以共享操作表初始化i2c总线
+ * @param bus i2c总线
+ * @param gpio 仿真gpio
+ * @param us us延时单位
+ */
+void misaka_sim_i2c_bus_init(misaka_soft_i2c_bus_t *bus, misaka_sim_gpio_t *gpio, uint16_t us)
+{
+	gpio->scl = 1;
+	gpio->sda = 1;
+	gpio->slave_sda = 1;
+
+	memset(bus, 0, sizeof(*bus));
+	bus->ops = &misaka_sim_i2c_ops;
+	bus->ctx = gpio;
+	bus->us = us;
+
+	misaka_soft_i2c_bus_init(bus);
+}
+
+/**
+ * @brief 回环收发
+ * @param sim 仿真spi总线
+ * @param txbuf 待发送数据，NULL时接收0xA5
+ * @param rxbuf 待接收数据，可为NULL
+ * @param length 数据长度
+ */
+static void misaka_sim_spi_loop(misaka_sim_spi_t *sim, const uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	sim->callbacks++;
+	sim->bytes += length;
+	misaka_sim_spin(sim->cost + sim->byte_cost * length);
+
+	if (rxbuf != NULL)
+	{
+		if (txbuf != NULL)
+		{
+			memcpy(rxbuf, txbuf, length);
+		}
+		else
+		{
+			memset(rxbuf, 0xA5, length);
+		}
+	}
+}
+
+static uint8_t misaka_sim_spi_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	misaka_sim_spi_loop((misaka_sim_spi_t *) ctx, txbuf, rxbuf, length);
+
+	return 0;
+}
+
+static uint8_t misaka_sim_spi_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	misaka_sim_spi_loop((misaka_sim_spi_t *) ctx, txbuf, NULL, length);
+
+	return 0;
+}
+
+static uint8_t misaka_sim_spi_recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	misaka_sim_spi_loop((misaka_sim_spi_t *) ctx, NULL, rxbuf, length);
+
+	return 0;
+}
+
+static void misaka_sim_spi_touch(void *ctx)
+{
+	misaka_sim_spi_t *sim = (misaka_sim_spi_t *) ctx;
+
+	sim->callbacks++;
+	misaka_sim_spin(sim->cost);
+}
+
+static void misaka_sim_spi_set_cs(void *ctx, uint8_t state)
+{
+	misaka_sim_spi_t *sim = (misaka_sim_spi_t *) ctx;
+
+	sim->callbacks++;
+	if (sim->cs != state)
+	{
+		sim->cs = state;
+		sim->cs_toggles++;
+	}
+	misaka_sim_spin(sim->cost);
+}
+
+const misaka_spi_bus_ops_t misaka_sim_spi_ops = {
+	misaka_sim_spi_send_recv,
+	misaka_sim_spi_send,
+	misaka_sim_spi_recv,
+	misaka_sim_spi_touch,
+	misaka_sim_spi_touch,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+
+const misaka_spi_cs_ops_t misaka_sim_spi_cs_ops = {
+	misaka_sim_spi_set_cs,
+	NULL,
+};
+
+static uint8_t misaka_sim_legacy_spi_send_recv(uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	return misaka_sim_spi_send_recv(s_misaka_sim_spi, txbuf, rxbuf, length);
+}
+
+static uint8_t misaka_sim_legacy_spi_send(uint8_t *txbuf, uint32_t length)
+{
+	return misaka_sim_spi_send(s_misaka_sim_spi, txbuf, length);
+}
+
+static uint8_t misaka_sim_legacy_spi_recv(uint8_t *rxbuf, uint32_t length)
+{
+	return misaka_sim_spi_recv(s_misaka_sim_spi, rxbuf, length);
+}
+
+static void misaka_sim_legacy_spi_touch(void)
+{
+	misaka_sim_spi_touch(s_misaka_sim_spi);
+}
+
+static void misaka_sim_legacy_spi_set_cs(uint8_t state)
+{
+	misaka_sim_spi_set_cs(s_misaka_sim_spi, state);
+}
+
+/**
+ * @brief 以不带上下文的函数初始化spi总线与设备，同一时刻只能有一个
+ * @param bus spi总线
+ * @param device spi设备
+ * @param sim 仿真spi总线
+ */
+void misaka_sim_spi_legacy_init(misaka_spi_bus_t *bus, misaka_spi_t *device, misaka_sim_spi_t *sim)
+{
+	s_misaka_sim_spi = sim;
+	sim->cs = 1;
+
+	s_misaka_sim_legacy_spi_bus.send_recv = misaka_sim_legacy_spi_send_recv;
+	s_misaka_sim_legacy_spi_bus.send = misaka_sim_legacy_spi_send;
+	s_misaka_sim_legacy_spi_bus.recv = misaka_sim_legacy_spi_recv;
+	s_misaka_sim_legacy_spi_bus.mutex_take = misaka_sim_legacy_spi_touch;
+	s_misaka_sim_legacy_spi_bus.mutex_release = misaka_sim_legacy_spi_touch;
+	s_misaka_sim_legacy_spi_cs.set_cs = misaka_sim_legacy_spi_set_cs;
+
+	misaka_spi_legacy_bus_init(bus, &s_misaka_sim_legacy_spi_bus);
+	misaka_spi_legacy_device_init(device, bus, &s_misaka_sim_legacy_spi_cs);
+}
+
+/**
+ * @brief 以共享操作表初始化spi总线与设备
+ * @param bus spi总线
+ * @param device spi设备
+ * @param sim 仿真spi总线
+ */
+void misaka_sim_spi_bus_init(misaka_spi_bus_t *bus, misaka_spi_t *device, misaka_sim_spi_t *sim)
+{
+	sim->cs = 1;
+
+	memset(bus, 0, sizeof(*bus));
+	bus->ops = &misaka_sim_spi_ops;
+	bus->ctx = sim;
+
+	memset(device, 0, sizeof(*device));
+	device->cs_ops = &misaka_sim_spi_cs_ops;
+	device->cs_ctx = sim;
+	device->bus = bus;
+	device->config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	device->config.data_width = 8;
+}
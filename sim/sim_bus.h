@@ -0,0 +1,111 @@
+/**
+ * @file sim_bus.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_SIM_BUS_H__
+#define __MISAKA_SIM_BUS_H__
+
+#include "misaka_device/soft_i2c.h"
+#include "misaka_device/spi.h"
+
+/**
+ * 仿真gpio：记录引脚电平与回调次数，每次回调空转cost次以模拟不同开销的引脚操作；
+ * 读取sda时返回sda_in，为0时从机对每个字节应答、读出的数据为0。
+ * 提供present时由从机模型按引脚时序解码：地址在位图中的从机应答地址与写入的字节，
+ * 读出的字节依次为7位地址加上已读出的字节数，其他地址不应答
+ */
+struct misaka_sim_gpio_struct
+{
+	uint32_t cost;/**< 每次回调的空转次数 */
+	uint8_t sda_in;/**< get_sda的返回值，present为NULL时使用 */
+	const uint8_t *present;/**< 应答的7位地址位图（可选，16字节，addr对应第addr / 8字节的第addr % 8位） */
+
+	uint8_t scl;/**< scl电平 */
+	uint8_t sda;/**< sda电平 */
+	uint32_t callbacks;/**< 回调次数（引脚、延时与互斥量） */
+
+	uint8_t slave_state;/**< 从机模型状态，内部使用 */
+	uint8_t slave_bit;/**< 当前字节的位序号，内部使用 */
+	uint8_t slave_shift;/**< 正在接收或发送的字节，内部使用 */
+	uint8_t slave_sda;/**< 从机驱动的sda电平，内部使用 */
+	uint8_t slave_addr;/**< 已应答的7位地址，内部使用 */
+	uint32_t slave_reads;/**< 从机模型读出的字节数 */
+	uint32_t slave_writes;/**< 从机模型收到的数据字节数（不含地址） */
+};
+
+typedef struct misaka_sim_gpio_struct misaka_sim_gpio_t;
+
+/**
+ * 仿真spi总线：回环，接收数据等于发送数据，只接收时为0xA5；每次回调空转cost次，每字节再空转byte_cost次
+ */
+struct misaka_sim_spi_struct
+{
+	uint32_t cost;/**< 每次回调的空转次数 */
+	uint32_t byte_cost;/**< 每字节的空转次数 */
+
+	uint8_t cs;/**< cs电平 */
+	uint32_t callbacks;/**< 回调次数（收发、互斥量与cs） */
+	uint32_t cs_toggles;/**< cs变化次数 */
+	uint32_t bytes;/**< 收发的字节数 */
+};
+
+typedef struct misaka_sim_spi_struct misaka_sim_spi_t;
+
+/**
+ * 仿真gpio的共享操作表，ctx为misaka_sim_gpio_t
+ */
+extern const misaka_soft_i2c_ops_t misaka_sim_i2c_ops;
+
+/**
+ * 仿真spi总线与cs的共享操作表，ctx为misaka_sim_spi_t
+ */
+extern const misaka_spi_bus_ops_t misaka_sim_spi_ops;
+extern const misaka_spi_cs_ops_t misaka_sim_spi_cs_ops;
+
+/**
+ * @brief 以不带上下文的函数初始化misaka_soft_i2c_t，同一时刻只能有一个
+ * @param i2c i2c设备
+ * @param gpio 仿真gpio
+ * @param us us延时单位
+ */
+void misaka_sim_i2c_legacy_init(misaka_soft_i2c_t *i2c, misaka_sim_gpio_t *gpio, uint16_t us);
+
+/**
+ * @brief 以共享操作表初始化i2c总线
+ * @param bus i2c总线
+ * @param gpio 仿真gpio
+ * @param us us延时单位
+ */
+void misaka_sim_i2c_bus_init(misaka_soft_i2c_bus_t *bus, misaka_sim_gpio_t *gpio, uint16_t us);
+
+/**
+ * @brief 以不带上下文的函数初始化spi总线与设备，同一时刻只能有一个
+ * @param bus spi总线
+ * @param device spi设备
+ * @param sim 仿真spi总线
+ */
+void misaka_sim_spi_legacy_init(misaka_spi_bus_t *bus, misaka_spi_t *device, misaka_sim_spi_t *sim);
+
+/**
+ * @brief 以共享操作表初始化spi总线与设备
+ * @param bus spi总线
+ * @param device spi设备
+ * @param sim 仿真spi总线
+ */
+void misaka_sim_spi_bus_init(misaka_spi_bus_t *bus, misaka_spi_t *device, misaka_sim_spi_t *sim);
+
+#endif //__MISAKA_SIM_BUS_H__
@@ -0,0 +1,141 @@
+/**
+ * @file sim_soft_spi.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 仿真spi从机（虚拟gpio）：按模式在采样边沿移入mosi、在另一边沿移出miso，
+ * 引脚函数为内联函数，供soft_spi.h模板的引脚宏使用，使基准测得的是模板本身每一位的开销。
+ */
+
+#ifndef __MISAKA_SIM_SOFT_SPI_H__
+#define __MISAKA_SIM_SOFT_SPI_H__
+
+#include <string.h>
+#include "misaka_device/spi.h"
+
+struct misaka_sim_spi_slave_struct
+{
+	uint8_t mode;/**< 模式，MISAKA_SPI_MODE_x与MISAKA_SPI_MSB/MISAKA_SPI_LSB组合 */
+	const uint8_t *txbuf;/**< 从机发送的数据 */
+	uint8_t *rxbuf;/**< 从机接收的数据 */
+	uint32_t length;/**< 缓冲区长度，超出部分发送1、不再接收 */
+
+	uint8_t sck;/**< sck电平 */
+	uint8_t mosi;/**< mosi电平 */
+	uint32_t sampled;/**< 已在采样边沿移入的位数 */
+	uint32_t shifted;/**< 已经过的移出边沿数 */
+	uint32_t pin_calls;/**< 引脚操作次数 */
+	uint32_t miso_calls;/**< 读取miso的次数 */
+	uint32_t mosi_calls;/**< 设置mosi的次数 */
+};
+
+typedef struct misaka_sim_spi_slave_struct misaka_sim_spi_slave_t;
+
+/**
+ * @brief 开始一次传输：清零接收缓冲区与计数，sck回到空闲电平
+ * @param slave 仿真从机
+ * @param mode 模式
+ * @param txbuf 从机发送的数据
+ * @param rxbuf 从机接收的数据
+ * @param length 缓冲区长度
+ */
+static inline void misaka_sim_spi_slave_reset(misaka_sim_spi_slave_t *slave, uint8_t mode, const uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	slave->mode = mode;
+	slave->txbuf = txbuf;
+	slave->rxbuf = rxbuf;
+	slave->length = length;
+	slave->sck = (mode & MISAKA_SPI_CPOL) ? 1 : 0;
+	slave->sampled = 0;
+	slave->shifted = 0;
+	slave->pin_calls = 0;
+	slave->miso_calls = 0;
+	slave->mosi_calls = 0;
+	memset(rxbuf, 0, length);
+}
+
+/**
+ * @brief 设置sck，电平变化时按模式判断是采样边沿还是移出边沿
+ * @param slave 仿真从机
+ * @param level 电平
+ */
+static inline void misaka_sim_spi_slave_set_sck(misaka_sim_spi_slave_t *slave, uint8_t level)
+{
+	uint8_t cpol = (slave->mode & MISAKA_SPI_CPOL) ? 1 : 0;
+	uint8_t cpha = (slave->mode & MISAKA_SPI_CPHA) ? 1 : 0;
+	uint32_t bit;
+
+	slave->pin_calls++;
+	if (level == slave->sck)
+	{
+		return;
+	}
+	slave->sck = level;
+
+	/** < 离开空闲电平为前沿；CPHA = 0时前沿采样，CPHA = 1时后沿采样 */
+	if ((level != cpol) != cpha)
+	{
+		bit = slave->sampled++;
+		if (bit / 8 < slave->length && slave->mosi)
+		{
+			slave->rxbuf[bit / 8] |= (uint8_t) ((slave->mode & MISAKA_SPI_MSB) ? 0x80 >> (bit % 8) : 1 << (bit % 8));
+		}
+	}
+	else
+	{
+		slave->shifted++;
+	}
+}
+
+/**
+ * @brief 设置mosi
+ * @param slave 仿真从机
+ * @param level 电平
+ */
+static inline void misaka_sim_spi_slave_set_mosi(misaka_sim_spi_slave_t *slave, uint8_t level)
+{
+	slave->pin_calls++;
+	slave->mosi_calls++;
+	slave->mosi = level;
+}
+
+/**
+ * @brief 读取miso：CPHA = 0时第一位在第一个边沿之前已就绪，CPHA = 1时在第一个移出边沿给出
+ * @param slave 仿真从机
+ * @return uint8_t @c 电平
+ */
+static inline uint8_t misaka_sim_spi_slave_get_miso(misaka_sim_spi_slave_t *slave)
+{
+	uint32_t bit = slave->shifted;
+
+	slave->pin_calls++;
+	slave->miso_calls++;
+	if (slave->mode & MISAKA_SPI_CPHA)
+	{
+		if (bit == 0)
+		{
+			return 1;
+		}
+		bit--;
+	}
+	if (bit / 8 >= slave->length)
+	{
+		return 1;
+	}
+
+	return (slave->mode & MISAKA_SPI_MSB) ? (slave->txbuf[bit / 8] >> (7 - bit % 8)) & 1 : (slave->txbuf[bit / 8] >> (bit % 8)) & 1;
+}
+
+#endif //__MISAKA_SIM_SOFT_SPI_H__
@@ -19,137 +19,273 @@
 
 #define LOG_NAME "misaka_soft_i2c"
 
+/**
+ * 时序引擎的总线视图：一律经ops调用，misaka_soft_i2c_t经下方的适配操作表转发；
+ * 提供传输后端时不进入时序引擎，互斥量与统计仍在此统一处理
+ */
+struct misaka_soft_i2c_bit_struct
+{
+	const misaka_soft_i2c_ops_t *ops;                        /**< 操作表 */
+
+	void *ctx;                                                /**< 上下文 */
+
+	uint16_t us;                                            /**< us延时单位 */
+
+	uint8_t backend;                                        /**< 1:使用传输后端 0:时序引擎 */
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	misaka_soft_i2c_statistics_t *stat;                        /**< 统计，可为NULL */
+#endif
+};
+
+typedef struct misaka_soft_i2c_bit_struct misaka_soft_i2c_bit_t;
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+#define MISAKA_SOFT_I2C_COUNT(i2c, field, n)  do { if ((i2c)->stat != NULL) { (i2c)->stat->field += (n); } } while (0)
+#else
+#define MISAKA_SOFT_I2C_COUNT(i2c, field, n)  ((void) 0)
+#endif
+
+#define misaka_soft_i2c_call(i2c, hook, ...)  ((i2c)->ops->hook((i2c)->ctx, __VA_ARGS__))
+#define misaka_soft_i2c_call0(i2c, hook)      ((i2c)->ops->hook((i2c)->ctx))
+
+/**
+ * misaka_soft_i2c_t的适配操作表：ctx为misaka_soft_i2c_t，各函数转发到对象上不带上下文的函数
+ */
+static void misaka_soft_i2c_legacy_set_sda(void *ctx, uint8_t state)
+{
+	((const misaka_soft_i2c_t *) ctx)->set_sda(state);
+}
+
+static void misaka_soft_i2c_legacy_set_scl(void *ctx, uint8_t state)
+{
+	((const misaka_soft_i2c_t *) ctx)->set_scl(state);
+}
+
+static uint8_t misaka_soft_i2c_legacy_get_sda(void *ctx)
+{
+	return ((const misaka_soft_i2c_t *) ctx)->get_sda();
+}
+
+static void misaka_soft_i2c_legacy_delay_us(void *ctx, uint16_t us)
+{
+	((const misaka_soft_i2c_t *) ctx)->delay_us(us);
+}
+
+static void misaka_soft_i2c_legacy_set_sda_out(void *ctx)
+{
+	((const misaka_soft_i2c_t *) ctx)->set_sda_out();
+}
+
+static void misaka_soft_i2c_legacy_set_sda_in(void *ctx)
+{
+	((const misaka_soft_i2c_t *) ctx)->set_sda_in();
+}
+
+static void misaka_soft_i2c_legacy_mutex_take(void *ctx)
+{
+	((const misaka_soft_i2c_t *) ctx)->mutex_take();
+}
+
+static void misaka_soft_i2c_legacy_mutex_release(void *ctx)
+{
+	((const misaka_soft_i2c_t *) ctx)->mutex_release();
+}
+
+static uint32_t misaka_soft_i2c_legacy_xfer(void *ctx, misaka_soft_i2c_message *msgs, uint32_t num)
+{
+	return ((const misaka_soft_i2c_t *) ctx)->xfer(msgs, num);
+}
+
+static const misaka_soft_i2c_ops_t s_misaka_soft_i2c_legacy_ops = {
+	misaka_soft_i2c_legacy_set_sda,
+	misaka_soft_i2c_legacy_set_scl,
+	misaka_soft_i2c_legacy_get_sda,
+	misaka_soft_i2c_legacy_delay_us,
+	misaka_soft_i2c_legacy_set_sda_out,
+	misaka_soft_i2c_legacy_set_sda_in,
+	misaka_soft_i2c_legacy_mutex_take,
+	misaka_soft_i2c_legacy_mutex_release,
+	NULL,
+	misaka_soft_i2c_legacy_xfer,
+};
+
+/**
+ * 引脚操作经以下函数调用，便于统计；未开启统计时与直接调用相同
+ */
+static void misaka_soft_i2c_set_sda(const misaka_soft_i2c_bit_t *i2c, uint8_t state)
+{
+	MISAKA_SOFT_I2C_COUNT(i2c, pin_calls, 1);
+	misaka_soft_i2c_call(i2c, set_sda, state);
+}
+
+static void misaka_soft_i2c_set_scl(const misaka_soft_i2c_bit_t *i2c, uint8_t state)
+{
+	MISAKA_SOFT_I2C_COUNT(i2c, pin_calls, 1);
+	misaka_soft_i2c_call(i2c, set_scl, state);
+}
+
+static uint8_t misaka_soft_i2c_get_sda(const misaka_soft_i2c_bit_t *i2c)
+{
+	MISAKA_SOFT_I2C_COUNT(i2c, pin_calls, 1);
+	return misaka_soft_i2c_call0(i2c, get_sda);
+}
+
+static void misaka_soft_i2c_set_sda_out(const misaka_soft_i2c_bit_t *i2c)
+{
+	MISAKA_SOFT_I2C_COUNT(i2c, pin_calls, 1);
+	misaka_soft_i2c_call0(i2c, set_sda_out);
+}
+
+static void misaka_soft_i2c_set_sda_in(const misaka_soft_i2c_bit_t *i2c)
+{
+	MISAKA_SOFT_I2C_COUNT(i2c, pin_calls, 1);
+	misaka_soft_i2c_call0(i2c, set_sda_in);
+}
+
+static void misaka_soft_i2c_delay_us(const misaka_soft_i2c_bit_t *i2c, uint16_t us)
+{
+	MISAKA_SOFT_I2C_COUNT(i2c, delay_calls, 1);
+	MISAKA_SOFT_I2C_COUNT(i2c, delay_us, us);
+	misaka_soft_i2c_call(i2c, delay_us, us);
+}
+
 /**
  * @brief 产生起始信号
- * @param ops i2c设备
+ * @param i2c i2c总线
  */
-static void misaka_soft_i2c_start(const misaka_soft_i2c_t *ops)
+static void misaka_soft_i2c_start(const misaka_soft_i2c_bit_t *i2c)
 {
-	ops->set_sda_out();
-	ops->set_sda(0);
-	ops->delay_us((ops->us + 1) >> 1);
-	ops->set_scl(0);
+	misaka_soft_i2c_set_sda_out(i2c);
+	misaka_soft_i2c_set_sda(i2c, 0);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+	misaka_soft_i2c_set_scl(i2c, 0);
 }
 
 /**
  * @brief 重复产生起始信号，一般是连续读写中
- * @param ops i2c设备
+ * @param i2c i2c总线
  */
-static void misaka_soft_i2c_restart(const misaka_soft_i2c_t *ops)
+static void misaka_soft_i2c_restart(const misaka_soft_i2c_bit_t *i2c)
 {
-	ops->set_sda_out();
-	ops->set_sda(1);
-	ops->set_scl(1);
-	ops->delay_us((ops->us + 1) >> 1);
-	ops->set_sda(0);
-	ops->delay_us((ops->us + 1) >> 1);
-	ops->set_scl(0);
+	misaka_soft_i2c_set_sda_out(i2c);
+	misaka_soft_i2c_set_sda(i2c, 1);
+	misaka_soft_i2c_set_scl(i2c, 1);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+	misaka_soft_i2c_set_sda(i2c, 0);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+	misaka_soft_i2c_set_scl(i2c, 0);
 }
 
 /**
  * @brief 产生停止信号
- * @param ops i2c设备
+ * @param i2c i2c总线
  */
-static void misaka_soft_i2c_stop(const misaka_soft_i2c_t *ops)
+static void misaka_soft_i2c_stop(const misaka_soft_i2c_bit_t *i2c)
 {
-	ops->set_sda_out();
-
-	ops->set_sda(0);
-	ops->delay_us((ops->us + 1) >> 1);
-	ops->set_scl(1);
-	ops->delay_us((ops->us + 1) >> 1);
-	ops->set_sda(1);
-	ops->delay_us(ops->us);
+	misaka_soft_i2c_set_sda_out(i2c);
+
+	misaka_soft_i2c_set_sda(i2c, 0);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+	misaka_soft_i2c_set_scl(i2c, 1);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+	misaka_soft_i2c_set_sda(i2c, 1);
+	misaka_soft_i2c_delay_us(i2c, i2c->us);
 }
 
 /**
  * @brief 等待应答信号到来
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @return 0 @c 接收应答失败
  * @return 1 @c 接收应答成功
  */
-static uint8_t misaka_soft_i2c_wait_ack(const misaka_soft_i2c_t *ops)
+static uint8_t misaka_soft_i2c_wait_ack(const misaka_soft_i2c_bit_t *i2c)
 {
 	uint8_t ack;
 
-	ops->set_sda_in();
+	misaka_soft_i2c_set_sda_in(i2c);
 
-	ops->set_sda(1);
-	ops->delay_us((ops->us + 1) >> 1);
-	ops->set_scl(1);
-	ack = !ops->get_sda();
-	ops->set_scl(0);
+	misaka_soft_i2c_set_sda(i2c, 1);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+	misaka_soft_i2c_set_scl(i2c, 1);
+	ack = !misaka_soft_i2c_get_sda(i2c);
+	misaka_soft_i2c_set_scl(i2c, 0);
 
 	return ack;
 }
 
 /**
  * @brief 发送一个字节
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @param data 待发送数据
  * @return 0 @c 无应答
  * @return 1 @c 有应答
  */
-static uint8_t MISAKA_SOFT_I2C_WRite_byte(const misaka_soft_i2c_t *ops, uint8_t data)
+static uint8_t MISAKA_SOFT_I2C_WRite_byte(const misaka_soft_i2c_bit_t *i2c, uint8_t data)
 {
 	int8_t i;
 	uint8_t bit;
 
-	ops->set_sda_out();
+	misaka_soft_i2c_set_sda_out(i2c);
 
 	for (i = 7; i >= 0; i--)
 	{
-		ops->set_scl(0);
+		misaka_soft_i2c_set_scl(i2c, 0);
 		bit = (data >> i) & 1;
-		ops->set_sda(bit);
-		ops->delay_us((ops->us + 1) >> 1);
-		ops->set_scl(1);
-		ops->delay_us((ops->us + 1) >> 1);
+		misaka_soft_i2c_set_sda(i2c, bit);
+		misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+		misaka_soft_i2c_set_scl(i2c, 1);
+		misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
 	}
-	ops->set_scl(0);
-	ops->delay_us((ops->us + 1) >> 1);
+	misaka_soft_i2c_set_scl(i2c, 0);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
 
-	return misaka_soft_i2c_wait_ack(ops);
+	bit = misaka_soft_i2c_wait_ack(i2c);
+	MISAKA_SOFT_I2C_COUNT(i2c, bytes, 1);
+	MISAKA_SOFT_I2C_COUNT(i2c, nacks, !bit);
+
+	return bit;
 }
 
 /**
  * @brief 读1个字节
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @return uint8_t @c 读取到的1个字节
  */
-static uint8_t misaka_soft_i2c_read_byte(const misaka_soft_i2c_t *ops)
+static uint8_t misaka_soft_i2c_read_byte(const misaka_soft_i2c_bit_t *i2c)
 {
 	uint8_t i;
 	uint8_t data = 0;
 
-	ops->set_sda_in();
+	misaka_soft_i2c_set_sda_in(i2c);
 
-	ops->set_sda(1);
-	ops->delay_us((ops->us + 1) >> 1);
+	misaka_soft_i2c_set_sda(i2c, 1);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
 	for (i = 0; i < 8; i++)
 	{
 		data <<= 1;
 
-		ops->set_scl(1);
+		misaka_soft_i2c_set_scl(i2c, 1);
 
-		if (ops->get_sda())
+		if (misaka_soft_i2c_get_sda(i2c))
 		{
 			data |= 1;
 		}
-		ops->set_scl(0);
-		ops->delay_us(ops->us);
+		misaka_soft_i2c_set_scl(i2c, 0);
+		misaka_soft_i2c_delay_us(i2c, i2c->us);
 	}
+	MISAKA_SOFT_I2C_COUNT(i2c, bytes, 1);
 
 	return data;
 }
 
 /**
  * @brief 发送多字节
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @param msg 消息对象
  * @return uint32_t @c 发送的字节数
  */
-static uint32_t misaka_soft_i2c_send_bytes(const misaka_soft_i2c_t *ops, misaka_soft_i2c_message_t msg)
+static uint32_t misaka_soft_i2c_send_bytes(const misaka_soft_i2c_bit_t *i2c, misaka_soft_i2c_message_t msg)
 {
 	uint8_t ret;
 	uint32_t bytes = 0;
@@ -159,7 +295,7 @@ static uint32_t misaka_soft_i2c_send_bytes(const misaka_soft_i2c_t *ops, misaka_
 
 	while (len > 0)
 	{
-		ret = MISAKA_SOFT_I2C_WRite_byte(ops, *ptr);
+		ret = MISAKA_SOFT_I2C_WRite_byte(i2c, *ptr);
 
 		if ((ret > 0) || (ignore_nack && (ret == 0)))
 		{
@@ -182,29 +318,29 @@ static uint32_t misaka_soft_i2c_send_bytes(const misaka_soft_i2c_t *ops, misaka_
 
 /**
  * @brief 产生ACK应答
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @param ack 0: 不产生 1: 产生
  */
-static void misaka_soft_i2c_send_ack_or_nack(const misaka_soft_i2c_t *ops, uint8_t ack)
+static void misaka_soft_i2c_send_ack_or_nack(const misaka_soft_i2c_bit_t *i2c, uint8_t ack)
 {
-	ops->set_sda_out();
+	misaka_soft_i2c_set_sda_out(i2c);
 
 	if (ack)
 	{
-		ops->set_sda(0);
+		misaka_soft_i2c_set_sda(i2c, 0);
 	}
-	ops->delay_us((ops->us + 1) >> 1);
-	ops->set_scl(1);
-	ops->set_scl(0);
+	misaka_soft_i2c_delay_us(i2c, (i2c->us + 1) >> 1);
+	misaka_soft_i2c_set_scl(i2c, 1);
+	misaka_soft_i2c_set_scl(i2c, 0);
 }
 
 /**
  * @brief 接收多字节
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @param msg 消息对象
  * @return uint32_t @c 接收多字节数
  */
-static uint32_t misaka_soft_i2c_recv_bytes(const misaka_soft_i2c_t *ops, misaka_soft_i2c_message_t msg)
+static uint32_t misaka_soft_i2c_recv_bytes(const misaka_soft_i2c_bit_t *i2c, misaka_soft_i2c_message_t msg)
 {
 	uint8_t val;
 	uint32_t bytes = 0;
@@ -214,7 +350,7 @@ static uint32_t misaka_soft_i2c_recv_bytes(const misaka_soft_i2c_t *ops, misaka_
 
 	while (len > 0)
 	{
-		val = misaka_soft_i2c_read_byte(ops);
+		val = misaka_soft_i2c_read_byte(i2c);
 		if (val >= 0)
 		{
 			*ptr = val;
@@ -230,7 +366,7 @@ static uint32_t misaka_soft_i2c_recv_bytes(const misaka_soft_i2c_t *ops, misaka_
 
 		if (!(flags & MISAKA_SOFT_I2C_NO_READ_ACK))
 		{
-			misaka_soft_i2c_send_ack_or_nack(ops, len);
+			misaka_soft_i2c_send_ack_or_nack(i2c, len);
 		}
 	}
 
@@ -239,27 +375,27 @@ static uint32_t misaka_soft_i2c_recv_bytes(const misaka_soft_i2c_t *ops, misaka_
 
 /**
  * @brief 发送地址，启动i2c总线，可重复
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @param addr 地址
  * @param retries 重复次数
  * @return 0 @c 有应答
  * @return 1 @c 无应答
  */
-static uint8_t misaka_soft_i2c_send_address(const misaka_soft_i2c_t *ops, uint8_t addr, uint8_t retries)
+static uint8_t misaka_soft_i2c_send_address(const misaka_soft_i2c_bit_t *i2c, uint8_t addr, uint8_t retries)
 {
 	uint8_t i;
 	uint8_t ret = 0;
 
 	for (i = 0; i <= retries; i++)
 	{
-		ret = MISAKA_SOFT_I2C_WRite_byte(ops, addr);
+		ret = MISAKA_SOFT_I2C_WRite_byte(i2c, addr);
 		if (ret == 1 || i == retries)
 		{
 			break;
 		}
-		misaka_soft_i2c_stop(ops);
-		ops->delay_us(ops->us);
-		misaka_soft_i2c_start(ops);
+		misaka_soft_i2c_stop(i2c);
+		misaka_soft_i2c_delay_us(i2c, i2c->us);
+		misaka_soft_i2c_start(i2c);
 	}
 
 	return ret;
@@ -267,12 +403,12 @@ static uint8_t misaka_soft_i2c_send_address(const misaka_soft_i2c_t *ops, uint8_
 
 /**
  * @brief 发送i2c从地址
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @param msg 消息对象
  * @return 0 @c 有应答
  * @return 1 @c 无应答
  */
-static uint8_t misaka_soft_i2c_bit_send_address(const misaka_soft_i2c_t *ops, misaka_soft_i2c_message_t msg)
+static uint8_t misaka_soft_i2c_bit_send_address(const misaka_soft_i2c_bit_t *i2c, misaka_soft_i2c_message_t msg)
 {
 	uint16_t flags = msg->flags;
 	uint16_t ignore_nack = msg->flags & MISAKA_SOFT_I2C_IGNORE_NACK;
@@ -287,22 +423,22 @@ static uint8_t misaka_soft_i2c_bit_send_address(const misaka_soft_i2c_t *ops, mi
 		addr1 = 0xf0 | ((msg->addr >> 7) & 0x06);
 		addr2 = msg->addr & 0xff;
 
-		ret = misaka_soft_i2c_send_address(ops, addr1, retries);
+		ret = misaka_soft_i2c_send_address(i2c, addr1, retries);
 		if ((ret != 1) && !ignore_nack)
 		{
 			return 1;
 		}
 
-		ret = MISAKA_SOFT_I2C_WRite_byte(ops, addr2);
+		ret = MISAKA_SOFT_I2C_WRite_byte(i2c, addr2);
 		if ((ret != 1) && !ignore_nack)
 		{
 			return 1;
 		}
 		if (flags & MISAKA_SOFT_I2C_RD)
 		{
-			misaka_soft_i2c_restart(ops);
+			misaka_soft_i2c_restart(i2c);
 			addr1 |= 0x01;
-			ret = misaka_soft_i2c_send_address(ops, addr1, retries);
+			ret = misaka_soft_i2c_send_address(i2c, addr1, retries);
 			if ((ret != 1) && !ignore_nack)
 			{
 				return 1;
@@ -317,7 +453,7 @@ static uint8_t misaka_soft_i2c_bit_send_address(const misaka_soft_i2c_t *ops, mi
 		{
 			addr1 |= 1;
 		}
-		ret = misaka_soft_i2c_send_address(ops, addr1, retries);
+		ret = misaka_soft_i2c_send_address(i2c, addr1, retries);
 		if ((ret != 1) && !ignore_nack)
 		{
 			return 1;
@@ -329,18 +465,18 @@ static uint8_t misaka_soft_i2c_bit_send_address(const misaka_soft_i2c_t *ops, mi
 
 /**
  * @brief 内部操作函数
- * @param ops i2c设备
+ * @param i2c i2c总线
  * @param msgs 消息对象
  * @param num 消息数量
  * @return uint32_t @c 操作的消息数
  */
-static uint32_t misaka_soft_i2c_bit_xfer(const misaka_soft_i2c_t *ops, misaka_soft_i2c_message *msgs, uint16_t num)
+static uint32_t misaka_soft_i2c_bit_xfer(const misaka_soft_i2c_bit_t *i2c, misaka_soft_i2c_message *msgs, uint16_t num)
 {
 	misaka_soft_i2c_message_t msg;
 	uint32_t i, ret;
 	uint16_t ignore_nack;
 
-	misaka_soft_i2c_start(ops);
+	misaka_soft_i2c_start(i2c);
 	for (i = 0; i < num; i++)
 	{
 		msg = &msgs[i];
@@ -351,17 +487,19 @@ static uint32_t misaka_soft_i2c_bit_xfer(const misaka_soft_i2c_t *ops, misaka_so
 		{
 			if (i)
 			{
-				misaka_soft_i2c_restart(ops);
+				misaka_soft_i2c_restart(i2c);
 			}
-			ret = misaka_soft_i2c_bit_send_address(ops, msg);
+			ret = misaka_soft_i2c_bit_send_address(i2c, msg);
 			if ((ret != 0) && !ignore_nack)
 			{
+				/** < 地址未应答：返回已完成的消息数 */
+				ret = i;
 				goto out;
 			}
 		}
 		if (msg->flags & MISAKA_SOFT_I2C_RD)
 		{
-			ret = misaka_soft_i2c_recv_bytes(ops, msg);
+			ret = misaka_soft_i2c_recv_bytes(i2c, msg);
 			if (ret < msg->len)
 			{
 				if (ret >= 0)
@@ -373,7 +511,7 @@ static uint32_t misaka_soft_i2c_bit_xfer(const misaka_soft_i2c_t *ops, misaka_so
 		}
 		else
 		{
-			ret = misaka_soft_i2c_send_bytes(ops, msg);
+			ret = misaka_soft_i2c_send_bytes(i2c, msg);
 			if (ret < msg->len)
 			{
 				if (ret >= 0)
@@ -387,7 +525,57 @@ static uint32_t misaka_soft_i2c_bit_xfer(const misaka_soft_i2c_t *ops, misaka_so
 	ret = i;
 
 	out:
-	misaka_soft_i2c_stop(ops);
+	misaka_soft_i2c_stop(i2c);
+
+	return ret;
+}
+
+/**
+ * @brief 获取互斥量后传输
+ * @param i2c i2c总线
+ * @param msgs 消息对象
+ * @param num 消息数量
+ * @return uint32_t @c 操作的消息数
+ */
+static uint32_t misaka_soft_i2c_bit_transfer(const misaka_soft_i2c_bit_t *i2c, misaka_soft_i2c_message *msgs, uint32_t num)
+{
+	uint32_t ret;
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	uint32_t tick = 0, hold;
+
+	if (i2c->stat != NULL && i2c->stat->get_tick_us != NULL)
+	{
+		tick = i2c->stat->get_tick_us();
+	}
+#endif
+
+	misaka_soft_i2c_call0(i2c, mutex_take);
+	if (i2c->backend)
+	{
+		ret = misaka_soft_i2c_call(i2c, xfer, msgs, num);
+	}
+	else
+	{
+		ret = misaka_soft_i2c_bit_xfer(i2c, msgs, num);
+	}
+	misaka_soft_i2c_call0(i2c, mutex_release);
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	if (i2c->stat != NULL)
+	{
+		i2c->stat->transfers++;
+		i2c->stat->messages += ret;
+		if (i2c->stat->get_tick_us != NULL)
+		{
+			hold = i2c->stat->get_tick_us() - tick;
+			i2c->stat->hold_us += hold;
+			if (hold > i2c->stat->hold_max_us)
+			{
+				i2c->stat->hold_max_us = hold;
+			}
+		}
+	}
+#endif
 
 	return ret;
 }
@@ -397,15 +585,22 @@ static uint32_t misaka_soft_i2c_bit_xfer(const misaka_soft_i2c_t *ops, misaka_so
  * @param ops i2c设备
  * @param msgs 消息对象
  * @param num 消息数量
- * @return uint16_t @c 操作的消息数
+ * @return uint32_t @c 操作的消息数
  */
 uint32_t misaka_soft_i2c_transfer(const misaka_soft_i2c_t *ops, misaka_soft_i2c_message *msgs, uint32_t num)
 {
 	uint32_t ret;
+	misaka_soft_i2c_bit_t bit;
+
+	bit.ops = &s_misaka_soft_i2c_legacy_ops;
+	bit.ctx = (void *) ops;
+	bit.us = ops->us;
+	bit.backend = ops->xfer != NULL;
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	bit.stat = ops->stat;
+#endif
 
-	ops->mutex_take();
-	ret = misaka_soft_i2c_bit_xfer(ops, msgs, num);
-	ops->mutex_release();
+	ret = misaka_soft_i2c_bit_transfer(&bit, msgs, num);
 	if (ret != num)
 	{
 		misaka_soft_i2c_error_callback(ops);
@@ -529,12 +724,176 @@ uint32_t misaka_soft_i2c_master_send_then_send(const misaka_soft_i2c_t *ops, uin
 void misaka_soft_i2c_init(const misaka_soft_i2c_t *ops)
 {
 	misaka_soft_i2c_assert(ops);
-	misaka_soft_i2c_assert(ops->delay_us);
-	misaka_soft_i2c_assert(ops->set_scl);
-	misaka_soft_i2c_assert(ops->set_sda);
-	misaka_soft_i2c_assert(ops->set_sda_out);
-	misaka_soft_i2c_assert(ops->get_sda);
-	misaka_soft_i2c_assert(ops->set_sda_in);
+	misaka_soft_i2c_assert(ops->xfer || ops->delay_us);
+	misaka_soft_i2c_assert(ops->xfer || ops->set_scl);
+	misaka_soft_i2c_assert(ops->xfer || ops->set_sda);
+	misaka_soft_i2c_assert(ops->xfer || ops->set_sda_out);
+	misaka_soft_i2c_assert(ops->xfer || ops->get_sda);
+	misaka_soft_i2c_assert(ops->xfer || ops->set_sda_in);
 	misaka_soft_i2c_assert(ops->mutex_release);
 	misaka_soft_i2c_assert(ops->mutex_take);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 外部操作函数（共享操作表）
+ * @param bus i2c总线
+ * @param msgs 消息对象
+ * @param num 消息数量
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_transfer(const misaka_soft_i2c_bus_t *bus, misaka_soft_i2c_message *msgs, uint32_t num)
+{
+	uint32_t ret;
+	misaka_soft_i2c_bit_t bit;
+
+	bit.ops = bus->ops;
+	bit.ctx = bus->ctx;
+	bit.us = bus->us;
+	bit.backend = bus->ops->xfer != NULL;
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+	bit.stat = bus->stat;
+#endif
+
+	ret = misaka_soft_i2c_bit_transfer(&bit, msgs, num);
+	if (ret != num && bus->ops->error != NULL)
+	{
+		bus->ops->error(bus->ctx);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief 发送数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param flags 标志
+ * @param buf 待发送数据
+ * @param len 发送数据长度
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_send(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint16_t flags, uint8_t *buf, uint32_t len)
+{
+	misaka_soft_i2c_message msg;
+
+	msg.addr = addr;
+	msg.flags = flags;
+	msg.len = len;
+	msg.buf = buf;
+
+	return misaka_soft_i2c_bus_transfer(bus, &msg, 1);
+}
+
+/**
+ * @brief 接收数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param flags 标志
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_recv(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint16_t flags, uint8_t *rxbuf, uint32_t rxlen)
+{
+	misaka_soft_i2c_message msg;
+
+	msg.addr = addr;
+	msg.flags = flags | MISAKA_SOFT_I2C_RD;
+	msg.len = rxlen;
+	msg.buf = rxbuf;
+
+	return misaka_soft_i2c_bus_transfer(bus, &msg, 1);
+}
+
+/**
+ * @brief 发送数据后接收数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param txbuf 待发送数据
+ * @param txlen 发送数据长度
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_send_then_recv(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint8_t *txbuf, uint32_t txlen, uint8_t *rxbuf, uint32_t rxlen)
+{
+	misaka_soft_i2c_message msg[2];
+
+	msg[0].addr = addr;
+	msg[0].flags = MISAKA_SOFT_I2C_WR;
+	msg[0].buf = txbuf;
+	msg[0].len = txlen;
+
+	msg[1].addr = addr;
+	msg[1].flags = MISAKA_SOFT_I2C_RD;
+	msg[1].buf = rxbuf;
+	msg[1].len = rxlen;
+
+	return misaka_soft_i2c_bus_transfer(bus, msg, 2);
+}
+
+/**
+ * @brief 发送数据后发送数据（共享操作表）
+ * @param bus i2c总线
+ * @param addr 地址
+ * @param txbuf1 待发送数据1
+ * @param txlen1 发送数据长度1
+ * @param txbuf2 待发送数据2
+ * @param txlen2 发送数据长度2
+ * @return uint32_t @c 操作的消息数
+ */
+uint32_t misaka_soft_i2c_bus_master_send_then_send(const misaka_soft_i2c_bus_t *bus, uint16_t addr, uint8_t *txbuf1, uint32_t txlen1, uint8_t *txbuf2, uint32_t txlen2)
+{
+	misaka_soft_i2c_message msg[2];
+
+	msg[0].addr = addr;
+	msg[0].flags = MISAKA_SOFT_I2C_WR;
+	msg[0].buf = txbuf1;
+	msg[0].len = txlen1;
+
+	msg[1].addr = addr;
+	msg[1].flags = MISAKA_SOFT_I2C_WR | MISAKA_SOFT_I2C_NO_START;
+	msg[1].buf = txbuf2;
+	msg[1].len = txlen2;
+
+	return misaka_soft_i2c_bus_transfer(bus, msg, 2);
+}
+
+/**
+ * @brief 初始化函数（共享操作表）
+ * @param bus i2c总线
+ */
+void misaka_soft_i2c_bus_init(const misaka_soft_i2c_bus_t *bus)
+{
+	misaka_soft_i2c_assert(bus);
+	misaka_soft_i2c_assert(bus->ops);
+	misaka_soft_i2c_assert(bus->ops->xfer || bus->ops->delay_us);
+	misaka_soft_i2c_assert(bus->ops->xfer || bus->ops->set_scl);
+	misaka_soft_i2c_assert(bus->ops->xfer || bus->ops->set_sda);
+	misaka_soft_i2c_assert(bus->ops->xfer || bus->ops->set_sda_out);
+	misaka_soft_i2c_assert(bus->ops->xfer || bus->ops->get_sda);
+	misaka_soft_i2c_assert(bus->ops->xfer || bus->ops->set_sda_in);
+	misaka_soft_i2c_assert(bus->ops->mutex_release);
+	misaka_soft_i2c_assert(bus->ops->mutex_take);
+}
+
+#ifdef MISAKA_SOFT_I2C_USING_STATISTICS
+/**
+ * @brief 清零统计，保留get_tick_us
+ * @param stat 统计
+ */
+void misaka_soft_i2c_reset_statistics(misaka_soft_i2c_statistics_t *stat)
+{
+	misaka_soft_i2c_assert(stat != NULL);
+
+	stat->transfers = 0;
+	stat->messages = 0;
+	stat->bytes = 0;
+	stat->nacks = 0;
+	stat->pin_calls = 0;
+	stat->delay_calls = 0;
+	stat->delay_us = 0;
+	stat->hold_us = 0;
+	stat->hold_max_us = 0;
+}
+#endif
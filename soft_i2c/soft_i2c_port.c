@@ -117,3 +117,163 @@ misaka_soft_i2c_t misaka_soft_i2c_port_init()
 	return &i2c_obj;
 }
 
+/**
+ * 共享操作表示例：多条软件i2c总线共用一份常量操作表，ctx给出各自的引脚与互斥量
+ */
+struct soft_i2c_pins
+{
+	uint32_t port;/**< gpio端口基址 */
+	uint16_t scl;/**< scl引脚掩码 */
+	uint16_t sda;/**< sda引脚掩码 */
+	void *mutex;/**< 互斥量，裸机系统为NULL */
+};
+
+static struct soft_i2c_pins s_i2c1_pins;
+static struct soft_i2c_pins s_i2c2_pins;
+static misaka_soft_i2c_bus_t s_i2c1_bus;
+static misaka_soft_i2c_bus_t s_i2c2_bus;
+
+/**
+ * @brief 设置sda引脚电平
+ * @param ctx 引脚
+ * @param level 0: 低电平 1: 高电平
+ */
+static void pins_set_sda(void *ctx, uint8_t level)
+{
+
+}
+
+/**
+ * @brief 设置scl引脚电平
+ * @param ctx 引脚
+ * @param level 0: 低电平 1: 高电平
+ */
+static void pins_set_scl(void *ctx, uint8_t level)
+{
+
+}
+
+/**
+ * @brief 读取sda引脚电平
+ * @param ctx 引脚
+ * @return 0 @c 低电平
+ * @return 1 @c 高电平
+ */
+static uint8_t pins_get_sda(void *ctx)
+{
+
+}
+
+/**
+ * @brief 延时us
+ * @param ctx 引脚
+ * @param us 延时
+ */
+static void pins_delay_us(void *ctx, uint16_t us)
+{
+
+}
+
+/**
+ * @brief 设置sda引脚为输出模式（硬件无上拉时需要添加）
+ * @param ctx 引脚
+ */
+static void pins_set_sda_out(void *ctx)
+{
+
+}
+
+/**
+ * @brief 设置sda引脚为输入模式（硬件无上拉时需要添加）
+ * @param ctx 引脚
+ */
+static void pins_set_sda_in(void *ctx)
+{
+
+}
+
+/**
+ * @brief 获取互斥量，如果为裸机系统，空函数即可
+ * @param ctx 引脚
+ */
+static void pins_mutex_take(void *ctx)
+{
+
+}
+
+/**
+ * @brief 释放互斥量，如果为裸机系统，空函数即可
+ * @param ctx 引脚
+ */
+static void pins_mutex_release(void *ctx)
+{
+
+}
+
+static const misaka_soft_i2c_ops_t s_soft_i2c_pins_ops = {
+	pins_set_sda,
+	pins_set_scl,
+	pins_get_sda,
+	pins_delay_us,
+	pins_set_sda_out,
+	pins_set_sda_in,
+	pins_mutex_take,
+	pins_mutex_release,
+	NULL,/**< 读写错误回调（可选） */
+	NULL,/**< 传输后端（可选） */
+};
+
+static int misaka_soft_i2c_bus_port_init()
+{
+	s_i2c1_bus.ops = &s_soft_i2c_pins_ops;
+	s_i2c1_bus.ctx = &s_i2c1_pins;
+	s_i2c1_bus.us = 1;
+	s_i2c2_bus.ops = &s_soft_i2c_pins_ops;
+	s_i2c2_bus.ctx = &s_i2c2_pins;
+	s_i2c2_bus.us = 5;/**< 共用操作表，速率各自设置 */
+
+	misaka_soft_i2c_bus_init(&s_i2c1_bus);
+	misaka_soft_i2c_bus_init(&s_i2c2_bus);
+
+	return 1;
+}
+
+/**
+ * 硬件后端示例：片上i2c控制器实现xfer，驱动代码不变，引脚操作可为NULL
+ */
+static misaka_soft_i2c_bus_t s_i2c3_bus;
+
+/**
+ * @brief 由i2c控制器完成整组消息（中断或DMA方式在此等待完成），按标志产生起始、重复起始与停止
+ * @param ctx 控制器
+ * @param msgs 消息对象
+ * @param num 消息数量
+ * @return uint32_t @c 完成的消息数
+ */
+static uint32_t hw_i2c_xfer(void *ctx, misaka_soft_i2c_message *msgs, uint32_t num)
+{
+
+}
+
+static const misaka_soft_i2c_ops_t s_hw_i2c_ops = {
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	pins_mutex_take,
+	pins_mutex_release,
+	NULL,/**< 读写错误回调（可选） */
+	hw_i2c_xfer,
+};
+
+static int misaka_soft_i2c_hw_port_init()
+{
+	s_i2c3_bus.ops = &s_hw_i2c_ops;
+	s_i2c3_bus.ctx = NULL;/**< 控制器基址 */
+
+	misaka_soft_i2c_bus_init(&s_i2c3_bus);
+
+	return 1;
+}
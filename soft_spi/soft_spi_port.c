@@ -0,0 +1,70 @@
+/**
+ * @file soft_spi_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/spi.h"
+
+/**
+ * 引脚操作建议直接写寄存器，例如 GPIOA->BSRR = (s) ? PIN_SCK : (PIN_SCK << 16)
+ */
+#define MISAKA_SOFT_SPI_NAME          soft_spi1
+#define MISAKA_SOFT_SPI_SET_SCK(s)    ((void) (s))
+#define MISAKA_SOFT_SPI_SET_MOSI(s)   ((void) (s))
+#define MISAKA_SOFT_SPI_GET_MISO()    (0)
+#define MISAKA_SOFT_SPI_DELAY()
+#define MISAKA_SOFT_SPI_MUTEX_TAKE(ctx)     ((void) (ctx))/**< 带操作系统时获取ctx指向的互斥量 */
+#define MISAKA_SOFT_SPI_MUTEX_RELEASE(ctx)  ((void) (ctx))
+#include "misaka_device/soft_spi.h"
+
+static misaka_spi_bus_t s_misaka_soft_spi1_bus_obj;
+misaka_spi_bus_t *misaka_soft_spi1_bus_obj = NULL;
+static misaka_spi_t s_misaka_soft_spi11_obj;
+misaka_spi_t *misaka_soft_spi11_obj = NULL;
+
+/**
+ * @brief 设置cs引脚电平
+ * @param ctx cs上下文
+ * @param state 0: 低电平 1: 高电平
+ */
+static void set_cs(void *ctx, uint8_t state)
+{
+
+}
+
+static const misaka_spi_cs_ops_t s_soft_spi_cs_ops = {
+	set_cs,
+	NULL,
+};
+
+static int misaka_soft_spi_port_init()
+{
+	soft_spi1_bus_init(&s_misaka_soft_spi1_bus_obj, NULL);
+
+	misaka_soft_spi1_bus_obj = &s_misaka_soft_spi1_bus_obj;
+
+	memset(&s_misaka_soft_spi11_obj, 0, sizeof(misaka_spi_t));
+	s_misaka_soft_spi11_obj.cs_ops = &s_soft_spi_cs_ops;
+	s_misaka_soft_spi11_obj.cs_ctx = NULL;
+	s_misaka_soft_spi11_obj.cs_active = 0;/**< 初始化时cs需为高电平 */
+	s_misaka_soft_spi11_obj.bus = misaka_soft_spi1_bus_obj;
+	s_misaka_soft_spi11_obj.config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	s_misaka_soft_spi11_obj.config.data_width = 8;
+	s_misaka_soft_spi11_obj.config.max_hz = 1000000;
+	misaka_soft_spi11_obj = &s_misaka_soft_spi11_obj;
+
+	return 1;
+}
@@ -19,15 +19,47 @@
 #include <string.h>
 #include "misaka_device/spi.h"
 
+/**
+ * @brief 产生空时钟周期，总线未提供dummy时以发送0xff代替，需周期数与线宽之积为8的整数倍
+ * @param ops spi设备
+ * @param cycles 周期数
+ * @param lines 数据线宽度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_dummy(misaka_spi_t *ops, uint8_t cycles, uint8_t lines)
+{
+	uint8_t dummy[128];
+
+	if (ops->bus->ops->dummy != NULL)
+	{
+		return ops->bus->ops->dummy(ops->bus->ctx, cycles, lines);
+	}
+
+	lines = lines > MISAKA_SPI_LINES_SINGLE ? lines : MISAKA_SPI_LINES_SINGLE;
+	if (((cycles * lines) & 0x07) != 0)
+	{
+		return 1;
+	}
+
+	memset(dummy, 0xff, sizeof(dummy));
+
+	if (lines > MISAKA_SPI_LINES_SINGLE)
+	{
+		return ops->bus->ops->send_lines != NULL ? ops->bus->ops->send_lines(ops->bus->ctx, dummy, (cycles * lines) >> 3, lines) : 1;
+	}
+
+	return ops->bus->ops->send(ops->bus->ctx, dummy, cycles >> 3);
+}
+
 /**
  * @brief 内部操作函数
  * @param ops spi设备
  * @param message 消息对象
- * @return 发送的字节数
+ * @return 0:成功 1:失败（含空周期失败，长度为0的段也能返回失败）
  */
-static uint32_t misaka_spi_xfer(misaka_spi_t *ops, misaka_spi_message_t *message)
+static uint8_t misaka_spi_xfer(misaka_spi_t *ops, misaka_spi_message_t *message)
 {
-	uint8_t state;
+	uint8_t state = 0;
 	uint32_t message_length, already_send_length;
 	uint32_t send_length;
 	uint8_t *recv_buf;
@@ -35,18 +67,30 @@ static uint32_t misaka_spi_xfer(misaka_spi_t *ops, misaka_spi_message_t *message
 
 	misaka_spi_assert(ops != NULL);
 	misaka_spi_assert(ops->bus != NULL);
-	misaka_spi_assert(ops->bus->send_recv != NULL);
-	misaka_spi_assert(ops->bus->send != NULL);
-	misaka_spi_assert(ops->bus->recv != NULL);
-	misaka_spi_assert(ops->set_sda != NULL);
+	misaka_spi_assert(ops->bus->ops->send_recv != NULL);
+	misaka_spi_assert(ops->bus->ops->send != NULL);
+	misaka_spi_assert(ops->bus->ops->recv != NULL);
+	misaka_spi_assert(ops->cs_ops != NULL);
 	misaka_spi_assert(message != NULL);
 
-	if (message->cs_take)
+	if (message->dc != MISAKA_SPI_DC_NONE && ops->cs_ops->set_dc != NULL)
+	{
+		ops->cs_ops->set_dc(ops->cs_ctx, message->dc == MISAKA_SPI_DC_DATA);
+	}
+
+	if (message->cs_take && !ops->cs_active)
 	{
-		ops->set_cs(0);
+		ops->cs_ops->set_cs(ops->cs_ctx, 0);
+		ops->cs_active = 1;
 	}
 
-	message_length = message->length;
+	if (message->dummy_cycles)
+	{
+		state = misaka_spi_dummy(ops, message->dummy_cycles, message->lines);
+	}
+
+	/** < 空周期失败时不再传输数据 */
+	message_length = state == 0 ? message->length : 0;
 	recv_buf = message->recv_buf;
 	send_buf = message->send_buf;
 	while (message_length)
@@ -66,32 +110,499 @@ static uint32_t misaka_spi_xfer(misaka_spi_t *ops, misaka_spi_message_t *message
 		send_buf = (uint8_t *) message->send_buf + already_send_length;
 		recv_buf = (uint8_t *) message->recv_buf + already_send_length;
 
-		if (message->send_buf && message->recv_buf)
+		if (message->lines > MISAKA_SPI_LINES_SINGLE)
 		{
-			state = ops->bus->send_recv(send_buf, recv_buf, send_length);
+			if (message->send_buf && message->recv_buf)
+			{
+				state = 1;
+			}
+			else if (message->send_buf)
+			{
+				state = ops->bus->ops->send_lines != NULL ? ops->bus->ops->send_lines(ops->bus->ctx, send_buf, send_length, message->lines) : 1;
+			}
+			else
+			{
+				state = ops->bus->ops->recv_lines != NULL ? ops->bus->ops->recv_lines(ops->bus->ctx, recv_buf, send_length, message->lines) : 1;
+			}
+		}
+		else if (message->send_buf && message->recv_buf)
+		{
+			state = ops->bus->ops->send_recv(ops->bus->ctx, send_buf, recv_buf, send_length);
 		}
 		else if (message->send_buf)
 		{
-			state = ops->bus->send(send_buf, send_length);
+			state = ops->bus->ops->send(ops->bus->ctx, send_buf, send_length);
 		}
 		else
 		{
 			memset((uint8_t *) recv_buf, 0xff, send_length);
-			state = ops->bus->recv(recv_buf, send_length);
+			state = ops->bus->ops->recv(ops->bus->ctx, recv_buf, send_length);
 		}
 
 		if (state != 0)
 		{
-			message->length = 0;
+			break;
 		}
 	}
 
-	if (message->cs_release)
+	if (message->cs_release && ops->cs_active)
+	{
+		ops->cs_ops->set_cs(ops->cs_ctx, 1);
+		ops->cs_active = 0;
+	}
+
+	return state;
+}
+
+#ifdef MISAKA_SPI_USING_STATISTICS
+/**
+ * @brief 统计一次消息链
+ * @param ops spi设备
+ * @param message 消息链
+ */
+static void misaka_spi_stat_chain(misaka_spi_t *ops, misaka_spi_message_t *message)
+{
+	uint32_t segments = 0, bytes = 0;
+
+	for (; message != NULL; message = message->next)
+	{
+		segments++;
+		bytes += message->length;
+	}
+
+	ops->stat.transfers++;
+	ops->stat.segments += segments;
+	ops->stat.bytes += bytes;
+	ops->bus->stat.transfers++;
+	ops->bus->stat.segments += segments;
+	ops->bus->stat.bytes += bytes;
+}
+
+/**
+ * @brief 统计一次失败
+ * @param ops spi设备
+ */
+static void misaka_spi_stat_failure(misaka_spi_t *ops)
+{
+	ops->stat.failures++;
+	ops->bus->stat.failures++;
+}
+
+/**
+ * @brief 累计时间统计
+ * @param stat 统计
+ * @param wait_us 等待时间
+ * @param hold_us 占用时间
+ */
+static void misaka_spi_stat_time(misaka_spi_statistics_t *stat, uint32_t wait_us, uint32_t hold_us)
+{
+	uint32_t latency = wait_us + hold_us;
+	uint32_t bucket = 0;
+
+	while (latency && bucket < MISAKA_SPI_STATISTICS_BUCKETS - 1)
+	{
+		latency >>= 1;
+		bucket++;
+	}
+
+	stat->wait_us += wait_us;
+	stat->hold_us += hold_us;
+	if (wait_us > stat->wait_max_us)
+	{
+		stat->wait_max_us = wait_us;
+	}
+	if (hold_us > stat->hold_max_us)
+	{
+		stat->hold_max_us = hold_us;
+	}
+	stat->histogram[bucket]++;
+}
+#else
+#define misaka_spi_stat_chain(ops, message)     ((void)0U)
+#define misaka_spi_stat_failure(ops)            ((void)0U)
+#endif
+
+/**
+ * @brief 判断两个配置是否一致
+ * @param cfg1 配置1
+ * @param cfg2 配置2
+ * @return 0:不一致 1:一致
+ */
+static uint8_t misaka_spi_configuration_equal(const misaka_spi_configuration_t *cfg1, const misaka_spi_configuration_t *cfg2)
+{
+	return cfg1->mode == cfg2->mode && cfg1->data_width == cfg2->data_width && cfg1->max_hz == cfg2->max_hz;
+}
+
+/**
+ * @brief 获取设备优先级
+ * @param ops spi设备
+ * @return uint8_t @c 优先级
+ */
+static uint8_t misaka_spi_priority(misaka_spi_t *ops)
+{
+	return ops->priority < MISAKA_SPI_PRIORITY_NUM ? ops->priority : MISAKA_SPI_PRIORITY_NUM - 1;
+}
+
+/**
+ * @brief 更新等待计数与优先级位图，只在仲裁时维护，计数的读改写必须在临界区内
+ * @param ops spi设备
+ * @param waiting 1:开始等待 0:结束等待
+ */
+static void misaka_spi_wait_count(misaka_spi_t *ops, uint8_t waiting)
+{
+	misaka_spi_bus_t *bus = ops->bus;
+
+	if (bus->chunk_size == 0)
+	{
+		return;
+	}
+
+	misaka_spi_assert(bus->ops->critical_enter != NULL);
+	misaka_spi_assert(bus->ops->critical_exit != NULL);
+
+	bus->ops->critical_enter(bus->ctx);
+	if (waiting)
+	{
+		bus->waiting[misaka_spi_priority(ops)]++;
+		bus->priorities |= 1UL << misaka_spi_priority(ops);
+	}
+	else
+	{
+		bus->waiting[misaka_spi_priority(ops)]--;
+	}
+	bus->ops->critical_exit(bus->ctx);
+}
+
+/**
+ * @brief 获取互斥量，登记等待并记录等待时间
+ * @param ops spi设备
+ */
+static void misaka_spi_lock_bus(misaka_spi_t *ops)
+{
+	misaka_spi_bus_t *bus = ops->bus;
+#ifdef MISAKA_SPI_USING_STATISTICS
+	uint32_t tick = bus->get_tick_us ? bus->get_tick_us() : 0;
+#endif
+
+	misaka_spi_wait_count(ops, 1);
+	bus->ops->mutex_take(bus->ctx);
+	misaka_spi_wait_count(ops, 0);
+
+#ifdef MISAKA_SPI_USING_STATISTICS
+	if (bus->get_tick_us)
+	{
+		bus->stat_take_tick = bus->get_tick_us();
+		bus->stat_wait_us = bus->stat_take_tick - tick;
+	}
+#endif
+}
+
+/**
+ * @brief 设备与上一次占用总线的设备配置不同时重新配置控制器，调用前需已获取互斥量
+ * @param ops spi设备
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_setup_bus(misaka_spi_t *ops)
+{
+	misaka_spi_bus_t *bus = ops->bus;
+
+	if (bus->owner != ops)
+	{
+		if (bus->ops->configure != NULL
+			&& (bus->owner == NULL || !misaka_spi_configuration_equal(&bus->owner->config, &ops->config)))
+		{
+			if (bus->ops->configure(bus->ctx, ops, &ops->config) != 0)
+			{
+				bus->owner = NULL;
+				misaka_spi_stat_failure(ops);
+				return 1;
+			}
+		}
+		bus->owner = ops;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 获取总线，设备与上一次占用总线的设备配置不同时重新配置控制器
+ * @param ops spi设备
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_take_bus(misaka_spi_t *ops)
+{
+	misaka_spi_lock_bus(ops);
+
+	if (misaka_spi_setup_bus(ops) != 0)
+	{
+		ops->bus->ops->mutex_release(ops->bus->ctx);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 释放总线
+ * @param ops spi设备
+ */
+static void misaka_spi_release_bus(misaka_spi_t *ops)
+{
+#ifdef MISAKA_SPI_USING_STATISTICS
+	misaka_spi_bus_t *bus = ops->bus;
+	uint32_t hold_us;
+
+	if (bus->get_tick_us)
+	{
+		hold_us = bus->get_tick_us() - bus->stat_take_tick;
+		misaka_spi_stat_time(&ops->stat, bus->stat_wait_us, hold_us);
+		misaka_spi_stat_time(&bus->stat, bus->stat_wait_us, hold_us);
+	}
+#endif
+
+	ops->bus->ops->mutex_release(ops->bus->ctx);
+}
+
+/**
+ * @brief 提交消息链，调用前需已获取总线
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_submit(misaka_spi_t *ops, misaka_spi_message_t *message)
+{
+	misaka_spi_message_t *index;
+	uint8_t state;
+
+	if (ops->bus->ops->transfer_chain != NULL)
+	{
+		state = ops->bus->ops->transfer_chain(ops->bus->ctx, ops, message);
+
+		/** < cs由移植层处理，按首段cs_take与末段cs_release同步cs_active */
+		for (index = message; index->next != NULL; index = index->next)
+		{
+		}
+		if (message->cs_take)
+		{
+			ops->cs_active = 1;
+		}
+		if (index->cs_release)
+		{
+			ops->cs_active = 0;
+		}
+
+		return state;
+	}
+
+	for (index = message; index != NULL; index = index->next)
+	{
+		if (misaka_spi_xfer(ops, index) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 判断是否有更高优先级的设备获取过总线，没有时无需分块与让出
+ * @param ops spi设备
+ * @return 0:无 1:有
+ */
+static uint8_t misaka_spi_outranked(misaka_spi_t *ops)
+{
+	return (ops->bus->priorities >> misaka_spi_priority(ops) >> 1) != 0;
+}
+
+/**
+ * @brief 判断是否有更高优先级的设备在等待总线
+ * @param ops spi设备
+ * @return 0:无 1:有
+ */
+static uint8_t misaka_spi_preempt_pending(misaka_spi_t *ops)
+{
+	uint8_t priority;
+
+	for (priority = misaka_spi_priority(ops) + 1; priority < MISAKA_SPI_PRIORITY_NUM; priority++)
+	{
+		if (ops->bus->waiting[priority] != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 让出总线后重新获取，调用时cs须已释放；失败时仍持有互斥量，由调用者释放
+ * @param ops spi设备
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_yield(misaka_spi_t *ops)
+{
+#ifdef MISAKA_SPI_USING_STATISTICS
+	ops->stat.preemptions++;
+	ops->bus->stat.preemptions++;
+#endif
+
+	misaka_spi_release_bus(ops);
+	misaka_spi_lock_bus(ops);
+
+	return misaka_spi_setup_bus(ops);
+}
+
+/**
+ * @brief 可抢占设备分块传输，块前发现更高优先级设备等待时该块结束后释放cs并让出总线，下一块重新选中cs
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_chunk_xfer(misaka_spi_t *ops, misaka_spi_message_t *message)
+{
+	misaka_spi_message_t chunk;
+	misaka_spi_message_t *index;
+	uint32_t offset;
+	uint8_t yield, resume = 0;
+
+	chunk.next = NULL;
+	for (index = message; index != NULL; index = index->next)
+	{
+		offset = 0;
+		do
+		{
+			chunk.length = index->length - offset;
+			if (chunk.length > ops->bus->chunk_size)
+			{
+				chunk.length = ops->bus->chunk_size;
+			}
+			chunk.send_buf = index->send_buf != NULL ? index->send_buf + offset : NULL;
+			chunk.recv_buf = index->recv_buf != NULL ? index->recv_buf + offset : NULL;
+			chunk.lines = index->lines;
+			chunk.dummy_cycles = offset == 0 ? index->dummy_cycles : 0;
+			chunk.dc = index->dc;
+			chunk.cs_take = (offset == 0 && index->cs_take) || resume;
+			chunk.cs_release = offset + chunk.length == index->length ? index->cs_release : 0;
+
+			yield = (offset + chunk.length != index->length || index->next != NULL) && misaka_spi_preempt_pending(ops);
+			resume = yield && !chunk.cs_release;
+			if (yield)
+			{
+				chunk.cs_release = 1;
+			}
+
+			if (misaka_spi_submit(ops, &chunk) != 0)
+			{
+				return 1;
+			}
+			offset += chunk.length;
+
+			if (yield && misaka_spi_yield(ops) != 0)
+			{
+				return 1;
+			}
+		} while (offset < index->length);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 仲裁传输，不可抢占设备以cs释放处为界分段提交，段间有更高优先级设备等待时让出总线
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_arbitrate_xfer(misaka_spi_t *ops, misaka_spi_message_t *message)
+{
+	uint8_t result;
+	misaka_spi_message_t *head, *tail, *next;
+
+	if (ops->preemptible)
+	{
+		return misaka_spi_chunk_xfer(ops, message);
+	}
+
+	for (head = message; head != NULL; head = next)
+	{
+		for (tail = head; tail->next != NULL && !tail->cs_release; tail = tail->next)
+		{
+		}
+
+		/** < 临时截断消息链，提交后恢复 */
+		next = tail->next;
+		tail->next = NULL;
+		result = misaka_spi_submit(ops, head);
+		tail->next = next;
+
+		if (result != 0)
+		{
+			return 1;
+		}
+
+		if (next != NULL && misaka_spi_preempt_pending(ops) && misaka_spi_yield(ops) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 传输整条消息链，调用前需已获取总线
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_chain_xfer(misaka_spi_t *ops, misaka_spi_message_t *message)
+{
+	uint8_t result;
+
+	misaka_spi_stat_chain(ops, message);
+
+	/** < 会话期间cs必须保持有效，不参与仲裁；没有更高优先级的设备时整条提交 */
+	if (ops->bus->chunk_size == 0 || ops->session || !misaka_spi_outranked(ops))
+	{
+		result = misaka_spi_submit(ops, message);
+	}
+	else
+	{
+		result = misaka_spi_arbitrate_xfer(ops, message);
+	}
+
+	if (result != 0)
 	{
-		ops->set_cs(1);
+		misaka_spi_stat_failure(ops);
 	}
 
-	return message->length;
+	return result;
+}
+
+/**
+ * @brief 配置spi设备，在下一次传输时生效
+ * @param ops spi设备
+ * @param cfg 配置
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_configure(misaka_spi_t *ops, misaka_spi_configuration_t *cfg)
+{
+	misaka_spi_assert(ops != NULL);
+	misaka_spi_assert(ops->bus != NULL);
+	misaka_spi_assert(cfg != NULL);
+
+	ops->bus->ops->mutex_take(ops->bus->ctx);
+	ops->config.mode = cfg->mode & MISAKA_SPI_MODE_MASK;
+	ops->config.data_width = cfg->data_width;
+	ops->config.max_hz = cfg->max_hz;
+	if (ops->bus->owner == ops)
+	{
+		ops->bus->owner = NULL;
+	}
+	ops->bus->ops->mutex_release(ops->bus->ctx);
+
+	return 0;
 }
 
 /**
@@ -105,46 +616,42 @@ static uint32_t misaka_spi_xfer(misaka_spi_t *ops, misaka_spi_message_t *message
  */
 uint8_t misaka_spi_send_then_send(misaka_spi_t *ops, uint8_t *txbuf1, uint32_t txlen1, uint8_t *txbuf2, uint32_t txlen2)
 {
-	uint32_t result;
-	misaka_spi_message_t message;
+	uint8_t result;
+	misaka_spi_message_t message[2];
 
 	misaka_spi_assert(ops != NULL);
 	misaka_spi_assert(ops->bus != NULL);
 
 	/** < 发送数据1 */
-	message.send_buf = txbuf1;
-	message.recv_buf = NULL;
-	message.length = txlen1;
-	message.cs_take = 1;
-	message.cs_release = 0;
-	message.next = NULL;
-
-	ops->bus->mutex_take();
-	result = misaka_spi_xfer(ops, &message);
-	if (result == 0)
-	{
-		goto __exit;
-	}
-
-	/** < 发送数据1 */
-	message.send_buf = txbuf2;
-	message.recv_buf = NULL;
-	message.length = txlen2;
-	message.cs_take = 0;
-	message.cs_release = 1;
-	message.next = NULL;
+	message[0].send_buf = txbuf1;
+	message[0].recv_buf = NULL;
+	message[0].length = txlen1;
+	message[0].cs_take = 1;
+	message[0].cs_release = 0;
+	message[0].next = &message[1];
+	message[0].lines = MISAKA_SPI_LINES_SINGLE;
+	message[0].dummy_cycles = 0;
+	message[0].dc = MISAKA_SPI_DC_NONE;
 
-	result = misaka_spi_xfer(ops, &message);
+	/** < 发送数据2 */
+	message[1].send_buf = txbuf2;
+	message[1].recv_buf = NULL;
+	message[1].length = txlen2;
+	message[1].cs_take = 0;
+	message[1].cs_release = 1;
+	message[1].next = NULL;
+	message[1].lines = MISAKA_SPI_LINES_SINGLE;
+	message[1].dummy_cycles = 0;
+	message[1].dc = MISAKA_SPI_DC_NONE;
 
-	if (result == 0)
+	if (misaka_spi_take_bus(ops) != 0)
 	{
-		goto __exit;
+		return 1;
 	}
+	result = misaka_spi_chain_xfer(ops, message);
+	misaka_spi_release_bus(ops);
 
-	__exit:
-	ops->bus->mutex_release();
-
-	return result ? 1 : 0;
+	return result;
 }
 
 /**
@@ -158,45 +665,42 @@ uint8_t misaka_spi_send_then_send(misaka_spi_t *ops, uint8_t *txbuf1, uint32_t t
  */
 uint8_t misaka_spi_send_then_recv(misaka_spi_t *ops, uint8_t *txbuf, uint32_t txlen, uint8_t *rxbuf, uint32_t rxlen)
 {
-	uint32_t result;
-	misaka_spi_message_t message;
+	uint8_t result;
+	misaka_spi_message_t message[2];
 
-	misaka_spi_assert(ops != RT_NULL);
-	misaka_spi_assert(ops->bus != RT_NULL);
+	misaka_spi_assert(ops != NULL);
+	misaka_spi_assert(ops->bus != NULL);
 
 	/** < 发送数据 */
-	message.send_buf = txbuf;
-	message.recv_buf = NULL;
-	message.length = txlen;
-	message.cs_take = 1;
-	message.cs_release = 0;
-	message.next = NULL;
-
-	ops->bus->mutex_take();
-	result = misaka_spi_xfer(ops, &message);
-	if (result == 0)
-	{
-		goto __exit;
-	}
+	message[0].send_buf = txbuf;
+	message[0].recv_buf = NULL;
+	message[0].length = txlen;
+	message[0].cs_take = 1;
+	message[0].cs_release = 0;
+	message[0].next = &message[1];
+	message[0].lines = MISAKA_SPI_LINES_SINGLE;
+	message[0].dummy_cycles = 0;
+	message[0].dc = MISAKA_SPI_DC_NONE;
 
 	/** < 接收数据 */
-	message.send_buf = NULL;
-	message.recv_buf = rxbuf;
-	message.length = rxlen;
-	message.cs_take = 0;
-	message.cs_release = 1;
-	message.next = NULL;
+	message[1].send_buf = NULL;
+	message[1].recv_buf = rxbuf;
+	message[1].length = rxlen;
+	message[1].cs_take = 0;
+	message[1].cs_release = 1;
+	message[1].next = NULL;
+	message[1].lines = MISAKA_SPI_LINES_SINGLE;
+	message[1].dummy_cycles = 0;
+	message[1].dc = MISAKA_SPI_DC_NONE;
 
-	result = misaka_spi_xfer(ops, &message);
-	if (result == 0)
+	if (misaka_spi_take_bus(ops) != 0)
 	{
-		goto __exit;
+		return 1;
 	}
+	result = misaka_spi_chain_xfer(ops, message);
+	misaka_spi_release_bus(ops);
 
-	__exit:
-	ops->bus->mutex_release();
-
-	return result ? 1 : 0;
+	return result;
 }
 
 /**
@@ -209,11 +713,11 @@ uint8_t misaka_spi_send_then_recv(misaka_spi_t *ops, uint8_t *txbuf, uint32_t tx
  */
 uint8_t misaka_spi_transfer(misaka_spi_t *ops, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
 {
-	uint32_t result;
+	uint8_t result;
 	misaka_spi_message_t message;
 
-	misaka_spi_assert(ops != RT_NULL);
-	misaka_spi_assert(ops->bus != RT_NULL);
+	misaka_spi_assert(ops != NULL);
+	misaka_spi_assert(ops->bus != NULL);
 
 	message.send_buf = txbuf;
 	message.recv_buf = rxbuf;
@@ -221,18 +725,18 @@ uint8_t misaka_spi_transfer(misaka_spi_t *ops, uint8_t *txbuf, uint8_t *rxbuf, u
 	message.cs_take = 1;
 	message.cs_release = 1;
 	message.next = NULL;
+	message.lines = MISAKA_SPI_LINES_SINGLE;
+	message.dummy_cycles = 0;
+	message.dc = MISAKA_SPI_DC_NONE;
 
-	ops->bus->mutex_take();
-	result = misaka_spi_xfer(ops, &message);
-	if (result == 0)
+	if (misaka_spi_take_bus(ops) != 0)
 	{
-		goto __exit;
+		return 1;
 	}
+	result = misaka_spi_chain_xfer(ops, &message);
+	misaka_spi_release_bus(ops);
 
-	__exit:
-	ops->bus->mutex_release();
-
-	return result ? 1 : 0;
+	return result;
 }
 
 /**
@@ -243,33 +747,23 @@ uint8_t misaka_spi_transfer(misaka_spi_t *ops, uint8_t *txbuf, uint8_t *rxbuf, u
  */
 uint8_t misaka_spi_transfer_message(misaka_spi_t *ops, misaka_spi_message_t *message)
 {
-	uint32_t result;
-	misaka_spi_message_t *index;
+	uint8_t result;
 
 	misaka_spi_assert(ops != NULL);
 
-	index = message;
-	if (index == NULL)
+	if (message == NULL)
 	{
 		return 1;
 	}
 
-	ops->bus->mutex_take();
-	while (index != NULL)
+	if (misaka_spi_take_bus(ops) != 0)
 	{
-		result = misaka_spi_xfer(ops, index);
-		if (result == 0)
-		{
-			goto __exit;
-		}
-
-		index = index->next;
+		return 1;
 	}
+	result = misaka_spi_chain_xfer(ops, message);
+	misaka_spi_release_bus(ops);
 
-	__exit:
-	ops->bus->mutex_release();
-
-	return result ? 1 : 0;
+	return result;
 }
 
 /**
@@ -296,3 +790,315 @@ uint8_t misaka_spi_recv(misaka_spi_t *ops, uint8_t *rxbuf, uint32_t length)
 	return misaka_spi_transfer(ops, NULL, rxbuf, length);
 }
 
+/**
+ * @brief 会话内传输，cs在首次传输时选中并保持有效
+ * @param ops spi设备
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_session_xfer(misaka_spi_t *ops, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	misaka_spi_message_t message;
+
+	misaka_spi_assert(ops != NULL);
+
+	if (!ops->session)
+	{
+		return 1;
+	}
+
+	message.send_buf = txbuf;
+	message.recv_buf = rxbuf;
+	message.length = length;
+	message.cs_take = 1;
+	message.cs_release = 0;
+	message.next = NULL;
+	message.lines = MISAKA_SPI_LINES_SINGLE;
+	message.dummy_cycles = 0;
+	message.dc = MISAKA_SPI_DC_NONE;
+
+	return misaka_spi_chain_xfer(ops, &message);
+}
+
+/**
+ * @brief 打开会话：获取总线并保持到关闭，会话内的传输之间cs保持有效；会话期间不可调用misaka_spi_configure等其他接口
+ * @param ops spi设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_open(misaka_spi_t *ops)
+{
+	misaka_spi_assert(ops != NULL);
+
+	if (misaka_spi_take_bus(ops) != 0)
+	{
+		return 1;
+	}
+	ops->session = 1;
+
+	return 0;
+}
+
+/**
+ * @brief 会话内发送数据
+ * @param ops spi设备
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_send(misaka_spi_t *ops, uint8_t *txbuf, uint32_t length)
+{
+	return misaka_spi_session_xfer(ops, txbuf, NULL, length);
+}
+
+/**
+ * @brief 会话内接收数据
+ * @param ops spi设备
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_recv(misaka_spi_t *ops, uint8_t *rxbuf, uint32_t length)
+{
+	return misaka_spi_session_xfer(ops, NULL, rxbuf, length);
+}
+
+/**
+ * @brief 会话内传输数据
+ * @param ops spi设备
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_transfer(misaka_spi_t *ops, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	return misaka_spi_session_xfer(ops, txbuf, rxbuf, length);
+}
+
+/**
+ * @brief 会话内提交消息链，各段的cs_take/cs_release由会话改写为保持cs有效
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_message(misaka_spi_t *ops, misaka_spi_message_t *message)
+{
+	misaka_spi_message_t *index;
+
+	misaka_spi_assert(ops != NULL);
+
+	if (!ops->session || message == NULL)
+	{
+		return 1;
+	}
+
+	for (index = message; index != NULL; index = index->next)
+	{
+		index->cs_take = 0;
+		index->cs_release = 0;
+	}
+	message->cs_take = 1;
+
+	return misaka_spi_chain_xfer(ops, message);
+}
+
+/**
+ * @brief 会话内按消息链自身的cs_take/cs_release提交，不改写消息，同一条链可反复提交
+ * @param ops spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_chain(misaka_spi_t *ops, misaka_spi_message_t *message)
+{
+	misaka_spi_assert(ops != NULL);
+
+	if (!ops->session || message == NULL)
+	{
+		return 1;
+	}
+
+	return misaka_spi_chain_xfer(ops, message);
+}
+
+/**
+ * @brief 关闭会话：释放cs与总线
+ * @param ops spi设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_session_close(misaka_spi_t *ops)
+{
+	uint8_t result;
+	misaka_spi_message_t message;
+
+	misaka_spi_assert(ops != NULL);
+
+	if (!ops->session)
+	{
+		return 1;
+	}
+
+	/** < 空消息只释放cs，cs未选中时不产生set_cs */
+	message.send_buf = NULL;
+	message.recv_buf = NULL;
+	message.length = 0;
+	message.cs_take = 0;
+	message.cs_release = 1;
+	message.next = NULL;
+	message.lines = MISAKA_SPI_LINES_SINGLE;
+	message.dummy_cycles = 0;
+	message.dc = MISAKA_SPI_DC_NONE;
+
+	result = misaka_spi_submit(ops, &message);
+	ops->session = 0;
+	misaka_spi_release_bus(ops);
+
+	return result;
+}
+
+/**
+ * 旧式函数的适配操作表：总线的ctx为misaka_spi_legacy_bus_t，设备的cs_ctx为misaka_spi_legacy_cs_t，
+ * 各函数转发到不带上下文的函数，可选操作为NULL，核心层按单线逐段传输
+ */
+static uint8_t misaka_spi_legacy_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	return ((misaka_spi_legacy_bus_t *) ctx)->send_recv(txbuf, rxbuf, length);
+}
+
+static uint8_t misaka_spi_legacy_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	return ((misaka_spi_legacy_bus_t *) ctx)->send(txbuf, length);
+}
+
+static uint8_t misaka_spi_legacy_recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	return ((misaka_spi_legacy_bus_t *) ctx)->recv(rxbuf, length);
+}
+
+static void misaka_spi_legacy_mutex_take(void *ctx)
+{
+	((misaka_spi_legacy_bus_t *) ctx)->mutex_take();
+}
+
+static void misaka_spi_legacy_mutex_release(void *ctx)
+{
+	((misaka_spi_legacy_bus_t *) ctx)->mutex_release();
+}
+
+static void misaka_spi_legacy_set_cs(void *ctx, uint8_t state)
+{
+	((misaka_spi_legacy_cs_t *) ctx)->set_cs(state);
+}
+
+static const misaka_spi_bus_ops_t s_misaka_spi_legacy_ops = {
+	misaka_spi_legacy_send_recv,
+	misaka_spi_legacy_send,
+	misaka_spi_legacy_recv,
+	misaka_spi_legacy_mutex_take,
+	misaka_spi_legacy_mutex_release,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+
+static const misaka_spi_cs_ops_t s_misaka_spi_legacy_cs_ops = {
+	misaka_spi_legacy_set_cs,
+	NULL,
+};
+
+/**
+ * @brief 以不带上下文的旧式函数初始化总线，总线经内部的适配操作表调用这些函数
+ * @param bus spi总线
+ * @param legacy 旧式总线函数，需在总线使用期间保持有效
+ */
+void misaka_spi_legacy_bus_init(misaka_spi_bus_t *bus, misaka_spi_legacy_bus_t *legacy)
+{
+	misaka_spi_assert(bus != NULL);
+	misaka_spi_assert(legacy != NULL);
+
+	memset(bus, 0, sizeof(misaka_spi_bus_t));
+	bus->ops = &s_misaka_spi_legacy_ops;
+	bus->ctx = legacy;
+}
+
+/**
+ * @brief 以不带上下文的旧式cs函数初始化设备，配置为模式0、高位在前、8位，其余为0
+ * @param device spi设备
+ * @param bus spi总线
+ * @param cs 旧式cs函数，需在设备使用期间保持有效
+ */
+void misaka_spi_legacy_device_init(misaka_spi_t *device, misaka_spi_bus_t *bus, misaka_spi_legacy_cs_t *cs)
+{
+	misaka_spi_assert(device != NULL);
+	misaka_spi_assert(cs != NULL);
+
+	memset(device, 0, sizeof(misaka_spi_t));
+	device->cs_ops = &s_misaka_spi_legacy_cs_ops;
+	device->cs_ctx = cs;
+	device->bus = bus;
+	device->config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	device->config.data_width = 8;
+}
+
+#ifdef MISAKA_SPI_USING_STATISTICS
+/**
+ * @brief 获取设备统计快照
+ * @param ops spi设备
+ * @param stat 统计
+ */
+void misaka_spi_get_statistics(misaka_spi_t *ops, misaka_spi_statistics_t *stat)
+{
+	misaka_spi_assert(ops != NULL);
+	misaka_spi_assert(stat != NULL);
+
+	ops->bus->ops->mutex_take(ops->bus->ctx);
+	memcpy(stat, &ops->stat, sizeof(misaka_spi_statistics_t));
+	ops->bus->ops->mutex_release(ops->bus->ctx);
+}
+
+/**
+ * @brief 清零设备统计
+ * @param ops spi设备
+ */
+void misaka_spi_reset_statistics(misaka_spi_t *ops)
+{
+	misaka_spi_assert(ops != NULL);
+
+	ops->bus->ops->mutex_take(ops->bus->ctx);
+	memset(&ops->stat, 0, sizeof(misaka_spi_statistics_t));
+	ops->bus->ops->mutex_release(ops->bus->ctx);
+}
+
+/**
+ * @brief 获取总线统计快照
+ * @param bus spi总线
+ * @param stat 统计
+ */
+void misaka_spi_bus_get_statistics(misaka_spi_bus_t *bus, misaka_spi_statistics_t *stat)
+{
+	misaka_spi_assert(bus != NULL);
+	misaka_spi_assert(stat != NULL);
+
+	bus->ops->mutex_take(bus->ctx);
+	memcpy(stat, &bus->stat, sizeof(misaka_spi_statistics_t));
+	bus->ops->mutex_release(bus->ctx);
+}
+
+/**
+ * @brief 清零总线统计
+ * @param bus spi总线
+ */
+void misaka_spi_bus_reset_statistics(misaka_spi_bus_t *bus)
+{
+	misaka_spi_assert(bus != NULL);
+
+	bus->ops->mutex_take(bus->ctx);
+	memset(&bus->stat, 0, sizeof(misaka_spi_statistics_t));
+	bus->ops->mutex_release(bus->ctx);
+}
+#endif
@@ -16,65 +16,132 @@
  * ********************************************************************************
  */
 
+#include <string.h>
 #include "misaka_device/spi.h"
 
 static misaka_spi_bus_t s_misaka_spi1_bus_obj;
 misaka_spi_bus_t *misaka_spi1_bus_obj = NULL;
 static misaka_spi_t s_misaka_spi11_obj;
 misaka_spi_t *misaka_spi11_obj = NULL;
+static misaka_spi_t s_misaka_spi12_obj;
+misaka_spi_t *misaka_spi12_obj = NULL;
+
+/**
+ * 共享cs操作表的上下文：同一总线上的多个设备共用一份set_cs，以端口与引脚掩码区分
+ */
+struct spi_cs_pin
+{
+	uint32_t port;/**< gpio端口基址 */
+	uint16_t pin;/**< cs引脚掩码 */
+};
+
+static struct spi_cs_pin s_spi12_cs = {0, 0};
 
 /**
  * @brief 发送接收数据
+ * @param ctx 总线上下文
  * @param txbuf 待发送数据
  * @param rxbuf 待接收数据
  * @param length 待数据长度
  * @return  0:成功 1:失败
  */
-static uint8_t send_recv(uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+static uint8_t send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
 {
 
 }
 
 /**
  * @brief 接收消息
+ * @param ctx 总线上下文
  * @param txbuf 待发送数据
  * @param length 待发送数据长度
  * @return  0:成功 1:失败
  */
-static uint8_t send(uint8_t *txbuf, uint32_t length)
+static uint8_t send(void *ctx, uint8_t *txbuf, uint32_t length)
 {
 
 }
 
 /**
  * @brief 接收消息
+ * @param ctx 总线上下文
  * @param rxbuf 待接收数据
  * @param length 待接收数据长度
  * @return  0:成功 1:失败
  */
-static uint8_t recv(uint8_t *rxbuf, uint32_t length)
+static uint8_t recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+
+}
+
+/**
+ * @brief 配置控制器，仅在占用总线的设备配置变化时调用
+ * @param ctx 总线上下文
+ * @param device spi设备
+ * @param cfg 配置
+ * @return  0:成功 1:失败
+ */
+static uint8_t configure(void *ctx, misaka_spi_t *device, misaka_spi_configuration_t *cfg)
 {
 
 }
 
 /**
  * @brief 获取互斥量，如果为裸机系统，空函数即可
+ * @param ctx 总线上下文
  */
-static void mutex_take()
+static void mutex_take(void *ctx)
 {
 
 }
 
 /**
  * @brief 释放互斥量，如果为裸机系统，空函数即可
+ * @param ctx 总线上下文
  */
-static void mutex_release()
+static void mutex_release(void *ctx)
 {
 
 }
 
 /**
- * @brief 设置cs引脚电平
+ * @brief 进入临界区，保护总线等待计数，如果为裸机系统，空函数即可
+ * @param ctx 总线上下文
+ */
+static void critical_enter(void *ctx)
+{
+
+}
+
+/**
+ * @brief 退出临界区，如果为裸机系统，空函数即可
+ * @param ctx 总线上下文
+ */
+static void critical_exit(void *ctx)
+{
+
+}
+
+/**
+ * 多个同型控制器可共用这一份操作表，以ctx区分寄存器基址
+ */
+static const misaka_spi_bus_ops_t s_spi_bus_ops = {
+	send_recv,
+	send,
+	recv,
+	mutex_take,
+	mutex_release,
+	NULL,/**< transfer_chain：支持链式DMA与硬件cs时可提供，整条消息链一次提交 */
+	configure,
+	NULL,/**< send_lines/recv_lines：控制器支持双线/四线时提供 */
+	NULL,
+	NULL,/**< dummy */
+	critical_enter,/**< chunk_size非0时必须提供 */
+	critical_exit,
+};
+
+/**
+ * @brief 设置cs引脚电平（旧式函数）
  * @param level 0: 低电平 1: 高电平
  */
 static void set_cs(uint8_t state)
@@ -82,20 +149,53 @@ static void set_cs(uint8_t state)
 
 }
 
-static int misaka_spi_port_init()
+static misaka_spi_legacy_cs_t s_spi11_cs = {
+	set_cs,
+};
+
+/**
+ * @brief 设置cs引脚电平（共享操作表）
+ * @param ctx cs引脚
+ * @param state 0: 低电平 1: 高电平
+ */
+static void pin_set_cs(void *ctx, uint8_t state)
 {
 
-	s_misaka_spi1_bus_obj.mutex_release = mutex_release;
-	s_misaka_spi1_bus_obj.mutex_take = mutex_take;
-	s_misaka_spi1_bus_obj.recv = recv;
-	s_misaka_spi1_bus_obj.send = send;
-	s_misaka_spi1_bus_obj.send_recv = send_recv;
+}
+
+static const misaka_spi_cs_ops_t s_spi_cs_pin_ops = {
+	pin_set_cs,
+	NULL,/**< set_dc：显示屏等以D/C区分命令与数据的设备提供 */
+};
+
+static int misaka_spi_port_init()
+{
+	memset(&s_misaka_spi1_bus_obj, 0, sizeof(misaka_spi_bus_t));
+	s_misaka_spi1_bus_obj.ops = &s_spi_bus_ops;
+	s_misaka_spi1_bus_obj.ctx = NULL;/**< 如控制器寄存器基址 */
+	s_misaka_spi1_bus_obj.chunk_size = 0;/**< 大块传输阻塞高优先级设备时设置，如4096 */
+#ifdef MISAKA_SPI_USING_STATISTICS
+	s_misaka_spi1_bus_obj.get_tick_us = NULL;/**< 提供us时间戳后统计等待/占用时间与延时直方图 */
+#endif
 
 	misaka_spi1_bus_obj = &s_misaka_spi1_bus_obj;
 
-	s_misaka_spi11_obj.set_cs = set_cs;
-	s_misaka_spi11_obj.bus = misaka_spi1_bus_obj;
+	/** < 不带上下文的set_cs经适配表接入，配置为模式0、高位在前、8位 */
+	misaka_spi_legacy_device_init(&s_misaka_spi11_obj, misaka_spi1_bus_obj, &s_spi11_cs);
+	s_misaka_spi11_obj.config.max_hz = 1000000;
 	misaka_spi11_obj = &s_misaka_spi11_obj;
 
+	memset(&s_misaka_spi12_obj, 0, sizeof(misaka_spi_t));
+	s_misaka_spi12_obj.cs_ops = &s_spi_cs_pin_ops;
+	s_misaka_spi12_obj.cs_ctx = &s_spi12_cs;
+	s_misaka_spi12_obj.cs_active = 0;/**< 初始化时cs需为高电平 */
+	s_misaka_spi12_obj.bus = misaka_spi1_bus_obj;
+	s_misaka_spi12_obj.config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	s_misaka_spi12_obj.config.data_width = 8;
+	s_misaka_spi12_obj.config.max_hz = 1000000;
+	s_misaka_spi12_obj.priority = 0;
+	s_misaka_spi12_obj.preemptible = 0;
+	misaka_spi12_obj = &s_misaka_spi12_obj;
+
 	return 1;
 }
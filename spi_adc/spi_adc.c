@@ -0,0 +1,192 @@
+/**
+ * @file spi_adc.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/spi_adc.h"
+
+/**
+ * @brief 设置消息链，每个通道一段，各自选中并释放cs以启动转换
+ * @param adc adc
+ */
+static void misaka_spi_adc_build(misaka_spi_adc_t *adc)
+{
+	uint32_t i;
+	misaka_spi_message_t *message;
+
+	for (i = 0; i < adc->channel_num; i++)
+	{
+		message = &adc->message[i];
+		message->send_buf = &adc->tx[i * adc->frame_size];
+		message->recv_buf = &adc->rx[i * adc->frame_size];
+		message->length = adc->frame_size;
+		message->next = i + 1 < adc->channel_num ? &adc->message[i + 1] : NULL;
+		message->cs_take = 1;
+		message->cs_release = 1;
+		message->lines = MISAKA_SPI_LINES_SINGLE;
+		message->dummy_cycles = 0;
+		message->dc = MISAKA_SPI_DC_NONE;
+	}
+}
+
+/**
+ * @brief 初始化，生成扫描表的命令帧与消息链并清空环形缓冲区
+ * @param adc adc
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_adc_init(misaka_spi_adc_t *adc)
+{
+	uint32_t i;
+
+	misaka_spi_assert(adc != NULL);
+	misaka_spi_assert(adc->spi != NULL);
+	misaka_spi_assert(adc->encode != NULL);
+	misaka_spi_assert(adc->decode != NULL);
+
+	if (adc->channel_num == 0 || adc->channel_num > MISAKA_SPI_ADC_CHANNEL_MAX
+		|| adc->frame_size == 0 || adc->frame_size > MISAKA_SPI_ADC_FRAME_MAX
+		|| adc->ring == NULL || adc->ring_size < adc->channel_num || (adc->ring_size & (adc->ring_size - 1)) != 0)
+	{
+		return 1;
+	}
+
+	for (i = 0; i < adc->channel_num; i++)
+	{
+		adc->encode(adc->channels[i], &adc->tx[i * adc->frame_size]);
+	}
+	misaka_spi_adc_build(adc);
+
+	adc->head = 0;
+	adc->tail = 0;
+	adc->scans = 0;
+	adc->overruns = 0;
+	adc->failures = 0;
+
+	return 0;
+}
+
+/**
+ * @brief 扫描一次，整个扫描表在一条消息链中完成，结果写入环形缓冲区，缓冲区不足时丢弃本次扫描并计入overruns
+ * @param adc adc
+ * @return 0:成功 1:传输失败
+ */
+uint8_t misaka_spi_adc_scan(misaka_spi_adc_t *adc)
+{
+	uint32_t i, head, tick;
+	misaka_spi_adc_sample_t *sample;
+
+	misaka_spi_assert(adc != NULL);
+
+	tick = adc->get_tick_us != NULL ? adc->get_tick_us() : 0;
+
+	if (misaka_spi_transfer_message(adc->spi, adc->message) != 0)
+	{
+		adc->failures++;
+		return 1;
+	}
+
+	head = adc->head;
+	if (adc->ring_size - (head - adc->tail) < adc->channel_num)
+	{
+		adc->overruns++;
+		return 0;
+	}
+
+	for (i = 0; i < adc->channel_num; i++)
+	{
+		sample = &adc->ring[(head + i) & (adc->ring_size - 1)];
+		sample->tick = tick;
+		sample->channel = adc->channels[i];
+		sample->value = adc->decode(adc->channels[i], &adc->rx[i * adc->frame_size]);
+	}
+
+	misaka_spi_adc_barrier();
+	adc->head = head + adc->channel_num;
+	adc->scans++;
+
+	return 0;
+}
+
+/**
+ * @brief 可读取的样本数
+ * @param adc adc
+ * @return uint32_t @c 样本数
+ */
+uint32_t misaka_spi_adc_available(misaka_spi_adc_t *adc)
+{
+	misaka_spi_assert(adc != NULL);
+
+	return adc->head - adc->tail;
+}
+
+/**
+ * @brief 读取样本，可与misaka_spi_adc_scan在不同任务/中断中无锁并发调用（单读单写）
+ * @param adc adc
+ * @param samples 样本
+ * @param num 最多读取的样本数
+ * @return uint32_t @c 读取的样本数
+ */
+uint32_t misaka_spi_adc_read(misaka_spi_adc_t *adc, misaka_spi_adc_sample_t *samples, uint32_t num)
+{
+	uint32_t i, tail, available;
+
+	misaka_spi_assert(adc != NULL);
+	misaka_spi_assert(samples != NULL);
+
+	tail = adc->tail;
+	available = adc->head - tail;
+	misaka_spi_adc_barrier();
+
+	if (num > available)
+	{
+		num = available;
+	}
+	for (i = 0; i < num; i++)
+	{
+		samples[i] = adc->ring[(tail + i) & (adc->ring_size - 1)];
+	}
+
+	misaka_spi_adc_barrier();
+	adc->tail = tail + num;
+
+	return num;
+}
+
+/**
+ * @brief MCP3204/MCP3208单端转换命令帧（3字节）
+ * @param channel 通道
+ * @param frame 命令帧
+ */
+void misaka_spi_adc_mcp3208_encode(uint8_t channel, uint8_t *frame)
+{
+	/** < 起始位、单端模式与通道号D2~D0，结果在后两个字节中 */
+	frame[0] = (uint8_t) (0x06 | ((channel >> 2) & 0x01));
+	frame[1] = (uint8_t) ((channel & 0x03) << 6);
+	frame[2] = 0x00;
+}
+
+/**
+ * @brief MCP3204/MCP3208转换结果（12位）
+ * @param channel 通道
+ * @param frame 接收帧
+ * @return uint16_t @c 转换结果
+ */
+uint16_t misaka_spi_adc_mcp3208_decode(uint8_t channel, const uint8_t *frame)
+{
+	(void) channel;
+
+	return (uint16_t) (((frame[1] & 0x0F) << 8) | frame[2]);
+}
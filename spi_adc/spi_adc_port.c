@@ -0,0 +1,62 @@
+/**
+ * @file spi_adc_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/spi_adc.h"
+
+#define SPI_ADC_RING_SIZE       256
+
+static misaka_spi_adc_sample_t s_spi_adc_ring[SPI_ADC_RING_SIZE];
+static misaka_spi_adc_t s_misaka_spi_adc_obj;
+misaka_spi_adc_t *misaka_spi_adc_obj = NULL;
+
+/**
+ * @brief 获取us时间戳
+ * @return uint32_t @c 时间戳
+ */
+static uint32_t get_tick_us(void)
+{
+
+}
+
+static int misaka_spi_adc_port_init(misaka_spi_t *spi)
+{
+	uint8_t i;
+
+	spi->priority = MISAKA_SPI_PRIORITY_NUM - 1;/**< 采样对延时敏感，总线开启仲裁时优先 */
+
+	s_misaka_spi_adc_obj.spi = spi;
+	s_misaka_spi_adc_obj.get_tick_us = get_tick_us;
+	s_misaka_spi_adc_obj.encode = misaka_spi_adc_mcp3208_encode;
+	s_misaka_spi_adc_obj.decode = misaka_spi_adc_mcp3208_decode;
+	s_misaka_spi_adc_obj.frame_size = 3;
+	s_misaka_spi_adc_obj.channel_num = 8;
+	for (i = 0; i < 8; i++)
+	{
+		s_misaka_spi_adc_obj.channels[i] = i;
+	}
+	s_misaka_spi_adc_obj.ring = s_spi_adc_ring;
+	s_misaka_spi_adc_obj.ring_size = SPI_ADC_RING_SIZE;
+
+	if (misaka_spi_adc_init(&s_misaka_spi_adc_obj) != 0)
+	{
+		return 0;
+	}
+	misaka_spi_adc_obj = &s_misaka_spi_adc_obj;
+
+	return 1;
+}
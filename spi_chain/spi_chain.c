@@ -0,0 +1,214 @@
+/**
+ * @file spi_chain.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/spi_chain.h"
+
+/**
+ * 影子状态即发送帧：最远的器件最先移入，因此器件index位于帧的(device_num - 1 - index)处，
+ * 更新直接写入帧中对应位置，刷新时无需拼装。更新与刷新需在同一任务中调用，或由调用者加锁，
+ * 否则发送过程中的更新可能只有一部分进入本帧。
+ */
+
+/**
+ * @brief 器件在帧中的位置
+ * @param chain 级联链
+ * @param index 器件序号
+ * @return uint8_t* @c 器件的影子状态
+ */
+static uint8_t *misaka_spi_chain_at(misaka_spi_chain_t *chain, uint16_t index)
+{
+	return &chain->frame[(uint32_t) (chain->device_num - 1 - index) * chain->device_size];
+}
+
+/**
+ * @brief 初始化，清零影子状态并置脏，首次刷新时输出全0
+ * @param chain 级联链
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_chain_init(misaka_spi_chain_t *chain)
+{
+	uint32_t i, length;
+
+	misaka_spi_assert(chain != NULL);
+	misaka_spi_assert(chain->spi != NULL);
+
+	if (chain->frame == NULL || chain->device_num == 0 || chain->device_size == 0)
+	{
+		return 1;
+	}
+
+	length = (uint32_t) chain->device_num * chain->device_size;
+	for (i = 0; i < length; i++)
+	{
+		chain->frame[i] = 0;
+	}
+
+	chain->dirty = 1;
+	chain->updates = 0;
+	chain->frames = 0;
+	chain->failures = 0;
+
+	return 0;
+}
+
+/**
+ * @brief 获取器件的影子状态
+ * @param chain 级联链
+ * @param index 器件序号，0为最靠近主机（MOSI直连）的器件
+ * @return uint8_t* @c 影子状态，device_size字节，直接修改后需调用misaka_spi_chain_mark
+ */
+uint8_t *misaka_spi_chain_state(misaka_spi_chain_t *chain, uint16_t index)
+{
+	misaka_spi_assert(chain != NULL);
+	misaka_spi_assert(index < chain->device_num);
+
+	return misaka_spi_chain_at(chain, index);
+}
+
+/**
+ * @brief 标记影子状态已被直接修改
+ * @param chain 级联链
+ */
+void misaka_spi_chain_mark(misaka_spi_chain_t *chain)
+{
+	misaka_spi_assert(chain != NULL);
+
+	chain->dirty = 1;
+	chain->updates++;
+}
+
+/**
+ * @brief 写入器件的影子状态，内容不变时不置脏
+ * @param chain 级联链
+ * @param index 器件序号
+ * @param data 器件数据，device_size字节，按移位顺序排列
+ * @return 0:成功 1:序号越界
+ */
+uint8_t misaka_spi_chain_write(misaka_spi_chain_t *chain, uint16_t index, const uint8_t *data)
+{
+	uint8_t i, changed = 0;
+	uint8_t *state;
+
+	misaka_spi_assert(chain != NULL);
+	misaka_spi_assert(data != NULL);
+
+	if (index >= chain->device_num)
+	{
+		return 1;
+	}
+
+	state = misaka_spi_chain_at(chain, index);
+	for (i = 0; i < chain->device_size; i++)
+	{
+		if (state[i] != data[i])
+		{
+			state[i] = data[i];
+			changed = 1;
+		}
+	}
+
+	if (changed)
+	{
+		misaka_spi_chain_mark(chain);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 按掩码修改器件影子状态中的一个字节，内容不变时不置脏
+ * @param chain 级联链
+ * @param index 器件序号
+ * @param offset 字节偏移
+ * @param mask 掩码
+ * @param value 值
+ * @return 0:成功 1:越界
+ */
+uint8_t misaka_spi_chain_update(misaka_spi_chain_t *chain, uint16_t index, uint8_t offset, uint8_t mask, uint8_t value)
+{
+	uint8_t *state;
+	uint8_t data;
+
+	misaka_spi_assert(chain != NULL);
+
+	if (index >= chain->device_num || offset >= chain->device_size)
+	{
+		return 1;
+	}
+
+	state = misaka_spi_chain_at(chain, index) + offset;
+	data = (uint8_t) ((*state & ~mask) | (value & mask));
+	if (data != *state)
+	{
+		*state = data;
+		misaka_spi_chain_mark(chain);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 设置链上的一个输出位，pin按器件序号连续编号，器件内按字节偏移、位0~7编号
+ * @param chain 级联链
+ * @param pin 输出位
+ * @param level 0: 低电平 1: 高电平
+ * @return 0:成功 1:越界
+ */
+uint8_t misaka_spi_chain_write_pin(misaka_spi_chain_t *chain, uint32_t pin, uint8_t level)
+{
+	uint32_t bits;
+	uint8_t mask;
+
+	misaka_spi_assert(chain != NULL);
+
+	bits = (uint32_t) chain->device_size * 8;
+	if (pin >= bits * chain->device_num)
+	{
+		return 1;
+	}
+
+	mask = (uint8_t) (1 << (pin & 0x07));
+
+	return misaka_spi_chain_update(chain, (uint16_t) (pin / bits), (uint8_t) ((pin % bits) >> 3), mask, level ? mask : 0);
+}
+
+/**
+ * @brief 刷新，影子状态有变化时以一次传输发送整条链并由cs锁存，周期任务中调用可将多次更新合并为一帧
+ * @param chain 级联链
+ * @return 0:成功或无需发送 1:失败，保持脏标记以便下次重发
+ */
+uint8_t misaka_spi_chain_flush(misaka_spi_chain_t *chain)
+{
+	misaka_spi_assert(chain != NULL);
+
+	if (!chain->dirty)
+	{
+		return 0;
+	}
+
+	chain->dirty = 0;
+	if (misaka_spi_send(chain->spi, chain->frame, (uint32_t) chain->device_num * chain->device_size) != 0)
+	{
+		chain->dirty = 1;
+		chain->failures++;
+		return 1;
+	}
+	chain->frames++;
+
+	return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file spi_chain_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/spi_chain.h"
+
+#define SPI_CHAIN_DEVICE_NUM    8                       /**< 8片74HC595 */
+#define SPI_CHAIN_DEVICE_SIZE   1
+
+static uint8_t s_spi_chain_frame[SPI_CHAIN_DEVICE_NUM * SPI_CHAIN_DEVICE_SIZE];
+static misaka_spi_chain_t s_misaka_spi_chain_obj;
+misaka_spi_chain_t *misaka_spi_chain_obj = NULL;
+
+/**
+ * 在周期任务（例如1ms）中调用misaka_spi_chain_flush，期间的多次更新合并为一帧
+ */
+static int misaka_spi_chain_port_init(misaka_spi_t *spi)
+{
+	s_misaka_spi_chain_obj.spi = spi;
+	s_misaka_spi_chain_obj.frame = s_spi_chain_frame;
+	s_misaka_spi_chain_obj.device_num = SPI_CHAIN_DEVICE_NUM;
+	s_misaka_spi_chain_obj.device_size = SPI_CHAIN_DEVICE_SIZE;
+
+	if (misaka_spi_chain_init(&s_misaka_spi_chain_obj) != 0)
+	{
+		return 0;
+	}
+	misaka_spi_chain_obj = &s_misaka_spi_chain_obj;
+
+	return 1;
+}
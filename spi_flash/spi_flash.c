@@ -0,0 +1,619 @@
+/**
+ * @file spi_flash.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include <string.h>
+#include "misaka_device/spi_flash.h"
+
+#define MISAKA_SPI_FLASH_CMD_WRSR           0x01
+#define MISAKA_SPI_FLASH_CMD_PP             0x02
+#define MISAKA_SPI_FLASH_CMD_WRDI           0x04
+#define MISAKA_SPI_FLASH_CMD_RDSR           0x05
+#define MISAKA_SPI_FLASH_CMD_WREN           0x06
+#define MISAKA_SPI_FLASH_CMD_FAST_READ      0x0B
+#define MISAKA_SPI_FLASH_CMD_WRSR2          0x31
+#define MISAKA_SPI_FLASH_CMD_RDSR2          0x35
+#define MISAKA_SPI_FLASH_CMD_SFDP           0x5A
+#define MISAKA_SPI_FLASH_CMD_JEDEC_ID       0x9F
+#define MISAKA_SPI_FLASH_CMD_EN4B           0xB7
+#define MISAKA_SPI_FLASH_CMD_CHIP_ERASE     0xC7
+
+#define MISAKA_SPI_FLASH_SR_WIP             (1u << 0)
+
+#define MISAKA_SPI_FLASH_SFDP_SIGNATURE     0x50444653UL
+#define MISAKA_SPI_FLASH_BFPT_DWORDS        16
+
+/**
+ * @brief 小端读取32位
+ * @param buf 数据
+ * @return uint32_t @c 数据
+ */
+static uint32_t misaka_spi_flash_le32(const uint8_t *buf)
+{
+	return (uint32_t) buf[0] | ((uint32_t) buf[1] << 8) | ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24);
+}
+
+/**
+ * @brief 填充指令与地址
+ * @param flash flash设备
+ * @param buf 缓冲区，至少5字节
+ * @param opcode 指令
+ * @param addr 地址
+ * @return uint32_t @c 填充的字节数
+ */
+static uint32_t misaka_spi_flash_fill_cmd(misaka_spi_flash_t *flash, uint8_t *buf, uint8_t opcode, uint32_t addr)
+{
+	uint32_t i = 0;
+
+	buf[i++] = opcode;
+	if (flash->addr_bytes == 4)
+	{
+		buf[i++] = (uint8_t) (addr >> 24);
+	}
+	buf[i++] = (uint8_t) (addr >> 16);
+	buf[i++] = (uint8_t) (addr >> 8);
+	buf[i++] = (uint8_t) addr;
+
+	return i;
+}
+
+/**
+ * @brief 初始化单线消息
+ * @param message 消息
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @param cs_take 是否拉低cs
+ * @param cs_release 是否释放cs
+ * @param next 下一条消息
+ */
+static void misaka_spi_flash_message(misaka_spi_message_t *message, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length,
+                                     uint8_t cs_take, uint8_t cs_release, misaka_spi_message_t *next)
+{
+	message->send_buf = txbuf;
+	message->recv_buf = rxbuf;
+	message->length = length;
+	message->next = next;
+	message->cs_take = cs_take;
+	message->cs_release = cs_release;
+	message->lines = MISAKA_SPI_LINES_SINGLE;
+	message->dummy_cycles = 0;
+	message->dc = MISAKA_SPI_DC_NONE;
+}
+
+/**
+ * @brief 读状态寄存器
+ * @param flash flash设备
+ * @param opcode 读状态指令
+ * @param status 状态
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_read_status(misaka_spi_flash_t *flash, uint8_t opcode, uint8_t *status)
+{
+	return misaka_spi_send_then_recv(flash->spi, &opcode, 1, status, 1);
+}
+
+/**
+ * @brief 等待编程或擦除完成，提供delay_us时先等待典型时间，之后以其1/8为间隔查询
+ * @param flash flash设备
+ * @param typ_us 典型时间，0表示直接查询
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_wait(misaka_spi_flash_t *flash, uint32_t typ_us)
+{
+	uint8_t status;
+	uint32_t i;
+	uint32_t step_us = (typ_us >> 3) ? (typ_us >> 3) : 1;
+
+	if (flash->delay_us != NULL && typ_us != 0)
+	{
+		flash->delay_us(typ_us);
+	}
+
+	for (i = 0; i < MISAKA_SPI_FLASH_POLL_MAX; i++)
+	{
+		if (misaka_spi_flash_read_status(flash, MISAKA_SPI_FLASH_CMD_RDSR, &status) != 0)
+		{
+			return 1;
+		}
+		if (!(status & MISAKA_SPI_FLASH_SR_WIP))
+		{
+			flash->busy = 0;
+			return 0;
+		}
+		if (flash->delay_us != NULL)
+		{
+			flash->delay_us(step_us);
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief 写使能后发送指令（可附带数据），一条消息链完成
+ * @param flash flash设备
+ * @param cmd 指令与地址
+ * @param cmdlen 指令与地址长度
+ * @param data 数据，可为NULL
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_write_cmd(misaka_spi_flash_t *flash, uint8_t *cmd, uint32_t cmdlen, uint8_t *data, uint32_t len)
+{
+	uint8_t wren = MISAKA_SPI_FLASH_CMD_WREN;
+	misaka_spi_message_t message[3];
+
+	misaka_spi_flash_message(&message[0], &wren, NULL, 1, 1, 1, &message[1]);
+	if (data != NULL && len != 0)
+	{
+		misaka_spi_flash_message(&message[1], cmd, NULL, cmdlen, 1, 0, &message[2]);
+		misaka_spi_flash_message(&message[2], data, NULL, len, 0, 1, NULL);
+	}
+	else
+	{
+		misaka_spi_flash_message(&message[1], cmd, NULL, cmdlen, 1, 1, NULL);
+	}
+
+	return misaka_spi_transfer_message(flash->spi, message);
+}
+
+/**
+ * @brief 读sfdp
+ * @param flash flash设备
+ * @param addr sfdp地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_read_sfdp(misaka_spi_flash_t *flash, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	uint8_t cmd[5];
+
+	cmd[0] = MISAKA_SPI_FLASH_CMD_SFDP;
+	cmd[1] = (uint8_t) (addr >> 16);
+	cmd[2] = (uint8_t) (addr >> 8);
+	cmd[3] = (uint8_t) addr;
+	cmd[4] = 0xFF;
+
+	return misaka_spi_send_then_recv(flash->spi, cmd, sizeof(cmd), buf, len);
+}
+
+/**
+ * @brief 擦除时间单位换算
+ * @param count 计数
+ * @param units 单位 0: 1ms 1: 16ms 2: 128ms 3: 1s
+ * @return uint32_t @c 时间(us)
+ */
+static uint32_t misaka_spi_flash_erase_time(uint32_t count, uint32_t units)
+{
+	static const uint32_t unit_us[4] = {1000UL, 16000UL, 128000UL, 1000000UL};
+
+	return (count + 1) * unit_us[units & 0x03];
+}
+
+/**
+ * @brief 使能四线模式
+ * @param flash flash设备
+ * @param qer sfdp中的quad enable requirements
+ * @return 0:成功 1:失败或不支持
+ */
+static uint8_t misaka_spi_flash_enable_quad(misaka_spi_flash_t *flash, uint8_t qer)
+{
+	uint8_t sr[3];
+
+	switch (qer)
+	{
+	case 0:
+		return 0;
+	case 1:
+	case 4:
+	case 5:
+		if (misaka_spi_flash_read_status(flash, MISAKA_SPI_FLASH_CMD_RDSR, &sr[1]) != 0
+			|| misaka_spi_flash_read_status(flash, MISAKA_SPI_FLASH_CMD_RDSR2, &sr[2]) != 0)
+		{
+			return 1;
+		}
+		if (sr[2] & 0x02)
+		{
+			return 0;
+		}
+		sr[0] = MISAKA_SPI_FLASH_CMD_WRSR;
+		sr[2] |= 0x02;
+		if (misaka_spi_flash_write_cmd(flash, sr, 3, NULL, 0) != 0)
+		{
+			return 1;
+		}
+		break;
+	case 2:
+		if (misaka_spi_flash_read_status(flash, MISAKA_SPI_FLASH_CMD_RDSR, &sr[1]) != 0)
+		{
+			return 1;
+		}
+		if (sr[1] & 0x40)
+		{
+			return 0;
+		}
+		sr[0] = MISAKA_SPI_FLASH_CMD_WRSR;
+		sr[1] |= 0x40;
+		if (misaka_spi_flash_write_cmd(flash, sr, 2, NULL, 0) != 0)
+		{
+			return 1;
+		}
+		break;
+	case 6:
+		if (misaka_spi_flash_read_status(flash, MISAKA_SPI_FLASH_CMD_RDSR2, &sr[1]) != 0)
+		{
+			return 1;
+		}
+		if (sr[1] & 0x02)
+		{
+			return 0;
+		}
+		sr[0] = MISAKA_SPI_FLASH_CMD_WRSR2;
+		sr[1] |= 0x02;
+		if (misaka_spi_flash_write_cmd(flash, sr, 2, NULL, 0) != 0)
+		{
+			return 1;
+		}
+		break;
+	default:
+		return 1;
+	}
+
+	return misaka_spi_flash_wait(flash, 0);
+}
+
+/**
+ * @brief 解析sfdp中的基本参数表
+ * @param flash flash设备
+ * @return 0:成功 1:无sfdp或解析失败
+ */
+static uint8_t misaka_spi_flash_parse_sfdp(misaka_spi_flash_t *flash)
+{
+	uint8_t header[8];
+	uint8_t param[MISAKA_SPI_FLASH_BFPT_DWORDS * 4];
+	uint32_t dw[MISAKA_SPI_FLASH_BFPT_DWORDS];
+	uint32_t i, j, nph, ptp, dwords;
+	uint8_t can_quad, can_dual, qer;
+	misaka_spi_flash_erase_t erase;
+
+	if (misaka_spi_flash_read_sfdp(flash, 0, header, sizeof(header)) != 0
+		|| misaka_spi_flash_le32(header) != MISAKA_SPI_FLASH_SFDP_SIGNATURE)
+	{
+		return 1;
+	}
+
+	/** < 查找jedec基本参数表 */
+	nph = (uint32_t) header[6] + 1;
+	dwords = 0;
+	ptp = 0;
+	for (i = 0; i < nph; i++)
+	{
+		if (misaka_spi_flash_read_sfdp(flash, 8 + i * 8, header, sizeof(header)) != 0)
+		{
+			return 1;
+		}
+		if (header[0] == 0x00 && header[7] == 0xFF)
+		{
+			dwords = header[3];
+			ptp = (uint32_t) header[4] | ((uint32_t) header[5] << 8) | ((uint32_t) header[6] << 16);
+			break;
+		}
+	}
+	if (dwords < 9)
+	{
+		return 1;
+	}
+	if (dwords > MISAKA_SPI_FLASH_BFPT_DWORDS)
+	{
+		dwords = MISAKA_SPI_FLASH_BFPT_DWORDS;
+	}
+
+	memset(param, 0xFF, sizeof(param));
+	if (misaka_spi_flash_read_sfdp(flash, ptp, param, dwords * 4) != 0)
+	{
+		return 1;
+	}
+	for (i = 0; i < MISAKA_SPI_FLASH_BFPT_DWORDS; i++)
+	{
+		dw[i] = i < dwords ? misaka_spi_flash_le32(&param[i * 4]) : 0;
+	}
+
+	/** < 容量 */
+	if (dw[1] & 0x80000000UL)
+	{
+		if ((dw[1] & 0x7FFFFFFFUL) < 35)
+		{
+			flash->capacity = 1UL << ((dw[1] & 0x7FFFFFFFUL) - 3);
+		}
+	}
+	else
+	{
+		flash->capacity = (dw[1] + 1) >> 3;
+	}
+
+	/** < 地址字节数 */
+	if (((dw[0] >> 17) & 0x03) == 0x02 || flash->capacity > 0x01000000UL)
+	{
+		flash->addr_bytes = 4;
+	}
+
+	/** < 擦除类型 */
+	for (i = 0; i < MISAKA_SPI_FLASH_ERASE_TYPE_MAX; i++)
+	{
+		j = (dw[7 + (i >> 1)] >> ((i & 1) * 16)) & 0xFFFF;
+		flash->erase[i].size = (j & 0xFF) ? (1UL << (j & 0xFF)) : 0;
+		flash->erase[i].opcode = (uint8_t) (j >> 8);
+		flash->erase[i].typ_us = 0;
+		if (dwords >= 10 && flash->erase[i].size != 0)
+		{
+			j = dw[9] >> (4 + i * 7);
+			flash->erase[i].typ_us = misaka_spi_flash_erase_time(j & 0x1F, (j >> 5) & 0x03);
+		}
+	}
+	for (i = 1; i < MISAKA_SPI_FLASH_ERASE_TYPE_MAX; i++)
+	{
+		for (j = i; j > 0 && (flash->erase[j - 1].size == 0 ||
+		                      (flash->erase[j].size != 0 && flash->erase[j].size < flash->erase[j - 1].size)); j--)
+		{
+			erase = flash->erase[j];
+			flash->erase[j] = flash->erase[j - 1];
+			flash->erase[j - 1] = erase;
+		}
+	}
+
+	/** < 页大小与编程时间 */
+	if (dwords >= 11)
+	{
+		flash->page_size = 1UL << ((dw[10] >> 4) & 0x0F);
+		flash->program_typ_us = (((dw[10] >> 8) & 0x1F) + 1) * ((dw[10] & (1UL << 13)) ? 64 : 8);
+	}
+
+	/** < 读指令，控制器支持时优先四线，其次双线 */
+	can_quad = (dw[0] & (1UL << 22)) && flash->spi->bus->ops->recv_lines != NULL;
+	can_dual = (dw[0] & (1UL << 16)) && flash->spi->bus->ops->recv_lines != NULL;
+	qer = dwords >= 15 ? (uint8_t) ((dw[14] >> 20) & 0x07) : 0;
+	if (can_quad && misaka_spi_flash_enable_quad(flash, qer) == 0)
+	{
+		flash->read_opcode = (uint8_t) (dw[2] >> 24);
+		flash->read_dummy = (uint8_t) (((dw[2] >> 16) & 0x1F) + ((dw[2] >> 21) & 0x07));
+		flash->read_lines = MISAKA_SPI_LINES_QUAD;
+	}
+	else if (can_dual)
+	{
+		flash->read_opcode = (uint8_t) (dw[3] >> 8);
+		flash->read_dummy = (uint8_t) ((dw[3] & 0x1F) + ((dw[3] >> 5) & 0x07));
+		flash->read_lines = MISAKA_SPI_LINES_DUAL;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 初始化，读取jedec id并解析sfdp，无sfdp时使用通用参数
+ * @param flash flash设备，需已设置spi
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_init(misaka_spi_flash_t *flash)
+{
+	uint8_t cmd;
+
+	misaka_spi_assert(flash != NULL);
+	misaka_spi_assert(flash->spi != NULL);
+
+	/** < 通用参数 */
+	flash->capacity = 0;
+	flash->page_size = 256;
+	flash->program_typ_us = 0;
+	flash->addr_bytes = 3;
+	flash->read_opcode = MISAKA_SPI_FLASH_CMD_FAST_READ;
+	flash->read_dummy = 8;
+	flash->read_lines = MISAKA_SPI_LINES_SINGLE;
+	memset(flash->erase, 0, sizeof(flash->erase));
+	flash->erase[0].opcode = 0x20;
+	flash->erase[0].size = 4096;
+	flash->erase[1].opcode = 0xD8;
+	flash->erase[1].size = 65536;
+	flash->busy = 0;
+
+	cmd = MISAKA_SPI_FLASH_CMD_JEDEC_ID;
+	if (misaka_spi_send_then_recv(flash->spi, &cmd, 1, flash->jedec_id, 3) != 0)
+	{
+		return 1;
+	}
+	if ((flash->jedec_id[0] == 0xFF && flash->jedec_id[1] == 0xFF) || (flash->jedec_id[0] == 0x00 && flash->jedec_id[1] == 0x00))
+	{
+		return 1;
+	}
+	if (flash->jedec_id[2] >= 10 && flash->jedec_id[2] < 32)
+	{
+		flash->capacity = 1UL << flash->jedec_id[2];
+	}
+
+	misaka_spi_flash_parse_sfdp(flash);
+
+	if (flash->addr_bytes == 4)
+	{
+		cmd = MISAKA_SPI_FLASH_CMD_EN4B;
+		if (misaka_spi_send(flash->spi, &cmd, 1) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 读数据，一条消息链完成指令、地址、空周期与数据阶段
+ * @param flash flash设备
+ * @param addr 地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_read(misaka_spi_flash_t *flash, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	uint8_t cmd[5];
+	misaka_spi_message_t message[2];
+
+	misaka_spi_assert(flash != NULL);
+
+	if (len == 0)
+	{
+		return 0;
+	}
+	if (flash->busy && misaka_spi_flash_wait(flash, 0) != 0)
+	{
+		return 1;
+	}
+
+	misaka_spi_flash_message(&message[0], cmd, NULL, misaka_spi_flash_fill_cmd(flash, cmd, flash->read_opcode, addr), 1, 0, &message[1]);
+	misaka_spi_flash_message(&message[1], NULL, buf, len, 0, 1, NULL);
+	message[1].lines = flash->read_lines;
+	message[1].dummy_cycles = flash->read_dummy;
+
+	return misaka_spi_transfer_message(flash->spi, message);
+}
+
+/**
+ * @brief 写数据，按页拆分编程，最后一页发出后立即返回，由下一次操作或misaka_spi_flash_sync等待完成
+ * @param flash flash设备
+ * @param addr 地址
+ * @param buf 待写入数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_write(misaka_spi_flash_t *flash, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	uint8_t cmd[5];
+	uint32_t size;
+	uint32_t typ_us = 0;
+
+	misaka_spi_assert(flash != NULL);
+
+	while (len)
+	{
+		size = flash->page_size - (addr & (flash->page_size - 1));
+		if (size > len)
+		{
+			size = len;
+		}
+
+		if (flash->busy && misaka_spi_flash_wait(flash, typ_us) != 0)
+		{
+			return 1;
+		}
+
+		if (misaka_spi_flash_write_cmd(flash, cmd, misaka_spi_flash_fill_cmd(flash, cmd, MISAKA_SPI_FLASH_CMD_PP, addr), buf, size) != 0)
+		{
+			return 1;
+		}
+		flash->busy = 1;
+		typ_us = flash->program_typ_us;
+
+		addr += size;
+		buf += size;
+		len -= size;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 擦除，每次选用能覆盖剩余区域的最大擦除块，地址与长度需按最小擦除块对齐
+ * @param flash flash设备
+ * @param addr 地址
+ * @param len 长度
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_erase(misaka_spi_flash_t *flash, uint32_t addr, uint32_t len)
+{
+	uint8_t cmd[5];
+	int8_t i;
+	uint32_t typ_us = 0;
+	misaka_spi_flash_erase_t *erase;
+
+	misaka_spi_assert(flash != NULL);
+
+	if (addr == 0 && len != 0 && len == flash->capacity)
+	{
+		if (flash->busy && misaka_spi_flash_wait(flash, 0) != 0)
+		{
+			return 1;
+		}
+		cmd[0] = MISAKA_SPI_FLASH_CMD_CHIP_ERASE;
+		if (misaka_spi_flash_write_cmd(flash, cmd, 1, NULL, 0) != 0)
+		{
+			return 1;
+		}
+		flash->busy = 1;
+		return 0;
+	}
+
+	while (len)
+	{
+		erase = NULL;
+		for (i = MISAKA_SPI_FLASH_ERASE_TYPE_MAX - 1; i >= 0; i--)
+		{
+			if (flash->erase[i].size != 0 && flash->erase[i].size <= len && (addr & (flash->erase[i].size - 1)) == 0)
+			{
+				erase = &flash->erase[i];
+				break;
+			}
+		}
+		if (erase == NULL)
+		{
+			return 1;
+		}
+
+		if (flash->busy && misaka_spi_flash_wait(flash, typ_us) != 0)
+		{
+			return 1;
+		}
+
+		if (misaka_spi_flash_write_cmd(flash, cmd, misaka_spi_flash_fill_cmd(flash, cmd, erase->opcode, addr), NULL, 0) != 0)
+		{
+			return 1;
+		}
+		flash->busy = 1;
+		typ_us = erase->typ_us;
+
+		addr += erase->size;
+		len -= erase->size;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 等待上一次编程或擦除完成
+ * @param flash flash设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_flash_sync(misaka_spi_flash_t *flash)
+{
+	misaka_spi_assert(flash != NULL);
+
+	if (!flash->busy)
+	{
+		return 0;
+	}
+
+	return misaka_spi_flash_wait(flash, 0);
+}
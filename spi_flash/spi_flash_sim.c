@@ -0,0 +1,530 @@
+/**
+ * @file spi_flash_sim.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 仿真flash：按字节解析spi nor指令，提供jedec id、sfdp（4K/32K/64K擦除，256字节页，1-1-2与1-1-4快速读）、
+ * 读、页编程、扇区/块/整片擦除与状态寄存器。编程与擦除后在busy_polls次状态读取内保持忙，忙时忽略其余指令。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_flash.h"
+
+#define MISAKA_SPI_FLASH_SIM_PAGE_SIZE  256
+
+struct misaka_spi_flash_sim_struct
+{
+	uint8_t *mem;
+	uint32_t size;
+	uint32_t busy_polls;
+
+	uint8_t selected;
+	uint8_t opcode;
+	uint32_t pos;/**< 本次选中后收到的字节数 */
+	uint8_t addr_len;
+	uint8_t dummy_cycles;/**< 剩余空周期 */
+	uint32_t addr;
+	uint8_t sfdp[0x50];
+
+	uint8_t wel;
+	uint8_t four_byte;
+	uint8_t sr1;
+	uint8_t sr2;
+	uint32_t busy;
+
+	uint32_t stat_cs;
+	uint32_t stat_status_reads;
+	uint32_t stat_bytes;
+};
+
+static struct misaka_spi_flash_sim_struct s_sim;
+static misaka_spi_bus_t s_sim_bus;
+
+/**
+ * @brief 小端写32位
+ * @param buf 缓冲区
+ * @param value 数据
+ */
+static void misaka_spi_flash_sim_put32(uint8_t *buf, uint32_t value)
+{
+	buf[0] = (uint8_t) value;
+	buf[1] = (uint8_t) (value >> 8);
+	buf[2] = (uint8_t) (value >> 16);
+	buf[3] = (uint8_t) (value >> 24);
+}
+
+/**
+ * @brief 生成sfdp表
+ */
+static void misaka_spi_flash_sim_build_sfdp(void)
+{
+	uint8_t *sfdp = s_sim.sfdp;
+	uint8_t *bfpt = &s_sim.sfdp[0x10];
+
+	memset(sfdp, 0xFF, sizeof(s_sim.sfdp));
+	memset(bfpt, 0, 16 * 4);
+
+	misaka_spi_flash_sim_put32(&sfdp[0], 0x50444653UL);
+	sfdp[4] = 6;
+	sfdp[5] = 1;
+	sfdp[6] = 0;
+	sfdp[7] = 0xFF;
+
+	sfdp[8] = 0x00;
+	sfdp[9] = 6;
+	sfdp[10] = 1;
+	sfdp[11] = 16;
+	sfdp[12] = 0x10;
+	sfdp[13] = 0x00;
+	sfdp[14] = 0x00;
+	sfdp[15] = 0xFF;
+
+	misaka_spi_flash_sim_put32(&bfpt[0 * 4], (1UL << 22) | (1UL << 16) | (0x20UL << 8) | 0x01UL);
+	misaka_spi_flash_sim_put32(&bfpt[1 * 4], s_sim.size * 8 - 1);
+	misaka_spi_flash_sim_put32(&bfpt[2 * 4], (0x6BUL << 24) | (8UL << 16));
+	misaka_spi_flash_sim_put32(&bfpt[3 * 4], (0x3BUL << 8) | 8UL);
+	misaka_spi_flash_sim_put32(&bfpt[7 * 4], (0x52UL << 24) | (15UL << 16) | (0x20UL << 8) | 12UL);
+	misaka_spi_flash_sim_put32(&bfpt[8 * 4], (0xD8UL << 8) | 16UL);
+	misaka_spi_flash_sim_put32(&bfpt[9 * 4], (((1UL << 5) | 2UL) << 4) | (((1UL << 5) | 7UL) << 11) | (((2UL << 5) | 2UL) << 18));
+	misaka_spi_flash_sim_put32(&bfpt[10 * 4], (1UL << 13) | (4UL << 8) | (8UL << 4));
+}
+
+/**
+ * @brief 擦除
+ * @param addr 地址
+ * @param size 大小
+ */
+static void misaka_spi_flash_sim_erase(uint32_t addr, uint32_t size)
+{
+	addr &= ~(size - 1) & (s_sim.size - 1);
+	memset(&s_sim.mem[addr], 0xFF, size);
+	s_sim.busy = s_sim.busy_polls;
+}
+
+/**
+ * @brief 选中后收到第一个字节，确定地址与空周期
+ * @param opcode 指令
+ */
+static void misaka_spi_flash_sim_opcode(uint8_t opcode)
+{
+	s_sim.opcode = opcode;
+	s_sim.addr = 0;
+	s_sim.addr_len = 0;
+	s_sim.dummy_cycles = 0;
+
+	if (s_sim.busy && opcode != 0x05)
+	{
+		s_sim.opcode = 0x00;
+		return;
+	}
+
+	switch (opcode)
+	{
+	case 0x03:
+	case 0x02:
+	case 0x20:
+	case 0x52:
+	case 0xD8:
+		s_sim.addr_len = s_sim.four_byte ? 4 : 3;
+		break;
+	case 0x0B:
+	case 0x3B:
+	case 0x6B:
+		s_sim.addr_len = s_sim.four_byte ? 4 : 3;
+		s_sim.dummy_cycles = 8;
+		break;
+	case 0x5A:
+		s_sim.addr_len = 3;
+		s_sim.dummy_cycles = 8;
+		break;
+	case 0x05:
+		s_sim.stat_status_reads++;
+		if (s_sim.busy)
+		{
+			s_sim.busy--;
+			s_sim.sr1 |= 0x01;
+		}
+		else
+		{
+			s_sim.sr1 &= (uint8_t) ~0x01;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief 处理一个字节
+ * @param in 主机发出的数据
+ * @param lines 数据线宽度
+ * @return uint8_t @c 仿真flash输出的数据
+ */
+static uint8_t misaka_spi_flash_sim_byte(uint8_t in, uint8_t lines)
+{
+	uint8_t out = 0xFF;
+	uint32_t index;
+
+	s_sim.stat_bytes++;
+
+	if (!s_sim.selected)
+	{
+		return out;
+	}
+
+	if (s_sim.pos++ == 0)
+	{
+		misaka_spi_flash_sim_opcode(in);
+		return out;
+	}
+
+	if (s_sim.addr_len)
+	{
+		s_sim.addr = (s_sim.addr << 8) | in;
+		s_sim.addr_len--;
+		return out;
+	}
+
+	if (s_sim.dummy_cycles)
+	{
+		lines = lines ? lines : 1;
+		s_sim.dummy_cycles = (uint8_t) (s_sim.dummy_cycles > 8 / lines ? s_sim.dummy_cycles - 8 / lines : 0);
+		return out;
+	}
+
+	switch (s_sim.opcode)
+	{
+	case 0x03:
+	case 0x0B:
+	case 0x3B:
+	case 0x6B:
+		out = s_sim.mem[s_sim.addr++ & (s_sim.size - 1)];
+		break;
+	case 0x5A:
+		out = s_sim.addr < sizeof(s_sim.sfdp) ? s_sim.sfdp[s_sim.addr] : 0xFF;
+		s_sim.addr++;
+		break;
+	case 0x9F:
+		index = s_sim.pos - 2;
+		if (index == 0)
+		{
+			out = 0xEF;
+		}
+		else if (index == 1)
+		{
+			out = 0x40;
+		}
+		else if (index == 2)
+		{
+			for (out = 0; (1UL << out) < s_sim.size; out++)
+			{
+			}
+		}
+		break;
+	case 0x05:
+		out = s_sim.sr1;
+		break;
+	case 0x35:
+		out = s_sim.sr2;
+		break;
+	case 0x02:
+		if (s_sim.wel)
+		{
+			s_sim.mem[s_sim.addr & (s_sim.size - 1)] &= in;
+			s_sim.addr = (s_sim.addr & ~(uint32_t) (MISAKA_SPI_FLASH_SIM_PAGE_SIZE - 1))
+			             | ((s_sim.addr + 1) & (MISAKA_SPI_FLASH_SIM_PAGE_SIZE - 1));
+		}
+		break;
+	case 0x01:
+		if (s_sim.wel)
+		{
+			if (s_sim.pos == 2)
+			{
+				s_sim.sr1 = in & (uint8_t) ~0x03;
+			}
+			else if (s_sim.pos == 3)
+			{
+				s_sim.sr2 = in;
+			}
+		}
+		break;
+	case 0x31:
+		if (s_sim.wel && s_sim.pos == 2)
+		{
+			s_sim.sr2 = in;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return out;
+}
+
+/**
+ * @brief 取消选中，执行需要在cs释放时生效的指令
+ */
+static void misaka_spi_flash_sim_finish(void)
+{
+	uint8_t wel = s_sim.wel;
+
+	switch (s_sim.opcode)
+	{
+	case 0x06:
+		s_sim.wel = 1;
+		break;
+	case 0x04:
+		s_sim.wel = 0;
+		break;
+	case 0xB7:
+		s_sim.four_byte = 1;
+		break;
+	case 0x02:
+	case 0x01:
+	case 0x31:
+		if (wel && s_sim.pos > 1)
+		{
+			s_sim.busy = s_sim.busy_polls;
+		}
+		s_sim.wel = 0;
+		break;
+	case 0x20:
+	case 0x52:
+	case 0xD8:
+		if (wel && s_sim.addr_len == 0 && s_sim.pos > 1)
+		{
+			misaka_spi_flash_sim_erase(s_sim.addr, s_sim.opcode == 0x20 ? 4096UL : (s_sim.opcode == 0x52 ? 32768UL : 65536UL));
+		}
+		s_sim.wel = 0;
+		break;
+	case 0xC7:
+	case 0x60:
+		if (wel)
+		{
+			memset(s_sim.mem, 0xFF, s_sim.size);
+			s_sim.busy = s_sim.busy_polls;
+		}
+		s_sim.wel = 0;
+		break;
+	default:
+		break;
+	}
+	s_sim.opcode = 0x00;
+}
+
+/**
+ * @brief 仿真flash的cs引脚
+ * @param ctx 未使用
+ * @param state 0: 低电平 1: 高电平
+ */
+static void misaka_spi_flash_sim_set_cs(void *ctx, uint8_t state)
+{
+	(void) ctx;
+
+	if (!state && !s_sim.selected)
+	{
+		s_sim.selected = 1;
+		s_sim.pos = 0;
+		s_sim.stat_cs++;
+	}
+	else if (state && s_sim.selected)
+	{
+		misaka_spi_flash_sim_finish();
+		s_sim.selected = 0;
+	}
+}
+
+/**
+ * 仿真flash的cs操作表，作为misaka_spi_t的cs_ops使用
+ */
+const misaka_spi_cs_ops_t misaka_spi_flash_sim_cs_ops = {
+	misaka_spi_flash_sim_set_cs,
+	NULL,
+};
+
+/**
+ * @brief 发送的时候接收数据
+ * @param ctx 未使用
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_sim_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		rxbuf[i] = misaka_spi_flash_sim_byte(txbuf[i], MISAKA_SPI_LINES_SINGLE);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 发送数据
+ * @param ctx 未使用
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_sim_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		misaka_spi_flash_sim_byte(txbuf[i], MISAKA_SPI_LINES_SINGLE);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 接收数据
+ * @param ctx 未使用
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_sim_recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		rxbuf[i] = misaka_spi_flash_sim_byte(0xFF, MISAKA_SPI_LINES_SINGLE);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 以双线/四线发送数据
+ * @param ctx 未使用
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @param lines 数据线宽度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_sim_send_lines(void *ctx, uint8_t *txbuf, uint32_t length, uint8_t lines)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		misaka_spi_flash_sim_byte(txbuf[i], lines);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 以双线/四线接收数据
+ * @param ctx 未使用
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @param lines 数据线宽度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_flash_sim_recv_lines(void *ctx, uint8_t *rxbuf, uint32_t length, uint8_t lines)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		rxbuf[i] = misaka_spi_flash_sim_byte(0xFF, lines);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 获取互斥量，仿真总线无需互斥
+ * @param ctx 未使用
+ */
+static void misaka_spi_flash_sim_mutex_take(void *ctx)
+{
+	(void) ctx;
+}
+
+/**
+ * @brief 释放互斥量，仿真总线无需互斥
+ * @param ctx 未使用
+ */
+static void misaka_spi_flash_sim_mutex_release(void *ctx)
+{
+	(void) ctx;
+}
+
+static const misaka_spi_bus_ops_t misaka_spi_flash_sim_ops = {
+	misaka_spi_flash_sim_send_recv,
+	misaka_spi_flash_sim_send,
+	misaka_spi_flash_sim_recv,
+	misaka_spi_flash_sim_mutex_take,
+	misaka_spi_flash_sim_mutex_release,
+	NULL,
+	NULL,
+	misaka_spi_flash_sim_send_lines,
+	misaka_spi_flash_sim_recv_lines,
+	NULL,
+	NULL,
+	NULL,
+};
+
+/**
+ * @brief 初始化仿真flash，返回的总线按指令解析读写mem，可用于在主机上测试与评估flash驱动
+ * @param mem 存储空间
+ * @param size 容量，需为2的整数次幂
+ * @param busy_polls 编程或擦除后状态寄存器保持忙的读取次数
+ * @return misaka_spi_bus_t* @c 仿真总线
+ */
+misaka_spi_bus_t *misaka_spi_flash_sim_init(uint8_t *mem, uint32_t size, uint32_t busy_polls)
+{
+	memset(&s_sim, 0, sizeof(s_sim));
+	s_sim.mem = mem;
+	s_sim.size = size;
+	s_sim.busy_polls = busy_polls;
+	misaka_spi_flash_sim_build_sfdp();
+
+	memset(&s_sim_bus, 0, sizeof(s_sim_bus));
+	s_sim_bus.ops = &misaka_spi_flash_sim_ops;
+	s_sim_bus.ctx = NULL;
+
+	return &s_sim_bus;
+}
+
+/**
+ * @brief 仿真flash的统计，cs次数、指令数与总线字节数
+ * @param cs 选中次数
+ * @param status_reads 状态寄存器读取次数
+ * @param bytes 总线上传输的字节数
+ */
+void misaka_spi_flash_sim_stat(uint32_t *cs, uint32_t *status_reads, uint32_t *bytes)
+{
+	if (cs != NULL)
+	{
+		*cs = s_sim.stat_cs;
+	}
+	if (status_reads != NULL)
+	{
+		*status_reads = s_sim.stat_status_reads;
+	}
+	if (bytes != NULL)
+	{
+		*bytes = s_sim.stat_bytes;
+	}
+}
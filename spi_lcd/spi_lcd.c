@@ -0,0 +1,416 @@
+/**
+ * @file spi_lcd.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include <string.h>
+#include "misaka_device/spi_lcd.h"
+
+/**
+ * @brief 初始化消息段
+ * @param message 消息
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @param dc MISAKA_SPI_DC_COMMAND或MISAKA_SPI_DC_DATA
+ */
+static void misaka_spi_lcd_segment(misaka_spi_message_t *message, uint8_t *txbuf, uint32_t length, uint8_t dc)
+{
+	message->send_buf = txbuf;
+	message->recv_buf = NULL;
+	message->length = length;
+	message->next = NULL;
+	message->cs_take = 0;
+	message->cs_release = 0;
+	message->lines = MISAKA_SPI_LINES_SINGLE;
+	message->dummy_cycles = 0;
+	message->dc = dc;
+}
+
+/**
+ * @brief 将前num段连成一条消息链
+ * @param lcd 屏幕
+ * @param num 段数
+ * @param cs_take 链首选中cs
+ * @param cs_release 链尾释放cs
+ */
+static void misaka_spi_lcd_link(misaka_spi_lcd_t *lcd, uint32_t num, uint8_t cs_take, uint8_t cs_release)
+{
+	uint32_t i;
+
+	for (i = 0; i + 1 < num; i++)
+	{
+		lcd->message[i].next = &lcd->message[i + 1];
+	}
+	lcd->message[num - 1].next = NULL;
+	lcd->message[0].cs_take = cs_take;
+	lcd->message[num - 1].cs_release = cs_release;
+	lcd->chains++;
+}
+
+/**
+ * @brief 将前num段连成一条消息链并提交，整条链只选中一次cs
+ * @param lcd 屏幕
+ * @param num 段数
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_lcd_submit(misaka_spi_lcd_t *lcd, uint32_t num)
+{
+	misaka_spi_lcd_link(lcd, num, 1, 1);
+
+	return misaka_spi_transfer_message(lcd->spi, lcd->message);
+}
+
+/**
+ * @brief 发送命令及参数
+ * @param lcd 屏幕
+ * @param cmd 命令
+ * @param data 参数
+ * @param len 参数长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_lcd_command(misaka_spi_lcd_t *lcd, uint8_t cmd, uint8_t *data, uint32_t len)
+{
+	lcd->command[0] = cmd;
+	misaka_spi_lcd_segment(&lcd->message[0], &lcd->command[0], 1, MISAKA_SPI_DC_COMMAND);
+	if (len == 0)
+	{
+		return misaka_spi_lcd_submit(lcd, 1);
+	}
+	misaka_spi_lcd_segment(&lcd->message[1], data, len, MISAKA_SPI_DC_DATA);
+
+	return misaka_spi_lcd_submit(lcd, 2);
+}
+
+/**
+ * @brief 矩形面积
+ * @param rect 矩形
+ * @return uint32_t @c 面积
+ */
+static uint32_t misaka_spi_lcd_area(const misaka_spi_lcd_rect_t *rect)
+{
+	return (uint32_t) rect->w * rect->h;
+}
+
+/**
+ * @brief 求包含两个矩形的最小矩形
+ * @param a 矩形a
+ * @param b 矩形b
+ * @param out 结果
+ */
+static void misaka_spi_lcd_union(const misaka_spi_lcd_rect_t *a, const misaka_spi_lcd_rect_t *b, misaka_spi_lcd_rect_t *out)
+{
+	uint16_t x1 = a->x < b->x ? a->x : b->x;
+	uint16_t y1 = a->y < b->y ? a->y : b->y;
+	uint16_t x2 = a->x + a->w > b->x + b->w ? a->x + a->w : b->x + b->w;
+	uint16_t y2 = a->y + a->h > b->y + b->h ? a->y + a->h : b->y + b->h;
+
+	out->x = x1;
+	out->y = y1;
+	out->w = x2 - x1;
+	out->h = y2 - y1;
+}
+
+/**
+ * @brief 刷新一个矩形：CASET/RASET/RAMWR与像素行在同一条消息链中发出，像素行直接指向显存，
+ *        整行宽度的矩形只占一段；段数超过MISAKA_SPI_LCD_SEGMENT_MAX时在会话内分多条消息链提交，
+ *        cs在整个矩形期间保持选中，RAMWR之后的像素写入不被打断
+ * @param lcd 屏幕
+ * @param rect 矩形
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_lcd_flush_rect(misaka_spi_lcd_t *lcd, const misaka_spi_lcd_rect_t *rect)
+{
+	uint16_t xs = rect->x + lcd->x_offset, xe = xs + rect->w - 1;
+	uint16_t ys = rect->y + lcd->y_offset, ye = ys + rect->h - 1;
+	uint32_t num = 0, row = 0, rows;
+	uint8_t session, cs_take = 1, result = 0;
+
+	lcd->command[0] = MISAKA_SPI_LCD_CMD_CASET;
+	lcd->command[1] = MISAKA_SPI_LCD_CMD_RASET;
+	lcd->command[2] = MISAKA_SPI_LCD_CMD_RAMWR;
+	lcd->window[0] = (uint8_t) (xs >> 8);
+	lcd->window[1] = (uint8_t) xs;
+	lcd->window[2] = (uint8_t) (xe >> 8);
+	lcd->window[3] = (uint8_t) xe;
+	lcd->window[4] = (uint8_t) (ys >> 8);
+	lcd->window[5] = (uint8_t) ys;
+	lcd->window[6] = (uint8_t) (ye >> 8);
+	lcd->window[7] = (uint8_t) ye;
+
+	/** < cs释放后控制器结束本次RAMWR，因此一条消息链放不下时需在会话内保持cs */
+	session = 5 + (rect->w == lcd->width ? 1 : rect->h) > MISAKA_SPI_LCD_SEGMENT_MAX;
+	if (session && misaka_spi_session_open(lcd->spi) != 0)
+	{
+		return 1;
+	}
+
+	misaka_spi_lcd_segment(&lcd->message[num++], &lcd->command[0], 1, MISAKA_SPI_DC_COMMAND);
+	misaka_spi_lcd_segment(&lcd->message[num++], &lcd->window[0], 4, MISAKA_SPI_DC_DATA);
+	misaka_spi_lcd_segment(&lcd->message[num++], &lcd->command[1], 1, MISAKA_SPI_DC_COMMAND);
+	misaka_spi_lcd_segment(&lcd->message[num++], &lcd->window[4], 4, MISAKA_SPI_DC_DATA);
+	misaka_spi_lcd_segment(&lcd->message[num++], &lcd->command[2], 1, MISAKA_SPI_DC_COMMAND);
+
+	while (row < rect->h)
+	{
+		rows = rect->w == lcd->width ? rect->h - row : 1;
+		misaka_spi_lcd_segment(&lcd->message[num++],
+		                       (uint8_t *) (lcd->framebuffer + (uint32_t) (rect->y + row) * lcd->width + rect->x),
+		                       rows * rect->w * 2, MISAKA_SPI_DC_DATA);
+		row += rows;
+
+		if (num == MISAKA_SPI_LCD_SEGMENT_MAX || row == rect->h)
+		{
+			if (session)
+			{
+				misaka_spi_lcd_link(lcd, num, cs_take, row == rect->h);
+				result = misaka_spi_session_chain(lcd->spi, lcd->message);
+				cs_take = 0;
+			}
+			else
+			{
+				result = misaka_spi_lcd_submit(lcd, num);
+			}
+			if (result != 0)
+			{
+				break;
+			}
+			num = 0;
+		}
+	}
+
+	if (session && misaka_spi_session_close(lcd->spi) != 0)
+	{
+		result = 1;
+	}
+	if (result != 0)
+	{
+		return 1;
+	}
+
+	lcd->flushes++;
+	lcd->pixels += misaka_spi_lcd_area(rect);
+
+	return 0;
+}
+
+/**
+ * @brief 初始化屏幕（ST7789/ILI9341类），清空脏矩形并设置为RGB565
+ * @param lcd 屏幕
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_lcd_init(misaka_spi_lcd_t *lcd)
+{
+	uint8_t data;
+
+	misaka_spi_assert(lcd != NULL);
+	misaka_spi_assert(lcd->spi != NULL);
+	misaka_spi_assert(lcd->framebuffer != NULL);
+
+	lcd->dirty_num = 0;
+	lcd->flushes = 0;
+	lcd->chains = 0;
+	lcd->pixels = 0;
+
+	if (misaka_spi_lcd_command(lcd, MISAKA_SPI_LCD_CMD_SWRESET, NULL, 0) != 0)
+	{
+		return 1;
+	}
+	lcd->delay_ms(150);
+	if (misaka_spi_lcd_command(lcd, MISAKA_SPI_LCD_CMD_SLPOUT, NULL, 0) != 0)
+	{
+		return 1;
+	}
+	lcd->delay_ms(120);
+
+	data = 0x55;
+	if (misaka_spi_lcd_command(lcd, MISAKA_SPI_LCD_CMD_COLMOD, &data, 1) != 0)
+	{
+		return 1;
+	}
+	data = lcd->madctl;
+	if (misaka_spi_lcd_command(lcd, MISAKA_SPI_LCD_CMD_MADCTL, &data, 1) != 0)
+	{
+		return 1;
+	}
+	if (lcd->invert && misaka_spi_lcd_command(lcd, MISAKA_SPI_LCD_CMD_INVON, NULL, 0) != 0)
+	{
+		return 1;
+	}
+	if (misaka_spi_lcd_command(lcd, MISAKA_SPI_LCD_CMD_DISPON, NULL, 0) != 0)
+	{
+		return 1;
+	}
+	lcd->delay_ms(20);
+
+	misaka_spi_lcd_invalidate(lcd, 0, 0, lcd->width, lcd->height);
+
+	return 0;
+}
+
+/**
+ * @brief 转换为显存中的像素值（RGB565，高字节在前）
+ * @param r 红色，0~255
+ * @param g 绿色，0~255
+ * @param b 蓝色，0~255
+ * @return uint16_t @c 像素值
+ */
+uint16_t misaka_spi_lcd_color(uint8_t r, uint8_t g, uint8_t b)
+{
+	uint16_t value = (uint16_t) (((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+	uint8_t bytes[2];
+	uint16_t color;
+
+	bytes[0] = (uint8_t) (value >> 8);
+	bytes[1] = (uint8_t) value;
+	memcpy(&color, bytes, sizeof(color));
+
+	return color;
+}
+
+/**
+ * @brief 标记区域需要刷新，与现有脏矩形合并后多刷新的像素不超过MISAKA_SPI_LCD_MERGE_SLACK时合并
+ * @param lcd 屏幕
+ * @param x 列
+ * @param y 行
+ * @param w 宽度
+ * @param h 高度
+ */
+void misaka_spi_lcd_invalidate(misaka_spi_lcd_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+	misaka_spi_lcd_rect_t rect, merged;
+	uint32_t i, best = 0, cost, best_cost = 0xFFFFFFFFUL;
+
+	misaka_spi_assert(lcd != NULL);
+
+	if (x >= lcd->width || y >= lcd->height || w == 0 || h == 0)
+	{
+		return;
+	}
+	rect.x = x;
+	rect.y = y;
+	rect.w = w < lcd->width - x ? w : lcd->width - x;
+	rect.h = h < lcd->height - y ? h : lcd->height - y;
+
+	i = 0;
+	while (i < lcd->dirty_num)
+	{
+		misaka_spi_lcd_union(&rect, &lcd->dirty[i], &merged);
+		if (misaka_spi_lcd_area(&merged)
+			<= misaka_spi_lcd_area(&rect) + misaka_spi_lcd_area(&lcd->dirty[i]) + MISAKA_SPI_LCD_MERGE_SLACK)
+		{
+			/** < 合并后的矩形可能与其他矩形相邻，重新检查 */
+			rect = merged;
+			lcd->dirty[i] = lcd->dirty[--lcd->dirty_num];
+			i = 0;
+			continue;
+		}
+		i++;
+	}
+
+	if (lcd->dirty_num < MISAKA_SPI_LCD_DIRTY_MAX)
+	{
+		lcd->dirty[lcd->dirty_num++] = rect;
+		return;
+	}
+
+	for (i = 0; i < lcd->dirty_num; i++)
+	{
+		misaka_spi_lcd_union(&rect, &lcd->dirty[i], &merged);
+		cost = misaka_spi_lcd_area(&merged) - misaka_spi_lcd_area(&lcd->dirty[i]);
+		if (cost < best_cost)
+		{
+			best_cost = cost;
+			best = i;
+		}
+	}
+	misaka_spi_lcd_union(&rect, &lcd->dirty[best], &lcd->dirty[best]);
+}
+
+/**
+ * @brief 画点
+ * @param lcd 屏幕
+ * @param x 列
+ * @param y 行
+ * @param color 像素值，由misaka_spi_lcd_color得到
+ */
+void misaka_spi_lcd_set_pixel(misaka_spi_lcd_t *lcd, uint16_t x, uint16_t y, uint16_t color)
+{
+	misaka_spi_assert(lcd != NULL);
+
+	if (x >= lcd->width || y >= lcd->height)
+	{
+		return;
+	}
+
+	lcd->framebuffer[(uint32_t) y * lcd->width + x] = color;
+	misaka_spi_lcd_invalidate(lcd, x, y, 1, 1);
+}
+
+/**
+ * @brief 填充矩形
+ * @param lcd 屏幕
+ * @param x 列
+ * @param y 行
+ * @param w 宽度
+ * @param h 高度
+ * @param color 像素值，由misaka_spi_lcd_color得到
+ */
+void misaka_spi_lcd_fill(misaka_spi_lcd_t *lcd, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+	uint16_t i, j;
+	uint16_t *line;
+
+	misaka_spi_assert(lcd != NULL);
+
+	if (x >= lcd->width || y >= lcd->height)
+	{
+		return;
+	}
+	w = w < lcd->width - x ? w : lcd->width - x;
+	h = h < lcd->height - y ? h : lcd->height - y;
+
+	for (j = 0; j < h; j++)
+	{
+		line = lcd->framebuffer + (uint32_t) (y + j) * lcd->width + x;
+		for (i = 0; i < w; i++)
+		{
+			line[i] = color;
+		}
+	}
+
+	misaka_spi_lcd_invalidate(lcd, x, y, w, h);
+}
+
+/**
+ * @brief 刷新所有脏矩形，每个矩形的窗口命令与像素数据在同一条消息链中发出
+ * @param lcd 屏幕
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_lcd_flush(misaka_spi_lcd_t *lcd)
+{
+	misaka_spi_assert(lcd != NULL);
+
+	while (lcd->dirty_num)
+	{
+		if (misaka_spi_lcd_flush_rect(lcd, &lcd->dirty[lcd->dirty_num - 1]) != 0)
+		{
+			return 1;
+		}
+		lcd->dirty_num--;
+	}
+
+	return 0;
+}
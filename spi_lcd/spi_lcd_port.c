@@ -0,0 +1,84 @@
+/**
+ * @file spi_lcd_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/spi_lcd.h"
+
+#define SPI_LCD_WIDTH       240
+#define SPI_LCD_HEIGHT      240
+
+static uint16_t s_spi_lcd_framebuffer[SPI_LCD_WIDTH * SPI_LCD_HEIGHT];
+static misaka_spi_lcd_t s_misaka_spi_lcd_obj;
+misaka_spi_lcd_t *misaka_spi_lcd_obj = NULL;
+
+/**
+ * @brief 毫秒延时
+ * @param ms 毫秒
+ */
+static void delay_ms(uint32_t ms)
+{
+
+}
+
+/**
+ * @brief 设置cs引脚电平
+ * @param ctx cs上下文
+ * @param state 0: 低电平 1: 高电平
+ */
+static void set_cs(void *ctx, uint8_t state)
+{
+
+}
+
+/**
+ * @brief 设置D/C引脚电平
+ * @param ctx cs上下文
+ * @param state 0: 命令 1: 数据
+ */
+static void set_dc(void *ctx, uint8_t state)
+{
+
+}
+
+static const misaka_spi_cs_ops_t s_spi_lcd_cs_ops = {
+	set_cs,
+	set_dc,
+};
+
+static int misaka_spi_lcd_port_init(misaka_spi_t *spi)
+{
+	spi->cs_ops = &s_spi_lcd_cs_ops;
+	spi->preemptible = 1;/**< 屏幕可容忍cs在写显存中途释放，总线开启仲裁时大块刷新不阻塞高优先级设备 */
+
+	s_misaka_spi_lcd_obj.spi = spi;
+	s_misaka_spi_lcd_obj.delay_ms = delay_ms;
+	s_misaka_spi_lcd_obj.framebuffer = s_spi_lcd_framebuffer;
+	s_misaka_spi_lcd_obj.width = SPI_LCD_WIDTH;
+	s_misaka_spi_lcd_obj.height = SPI_LCD_HEIGHT;
+	s_misaka_spi_lcd_obj.x_offset = 0;
+	s_misaka_spi_lcd_obj.y_offset = 0;
+	s_misaka_spi_lcd_obj.madctl = 0x00;
+	s_misaka_spi_lcd_obj.invert = 1;
+
+	if (misaka_spi_lcd_init(&s_misaka_spi_lcd_obj) != 0)
+	{
+		return 0;
+	}
+	misaka_spi_lcd_obj = &s_misaka_spi_lcd_obj;
+
+	return 1;
+}
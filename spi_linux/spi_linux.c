@@ -0,0 +1,479 @@
+/**
+ * @file spi_linux.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * linux spidev后端：整条消息链转换为一次SPI_IOC_MESSAGE(N)，cs由内核控制，
+ * 段的cs_release映射为cs_change，链尾未释放cs时同样置cs_change使cs保持有效；
+ * 设备提供set_dc时在D/C变化处分批提交；链中有双线/四线段时先以SPI_IOC_WR_MODE32打开对应的SPI_TX/RX_DUAL/QUAD，
+ * 否则内核会拒绝tx_nbits/rx_nbits为2或4的传输。
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include "misaka_device/spi_linux.h"
+
+static pthread_once_t s_misaka_spi_linux_once = PTHREAD_ONCE_INIT;
+static uint8_t s_misaka_spi_linux_dummy[128];
+
+/**
+ * @brief 默认ioctl，直接调用系统调用
+ * @param fd 文件描述符
+ * @param request 请求
+ * @param arg 参数
+ * @return int @c 系统调用返回值
+ */
+static int misaka_spi_linux_sys_ioctl(int fd, unsigned long request, void *arg)
+{
+	return ioctl(fd, request, arg);
+}
+
+/**
+ * @brief 发起ioctl并计数
+ * @param dev spidev设备
+ * @param request 请求
+ * @param arg 参数
+ * @return int @c ioctl返回值
+ */
+static int misaka_spi_linux_ioctl(misaka_spi_linux_t *dev, unsigned long request, void *arg)
+{
+	dev->ioctls++;
+
+	return dev->ioctl(dev->fd, request, arg);
+}
+
+/**
+ * @brief 提交一批spi_ioc_transfer
+ * @param dev spidev设备
+ * @param xfer 传输
+ * @param num 传输数量
+ * @param release 批次结束时是否释放cs
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_linux_submit(misaka_spi_linux_t *dev, struct spi_ioc_transfer *xfer, uint32_t num, uint8_t release)
+{
+	if (num == 0)
+	{
+		return 0;
+	}
+
+	/** < 链尾的cs_change表示传输结束后cs保持有效 */
+	xfer[num - 1].cs_change = release ? 0 : 1;
+
+	return misaka_spi_linux_ioctl(dev, SPI_IOC_MESSAGE(num), xfer) < 0 ? 1 : 0;
+}
+
+/**
+ * @brief 填充一个spi_ioc_transfer
+ * @param xfer 传输
+ * @param device spi设备
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @param lines 数据线宽度
+ */
+static void misaka_spi_linux_fill(struct spi_ioc_transfer *xfer, misaka_spi_t *device, uint8_t *txbuf, uint8_t *rxbuf,
+                                  uint32_t length, uint8_t lines)
+{
+	memset(xfer, 0, sizeof(struct spi_ioc_transfer));
+	xfer->tx_buf = (unsigned long) txbuf;
+	xfer->rx_buf = (unsigned long) rxbuf;
+	xfer->len = length;
+	xfer->speed_hz = device->config.max_hz;
+	xfer->bits_per_word = device->config.data_width;
+	if (lines > MISAKA_SPI_LINES_SINGLE)
+	{
+		xfer->tx_nbits = txbuf != NULL ? lines : 0;
+		xfer->rx_nbits = rxbuf != NULL ? lines : 0;
+	}
+}
+
+/**
+ * @brief 数据线宽度对应的模式位
+ * @param lines 数据线宽度
+ * @param tx 1:发送 0:接收
+ * @return uint32_t @c SPI_TX/RX_DUAL/QUAD，单线为0
+ */
+static uint32_t misaka_spi_linux_lines_mode(uint8_t lines, uint8_t tx)
+{
+	if (lines == MISAKA_SPI_LINES_QUAD)
+	{
+		return tx ? SPI_TX_QUAD : SPI_RX_QUAD;
+	}
+	if (lines == MISAKA_SPI_LINES_DUAL)
+	{
+		return tx ? SPI_TX_DUAL : SPI_RX_DUAL;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 链中用到双线/四线而当前模式未打开时，追加对应的模式位并重新下发
+ * @param dev spidev设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_linux_setup_lines(misaka_spi_linux_t *dev, misaka_spi_message_t *message)
+{
+	uint32_t mode = dev->mode;
+
+	for (; message != NULL; message = message->next)
+	{
+		if (message->send_buf != NULL || message->dummy_cycles)
+		{
+			mode |= misaka_spi_linux_lines_mode(message->lines, 1);
+		}
+		if (message->recv_buf != NULL)
+		{
+			mode |= misaka_spi_linux_lines_mode(message->lines, 0);
+		}
+	}
+
+	if (mode == dev->mode)
+	{
+		return 0;
+	}
+	if (misaka_spi_linux_ioctl(dev, SPI_IOC_WR_MODE32, &mode) < 0)
+	{
+		return 1;
+	}
+	dev->mode = mode;
+
+	return 0;
+}
+
+/**
+ * @brief 整条消息链转换为SPI_IOC_MESSAGE，超过MISAKA_SPI_LINUX_TRANSFER_MAX时分批并保持cs
+ * @param ctx spidev设备
+ * @param device spi设备
+ * @param message 消息链
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_linux_transfer_chain(void *ctx, misaka_spi_t *device, misaka_spi_message_t *message)
+{
+	misaka_spi_linux_t *dev = (misaka_spi_linux_t *) ctx;
+	struct spi_ioc_transfer xfer[MISAKA_SPI_LINUX_TRANSFER_MAX];
+	misaka_spi_message_t *index;
+	uint32_t num = 0, need, dummy_len;
+	uint8_t lines, release = 1, dc = MISAKA_SPI_DC_NONE;
+
+	if (misaka_spi_linux_setup_lines(dev, message) != 0)
+	{
+		return 1;
+	}
+
+	for (index = message; index != NULL; index = index->next)
+	{
+		/** < D/C由用户空间gpio控制，电平变化处分批提交 */
+		if (index->dc != MISAKA_SPI_DC_NONE && index->dc != dc && device->cs_ops->set_dc != NULL)
+		{
+			if (misaka_spi_linux_submit(dev, xfer, num, release) != 0)
+			{
+				return 1;
+			}
+			num = 0;
+			device->cs_ops->set_dc(device->cs_ctx, index->dc == MISAKA_SPI_DC_DATA);
+			dc = index->dc;
+		}
+
+		need = index->dummy_cycles ? 2 : 1;
+		if (num + need > MISAKA_SPI_LINUX_TRANSFER_MAX)
+		{
+			if (misaka_spi_linux_submit(dev, xfer, num, release) != 0)
+			{
+				return 1;
+			}
+			num = 0;
+		}
+
+		lines = index->lines > MISAKA_SPI_LINES_SINGLE ? index->lines : MISAKA_SPI_LINES_SINGLE;
+		if (index->dummy_cycles)
+		{
+			dummy_len = ((uint32_t) index->dummy_cycles * lines) >> 3;
+			if ((((uint32_t) index->dummy_cycles * lines) & 0x07) != 0 || dummy_len > sizeof(s_misaka_spi_linux_dummy))
+			{
+				return 1;
+			}
+			misaka_spi_linux_fill(&xfer[num++], device, s_misaka_spi_linux_dummy, NULL, dummy_len, lines);
+		}
+
+		if (index->lines > MISAKA_SPI_LINES_SINGLE && index->send_buf != NULL && index->recv_buf != NULL)
+		{
+			return 1;
+		}
+		misaka_spi_linux_fill(&xfer[num], device, index->send_buf, index->recv_buf, index->length, lines);
+		xfer[num].cs_change = index->cs_release && index->next != NULL;
+		num++;
+
+		release = index->cs_release;
+	}
+
+	return misaka_spi_linux_submit(dev, xfer, num, release);
+}
+
+/**
+ * @brief 下发模式、位宽与速率
+ * @param ctx spidev设备
+ * @param device spi设备
+ * @param cfg 配置
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_linux_configure(void *ctx, misaka_spi_t *device, misaka_spi_configuration_t *cfg)
+{
+	misaka_spi_linux_t *dev = (misaka_spi_linux_t *) ctx;
+	uint32_t mode = cfg->mode & (MISAKA_SPI_CPHA | MISAKA_SPI_CPOL);
+	uint8_t bits = cfg->data_width ? cfg->data_width : 8;
+	uint32_t speed = cfg->max_hz;
+
+	(void) device;
+
+	if (!(cfg->mode & MISAKA_SPI_MSB))
+	{
+		mode |= SPI_LSB_FIRST;
+	}
+
+	/** < 重新配置时保留已打开的多线模式位 */
+	mode |= dev->mode & (SPI_TX_DUAL | SPI_TX_QUAD | SPI_RX_DUAL | SPI_RX_QUAD);
+	if (misaka_spi_linux_ioctl(dev, SPI_IOC_WR_MODE32, &mode) < 0)
+	{
+		return 1;
+	}
+	dev->mode = mode;
+	if (misaka_spi_linux_ioctl(dev, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0)
+	{
+		return 1;
+	}
+	if (speed != 0 && misaka_spi_linux_ioctl(dev, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 逐段收发不适用于spidev，消息均经transfer_chain提交
+ * @param ctx spidev设备
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 1:失败
+ */
+static uint8_t misaka_spi_linux_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	(void) ctx;
+	(void) txbuf;
+	(void) rxbuf;
+	(void) length;
+
+	return 1;
+}
+
+/**
+ * @brief 逐段发送不适用于spidev，消息均经transfer_chain提交
+ * @param ctx spidev设备
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @return 1:失败
+ */
+static uint8_t misaka_spi_linux_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	(void) ctx;
+	(void) txbuf;
+	(void) length;
+
+	return 1;
+}
+
+/**
+ * @brief 逐段接收不适用于spidev，消息均经transfer_chain提交
+ * @param ctx spidev设备
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 1:失败
+ */
+static uint8_t misaka_spi_linux_recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	(void) ctx;
+	(void) rxbuf;
+	(void) length;
+
+	return 1;
+}
+
+/**
+ * @brief 获取互斥量
+ * @param ctx spidev设备
+ */
+static void misaka_spi_linux_mutex_take(void *ctx)
+{
+	pthread_mutex_lock(&((misaka_spi_linux_t *) ctx)->mutex);
+}
+
+/**
+ * @brief 释放互斥量
+ * @param ctx spidev设备
+ */
+static void misaka_spi_linux_mutex_release(void *ctx)
+{
+	pthread_mutex_unlock(&((misaka_spi_linux_t *) ctx)->mutex);
+}
+
+/**
+ * 所有spidev设备共用的操作表，ctx为misaka_spi_linux_t
+ */
+static const misaka_spi_bus_ops_t s_misaka_spi_linux_ops = {
+	misaka_spi_linux_send_recv,
+	misaka_spi_linux_send,
+	misaka_spi_linux_recv,
+	misaka_spi_linux_mutex_take,
+	misaka_spi_linux_mutex_release,
+	misaka_spi_linux_transfer_chain,
+	misaka_spi_linux_configure,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+
+/**
+ * @brief cs由内核控制
+ * @param ctx spidev设备
+ * @param state 0: 低电平 1: 高电平
+ */
+static void misaka_spi_linux_set_cs(void *ctx, uint8_t state)
+{
+	(void) ctx;
+	(void) state;
+}
+
+/**
+ * 默认的cs操作表，需要D/C时以带set_dc的操作表替换dev->device.cs_ops
+ */
+static const misaka_spi_cs_ops_t s_misaka_spi_linux_cs_ops = {
+	misaka_spi_linux_set_cs,
+	NULL,
+};
+
+#ifdef MISAKA_SPI_USING_STATISTICS
+/**
+ * @brief 获取us时间戳
+ * @return uint32_t @c 时间戳
+ */
+static uint32_t misaka_spi_linux_get_tick_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint32_t) ts.tv_sec * 1000000UL + (uint32_t) (ts.tv_nsec / 1000);
+}
+#endif
+
+/**
+ * @brief 初始化空周期使用的发送数据
+ */
+static void misaka_spi_linux_dummy_init(void)
+{
+	memset(s_misaka_spi_linux_dummy, 0xff, sizeof(s_misaka_spi_linux_dummy));
+}
+
+/**
+ * @brief 以已打开的文件描述符初始化spidev设备，可配合ioctl拦截函数在无硬件时测试
+ * @param dev spidev设备
+ * @param fd 文件描述符
+ * @param cfg 设备配置
+ */
+void misaka_spi_linux_attach(misaka_spi_linux_t *dev, int fd, misaka_spi_configuration_t *cfg)
+{
+	misaka_spi_assert(dev != NULL);
+	misaka_spi_assert(cfg != NULL);
+
+	pthread_once(&s_misaka_spi_linux_once, misaka_spi_linux_dummy_init);
+
+	/** < spidev的模式与速率按文件描述符保存，每个设备独占一条总线，互不触发重配，由内核在控制器上排队 */
+	memset(&dev->bus, 0, sizeof(misaka_spi_bus_t));
+	dev->bus.ops = &s_misaka_spi_linux_ops;
+	dev->bus.ctx = dev;
+#ifdef MISAKA_SPI_USING_STATISTICS
+	dev->bus.get_tick_us = misaka_spi_linux_get_tick_us;
+#endif
+	pthread_mutex_init(&dev->mutex, NULL);
+
+	if (dev->ioctl == NULL)
+	{
+		dev->ioctl = misaka_spi_linux_sys_ioctl;
+	}
+	dev->fd = fd;
+	dev->mode = 0;
+	dev->ioctls = 0;
+
+	memset(&dev->device, 0, sizeof(misaka_spi_t));
+	dev->device.cs_ops = &s_misaka_spi_linux_cs_ops;
+	dev->device.cs_ctx = dev;
+	dev->device.bus = &dev->bus;
+	dev->device.config.mode = cfg->mode;
+	dev->device.config.data_width = cfg->data_width;
+	dev->device.config.max_hz = cfg->max_hz;
+}
+
+/**
+ * @brief 打开spidev设备，打开后使用dev->device进行传输
+ * @param dev spidev设备，ioctl为NULL时使用系统调用
+ * @param path 设备路径，如 /dev/spidev0.0
+ * @param cfg 设备配置，模式、位宽与速率在首次传输时下发
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_linux_open(misaka_spi_linux_t *dev, const char *path, misaka_spi_configuration_t *cfg)
+{
+	int fd;
+
+	misaka_spi_assert(dev != NULL);
+	misaka_spi_assert(path != NULL);
+
+	fd = open(path, O_RDWR);
+	if (fd < 0)
+	{
+		return 1;
+	}
+
+	misaka_spi_linux_attach(dev, fd, cfg);
+
+	return 0;
+}
+
+/**
+ * @brief 关闭spidev设备
+ * @param dev spidev设备
+ */
+void misaka_spi_linux_close(misaka_spi_linux_t *dev)
+{
+	misaka_spi_assert(dev != NULL);
+
+	if (dev->fd >= 0)
+	{
+		close(dev->fd);
+		dev->fd = -1;
+	}
+	dev->bus.owner = NULL;
+	pthread_mutex_destroy(&dev->mutex);
+}
@@ -0,0 +1,776 @@
+/**
+ * @file spi_sd.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * sd卡spi模式驱动：一次命令从选中cs到释放cs在一个spi会话中完成，期间总线与cs保持占用；
+ * 响应、数据令牌与忙状态按MISAKA_SPI_SD_POLL_BURST字节突发读取，多读的字节保存在预读缓冲中供后续读取。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_sd.h"
+
+#define MISAKA_SPI_SD_WAIT_R1       0                       /**< 等待R1，最高位为0 */
+#define MISAKA_SPI_SD_WAIT_TOKEN    1                       /**< 等待数据令牌或数据响应，不为0xFF */
+#define MISAKA_SPI_SD_WAIT_READY    2                       /**< 等待忙结束，为0xFF */
+
+#ifdef MISAKA_SPI_SD_USING_CRC_TABLE
+static const uint8_t s_misaka_spi_sd_crc7_table[256] =
+{
+	0x00, 0x12, 0x24, 0x36, 0x48, 0x5A, 0x6C, 0x7E, 0x90, 0x82, 0xB4, 0xA6, 0xD8, 0xCA, 0xFC, 0xEE,
+	0x32, 0x20, 0x16, 0x04, 0x7A, 0x68, 0x5E, 0x4C, 0xA2, 0xB0, 0x86, 0x94, 0xEA, 0xF8, 0xCE, 0xDC,
+	0x64, 0x76, 0x40, 0x52, 0x2C, 0x3E, 0x08, 0x1A, 0xF4, 0xE6, 0xD0, 0xC2, 0xBC, 0xAE, 0x98, 0x8A,
+	0x56, 0x44, 0x72, 0x60, 0x1E, 0x0C, 0x3A, 0x28, 0xC6, 0xD4, 0xE2, 0xF0, 0x8E, 0x9C, 0xAA, 0xB8,
+	0xC8, 0xDA, 0xEC, 0xFE, 0x80, 0x92, 0xA4, 0xB6, 0x58, 0x4A, 0x7C, 0x6E, 0x10, 0x02, 0x34, 0x26,
+	0xFA, 0xE8, 0xDE, 0xCC, 0xB2, 0xA0, 0x96, 0x84, 0x6A, 0x78, 0x4E, 0x5C, 0x22, 0x30, 0x06, 0x14,
+	0xAC, 0xBE, 0x88, 0x9A, 0xE4, 0xF6, 0xC0, 0xD2, 0x3C, 0x2E, 0x18, 0x0A, 0x74, 0x66, 0x50, 0x42,
+	0x9E, 0x8C, 0xBA, 0xA8, 0xD6, 0xC4, 0xF2, 0xE0, 0x0E, 0x1C, 0x2A, 0x38, 0x46, 0x54, 0x62, 0x70,
+	0x82, 0x90, 0xA6, 0xB4, 0xCA, 0xD8, 0xEE, 0xFC, 0x12, 0x00, 0x36, 0x24, 0x5A, 0x48, 0x7E, 0x6C,
+	0xB0, 0xA2, 0x94, 0x86, 0xF8, 0xEA, 0xDC, 0xCE, 0x20, 0x32, 0x04, 0x16, 0x68, 0x7A, 0x4C, 0x5E,
+	0xE6, 0xF4, 0xC2, 0xD0, 0xAE, 0xBC, 0x8A, 0x98, 0x76, 0x64, 0x52, 0x40, 0x3E, 0x2C, 0x1A, 0x08,
+	0xD4, 0xC6, 0xF0, 0xE2, 0x9C, 0x8E, 0xB8, 0xAA, 0x44, 0x56, 0x60, 0x72, 0x0C, 0x1E, 0x28, 0x3A,
+	0x4A, 0x58, 0x6E, 0x7C, 0x02, 0x10, 0x26, 0x34, 0xDA, 0xC8, 0xFE, 0xEC, 0x92, 0x80, 0xB6, 0xA4,
+	0x78, 0x6A, 0x5C, 0x4E, 0x30, 0x22, 0x14, 0x06, 0xE8, 0xFA, 0xCC, 0xDE, 0xA0, 0xB2, 0x84, 0x96,
+	0x2E, 0x3C, 0x0A, 0x18, 0x66, 0x74, 0x42, 0x50, 0xBE, 0xAC, 0x9A, 0x88, 0xF6, 0xE4, 0xD2, 0xC0,
+	0x1C, 0x0E, 0x38, 0x2A, 0x54, 0x46, 0x70, 0x62, 0x8C, 0x9E, 0xA8, 0xBA, 0xC4, 0xD6, 0xE0, 0xF2,
+};
+
+static const uint16_t s_misaka_spi_sd_crc16_table[256] =
+{
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+#endif
+
+/**
+ * @brief cs为高时提供时钟（上电时钟与释放cs后使卡释放MISO）
+ * @param sd sd卡
+ * @param length 字节数
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_clocks(misaka_spi_sd_t *sd, uint32_t length)
+{
+	uint8_t dummy[10];
+	misaka_spi_message_t message;
+
+	memset(dummy, 0xFF, sizeof(dummy));
+	message.send_buf = dummy;
+	message.recv_buf = NULL;
+	message.length = length < sizeof(dummy) ? length : sizeof(dummy);
+	message.next = NULL;
+	message.cs_take = 0;
+	message.cs_release = 0;
+	message.lines = MISAKA_SPI_LINES_SINGLE;
+	message.dummy_cycles = 0;
+	message.dc = MISAKA_SPI_DC_NONE;
+
+	return misaka_spi_transfer_message(sd->spi, &message);
+}
+
+/**
+ * @brief 选中卡，打开spi会话
+ * @param sd sd卡
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_select(misaka_spi_sd_t *sd)
+{
+	sd->look_pos = 0;
+	sd->look_len = 0;
+
+	return misaka_spi_session_open(sd->spi);
+}
+
+/**
+ * @brief 释放卡，关闭spi会话后再提供8个时钟
+ * @param sd sd卡
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_deselect(misaka_spi_sd_t *sd)
+{
+	uint8_t result;
+
+	sd->look_pos = 0;
+	sd->look_len = 0;
+
+	result = misaka_spi_session_close(sd->spi);
+	if (misaka_spi_sd_clocks(sd, 1) != 0)
+	{
+		result = 1;
+	}
+
+	return result;
+}
+
+/**
+ * @brief 读取数据，先取预读缓冲中的字节，其余以0xFF全双工读取
+ * @param sd sd卡
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_recv(misaka_spi_sd_t *sd, uint8_t *buf, uint32_t len)
+{
+	uint32_t n = sd->look_len - sd->look_pos;
+
+	if (n > len)
+	{
+		n = len;
+	}
+	memcpy(buf, &sd->look[sd->look_pos], n);
+	sd->look_pos += (uint8_t) n;
+	if (n == len)
+	{
+		return 0;
+	}
+
+	/** < 读取时MOSI需保持高电平 */
+	memset(buf + n, 0xFF, len - n);
+
+	return misaka_spi_session_transfer(sd->spi, buf + n, buf + n, len - n);
+}
+
+/**
+ * @brief 突发轮询
+ * @param sd sd卡
+ * @param wait MISAKA_SPI_SD_WAIT_x
+ * @param value 满足条件的字节（可为NULL）
+ * @param max 最多轮询的字节数
+ * @return 0:成功 1:失败或超时
+ */
+static uint8_t misaka_spi_sd_poll(misaka_spi_sd_t *sd, uint8_t wait, uint8_t *value, uint32_t max)
+{
+	uint32_t polled = 0;
+	uint8_t byte, found;
+
+	for (;;)
+	{
+		while (sd->look_pos < sd->look_len)
+		{
+			byte = sd->look[sd->look_pos++];
+			switch (wait)
+			{
+			case MISAKA_SPI_SD_WAIT_R1:
+				found = (byte & 0x80) == 0;
+				break;
+			case MISAKA_SPI_SD_WAIT_TOKEN:
+				found = byte != 0xFF;
+				break;
+			default:
+				found = byte == 0xFF;
+				break;
+			}
+			if (found)
+			{
+				if (value != NULL)
+				{
+					*value = byte;
+				}
+				return 0;
+			}
+		}
+
+		if (polled >= max)
+		{
+			return 1;
+		}
+		memset(sd->look, 0xFF, sizeof(sd->look));
+		if (misaka_spi_session_transfer(sd->spi, sd->look, sd->look, sizeof(sd->look)) != 0)
+		{
+			return 1;
+		}
+		sd->look_pos = 0;
+		sd->look_len = sizeof(sd->look);
+		polled += sizeof(sd->look);
+		sd->polls++;
+	}
+}
+
+/**
+ * @brief 发送命令并读取R1，除CMD0与CMD12外先等待忙结束
+ * @param sd sd卡
+ * @param cmd 命令
+ * @param arg 参数
+ * @param r1 R1响应
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_command(misaka_spi_sd_t *sd, uint8_t cmd, uint32_t arg, uint8_t *r1)
+{
+	uint8_t frame[6];
+	uint8_t stuff;
+
+	if (cmd != 0 && cmd != 12 && misaka_spi_sd_poll(sd, MISAKA_SPI_SD_WAIT_READY, NULL, MISAKA_SPI_SD_BUSY_POLL) != 0)
+	{
+		return 1;
+	}
+	sd->look_pos = 0;
+	sd->look_len = 0;
+
+	frame[0] = (uint8_t) (0x40 | cmd);
+	frame[1] = (uint8_t) (arg >> 24);
+	frame[2] = (uint8_t) (arg >> 16);
+	frame[3] = (uint8_t) (arg >> 8);
+	frame[4] = (uint8_t) arg;
+	frame[5] = (uint8_t) (misaka_spi_sd_crc7(frame, 5) | 0x01);
+
+	sd->commands++;
+	if (misaka_spi_session_transfer(sd->spi, frame, NULL, sizeof(frame)) != 0)
+	{
+		return 1;
+	}
+
+	/** < CMD12之后的第一个字节无效 */
+	if (cmd == 12 && misaka_spi_sd_recv(sd, &stuff, 1) != 0)
+	{
+		return 1;
+	}
+
+	return misaka_spi_sd_poll(sd, MISAKA_SPI_SD_WAIT_R1, r1, 16);
+}
+
+/**
+ * @brief 发送应用命令（CMD55 + ACMDx）
+ * @param sd sd卡
+ * @param cmd 命令
+ * @param arg 参数
+ * @param r1 R1响应
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_acmd(misaka_spi_sd_t *sd, uint8_t cmd, uint32_t arg, uint8_t *r1)
+{
+	if (misaka_spi_sd_command(sd, 55, 0, r1) != 0 || (*r1 & 0xFE) != 0)
+	{
+		return 1;
+	}
+
+	return misaka_spi_sd_command(sd, cmd, arg, r1);
+}
+
+/**
+ * @brief 选中卡发送一条命令，读取其后的响应字节后释放
+ * @param sd sd卡
+ * @param cmd 命令
+ * @param arg 参数
+ * @param r1 R1响应
+ * @param extra R3/R7的后续字节（可为NULL）
+ * @param len 后续字节长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_command_once(misaka_spi_sd_t *sd, uint8_t cmd, uint32_t arg, uint8_t *r1, uint8_t *extra, uint32_t len)
+{
+	uint8_t result;
+
+	if (misaka_spi_sd_select(sd) != 0)
+	{
+		return 1;
+	}
+	result = misaka_spi_sd_command(sd, cmd, arg, r1);
+	if (result == 0 && len != 0 && (*r1 & 0xFE) == 0)
+	{
+		result = misaka_spi_sd_recv(sd, extra, len);
+	}
+	if (misaka_spi_sd_deselect(sd) != 0)
+	{
+		result = 1;
+	}
+
+	return result;
+}
+
+/**
+ * @brief 读数据块：等待数据令牌，读取数据与CRC16
+ * @param sd sd卡
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_read_data(misaka_spi_sd_t *sd, uint8_t *buf, uint32_t len)
+{
+	uint8_t token, crc[2];
+
+	if (misaka_spi_sd_poll(sd, MISAKA_SPI_SD_WAIT_TOKEN, &token, MISAKA_SPI_SD_TOKEN_POLL) != 0 || token != 0xFE)
+	{
+		return 1;
+	}
+	if (misaka_spi_sd_recv(sd, buf, len) != 0 || misaka_spi_sd_recv(sd, crc, 2) != 0)
+	{
+		return 1;
+	}
+	if (sd->use_crc && misaka_spi_sd_crc16(buf, len) != (uint16_t) ((crc[0] << 8) | crc[1]))
+	{
+		sd->crc_errors++;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 写数据块：等待忙结束，令牌、数据与CRC16在一条消息链中发出，然后读取数据响应
+ * @param sd sd卡
+ * @param token 数据令牌
+ * @param buf 待写入数据
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_write_data(misaka_spi_sd_t *sd, uint8_t token, uint8_t *buf)
+{
+	uint8_t i, crc[2], response;
+	uint16_t value;
+	misaka_spi_message_t message[3];
+
+	if (misaka_spi_sd_poll(sd, MISAKA_SPI_SD_WAIT_READY, NULL, MISAKA_SPI_SD_BUSY_POLL) != 0)
+	{
+		return 1;
+	}
+	sd->look_pos = 0;
+	sd->look_len = 0;
+
+	value = sd->use_crc ? misaka_spi_sd_crc16(buf, MISAKA_SPI_SD_BLOCK_SIZE) : 0xFFFF;
+	crc[0] = (uint8_t) (value >> 8);
+	crc[1] = (uint8_t) value;
+
+	message[0].send_buf = &token;
+	message[0].length = 1;
+	message[0].next = &message[1];
+	message[1].send_buf = buf;
+	message[1].length = MISAKA_SPI_SD_BLOCK_SIZE;
+	message[1].next = &message[2];
+	message[2].send_buf = crc;
+	message[2].length = 2;
+	message[2].next = NULL;
+	for (i = 0; i < 3; i++)
+	{
+		message[i].recv_buf = NULL;
+		message[i].lines = MISAKA_SPI_LINES_SINGLE;
+		message[i].dummy_cycles = 0;
+		message[i].dc = MISAKA_SPI_DC_NONE;
+	}
+
+	if (misaka_spi_session_message(sd->spi, message) != 0)
+	{
+		return 1;
+	}
+
+	if (misaka_spi_sd_poll(sd, MISAKA_SPI_SD_WAIT_TOKEN, &response, 16) != 0)
+	{
+		return 1;
+	}
+	if ((response & 0x1F) != 0x05)
+	{
+		if ((response & 0x1F) == 0x0B)
+		{
+			sd->crc_errors++;
+		}
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 块号转换为命令地址
+ * @param sd sd卡
+ * @param block 块号
+ * @return uint32_t @c 地址
+ */
+static uint32_t misaka_spi_sd_addr(misaka_spi_sd_t *sd, uint32_t block)
+{
+	return sd->type == MISAKA_SPI_SD_TYPE_SDHC ? block : block * MISAKA_SPI_SD_BLOCK_SIZE;
+}
+
+/**
+ * @brief 初始化：以init_hz完成上电时钟、CMD0/CMD8/ACMD41/CMD58，读取CSD得到容量，然后切换到max_hz
+ * @param sd sd卡
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_init(misaka_spi_sd_t *sd)
+{
+	misaka_spi_configuration_t cfg;
+	uint8_t result = 1, r1, ocr[4], csd[16];
+	uint32_t i, c_size;
+
+	misaka_spi_assert(sd != NULL);
+	misaka_spi_assert(sd->spi != NULL);
+	misaka_spi_assert(sd->delay_ms != NULL);
+
+	sd->type = MISAKA_SPI_SD_TYPE_NONE;
+	sd->block_num = 0;
+	sd->commands = 0;
+	sd->polls = 0;
+	sd->crc_errors = 0;
+	sd->look_pos = 0;
+	sd->look_len = 0;
+
+	cfg = sd->spi->config;
+	cfg.max_hz = sd->init_hz;
+	misaka_spi_configure(sd->spi, &cfg);
+
+	/** < cs为高时至少74个时钟 */
+	if (misaka_spi_sd_clocks(sd, 10) != 0)
+	{
+		return 1;
+	}
+
+	for (i = 0; i < 10; i++)
+	{
+		if (misaka_spi_sd_command_once(sd, 0, 0, &r1, NULL, 0) == 0 && r1 == 0x01)
+		{
+			break;
+		}
+	}
+	if (i == 10)
+	{
+		return 1;
+	}
+
+	if (misaka_spi_sd_command_once(sd, 8, 0x1AA, &r1, ocr, 4) != 0)
+	{
+		return 1;
+	}
+	if (r1 == 0x01)
+	{
+		if ((ocr[2] & 0x0F) != 0x01 || ocr[3] != 0xAA)
+		{
+			return 1;
+		}
+		sd->type = MISAKA_SPI_SD_TYPE_SDV2;
+	}
+	else
+	{
+		sd->type = MISAKA_SPI_SD_TYPE_SDV1;
+	}
+
+	if (sd->use_crc && (misaka_spi_sd_command_once(sd, 59, 1, &r1, NULL, 0) != 0 || (r1 & 0xFE) != 0))
+	{
+		goto __exit;
+	}
+
+	for (i = 0; i < 1000; i++)
+	{
+		if (misaka_spi_sd_select(sd) != 0)
+		{
+			result = 1;
+			goto __exit;
+		}
+		result = misaka_spi_sd_acmd(sd, 41, sd->type == MISAKA_SPI_SD_TYPE_SDV2 ? 0x40000000UL : 0, &r1);
+		if (misaka_spi_sd_deselect(sd) != 0 || result != 0 || (r1 & 0xFE) != 0)
+		{
+			result = 1;
+			goto __exit;
+		}
+		if (r1 == 0)
+		{
+			break;
+		}
+		sd->delay_ms(1);
+	}
+	result = 1;
+	if (i == 1000)
+	{
+		goto __exit;
+	}
+
+	if (sd->type == MISAKA_SPI_SD_TYPE_SDV2)
+	{
+		if (misaka_spi_sd_command_once(sd, 58, 0, &r1, ocr, 4) != 0 || r1 != 0)
+		{
+			goto __exit;
+		}
+		if (ocr[0] & 0x40)
+		{
+			sd->type = MISAKA_SPI_SD_TYPE_SDHC;
+		}
+	}
+	if (sd->type != MISAKA_SPI_SD_TYPE_SDHC
+		&& (misaka_spi_sd_command_once(sd, 16, MISAKA_SPI_SD_BLOCK_SIZE, &r1, NULL, 0) != 0 || r1 != 0))
+	{
+		goto __exit;
+	}
+
+	if (misaka_spi_sd_select(sd) != 0)
+	{
+		goto __exit;
+	}
+	if (misaka_spi_sd_command(sd, 9, 0, &r1) == 0 && r1 == 0 && misaka_spi_sd_read_data(sd, csd, 16) == 0)
+	{
+		result = 0;
+	}
+	if (misaka_spi_sd_deselect(sd) != 0 || result != 0)
+	{
+		result = 1;
+		goto __exit;
+	}
+
+	if ((csd[0] >> 6) == 1)
+	{
+		c_size = ((uint32_t) (csd[7] & 0x3F) << 16) | ((uint32_t) csd[8] << 8) | csd[9];
+		sd->block_num = (c_size + 1) << 10;
+	}
+	else
+	{
+		c_size = ((uint32_t) (csd[6] & 0x03) << 10) | ((uint32_t) csd[7] << 2) | (csd[8] >> 6);
+		i = (uint32_t) (((csd[9] & 0x03) << 1) | (csd[10] >> 7)) + 2 + (csd[5] & 0x0F);
+		sd->block_num = (c_size + 1) << (i - 9);
+	}
+
+	cfg.max_hz = sd->max_hz;
+	misaka_spi_configure(sd->spi, &cfg);
+
+__exit:
+	if (result != 0)
+	{
+		sd->type = MISAKA_SPI_SD_TYPE_NONE;
+	}
+
+	return result;
+}
+
+/**
+ * @brief 读块，多块时使用CMD18连续读取
+ * @param sd sd卡
+ * @param block 起始块号
+ * @param buf 待接收数据，count * MISAKA_SPI_SD_BLOCK_SIZE字节
+ * @param count 块数
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_read(misaka_spi_sd_t *sd, uint32_t block, uint8_t *buf, uint32_t count)
+{
+	uint8_t result = 1, r1;
+	uint32_t i;
+
+	misaka_spi_assert(sd != NULL);
+
+	if (count == 0)
+	{
+		return 0;
+	}
+	if (sd->type == MISAKA_SPI_SD_TYPE_NONE || block + count > sd->block_num)
+	{
+		return 1;
+	}
+
+	if (misaka_spi_sd_select(sd) != 0)
+	{
+		return 1;
+	}
+	if (count == 1)
+	{
+		if (misaka_spi_sd_command(sd, 17, misaka_spi_sd_addr(sd, block), &r1) == 0 && r1 == 0)
+		{
+			result = misaka_spi_sd_read_data(sd, buf, MISAKA_SPI_SD_BLOCK_SIZE);
+		}
+	}
+	else if (misaka_spi_sd_command(sd, 18, misaka_spi_sd_addr(sd, block), &r1) == 0 && r1 == 0)
+	{
+		for (i = 0; i < count; i++)
+		{
+			if (misaka_spi_sd_read_data(sd, buf + i * MISAKA_SPI_SD_BLOCK_SIZE, MISAKA_SPI_SD_BLOCK_SIZE) != 0)
+			{
+				break;
+			}
+		}
+		if (misaka_spi_sd_command(sd, 12, 0, &r1) == 0 && i == count)
+		{
+			result = 0;
+		}
+	}
+
+	if (misaka_spi_sd_deselect(sd) != 0)
+	{
+		result = 1;
+	}
+
+	return result;
+}
+
+/**
+ * @brief 写块，多块时先以ACMD23预擦除再使用CMD25连续写入；最后的编程忙状态在下一条命令前等待
+ * @param sd sd卡
+ * @param block 起始块号
+ * @param buf 待写入数据，count * MISAKA_SPI_SD_BLOCK_SIZE字节
+ * @param count 块数
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_write(misaka_spi_sd_t *sd, uint32_t block, uint8_t *buf, uint32_t count)
+{
+	uint8_t result = 1, r1, stop = 0xFD;
+	uint32_t i;
+
+	misaka_spi_assert(sd != NULL);
+
+	if (count == 0)
+	{
+		return 0;
+	}
+	if (sd->type == MISAKA_SPI_SD_TYPE_NONE || block + count > sd->block_num)
+	{
+		return 1;
+	}
+
+	if (misaka_spi_sd_select(sd) != 0)
+	{
+		return 1;
+	}
+	if (count == 1)
+	{
+		if (misaka_spi_sd_command(sd, 24, misaka_spi_sd_addr(sd, block), &r1) == 0 && r1 == 0)
+		{
+			result = misaka_spi_sd_write_data(sd, 0xFE, buf);
+		}
+	}
+	else
+	{
+		/** < 预擦除只是提示，失败时不影响写入 */
+		misaka_spi_sd_acmd(sd, 23, count, &r1);
+
+		if (misaka_spi_sd_command(sd, 25, misaka_spi_sd_addr(sd, block), &r1) == 0 && r1 == 0)
+		{
+			for (i = 0; i < count; i++)
+			{
+				if (misaka_spi_sd_write_data(sd, 0xFC, buf + i * MISAKA_SPI_SD_BLOCK_SIZE) != 0)
+				{
+					break;
+				}
+			}
+			if (misaka_spi_sd_poll(sd, MISAKA_SPI_SD_WAIT_READY, NULL, MISAKA_SPI_SD_BUSY_POLL) == 0
+				&& misaka_spi_session_transfer(sd->spi, &stop, NULL, 1) == 0 && i == count)
+			{
+				result = 0;
+			}
+		}
+	}
+
+	if (misaka_spi_sd_deselect(sd) != 0)
+	{
+		result = 1;
+	}
+
+	return result;
+}
+
+/**
+ * @brief 等待写入完成
+ * @param sd sd卡
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_sd_sync(misaka_spi_sd_t *sd)
+{
+	uint8_t result;
+
+	misaka_spi_assert(sd != NULL);
+
+	if (misaka_spi_sd_select(sd) != 0)
+	{
+		return 1;
+	}
+	result = misaka_spi_sd_poll(sd, MISAKA_SPI_SD_WAIT_READY, NULL, MISAKA_SPI_SD_BUSY_POLL);
+	if (misaka_spi_sd_deselect(sd) != 0)
+	{
+		result = 1;
+	}
+
+	return result;
+}
+
+/**
+ * @brief 计算CRC7（命令帧），结果位于高7位
+ * @param buf 数据
+ * @param len 数据长度
+ * @return uint8_t @c crc << 1
+ */
+uint8_t misaka_spi_sd_crc7(const uint8_t *buf, uint32_t len)
+{
+	uint8_t crc = 0;
+#ifdef MISAKA_SPI_SD_USING_CRC_TABLE
+
+	while (len--)
+	{
+		crc = s_misaka_spi_sd_crc7_table[crc ^ *buf++];
+	}
+#else
+	uint8_t i;
+
+	while (len--)
+	{
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+		{
+			crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x12) : (uint8_t) (crc << 1);
+		}
+	}
+#endif
+
+	return crc;
+}
+
+/**
+ * @brief 计算CRC16-CCITT（数据块）
+ * @param buf 数据
+ * @param len 数据长度
+ * @return uint16_t @c crc
+ */
+uint16_t misaka_spi_sd_crc16(const uint8_t *buf, uint32_t len)
+{
+	uint16_t crc = 0;
+#ifdef MISAKA_SPI_SD_USING_CRC_TABLE
+
+	while (len--)
+	{
+		crc = (uint16_t) ((crc << 8) ^ s_misaka_spi_sd_crc16_table[((crc >> 8) ^ *buf++) & 0xFF]);
+	}
+#else
+	uint8_t i;
+
+	while (len--)
+	{
+		crc ^= (uint16_t) (*buf++ << 8);
+		for (i = 0; i < 8; i++)
+		{
+			crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+		}
+	}
+#endif
+
+	return crc;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file spi_sd_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/spi_sd.h"
+
+static misaka_spi_sd_t s_misaka_spi_sd_obj;
+misaka_spi_sd_t *misaka_spi_sd_obj = NULL;
+
+/**
+ * @brief 毫秒延时
+ * @param ms 毫秒
+ */
+static void delay_ms(uint32_t ms)
+{
+
+}
+
+static int misaka_spi_sd_port_init(misaka_spi_t *spi)
+{
+	s_misaka_spi_sd_obj.spi = spi;
+	s_misaka_spi_sd_obj.delay_ms = delay_ms;
+	s_misaka_spi_sd_obj.init_hz = 400000;
+	s_misaka_spi_sd_obj.max_hz = 25000000;
+	s_misaka_spi_sd_obj.use_crc = 0;/**< 开启后数据块额外计算CRC16，定义MISAKA_SPI_SD_USING_CRC_TABLE使用查表实现 */
+
+	if (misaka_spi_sd_init(&s_misaka_spi_sd_obj) != 0)
+	{
+		return 0;
+	}
+	misaka_spi_sd_obj = &s_misaka_spi_sd_obj;
+
+	return 1;
+}
@@ -0,0 +1,503 @@
+/**
+ * @file spi_sd_sim.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 仿真sd卡（SDHC）：按字节解析spi模式命令，支持CMD0/8/9/12/16/17/18/24/25/55/58/59与ACMD23/41，
+ * 开启CMD59后校验命令与数据crc。ACMD41需重复3次才退出空闲状态，写块后保持busy_bytes字节忙，
+ * CMD12之后的填充字节为0x5A以检验驱动是否正确丢弃。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_sd.h"
+
+#define MISAKA_SPI_SD_SIM_QUEUE         (MISAKA_SPI_SD_BLOCK_SIZE + 16)
+
+#define MISAKA_SPI_SD_SIM_IDLE          0
+#define MISAKA_SPI_SD_SIM_READ_MULTI    1
+#define MISAKA_SPI_SD_SIM_WRITE_SINGLE  2
+#define MISAKA_SPI_SD_SIM_WRITE_MULTI   3
+
+struct misaka_spi_sd_sim_struct
+{
+	uint8_t *mem;
+	uint32_t block_num;
+	uint32_t busy_bytes;
+
+	uint8_t selected;
+	uint8_t idle;
+	uint8_t app;
+	uint8_t crc_on;
+	uint8_t init_polls;
+	uint8_t mode;
+	uint32_t block;
+
+	uint8_t frame[6];
+	uint8_t frame_len;
+	uint8_t receiving;
+	uint8_t data[MISAKA_SPI_SD_BLOCK_SIZE + 2];
+	uint32_t data_len;
+
+	uint8_t queue[MISAKA_SPI_SD_SIM_QUEUE];
+	uint32_t queue_pos;
+	uint32_t queue_len;
+	uint32_t busy;
+
+	uint32_t stat_commands;
+	uint32_t stat_bytes;
+};
+
+static struct misaka_spi_sd_sim_struct s_sim;
+static misaka_spi_bus_t s_sim_bus;
+
+/**
+ * @brief 追加待输出的字节
+ * @param byte 字节
+ */
+static void misaka_spi_sd_sim_push(uint8_t byte)
+{
+	if (s_sim.queue_pos + s_sim.queue_len < MISAKA_SPI_SD_SIM_QUEUE)
+	{
+		s_sim.queue[s_sim.queue_pos + s_sim.queue_len++] = byte;
+	}
+}
+
+/**
+ * @brief 追加一个数据块：令牌、数据与CRC16
+ * @param buf 数据
+ * @param len 数据长度
+ */
+static void misaka_spi_sd_sim_push_data(const uint8_t *buf, uint32_t len)
+{
+	uint16_t crc = misaka_spi_sd_crc16(buf, len);
+	uint32_t i;
+
+	misaka_spi_sd_sim_push(0xFE);
+	for (i = 0; i < len; i++)
+	{
+		misaka_spi_sd_sim_push(buf[i]);
+	}
+	misaka_spi_sd_sim_push((uint8_t) (crc >> 8));
+	misaka_spi_sd_sim_push((uint8_t) crc);
+}
+
+/**
+ * @brief 生成CSD（版本2.0）并输出
+ */
+static void misaka_spi_sd_sim_push_csd(void)
+{
+	uint8_t csd[16];
+	uint32_t c_size = s_sim.block_num / 1024 - 1;
+
+	memset(csd, 0, sizeof(csd));
+	csd[0] = 0x40;
+	csd[5] = 0x09;
+	csd[7] = (uint8_t) ((c_size >> 16) & 0x3F);
+	csd[8] = (uint8_t) (c_size >> 8);
+	csd[9] = (uint8_t) c_size;
+	csd[15] = (uint8_t) ((misaka_spi_sd_crc7(csd, 15)) | 0x01);
+
+	misaka_spi_sd_sim_push_data(csd, sizeof(csd));
+}
+
+/**
+ * @brief 收到完整的写数据块
+ */
+static void misaka_spi_sd_sim_write_done(void)
+{
+	uint16_t crc = (uint16_t) ((s_sim.data[MISAKA_SPI_SD_BLOCK_SIZE] << 8) | s_sim.data[MISAKA_SPI_SD_BLOCK_SIZE + 1]);
+
+	s_sim.receiving = 0;
+	if (s_sim.crc_on && misaka_spi_sd_crc16(s_sim.data, MISAKA_SPI_SD_BLOCK_SIZE) != crc)
+	{
+		misaka_spi_sd_sim_push(0x0B);
+		return;
+	}
+
+	if (s_sim.block < s_sim.block_num)
+	{
+		memcpy(&s_sim.mem[s_sim.block * MISAKA_SPI_SD_BLOCK_SIZE], s_sim.data, MISAKA_SPI_SD_BLOCK_SIZE);
+	}
+	s_sim.block++;
+	misaka_spi_sd_sim_push(0x05);
+	s_sim.busy = s_sim.busy_bytes;
+	if (s_sim.mode == MISAKA_SPI_SD_SIM_WRITE_SINGLE)
+	{
+		s_sim.mode = MISAKA_SPI_SD_SIM_IDLE;
+	}
+}
+
+/**
+ * @brief 收到完整的命令帧
+ */
+static void misaka_spi_sd_sim_command(void)
+{
+	uint8_t cmd = s_sim.frame[0] & 0x3F;
+	uint32_t arg = ((uint32_t) s_sim.frame[1] << 24) | ((uint32_t) s_sim.frame[2] << 16)
+	               | ((uint32_t) s_sim.frame[3] << 8) | s_sim.frame[4];
+	uint8_t r1 = s_sim.idle ? 0x01 : 0x00;
+	uint8_t app = s_sim.app;
+
+	s_sim.stat_commands++;
+	s_sim.app = 0;
+
+	if (cmd == 12)
+	{
+		s_sim.mode = MISAKA_SPI_SD_SIM_IDLE;
+		s_sim.queue_pos = 0;
+		s_sim.queue_len = 0;
+		misaka_spi_sd_sim_push(0x5A);
+		misaka_spi_sd_sim_push(r1);
+		s_sim.busy = 2;
+		return;
+	}
+
+	misaka_spi_sd_sim_push(0xFF);
+	if ((s_sim.crc_on || cmd == 0 || cmd == 8) && (misaka_spi_sd_crc7(s_sim.frame, 5) | 0x01) != s_sim.frame[5])
+	{
+		misaka_spi_sd_sim_push((uint8_t) (r1 | 0x08));
+		return;
+	}
+
+	if (app)
+	{
+		switch (cmd)
+		{
+		case 41:
+			if (s_sim.init_polls)
+			{
+				s_sim.init_polls--;
+			}
+			else
+			{
+				s_sim.idle = 0;
+			}
+			misaka_spi_sd_sim_push(s_sim.idle ? 0x01 : 0x00);
+			break;
+		case 23:
+			misaka_spi_sd_sim_push(r1);
+			break;
+		default:
+			misaka_spi_sd_sim_push((uint8_t) (r1 | 0x04));
+			break;
+		}
+		return;
+	}
+
+	switch (cmd)
+	{
+	case 0:
+		s_sim.idle = 1;
+		s_sim.crc_on = 0;
+		s_sim.init_polls = 3;
+		s_sim.mode = MISAKA_SPI_SD_SIM_IDLE;
+		misaka_spi_sd_sim_push(0x01);
+		break;
+	case 8:
+		misaka_spi_sd_sim_push(r1);
+		misaka_spi_sd_sim_push(0x00);
+		misaka_spi_sd_sim_push(0x00);
+		misaka_spi_sd_sim_push((uint8_t) ((arg >> 8) & 0x0F));
+		misaka_spi_sd_sim_push((uint8_t) arg);
+		break;
+	case 9:
+		misaka_spi_sd_sim_push(r1);
+		misaka_spi_sd_sim_push(0xFF);
+		misaka_spi_sd_sim_push_csd();
+		break;
+	case 16:
+		misaka_spi_sd_sim_push(r1);
+		break;
+	case 17:
+		if (arg >= s_sim.block_num)
+		{
+			misaka_spi_sd_sim_push((uint8_t) (r1 | 0x40));
+			break;
+		}
+		misaka_spi_sd_sim_push(r1);
+		misaka_spi_sd_sim_push(0xFF);
+		misaka_spi_sd_sim_push_data(&s_sim.mem[arg * MISAKA_SPI_SD_BLOCK_SIZE], MISAKA_SPI_SD_BLOCK_SIZE);
+		break;
+	case 18:
+		misaka_spi_sd_sim_push(r1);
+		s_sim.mode = MISAKA_SPI_SD_SIM_READ_MULTI;
+		s_sim.block = arg;
+		break;
+	case 24:
+	case 25:
+		misaka_spi_sd_sim_push(r1);
+		s_sim.mode = cmd == 24 ? MISAKA_SPI_SD_SIM_WRITE_SINGLE : MISAKA_SPI_SD_SIM_WRITE_MULTI;
+		s_sim.block = arg;
+		break;
+	case 55:
+		s_sim.app = 1;
+		misaka_spi_sd_sim_push(r1);
+		break;
+	case 58:
+		misaka_spi_sd_sim_push(r1);
+		misaka_spi_sd_sim_push(s_sim.idle ? 0x40 : 0xC0);
+		misaka_spi_sd_sim_push(0xFF);
+		misaka_spi_sd_sim_push(0x80);
+		misaka_spi_sd_sim_push(0x00);
+		break;
+	case 59:
+		s_sim.crc_on = arg & 0x01;
+		misaka_spi_sd_sim_push(r1);
+		break;
+	default:
+		misaka_spi_sd_sim_push((uint8_t) (r1 | 0x04));
+		break;
+	}
+}
+
+/**
+ * @brief 传输一个字节
+ * @param tx 主机发送的字节
+ * @return uint8_t @c 卡输出的字节
+ */
+static uint8_t misaka_spi_sd_sim_byte(uint8_t tx)
+{
+	uint8_t rx = 0xFF;
+
+	if (!s_sim.selected)
+	{
+		return 0xFF;
+	}
+	s_sim.stat_bytes++;
+
+	if (s_sim.queue_len == 0 && s_sim.busy == 0 && s_sim.mode == MISAKA_SPI_SD_SIM_READ_MULTI)
+	{
+		s_sim.queue_pos = 0;
+		misaka_spi_sd_sim_push(0xFF);
+		if (s_sim.block < s_sim.block_num)
+		{
+			misaka_spi_sd_sim_push_data(&s_sim.mem[s_sim.block * MISAKA_SPI_SD_BLOCK_SIZE], MISAKA_SPI_SD_BLOCK_SIZE);
+			s_sim.block++;
+		}
+		else
+		{
+			misaka_spi_sd_sim_push(0x08);
+			s_sim.mode = MISAKA_SPI_SD_SIM_IDLE;
+		}
+	}
+
+	if (s_sim.queue_len)
+	{
+		rx = s_sim.queue[s_sim.queue_pos++];
+		if (--s_sim.queue_len == 0)
+		{
+			s_sim.queue_pos = 0;
+		}
+	}
+	else if (s_sim.busy)
+	{
+		s_sim.busy--;
+		rx = 0x00;
+	}
+
+	if (s_sim.receiving)
+	{
+		s_sim.data[s_sim.data_len++] = tx;
+		if (s_sim.data_len == sizeof(s_sim.data))
+		{
+			misaka_spi_sd_sim_write_done();
+		}
+		return rx;
+	}
+
+	if ((s_sim.mode == MISAKA_SPI_SD_SIM_WRITE_SINGLE || s_sim.mode == MISAKA_SPI_SD_SIM_WRITE_MULTI)
+		&& s_sim.frame_len == 0 && s_sim.busy == 0 && s_sim.queue_len == 0)
+	{
+		if ((tx == 0xFE && s_sim.mode == MISAKA_SPI_SD_SIM_WRITE_SINGLE)
+			|| (tx == 0xFC && s_sim.mode == MISAKA_SPI_SD_SIM_WRITE_MULTI))
+		{
+			s_sim.receiving = 1;
+			s_sim.data_len = 0;
+			return rx;
+		}
+		if (tx == 0xFD && s_sim.mode == MISAKA_SPI_SD_SIM_WRITE_MULTI)
+		{
+			s_sim.mode = MISAKA_SPI_SD_SIM_IDLE;
+			s_sim.busy = s_sim.busy_bytes;
+			return rx;
+		}
+	}
+
+	if (s_sim.frame_len == 0 && (tx & 0xC0) != 0x40)
+	{
+		return rx;
+	}
+	s_sim.frame[s_sim.frame_len++] = tx;
+	if (s_sim.frame_len == sizeof(s_sim.frame))
+	{
+		s_sim.frame_len = 0;
+		misaka_spi_sd_sim_command();
+	}
+
+	return rx;
+}
+
+/**
+ * @brief 发送的时候接收数据
+ * @param ctx 未使用
+ * @param txbuf 待发送数据
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_sim_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		rxbuf[i] = misaka_spi_sd_sim_byte(txbuf[i]);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 发送数据
+ * @param ctx 未使用
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_sim_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		misaka_spi_sd_sim_byte(txbuf[i]);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 接收数据
+ * @param ctx 未使用
+ * @param rxbuf 待接收数据
+ * @param length 数据长度
+ * @return 0:成功 1:失败
+ */
+static uint8_t misaka_spi_sd_sim_recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		rxbuf[i] = misaka_spi_sd_sim_byte(0xFF);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 获取互斥量，仿真总线无需互斥
+ * @param ctx 未使用
+ */
+static void misaka_spi_sd_sim_mutex_take(void *ctx)
+{
+	(void) ctx;
+}
+
+/**
+ * @brief 释放互斥量，仿真总线无需互斥
+ * @param ctx 未使用
+ */
+static void misaka_spi_sd_sim_mutex_release(void *ctx)
+{
+	(void) ctx;
+}
+
+static const misaka_spi_bus_ops_t misaka_spi_sd_sim_ops = {
+	misaka_spi_sd_sim_send_recv,
+	misaka_spi_sd_sim_send,
+	misaka_spi_sd_sim_recv,
+	misaka_spi_sd_sim_mutex_take,
+	misaka_spi_sd_sim_mutex_release,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+
+/**
+ * @brief 初始化仿真sd卡（SDHC），返回的总线按SPI模式协议读写mem，可用于在主机上测试与评估sd驱动
+ * @param mem 存储空间，block_num * MISAKA_SPI_SD_BLOCK_SIZE字节
+ * @param block_num 块数，需为1024的整数倍
+ * @param busy_bytes 写块后保持忙的字节数
+ * @return misaka_spi_bus_t* @c 仿真总线
+ */
+misaka_spi_bus_t *misaka_spi_sd_sim_init(uint8_t *mem, uint32_t block_num, uint32_t busy_bytes)
+{
+	memset(&s_sim, 0, sizeof(s_sim));
+	s_sim.mem = mem;
+	s_sim.block_num = block_num;
+	s_sim.busy_bytes = busy_bytes;
+	s_sim.idle = 1;
+
+	memset(&s_sim_bus, 0, sizeof(s_sim_bus));
+	s_sim_bus.ops = &misaka_spi_sd_sim_ops;
+	s_sim_bus.ctx = NULL;
+
+	return &s_sim_bus;
+}
+
+/**
+ * @brief 仿真sd卡的cs引脚
+ * @param ctx 未使用
+ * @param state 0: 低电平 1: 高电平
+ */
+static void misaka_spi_sd_sim_set_cs(void *ctx, uint8_t state)
+{
+	(void) ctx;
+
+	s_sim.selected = state ? 0 : 1;
+	s_sim.frame_len = 0;
+	s_sim.queue_pos = 0;
+	s_sim.queue_len = 0;
+}
+
+/**
+ * 仿真sd卡的cs操作表，作为misaka_spi_t的cs_ops使用
+ */
+const misaka_spi_cs_ops_t misaka_spi_sd_sim_cs_ops = {
+	misaka_spi_sd_sim_set_cs,
+	NULL,
+};
+
+/**
+ * @brief 仿真sd卡的统计
+ * @param commands 收到的命令数
+ * @param bytes 总线上传输的字节数
+ */
+void misaka_spi_sd_sim_stat(uint32_t *commands, uint32_t *bytes)
+{
+	if (commands != NULL)
+	{
+		*commands = s_sim.stat_commands;
+	}
+	if (bytes != NULL)
+	{
+		*bytes = s_sim.stat_bytes;
+	}
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test.h
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#ifndef __MISAKA_TEST_H__
+#define __MISAKA_TEST_H__
+
+#include <stdio.h>
+
+/**
+ * 检查条件，不成立时输出位置并使所在函数返回1；测试函数返回0为通过
+ */
+#define misaka_test_check(expr)                                                         \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(expr))                                                                    \
+        {                                                                               \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);             \
+            return 1;                                                                   \
+        }                                                                               \
+    } while (0)
+
+/**
+ * 运行一个测试函数并累计失败数
+ */
+#define misaka_test_run(failures, fn)                                                   \
+    do                                                                                  \
+    {                                                                                   \
+        if (fn() != 0)                                                                  \
+        {                                                                               \
+            printf("FAIL %s\n", #fn);                                                   \
+            (failures)++;                                                               \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            printf("ok   %s\n", #fn);                                                   \
+        }                                                                               \
+    } while (0)
+
+#endif //__MISAKA_TEST_H__
@@ -0,0 +1,209 @@
+/**
+ * @file test_block_cache.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 块缓存：以内存模拟存储设备，检查预读不挤出最近访问的块、被预读覆盖的脏块先写回，
+ * 以及LRU与CLOCK两种策略下顺序扫描时预读持续生效、读出的数据与存储设备一致。
+ */
+
+#include <string.h>
+#include "misaka_device/block_cache.h"
+#include "test.h"
+
+#define TEST_BLOCK_SIZE         16
+#define TEST_BLOCK_NUM          8
+#define TEST_DEVICE_BLOCKS      64
+
+static uint8_t s_device[TEST_DEVICE_BLOCKS * TEST_BLOCK_SIZE];
+static uint8_t s_image[TEST_DEVICE_BLOCKS * TEST_BLOCK_SIZE];/**< 经缓存写入后应有的内容 */
+static uint8_t s_arena[TEST_BLOCK_SIZE * TEST_BLOCK_NUM];
+static misaka_block_cache_entry_t s_entries[TEST_BLOCK_NUM];
+static misaka_block_cache_t s_cache;
+
+static uint8_t test_device_read(void *device, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	(void) device;
+
+	memcpy(buf, &s_device[addr], len);
+
+	return 0;
+}
+
+static uint8_t test_device_write(void *device, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+	(void) device;
+
+	memcpy(&s_device[addr], buf, len);
+
+	return 0;
+}
+
+/**
+ * @brief 填充存储设备并初始化缓存
+ * @param policy 替换策略
+ */
+static void test_setup(uint8_t policy)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(s_device); i++)
+	{
+		s_device[i] = (uint8_t) (i * 7 + i / TEST_BLOCK_SIZE);
+	}
+	memcpy(s_image, s_device, sizeof(s_image));
+
+	memset(&s_cache, 0, sizeof(s_cache));
+	s_cache.read = test_device_read;
+	s_cache.write = test_device_write;
+	s_cache.capacity = sizeof(s_device);
+	s_cache.arena = s_arena;
+	s_cache.entries = s_entries;
+	s_cache.block_size = TEST_BLOCK_SIZE;
+	s_cache.block_num = TEST_BLOCK_NUM;
+	s_cache.readahead = 4;
+	s_cache.policy = policy;
+	s_cache.write_mode = MISAKA_BLOCK_CACHE_WRITE_BACK;
+	misaka_block_cache_init(&s_cache);
+}
+
+/**
+ * @brief 经缓存写入
+ * @param addr 地址
+ * @param value 填充值
+ * @param len 数据长度
+ * @return 0:成功 1:失败
+ */
+static int test_write(uint32_t addr, uint8_t value, uint32_t len)
+{
+	uint8_t buf[TEST_BLOCK_SIZE];
+
+	memset(buf, value, len);
+	memset(&s_image[addr], value, len);
+	misaka_test_check(misaka_block_cache_write(&s_cache, addr, buf, len) == 0);
+
+	return 0;
+}
+
+/**
+ * @brief 读数据并与应有的内容比较
+ * @param block 块号
+ * @param offset 块内偏移
+ * @param len 数据长度
+ * @return 0:通过 1:失败
+ */
+static int test_read(uint32_t block, uint32_t offset, uint32_t len)
+{
+	uint8_t buf[TEST_BLOCK_SIZE * 2];
+	uint32_t addr = block * TEST_BLOCK_SIZE + offset;
+
+	misaka_test_check(misaka_block_cache_read(&s_cache, addr, buf, len) == 0);
+	misaka_test_check(memcmp(buf, &s_image[addr], len) == 0);
+
+	return 0;
+}
+
+static int test_block_cache_hot(void)
+{
+	uint32_t i, reads;
+
+	test_setup(MISAKA_BLOCK_CACHE_LRU);
+
+	/** < 缓存块0为块50，缓存块1~6为分散读入的块，缓存块7为最近写入的脏块40，缓存块6最久未访问 */
+	misaka_test_check(test_read(50, 0, 1) == 0);
+	for (i = 0; i < 6; i++)
+	{
+		misaka_test_check(test_read(10 + i * 2, 0, 1) == 0);
+	}
+	misaka_test_check(test_write(40 * TEST_BLOCK_SIZE, 0x3C, TEST_BLOCK_SIZE) == 0);
+	for (i = 0; i < 5; i++)
+	{
+		misaka_test_check(test_read(10 + i * 2, 0, 1) == 0);
+	}
+	misaka_test_check(test_write(40 * TEST_BLOCK_SIZE + 4, 0x5A, 4) == 0);
+
+	/** < 在块50内连续读取触发顺序访问，未命中的块51选中缓存块6，其后的缓存块7是热块 */
+	misaka_test_check(test_read(50, 0, 4) == 0);
+	misaka_test_check(test_read(50, 4, 4) == 0);
+	misaka_test_check(test_read(50, 8, 8) == 0);
+	misaka_test_check(test_read(51, 0, TEST_BLOCK_SIZE) == 0);
+
+	/** < 脏块40仍在缓存中，未被写回也未被重新读入 */
+	reads = s_cache.device_reads;
+	misaka_test_check(test_read(40, 0, TEST_BLOCK_SIZE) == 0);
+	misaka_test_check(s_cache.device_reads == reads);
+	misaka_test_check(s_cache.device_writes == 0);
+
+	return 0;
+}
+
+/**
+ * @brief 写入若干脏块后顺序扫描整个存储设备
+ * @param policy 替换策略
+ * @return 0:通过 1:失败
+ */
+static int test_scan(uint8_t policy)
+{
+	uint32_t block, readahead;
+
+	test_setup(policy);
+
+	misaka_test_check(test_write(3 * TEST_BLOCK_SIZE + 2, 0xA5, 4) == 0);
+	misaka_test_check(test_write(60 * TEST_BLOCK_SIZE, 0xA5, TEST_BLOCK_SIZE) == 0);
+	/** < 尚未写回 */
+	misaka_test_check(memcmp(s_device, s_image, sizeof(s_device)) != 0);
+
+	for (block = 0; block < TEST_DEVICE_BLOCKS / 2; block++)
+	{
+		misaka_test_check(test_read(block, 0, TEST_BLOCK_SIZE) == 0);
+	}
+	readahead = s_cache.readahead_blocks;
+	for (; block < TEST_DEVICE_BLOCKS; block++)
+	{
+		misaka_test_check(test_read(block, 0, TEST_BLOCK_SIZE) == 0);
+	}
+	/** < 被预读覆盖的脏块3已写回 */
+	misaka_test_check(memcmp(&s_device[3 * TEST_BLOCK_SIZE], &s_image[3 * TEST_BLOCK_SIZE], TEST_BLOCK_SIZE) == 0);
+
+	/** < 缓存装满之后预读仍然生效 */
+	misaka_test_check(s_cache.readahead_blocks - readahead >= TEST_DEVICE_BLOCKS / 4);
+	misaka_test_check(s_cache.device_reads < TEST_DEVICE_BLOCKS / 2);
+
+	misaka_test_check(misaka_block_cache_flush(&s_cache) == 0);
+	misaka_test_check(memcmp(s_device, s_image, sizeof(s_device)) == 0);
+
+	return 0;
+}
+
+static int test_block_cache_scan_lru(void)
+{
+	return test_scan(MISAKA_BLOCK_CACHE_LRU);
+}
+
+static int test_block_cache_scan_clock(void)
+{
+	return test_scan(MISAKA_BLOCK_CACHE_CLOCK);
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_block_cache_hot);
+	misaka_test_run(failures, test_block_cache_scan_lru);
+	misaka_test_run(failures, test_block_cache_scan_clock);
+
+	return failures != 0;
+}
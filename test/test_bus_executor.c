@@ -0,0 +1,360 @@
+/**
+ * @file test_bus_executor.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 多总线执行器：两条仿真spi总线与一条仿真i2c总线上，同一总线的请求按提交顺序执行、不同总线并行，
+ * wait返回请求结果，wait_all与stop等待全部请求（包括回调中再次提交的请求）。
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include "misaka_device/bus_executor.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_SPI_BUSES          2
+#define TEST_WORKERS            (TEST_SPI_BUSES + 1)
+#define TEST_REQUESTS           48                          /**< 每条总线的请求数，多于槽位数以覆盖队列满时的重试 */
+#define TEST_CELLS              16
+
+/**
+ * 仿真spi总线外加阻塞与失败注入，sim须为第一个成员：操作表的ctx即指向本结构体
+ */
+struct test_bus_struct
+{
+	misaka_sim_spi_t sim;
+	misaka_spi_bus_t bus;
+	misaka_spi_t device;
+	uint8_t block;/**< 为1时发送阻塞到另一条总线也进入发送 */
+	uint8_t fail;/**< 为1时发送失败 */
+};
+
+struct test_order_struct
+{
+	uint32_t index[TEST_REQUESTS * 2];
+	uint32_t num;
+};
+
+static struct test_bus_struct s_spi[TEST_SPI_BUSES];
+static misaka_sim_gpio_t s_gpio;
+static misaka_soft_i2c_bus_t s_i2c;
+static misaka_spi_bus_ops_t s_ops;
+
+static misaka_bus_worker_t s_workers[TEST_WORKERS];
+static misaka_bus_queue_cell_t s_cells[TEST_WORKERS][TEST_CELLS];
+static misaka_bus_executor_t s_exec;
+
+static misaka_bus_request_t s_requests[TEST_WORKERS][TEST_REQUESTS];
+static misaka_spi_message_t s_messages[TEST_SPI_BUSES][TEST_REQUESTS];
+static misaka_soft_i2c_message s_i2c_msgs[TEST_REQUESTS];
+static uint8_t s_data[4] = {0x11, 0x22, 0x33, 0x44};
+static struct test_order_struct s_order[TEST_WORKERS];
+static uint32_t s_resubmit;
+
+static volatile uint32_t s_inside;
+static volatile uint32_t s_max_inside;
+
+/**
+ * @brief 阻塞时等待另一条总线也进入发送，最多1s；串行执行时超时，最大并发数保持为1
+ * @param t 总线
+ */
+static void test_block(struct test_bus_struct *t)
+{
+	struct timespec start, now;
+	uint32_t inside;
+
+	if (!t->block)
+	{
+		return;
+	}
+
+	inside = __atomic_add_fetch(&s_inside, 1, __ATOMIC_ACQ_REL);
+	if (inside > __atomic_load_n(&s_max_inside, __ATOMIC_ACQUIRE))
+	{
+		__atomic_store_n(&s_max_inside, inside, __ATOMIC_RELEASE);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	do
+	{
+		sched_yield();
+		clock_gettime(CLOCK_MONOTONIC, &now);
+	} while (__atomic_load_n(&s_max_inside, __ATOMIC_ACQUIRE) < TEST_SPI_BUSES
+		&& (now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec) < 1000000000L);
+
+	__atomic_sub_fetch(&s_inside, 1, __ATOMIC_ACQ_REL);
+}
+
+static uint8_t test_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	struct test_bus_struct *t = (struct test_bus_struct *) ctx;
+
+	test_block(t);
+
+	return t->fail ? 1 : misaka_sim_spi_ops.send_recv(ctx, txbuf, rxbuf, length);
+}
+
+static uint8_t test_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	struct test_bus_struct *t = (struct test_bus_struct *) ctx;
+
+	test_block(t);
+
+	return t->fail ? 1 : misaka_sim_spi_ops.send(ctx, txbuf, length);
+}
+
+/**
+ * @brief 在工作线程中记录完成顺序，每条总线只有一个工作线程，无需加锁
+ * @param request 请求
+ * @param result 结果
+ */
+static void test_callback(misaka_bus_request_t *request, uint8_t result)
+{
+	struct test_order_struct *order = (struct test_order_struct *) request->user_data;
+	uint32_t w = (uint32_t) (order - s_order);
+
+	(void) result;
+
+	if (order->num < sizeof(order->index) / sizeof(order->index[0]))
+	{
+		order->index[order->num++] = (uint32_t) (request - s_requests[w]);
+	}
+}
+
+/**
+ * @brief 第一个请求完成时再次提交自身一次，用于检查wait_all包括回调中提交的请求
+ * @param request 请求
+ * @param result 结果
+ */
+static void test_resubmit_callback(misaka_bus_request_t *request, uint8_t result)
+{
+	test_callback(request, result);
+	if (s_resubmit > 0)
+	{
+		s_resubmit--;
+		misaka_bus_executor_submit(&s_exec, request);
+	}
+}
+
+/**
+ * @brief 初始化仿真总线、请求与执行器，并启动工作线程
+ * @return 0:成功 1:失败
+ */
+static uint8_t test_setup(void)
+{
+	uint32_t b, i;
+
+	s_ops = misaka_sim_spi_ops;
+	s_ops.send_recv = test_send_recv;
+	s_ops.send = test_send;
+
+	memset(s_spi, 0, sizeof(s_spi));
+	memset(s_requests, 0, sizeof(s_requests));
+	memset(s_messages, 0, sizeof(s_messages));
+	memset(s_order, 0, sizeof(s_order));
+	memset(s_workers, 0, sizeof(s_workers));
+	s_inside = 0;
+	s_max_inside = 0;
+	s_resubmit = 0;
+
+	for (b = 0; b < TEST_SPI_BUSES; b++)
+	{
+		misaka_sim_spi_bus_init(&s_spi[b].bus, &s_spi[b].device, &s_spi[b].sim);
+		s_spi[b].bus.ops = &s_ops;
+		s_workers[b].bus = &s_spi[b].bus;
+
+		for (i = 0; i < TEST_REQUESTS; i++)
+		{
+			s_messages[b][i].send_buf = s_data;
+			s_messages[b][i].length = sizeof(s_data);
+			s_messages[b][i].cs_take = 1;
+			s_messages[b][i].cs_release = 1;
+			s_requests[b][i].type = MISAKA_BUS_REQUEST_SPI;
+			s_requests[b][i].spi = &s_spi[b].device;
+			s_requests[b][i].message = &s_messages[b][i];
+		}
+	}
+
+	misaka_sim_i2c_bus_init(&s_i2c, &s_gpio, 1);
+	s_workers[TEST_SPI_BUSES].bus = &s_i2c;
+	for (i = 0; i < TEST_REQUESTS; i++)
+	{
+		s_i2c_msgs[i].addr = 0x50;
+		s_i2c_msgs[i].flags = MISAKA_SOFT_I2C_WR;
+		s_i2c_msgs[i].len = sizeof(s_data);
+		s_i2c_msgs[i].buf = s_data;
+		s_requests[TEST_SPI_BUSES][i].type = MISAKA_BUS_REQUEST_I2C;
+		s_requests[TEST_SPI_BUSES][i].i2c = &s_i2c;
+		s_requests[TEST_SPI_BUSES][i].msgs = &s_i2c_msgs[i];
+		s_requests[TEST_SPI_BUSES][i].num = 1;
+	}
+
+	for (b = 0; b < TEST_WORKERS; b++)
+	{
+		s_workers[b].cells = s_cells[b];
+		s_workers[b].size = TEST_CELLS;
+		for (i = 0; i < TEST_REQUESTS; i++)
+		{
+			s_requests[b][i].callback = test_callback;
+			s_requests[b][i].user_data = &s_order[b];
+		}
+	}
+
+	s_exec.workers = s_workers;
+	s_exec.count = TEST_WORKERS;
+
+	return misaka_bus_executor_start(&s_exec);
+}
+
+/**
+ * @brief 提交请求，队列满时让出后重试
+ * @param request 请求
+ */
+static void test_submit(misaka_bus_request_t *request)
+{
+	while (misaka_bus_executor_submit(&s_exec, request) != 0)
+	{
+		sched_yield();
+	}
+}
+
+static int test_bus_executor_order(void)
+{
+	uint32_t b, i;
+
+	misaka_test_check(test_setup() == 0);
+
+	/** < 各总线交错提交 */
+	for (i = 0; i < TEST_REQUESTS; i++)
+	{
+		for (b = 0; b < TEST_WORKERS; b++)
+		{
+			test_submit(&s_requests[b][i]);
+		}
+	}
+	misaka_bus_executor_wait_all(&s_exec);
+
+	for (b = 0; b < TEST_WORKERS; b++)
+	{
+		misaka_test_check(s_order[b].num == TEST_REQUESTS);
+		for (i = 0; i < TEST_REQUESTS; i++)
+		{
+			misaka_test_check(s_order[b].index[i] == i);
+			misaka_test_check(s_requests[b][i].busy == 0);
+			misaka_test_check(s_requests[b][i].result == 0);
+		}
+	}
+	for (b = 0; b < TEST_SPI_BUSES; b++)
+	{
+		misaka_test_check(s_spi[b].sim.bytes == TEST_REQUESTS * sizeof(s_data));
+		misaka_test_check(s_spi[b].sim.cs_toggles == TEST_REQUESTS * 2);
+	}
+	misaka_bus_executor_stop(&s_exec);
+
+	return 0;
+}
+
+static int test_bus_executor_parallel(void)
+{
+	uint32_t b;
+
+	misaka_test_check(test_setup() == 0);
+	for (b = 0; b < TEST_SPI_BUSES; b++)
+	{
+		s_spi[b].block = 1;
+	}
+
+	for (b = 0; b < TEST_SPI_BUSES; b++)
+	{
+		test_submit(&s_requests[b][0]);
+	}
+	for (b = 0; b < TEST_SPI_BUSES; b++)
+	{
+		misaka_test_check(misaka_bus_executor_wait(&s_exec, &s_requests[b][0]) == 0);
+	}
+	misaka_test_check(s_max_inside == TEST_SPI_BUSES);
+	misaka_bus_executor_stop(&s_exec);
+
+	return 0;
+}
+
+static int test_bus_executor_wait(void)
+{
+	misaka_bus_request_t orphan;
+	misaka_spi_bus_t other_bus;
+	misaka_spi_t other;
+	misaka_sim_spi_t other_sim;
+
+	misaka_test_check(test_setup() == 0);
+
+	/** < 失败结果经wait返回 */
+	s_spi[0].fail = 1;
+	test_submit(&s_requests[0][0]);
+	misaka_test_check(misaka_bus_executor_wait(&s_exec, &s_requests[0][0]) == 1);
+	misaka_test_check(s_requests[0][0].result == 1);
+	s_spi[0].fail = 0;
+	test_submit(&s_requests[0][0]);
+	misaka_test_check(misaka_bus_executor_wait(&s_exec, &s_requests[0][0]) == 0);
+
+	/** < 没有工作线程的总线被拒绝，且不计入等待数 */
+	misaka_sim_spi_bus_init(&other_bus, &other, &other_sim);
+	orphan = s_requests[0][1];
+	orphan.spi = &other;
+	misaka_test_check(misaka_bus_executor_submit(&s_exec, &orphan) == 1);
+	misaka_bus_executor_wait_all(&s_exec);
+
+	/** < 回调中再次提交的请求同样被wait_all等待 */
+	s_resubmit = 3;
+	s_requests[1][0].callback = test_resubmit_callback;
+	test_submit(&s_requests[1][0]);
+	misaka_bus_executor_wait_all(&s_exec);
+	misaka_test_check(s_order[1].num == 4);
+	misaka_test_check(s_requests[1][0].busy == 0);
+
+	misaka_bus_executor_stop(&s_exec);
+
+	return 0;
+}
+
+static int test_bus_executor_stop(void)
+{
+	uint32_t i;
+
+	misaka_test_check(test_setup() == 0);
+	for (i = 0; i < TEST_CELLS; i++)
+	{
+		test_submit(&s_requests[TEST_SPI_BUSES][i]);
+	}
+	misaka_bus_executor_stop(&s_exec);
+	misaka_test_check(s_order[TEST_SPI_BUSES].num == TEST_CELLS);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_bus_executor_order);
+	misaka_test_run(failures, test_bus_executor_parallel);
+	misaka_test_run(failures, test_bus_executor_wait);
+	misaka_test_run(failures, test_bus_executor_stop);
+
+	return failures != 0;
+}
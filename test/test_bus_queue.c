@@ -0,0 +1,250 @@
+/**
+ * @file test_bus_queue.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 总线请求队列：顺序、满、重复投递，以及多个投递线程与一个处理线程并发时每次投递恰好执行一次。
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "misaka_device/bus_queue.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_PRODUCERS          4
+#define TEST_REQUESTS           16                          /**< 每个投递线程的请求数 */
+#define TEST_POSTS              20000                       /**< 每个投递线程的投递次数 */
+
+static misaka_sim_gpio_t s_gpio;
+static misaka_soft_i2c_bus_t s_bus;
+static uint8_t s_data[4] = {1, 2, 3, 4};
+static misaka_soft_i2c_message s_msg = {0x50, MISAKA_SOFT_I2C_WR, sizeof(s_data), s_data};
+
+static misaka_bus_queue_t s_queue;
+static misaka_bus_queue_cell_t s_cells[8];
+static uint32_t s_done[TEST_PRODUCERS][TEST_REQUESTS];
+static uint32_t s_order[16];
+static uint32_t s_order_num;
+static int s_stop;
+
+/**
+ * @brief 记录完成次数与顺序，在处理方线程中调用
+ * @param request 请求
+ * @param result 结果
+ */
+static void test_callback(misaka_bus_request_t *request, uint8_t result)
+{
+	(void) result;
+
+	(*(uint32_t *) request->user_data)++;
+	if (s_order_num < sizeof(s_order) / sizeof(s_order[0]))
+	{
+		s_order[s_order_num++] = (uint32_t) ((uint32_t *) request->user_data - &s_done[0][0]);
+	}
+}
+
+/**
+ * @brief 初始化i2c请求
+ * @param request 请求
+ * @param counter 完成计数
+ */
+static void test_request_init(misaka_bus_request_t *request, uint32_t *counter)
+{
+	memset(request, 0, sizeof(*request));
+	request->type = MISAKA_BUS_REQUEST_I2C;
+	request->i2c = &s_bus;
+	request->msgs = &s_msg;
+	request->num = 1;
+	request->callback = test_callback;
+	request->user_data = counter;
+}
+
+/**
+ * @brief 初始化队列与仿真总线
+ * @param size 槽位数
+ * @return 0:成功 1:失败
+ */
+static uint8_t test_setup(uint32_t size)
+{
+	memset(s_done, 0, sizeof(s_done));
+	s_order_num = 0;
+	misaka_sim_i2c_bus_init(&s_bus, &s_gpio, 1);
+
+	memset(&s_queue, 0, sizeof(s_queue));
+	s_queue.cells = s_cells;
+	s_queue.size = size;
+
+	return misaka_bus_queue_init(&s_queue);
+}
+
+static int test_bus_queue_init(void)
+{
+	misaka_test_check(test_setup(6) == 1);
+	misaka_test_check(test_setup(8) == 0);
+
+	return 0;
+}
+
+static int test_bus_queue_order(void)
+{
+	misaka_bus_request_t requests[9];
+	uint32_t i;
+
+	misaka_test_check(test_setup(8) == 0);
+	for (i = 0; i < 9; i++)
+	{
+		test_request_init(&requests[i], &s_done[0][i]);
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		misaka_test_check(misaka_bus_queue_post(&s_queue, &requests[i]) == 0);
+	}
+	misaka_test_check(misaka_bus_queue_post(&s_queue, &requests[8]) == 1);
+	misaka_test_check(s_queue.overflows == 1);
+	misaka_test_check(misaka_bus_queue_post(&s_queue, &requests[0]) == 1);
+	misaka_test_check(s_queue.duplicates == 1);
+
+	misaka_test_check(misaka_bus_queue_process(&s_queue) == 8);
+	misaka_test_check(s_order_num == 8);
+	for (i = 0; i < 8; i++)
+	{
+		misaka_test_check(s_order[i] == i);
+		misaka_test_check(requests[i].busy == 0);
+		misaka_test_check(requests[i].result == 0);
+	}
+
+	/** < 完成后可再次投递，满时被拒绝的请求未被标记为忙 */
+	misaka_test_check(misaka_bus_queue_post(&s_queue, &requests[8]) == 0);
+	misaka_test_check(misaka_bus_queue_post(&s_queue, &requests[0]) == 0);
+	misaka_test_check(misaka_bus_queue_process(&s_queue) == 2);
+	misaka_test_check(s_done[0][8] == 1 && s_done[0][0] == 2);
+	misaka_test_check(s_queue.processed == 10);
+
+	return 0;
+}
+
+/**
+ * @brief 投递线程：轮流投递自己的请求，失败（队列满或上次未完成）时让出后重试
+ * @param arg 投递计数，TEST_REQUESTS个
+ * @return void* @c NULL
+ */
+static void *test_producer(void *arg)
+{
+	uint32_t *posts = (uint32_t *) arg;
+	uint32_t id = (uint32_t) (posts[TEST_REQUESTS]);
+	misaka_bus_request_t requests[TEST_REQUESTS];
+	uint32_t i, n;
+
+	for (i = 0; i < TEST_REQUESTS; i++)
+	{
+		test_request_init(&requests[i], &s_done[id][i]);
+	}
+
+	for (n = 0; n < TEST_POSTS; n++)
+	{
+		i = n % TEST_REQUESTS;
+		while (misaka_bus_queue_post(&s_queue, &requests[i]) != 0)
+		{
+			sched_yield();
+		}
+		posts[i]++;
+	}
+
+	/** < 请求在栈上，返回前等待全部完成 */
+	for (i = 0; i < TEST_REQUESTS; i++)
+	{
+		while (__atomic_load_n(&requests[i].busy, __ATOMIC_ACQUIRE) != 0)
+		{
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief 处理线程：持续处理直到停止，最后再处理一次剩余请求
+ * @param arg 未使用
+ * @return void* @c NULL
+ */
+static void *test_consumer(void *arg)
+{
+	(void) arg;
+
+	while (!__atomic_load_n(&s_stop, __ATOMIC_ACQUIRE))
+	{
+		if (misaka_bus_queue_process(&s_queue) == 0)
+		{
+			sched_yield();
+		}
+	}
+	misaka_bus_queue_process(&s_queue);
+
+	return NULL;
+}
+
+static int test_bus_queue_stress(void)
+{
+	static uint32_t posts[TEST_PRODUCERS][TEST_REQUESTS + 1];
+	pthread_t producers[TEST_PRODUCERS], consumer;
+	uint32_t i, j, total = 0;
+
+	misaka_test_check(test_setup(8) == 0);
+	memset(posts, 0, sizeof(posts));
+	s_stop = 0;
+
+	misaka_test_check(pthread_create(&consumer, NULL, test_consumer, NULL) == 0);
+	for (i = 0; i < TEST_PRODUCERS; i++)
+	{
+		posts[i][TEST_REQUESTS] = i;
+		misaka_test_check(pthread_create(&producers[i], NULL, test_producer, posts[i]) == 0);
+	}
+	for (i = 0; i < TEST_PRODUCERS; i++)
+	{
+		pthread_join(producers[i], NULL);
+	}
+	__atomic_store_n(&s_stop, 1, __ATOMIC_RELEASE);
+	pthread_join(consumer, NULL);
+
+	for (i = 0; i < TEST_PRODUCERS; i++)
+	{
+		for (j = 0; j < TEST_REQUESTS; j++)
+		{
+			misaka_test_check(s_done[i][j] == posts[i][j]);
+			total += posts[i][j];
+		}
+	}
+	misaka_test_check(total == TEST_PRODUCERS * TEST_POSTS);
+	misaka_test_check(s_queue.processed == total);
+	printf("     %u posts, %u overflows, %u duplicates\n", total, s_queue.overflows, s_queue.duplicates);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_bus_queue_init);
+	misaka_test_run(failures, test_bus_queue_order);
+	misaka_test_run(failures, test_bus_queue_stress);
+
+	return failures != 0;
+}
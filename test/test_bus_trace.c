@@ -0,0 +1,189 @@
+/**
+ * @file test_bus_trace.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 总线轨迹：同一spi总线上只记录与回放挂接的设备，其他设备原样访问总线；两个轨迹分别挂接两条总线时互不影响；
+ * 使用共享操作表的i2c总线记录后回放不访问引脚，发送数据不同时计入mismatches；解除挂接后恢复原操作表。
+ */
+
+#include <string.h>
+#include "misaka_device/bus_trace.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_TRACE_SIZE         512
+#define TEST_LENGTH             8
+
+static uint8_t s_buf[2][TEST_TRACE_SIZE];
+static uint8_t s_tx[TEST_LENGTH] = {0x9F, 0x01, 0x02, 0x03, 0xA0, 0xB1, 0xC2, 0xD3};
+
+/**
+ * @brief 清零轨迹并指定缓冲区
+ * @param trace 轨迹
+ * @param buf 缓冲区
+ * @param length 回放时的轨迹长度
+ */
+static void test_trace_init(misaka_bus_trace_t *trace, uint8_t *buf, uint32_t length)
+{
+	memset(trace, 0, sizeof(*trace));
+	trace->buf = buf;
+	trace->size = TEST_TRACE_SIZE;
+	trace->length = length;
+}
+
+static int test_bus_trace_spi_filter(void)
+{
+	misaka_bus_trace_t trace;
+	misaka_sim_spi_t sim = {0};
+	misaka_spi_bus_t bus;
+	misaka_spi_t traced, other;
+	uint8_t rx[TEST_LENGTH];
+	uint32_t bytes, toggles;
+
+	misaka_sim_spi_bus_init(&bus, &traced, &sim);
+	other = traced;
+
+	test_trace_init(&trace, s_buf[0], 0);
+	misaka_test_check(misaka_bus_trace_record_init(&trace) == 0);
+	misaka_bus_trace_spi_attach(&trace, &traced);
+	misaka_test_check(misaka_spi_transfer(&traced, s_tx, rx, TEST_LENGTH) == 0);
+	misaka_test_check(misaka_spi_send(&other, s_tx, 4) == 0);
+	misaka_test_check(misaka_spi_transfer(&traced, s_tx, rx, TEST_LENGTH) == 0);
+	misaka_bus_trace_detach(&trace);
+
+	misaka_test_check(sim.bytes == 2 * TEST_LENGTH + 4);
+	misaka_test_check(trace.stat.tx_bytes == 2 * TEST_LENGTH);
+	misaka_test_check(trace.stat.cs_asserts == 2);
+	misaka_test_check(bus.ops == &misaka_sim_spi_ops && bus.ctx == &sim);
+	misaka_test_check(traced.cs_ops == &misaka_sim_spi_cs_ops && traced.cs_ctx == &sim);
+
+	/** < 回放时挂接的设备不访问总线，另一设备仍访问总线 */
+	test_trace_init(&trace, s_buf[0], trace.length);
+	misaka_test_check(misaka_bus_trace_replay_init(&trace) == 0);
+	misaka_bus_trace_spi_attach(&trace, &traced);
+	bytes = sim.bytes;
+	toggles = sim.cs_toggles;
+	memset(rx, 0, sizeof(rx));
+	misaka_test_check(misaka_spi_transfer(&traced, s_tx, rx, TEST_LENGTH) == 0);
+	misaka_test_check(memcmp(rx, s_tx, TEST_LENGTH) == 0);
+	misaka_test_check(misaka_spi_send(&other, s_tx, 4) == 0);
+	misaka_test_check(misaka_spi_transfer(&traced, s_tx, rx, TEST_LENGTH) == 0);
+	misaka_bus_trace_detach(&trace);
+
+	misaka_test_check(sim.bytes == bytes + 4);
+	misaka_test_check(sim.cs_toggles == toggles + 2);
+	misaka_test_check(trace.stat.mismatches == 0);
+
+	return 0;
+}
+
+static int test_bus_trace_spi_buses(void)
+{
+	misaka_bus_trace_t trace[2];
+	misaka_sim_spi_t sim[2] = {{0}, {0}};
+	misaka_spi_bus_t bus[2];
+	misaka_spi_t device[2];
+	uint8_t rx[TEST_LENGTH];
+	uint8_t i;
+
+	for (i = 0; i < 2; i++)
+	{
+		misaka_sim_spi_bus_init(&bus[i], &device[i], &sim[i]);
+		test_trace_init(&trace[i], s_buf[i], 0);
+		misaka_test_check(misaka_bus_trace_record_init(&trace[i]) == 0);
+		misaka_bus_trace_spi_attach(&trace[i], &device[i]);
+	}
+
+	misaka_test_check(misaka_spi_transfer(&device[0], s_tx, rx, TEST_LENGTH) == 0);
+	misaka_test_check(misaka_spi_send(&device[1], s_tx, 3) == 0);
+	misaka_test_check(misaka_spi_send(&device[1], s_tx, 2) == 0);
+
+	for (i = 0; i < 2; i++)
+	{
+		misaka_bus_trace_detach(&trace[i]);
+		misaka_test_check(bus[i].ops == &misaka_sim_spi_ops && bus[i].ctx == &sim[i]);
+	}
+	misaka_test_check(trace[0].stat.tx_bytes == TEST_LENGTH && trace[0].stat.cs_asserts == 1);
+	misaka_test_check(trace[1].stat.tx_bytes == 5 && trace[1].stat.cs_asserts == 2);
+	misaka_test_check(sim[0].bytes == TEST_LENGTH && sim[1].bytes == 5);
+
+	return 0;
+}
+
+static int test_bus_trace_i2c_bus(void)
+{
+	misaka_bus_trace_t trace;
+	misaka_sim_gpio_t gpio = {0};
+	misaka_soft_i2c_bus_t bus;
+	misaka_soft_i2c_message msgs[2];
+	uint8_t reg = 0x12, data[2];
+	uint32_t callbacks, length;
+
+	misaka_sim_i2c_bus_init(&bus, &gpio, 1);
+	msgs[0].addr = 0x50;
+	msgs[0].flags = MISAKA_SOFT_I2C_WR;
+	msgs[0].len = 1;
+	msgs[0].buf = &reg;
+	msgs[1].addr = 0x50;
+	msgs[1].flags = MISAKA_SOFT_I2C_RD;
+	msgs[1].len = sizeof(data);
+	msgs[1].buf = data;
+
+	test_trace_init(&trace, s_buf[0], 0);
+	misaka_test_check(misaka_bus_trace_record_init(&trace) == 0);
+	misaka_bus_trace_i2c_bus_attach(&trace, &bus);
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&bus, msgs, 2) == 2);
+	misaka_bus_trace_detach(&trace);
+
+	misaka_test_check(trace.stat.i2c_starts == 2);
+	misaka_test_check(trace.stat.tx_bytes == 3);
+	misaka_test_check(trace.stat.rx_bytes == sizeof(data));
+	misaka_test_check(trace.stat.nacks == 0);
+	misaka_test_check(bus.ops == &misaka_sim_i2c_ops && bus.ctx == &gpio);
+	length = trace.length;
+
+	/** < 回放时只转发互斥量 */
+	test_trace_init(&trace, s_buf[0], length);
+	misaka_test_check(misaka_bus_trace_replay_init(&trace) == 0);
+	misaka_bus_trace_i2c_bus_attach(&trace, &bus);
+	callbacks = gpio.callbacks;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&bus, msgs, 2) == 2);
+	misaka_test_check(gpio.callbacks == callbacks + 2);
+	misaka_test_check(trace.stat.mismatches == 0);
+	misaka_bus_trace_detach(&trace);
+
+	/** < 写入的寄存器地址与记录不同 */
+	reg = 0x34;
+	test_trace_init(&trace, s_buf[0], length);
+	misaka_test_check(misaka_bus_trace_replay_init(&trace) == 0);
+	misaka_bus_trace_i2c_bus_attach(&trace, &bus);
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&bus, msgs, 2) == 2);
+	misaka_test_check(trace.stat.mismatches != 0);
+	misaka_bus_trace_detach(&trace);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_bus_trace_spi_filter);
+	misaka_test_run(failures, test_bus_trace_spi_buses);
+	misaka_test_run(failures, test_bus_trace_i2c_bus);
+
+	return failures != 0;
+}
@@ -0,0 +1,469 @@
+/**
+ * @file test_coroutine.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 协程：在仿真gpio上记录引脚操作序列，可恢复的模拟i2c传输与misaka_soft_i2c_bus_transfer逐项比较
+ * （7位地址读写、10位地址读、地址未应答重试、数据未应答与NO_START），返回值与统计也须一致，
+ * 延时全部让出与全部忙等两种方式都要覆盖；另检查两个spi协程共用协作锁时传输不交错。
+ */
+
+#include <string.h>
+#include "misaka_device/coroutine.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_TRACE_MAX          2048
+#define TEST_US                 10
+#define TEST_ADDR               0x50
+#define TEST_ADDR_10BIT         0x2F0
+#define TEST_ADDR_ABSENT        0x51
+#define TEST_POLL_MAX           100000
+
+#define TEST_EVENT_SDA          1
+#define TEST_EVENT_SCL          2
+#define TEST_EVENT_GET_SDA      3
+#define TEST_EVENT_SDA_OUT      4
+#define TEST_EVENT_SDA_IN       5
+#define TEST_EVENT_DELAY        6
+
+/**
+ * 一次引脚操作或延时
+ */
+struct test_event_struct
+{
+	uint8_t type;/**< TEST_EVENT_x */
+	uint16_t value;/**< 电平、读到的电平或延时 */
+};
+
+static struct test_event_struct s_trace[2][TEST_TRACE_MAX];/**< 0:时序引擎 1:协程 */
+static uint32_t s_trace_num[2];
+static uint8_t s_side;
+static uint32_t s_get_sda_calls;
+static uint32_t s_nack_at;/**< 第几次读sda强制为高（不应答），0为不强制 */
+static uint32_t s_now;
+
+static uint8_t s_present[16];
+static misaka_sim_gpio_t s_gpio;
+static misaka_soft_i2c_ops_t s_ops;
+static misaka_soft_i2c_bus_t s_bus;
+static misaka_soft_i2c_statistics_t s_stat;
+
+static uint8_t s_tx[4] = {0x12, 0x34, 0x56, 0x78};
+static uint8_t s_rx[4];
+
+static void test_record(uint8_t type, uint16_t value)
+{
+	if (s_trace_num[s_side] < TEST_TRACE_MAX)
+	{
+		s_trace[s_side][s_trace_num[s_side]].type = type;
+		s_trace[s_side][s_trace_num[s_side]].value = value;
+	}
+	s_trace_num[s_side]++;
+}
+
+static void test_set_sda(void *ctx, uint8_t state)
+{
+	test_record(TEST_EVENT_SDA, state);
+	misaka_sim_i2c_ops.set_sda(ctx, state);
+}
+
+static void test_set_scl(void *ctx, uint8_t state)
+{
+	test_record(TEST_EVENT_SCL, state);
+	misaka_sim_i2c_ops.set_scl(ctx, state);
+}
+
+static uint8_t test_get_sda(void *ctx)
+{
+	uint8_t state = misaka_sim_i2c_ops.get_sda(ctx);
+
+	if (++s_get_sda_calls == s_nack_at)
+	{
+		state = 1;
+	}
+	test_record(TEST_EVENT_GET_SDA, state);
+
+	return state;
+}
+
+static void test_set_sda_out(void *ctx)
+{
+	test_record(TEST_EVENT_SDA_OUT, 0);
+	misaka_sim_i2c_ops.set_sda_out(ctx);
+}
+
+static void test_set_sda_in(void *ctx)
+{
+	test_record(TEST_EVENT_SDA_IN, 0);
+	misaka_sim_i2c_ops.set_sda_in(ctx);
+}
+
+static void test_delay_us(void *ctx, uint16_t us)
+{
+	test_record(TEST_EVENT_DELAY, us);
+	misaka_sim_i2c_ops.delay_us(ctx, us);
+}
+
+/**
+ * @brief 每次调用前进1us，让出的延时经过若干次轮询后到期
+ */
+static uint32_t test_get_tick_us(void)
+{
+	return s_now++;
+}
+
+/**
+ * @brief 初始化记录引脚操作的仿真i2c总线，从机应答TEST_ADDR与10位地址的高位字节
+ * @param side 0:时序引擎 1:协程
+ */
+static void test_i2c_setup(uint8_t side)
+{
+	memset(&s_gpio, 0, sizeof(s_gpio));
+	memset(s_present, 0, sizeof(s_present));
+	s_present[TEST_ADDR >> 3] |= 1u << (TEST_ADDR & 7);
+	s_present[0x7A >> 3] |= 1u << (0x7A & 7);
+	s_gpio.present = s_present;
+	misaka_sim_i2c_bus_init(&s_bus, &s_gpio, TEST_US);
+
+	s_ops = misaka_sim_i2c_ops;
+	s_ops.set_sda = test_set_sda;
+	s_ops.set_scl = test_set_scl;
+	s_ops.get_sda = test_get_sda;
+	s_ops.set_sda_out = test_set_sda_out;
+	s_ops.set_sda_in = test_set_sda_in;
+	s_ops.delay_us = test_delay_us;
+	s_bus.ops = &s_ops;
+	memset(&s_stat, 0, sizeof(s_stat));
+	s_bus.stat = &s_stat;
+
+	s_side = side;
+	s_trace_num[side] = 0;
+	s_get_sda_calls = 0;
+	memset(s_rx, 0, sizeof(s_rx));
+}
+
+/**
+ * @brief 比较两份记录，skip_delay为1时跳过延时（让出的延时不经过delay_us）
+ * @return 1:相同 0:不同
+ */
+static int test_trace_equal(uint8_t skip_delay)
+{
+	uint32_t a = 0, b = 0;
+
+	if (s_trace_num[0] > TEST_TRACE_MAX || s_trace_num[1] > TEST_TRACE_MAX)
+	{
+		return 0;
+	}
+	for (;;)
+	{
+		while (skip_delay && a < s_trace_num[0] && s_trace[0][a].type == TEST_EVENT_DELAY)
+		{
+			a++;
+		}
+		while (skip_delay && b < s_trace_num[1] && s_trace[1][b].type == TEST_EVENT_DELAY)
+		{
+			b++;
+		}
+		if (a == s_trace_num[0] || b == s_trace_num[1])
+		{
+			return a == s_trace_num[0] && b == s_trace_num[1];
+		}
+		if (s_trace[0][a].type != s_trace[1][b].type || s_trace[0][a].value != s_trace[1][b].value)
+		{
+			return 0;
+		}
+		a++;
+		b++;
+	}
+}
+
+/**
+ * @brief 同一组消息分别由时序引擎与协程传输，比较引脚操作、返回值、读到的数据与统计
+ * @param msgs 消息对象
+ * @param num 消息数量
+ * @param yield_us 协程的让出阈值，0为全部让出，0xFFFF为全部忙等
+ * @param ret 时序引擎的返回值
+ * @return 0:一致 1:不一致
+ */
+static int test_i2c_compare(misaka_soft_i2c_message *msgs, uint32_t num, uint16_t yield_us, uint32_t *ret)
+{
+	misaka_soft_i2c_statistics_t engine;
+	misaka_soft_i2c_coroutine_t x;
+	uint8_t rx[sizeof(s_rx)];
+	uint32_t polls = 0;
+
+	test_i2c_setup(0);
+	*ret = misaka_soft_i2c_bus_transfer(&s_bus, msgs, num);
+	engine = s_stat;
+	memcpy(rx, s_rx, sizeof(rx));
+
+	test_i2c_setup(1);
+	memset(&x, 0, sizeof(x));
+	x.bus = &s_bus;
+	x.get_tick_us = test_get_tick_us;
+	x.yield_us = yield_us;
+	misaka_soft_i2c_coroutine_start(&x, msgs, num);
+	while (misaka_soft_i2c_coroutine_poll(&x) == MISAKA_COROUTINE_WAITING && polls < TEST_POLL_MAX)
+	{
+		polls++;
+	}
+
+	misaka_test_check(polls < TEST_POLL_MAX);
+	misaka_test_check(yield_us == 0 ? polls > 0 : polls == 0);
+	misaka_test_check(x.ret == *ret);
+	misaka_test_check(test_trace_equal(yield_us == 0));
+	misaka_test_check(memcmp(rx, s_rx, sizeof(rx)) == 0);
+
+	misaka_test_check(s_stat.transfers == 1 && engine.transfers == 1);
+	misaka_test_check(s_stat.messages == engine.messages);
+	misaka_test_check(s_stat.bytes == engine.bytes);
+	misaka_test_check(s_stat.nacks == engine.nacks);
+	misaka_test_check(s_stat.pin_calls == engine.pin_calls);
+	misaka_test_check(s_stat.delay_calls == engine.delay_calls);
+	misaka_test_check(s_stat.delay_us == engine.delay_us);
+
+	return 0;
+}
+
+/**
+ * @brief 两种让出方式各比较一次
+ */
+static int test_i2c_compare_both(misaka_soft_i2c_message *msgs, uint32_t num, uint32_t *ret)
+{
+	uint32_t ret2;
+
+	misaka_test_check(test_i2c_compare(msgs, num, 0xFFFF, ret) == 0);
+	misaka_test_check(test_i2c_compare(msgs, num, 0, &ret2) == 0);
+	misaka_test_check(ret2 == *ret);
+
+	return 0;
+}
+
+static int test_coroutine_i2c_7bit(void)
+{
+	misaka_soft_i2c_message msgs[2];
+	uint32_t ret;
+
+	msgs[0].addr = TEST_ADDR;
+	msgs[0].flags = MISAKA_SOFT_I2C_WR;
+	msgs[0].buf = s_tx;
+	msgs[0].len = 2;
+	msgs[1].addr = TEST_ADDR;
+	msgs[1].flags = MISAKA_SOFT_I2C_RD;
+	msgs[1].buf = s_rx;
+	msgs[1].len = 3;
+
+	s_nack_at = 0;
+	misaka_test_check(test_i2c_compare_both(msgs, 2, &ret) == 0);
+	misaka_test_check(ret == 2);
+	misaka_test_check(s_gpio.slave_writes == 2 && s_gpio.slave_reads == 3);
+	misaka_test_check(s_rx[0] == TEST_ADDR && s_rx[2] == TEST_ADDR + 2);
+
+	return 0;
+}
+
+static int test_coroutine_i2c_10bit(void)
+{
+	misaka_soft_i2c_message msgs[1];
+	uint32_t ret;
+
+	/** < 高位字节0xF4应答，低位字节作为数据写入，重复起始后以0xF5读取 */
+	msgs[0].addr = TEST_ADDR_10BIT;
+	msgs[0].flags = MISAKA_SOFT_I2C_ADDR_10BIT | MISAKA_SOFT_I2C_RD;
+	msgs[0].buf = s_rx;
+	msgs[0].len = 2;
+
+	s_nack_at = 0;
+	misaka_test_check(test_i2c_compare_both(msgs, 1, &ret) == 0);
+	misaka_test_check(ret == 1);
+	misaka_test_check(s_gpio.slave_writes == 1 && s_gpio.slave_reads == 2);
+	misaka_test_check(s_rx[0] == 0x7A && s_rx[1] == 0x7B);
+
+	return 0;
+}
+
+static int test_coroutine_i2c_nack(void)
+{
+	misaka_soft_i2c_message msgs[2];
+	uint32_t ret;
+
+	/** < 第二条消息的地址未应答：重试一次，返回已完成的1条 */
+	msgs[0].addr = TEST_ADDR;
+	msgs[0].flags = MISAKA_SOFT_I2C_WR;
+	msgs[0].buf = s_tx;
+	msgs[0].len = 1;
+	msgs[1].addr = TEST_ADDR_ABSENT;
+	msgs[1].flags = MISAKA_SOFT_I2C_RD;
+	msgs[1].buf = s_rx;
+	msgs[1].len = 1;
+
+	s_nack_at = 0;
+	misaka_test_check(test_i2c_compare_both(msgs, 2, &ret) == 0);
+	misaka_test_check(ret == 1);
+	misaka_test_check(s_stat.nacks == 2);
+
+	/** < 忽略未应答：地址与数据均不应答，仍计为完成 */
+	msgs[1].flags = MISAKA_SOFT_I2C_WR | MISAKA_SOFT_I2C_IGNORE_NACK;
+	msgs[1].buf = s_tx;
+	msgs[1].len = 2;
+	misaka_test_check(test_i2c_compare_both(msgs, 2, &ret) == 0);
+	misaka_test_check(ret == 2);
+	misaka_test_check(s_stat.nacks == 3);
+
+	/** < 数据未应答：与时序引擎相同，整组按0条计 */
+	msgs[1].addr = TEST_ADDR;
+	msgs[1].flags = MISAKA_SOFT_I2C_WR;
+	msgs[1].len = 3;
+	s_nack_at = 4;
+	misaka_test_check(test_i2c_compare_both(msgs, 2, &ret) == 0);
+	misaka_test_check(ret == 0);
+	misaka_test_check(s_stat.nacks == 1 && s_stat.bytes == 4);
+	s_nack_at = 0;
+
+	return 0;
+}
+
+static int test_coroutine_i2c_no_start(void)
+{
+	misaka_soft_i2c_message msgs[3];
+	uint32_t ret;
+
+	/** < 寄存器地址与数据分两条消息，第二条不产生起始信号；读取不产生应答 */
+	msgs[0].addr = TEST_ADDR;
+	msgs[0].flags = MISAKA_SOFT_I2C_WR;
+	msgs[0].buf = s_tx;
+	msgs[0].len = 1;
+	msgs[1].addr = TEST_ADDR;
+	msgs[1].flags = MISAKA_SOFT_I2C_WR | MISAKA_SOFT_I2C_NO_START;
+	msgs[1].buf = &s_tx[1];
+	msgs[1].len = 3;
+	msgs[2].addr = TEST_ADDR;
+	msgs[2].flags = MISAKA_SOFT_I2C_RD | MISAKA_SOFT_I2C_NO_READ_ACK;
+	msgs[2].buf = s_rx;
+	msgs[2].len = 1;
+
+	s_nack_at = 0;
+	misaka_test_check(test_i2c_compare_both(msgs, 3, &ret) == 0);
+	misaka_test_check(ret == 3);
+	misaka_test_check(s_gpio.slave_writes == 4 && s_gpio.slave_reads == 1);
+
+	return 0;
+}
+
+static uint8_t s_wire[16];/**< 依次发出的字节 */
+static uint32_t s_wire_len;
+static misaka_sim_spi_t s_sim;
+static misaka_spi_bus_ops_t s_spi_ops;
+static misaka_spi_bus_t s_spi_bus;
+static misaka_spi_t s_spi[2];
+
+static uint8_t test_spi_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0; i < length && s_wire_len < sizeof(s_wire); i++)
+	{
+		s_wire[s_wire_len++] = txbuf[i];
+	}
+
+	return misaka_sim_spi_ops.send(ctx, txbuf, length);
+}
+
+/**
+ * @brief 两个设备共用一条仿真spi总线，各自的消息链为1字节命令与2字节数据
+ * @param x 传输对象
+ * @param msgs 消息链
+ * @param data 发送的数据
+ * @param lock 协作锁
+ */
+static void test_spi_setup(misaka_spi_coroutine_t *x, misaka_spi_message_t *msgs, uint8_t *data, misaka_coroutine_lock_t *lock)
+{
+	memset(msgs, 0, 2 * sizeof(misaka_spi_message_t));
+	msgs[0].send_buf = data;
+	msgs[0].length = 1;
+	msgs[0].cs_take = 1;
+	msgs[0].next = &msgs[1];
+	msgs[1].send_buf = data + 1;
+	msgs[1].length = 2;
+	msgs[1].cs_release = 1;
+
+	memset(x, 0, sizeof(*x));
+	x->lock = lock;
+	misaka_spi_coroutine_start(x, msgs);
+}
+
+static int test_coroutine_spi_lock(void)
+{
+	uint8_t a[3] = {0xA1, 0xA2, 0xA3}, b[3] = {0xB1, 0xB2, 0xB3};
+	misaka_spi_message_t msgs_a[2], msgs_b[2];
+	misaka_spi_coroutine_t xa, xb;
+	misaka_coroutine_lock_t lock = {0};
+
+	memset(&s_sim, 0, sizeof(s_sim));
+	misaka_sim_spi_bus_init(&s_spi_bus, &s_spi[0], &s_sim);
+	s_spi_ops = misaka_sim_spi_ops;
+	s_spi_ops.send = test_spi_send;
+	s_spi_bus.ops = &s_spi_ops;
+	s_spi[1] = s_spi[0];
+	s_wire_len = 0;
+
+	test_spi_setup(&xa, msgs_a, a, &lock);
+	xa.spi = &s_spi[0];
+	test_spi_setup(&xb, msgs_b, b, &lock);
+	xb.spi = &s_spi[1];
+
+	/** < a提交命令后让出，b等待协作锁，不访问总线 */
+	misaka_test_check(misaka_spi_coroutine_poll(&xa) == MISAKA_COROUTINE_WAITING);
+	misaka_test_check(lock.owner == &xa.co);
+	misaka_test_check(misaka_spi_coroutine_poll(&xb) == MISAKA_COROUTINE_WAITING);
+	misaka_test_check(s_wire_len == 1 && s_sim.cs_toggles == 1);
+
+	/** < a结束并释放锁后b才开始 */
+	misaka_test_check(misaka_spi_coroutine_poll(&xa) == MISAKA_COROUTINE_DONE);
+	misaka_test_check(xa.ret == 0 && lock.owner == NULL);
+	misaka_test_check(misaka_spi_coroutine_poll(&xb) == MISAKA_COROUTINE_WAITING);
+	misaka_test_check(misaka_spi_coroutine_poll(&xb) == MISAKA_COROUTINE_DONE);
+	misaka_test_check(xb.ret == 0);
+
+	misaka_test_check(s_wire_len == 6);
+	misaka_test_check(memcmp(s_wire, a, 3) == 0 && memcmp(&s_wire[3], b, 3) == 0);
+	misaka_test_check(s_sim.cs_toggles == 4 && s_sim.cs == 1);
+
+	/** < 不加锁时两个设备的段交错 */
+	s_wire_len = 0;
+	test_spi_setup(&xa, msgs_a, a, NULL);
+	xa.spi = &s_spi[0];
+	test_spi_setup(&xb, msgs_b, b, NULL);
+	xb.spi = &s_spi[1];
+	misaka_test_check(misaka_spi_coroutine_poll(&xa) == MISAKA_COROUTINE_WAITING);
+	misaka_test_check(misaka_spi_coroutine_poll(&xb) == MISAKA_COROUTINE_WAITING);
+	misaka_test_check(s_wire_len == 2 && s_wire[1] == 0xB1);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_coroutine_i2c_7bit);
+	misaka_test_run(failures, test_coroutine_i2c_10bit);
+	misaka_test_run(failures, test_coroutine_i2c_nack);
+	misaka_test_run(failures, test_coroutine_i2c_no_start);
+	misaka_test_run(failures, test_coroutine_spi_lock);
+
+	return failures != 0;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file test_decode.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 样本解码：与逐字节的参考实现逐个比较，覆盖各宽度、字节序、符号、右移、通道与帧间隙，
+ * 样本数0~40（SIMD整块与标量尾部的各种组合）及非对齐起始地址，并检查输出末尾之后未被写入。
+ */
+
+#include <string.h>
+#include "misaka_device/decode.h"
+#include "test.h"
+
+#define TEST_FRAMES_MAX         40
+#define TEST_CHANNELS_MAX       3
+#define TEST_PAD                4                           /**< 帧间隙字节数 */
+#define TEST_GUARD              8                           /**< 输出末尾之后的哨兵个数 */
+#define TEST_BUF_SIZE           (TEST_FRAMES_MAX * (4 * TEST_CHANNELS_MAX + TEST_PAD) + 16)
+
+static uint8_t s_raw[TEST_BUF_SIZE];
+
+/**
+ * @brief 填充确定的伪随机字节
+ */
+static void test_fill(void)
+{
+	uint32_t i, x = 0x12345678;
+
+	for (i = 0; i < sizeof(s_raw); i++)
+	{
+		x = x * 1103515245U + 12345U;
+		s_raw[i] = (uint8_t) (x >> 16);
+	}
+}
+
+/**
+ * @brief 参考实现：按字节序组合后做符号扩展与右移
+ * @param f 格式
+ * @param p 样本
+ * @return int32_t @c 数值
+ */
+static int32_t test_reference(const misaka_decode_format_t *f, const uint8_t *p)
+{
+	int64_t v = 0;
+	uint8_t i;
+
+	for (i = 0; i < f->width; i++)
+	{
+		if (f->endian == MISAKA_DECODE_BIG_ENDIAN)
+		{
+			v = v * 256 + p[i];
+		}
+		else
+		{
+			v = v * 256 + p[f->width - 1 - i];
+		}
+	}
+
+	if (f->sign && v >= ((int64_t) 1 << (f->width * 8 - 1)))
+	{
+		v -= (int64_t) 1 << (f->width * 8);
+	}
+
+	/** < 向负无穷取整，与算术右移一致 */
+	return (int32_t) (v >= 0 ? v >> f->shift : -((-v - 1) >> f->shift) - 1);
+}
+
+/**
+ * @brief 第i帧第c个样本的地址
+ */
+static const uint8_t *test_sample(const misaka_decode_format_t *f, const uint8_t *buf, uint32_t i, uint8_t c)
+{
+	uint8_t channels = f->channels ? f->channels : 1;
+	uint32_t stride = f->stride ? f->stride : (uint32_t) f->width * channels;
+
+	return &buf[i * stride + c * f->width];
+}
+
+/**
+ * @brief 以一种格式比较misaka_decode_int32与misaka_decode_float，遍历帧数与起始偏移
+ * @param f 格式
+ * @return 0:通过 1:失败
+ */
+static int test_format(const misaka_decode_format_t *f)
+{
+	int32_t out[TEST_FRAMES_MAX * TEST_CHANNELS_MAX + TEST_GUARD];
+	float fout[TEST_FRAMES_MAX * TEST_CHANNELS_MAX + TEST_GUARD];
+	uint8_t channels = f->channels ? f->channels : 1;
+	uint32_t frames, offset, i, n;
+	uint8_t c;
+	uint32_t guard;
+	int32_t v;
+
+	memset(&guard, 0x5A, sizeof(guard));
+	for (offset = 0; offset < 4; offset++)
+	{
+		for (frames = 0; frames <= TEST_FRAMES_MAX; frames++)
+		{
+			n = frames * channels;
+			memset(out, 0x5A, sizeof(out));
+			memset(fout, 0x5A, sizeof(fout));
+
+			misaka_decode_int32(f, &s_raw[offset], frames, out);
+			misaka_decode_float(f, &s_raw[offset], frames, fout);
+
+			for (i = 0; i < frames; i++)
+			{
+				for (c = 0; c < channels; c++)
+				{
+					v = test_reference(f, test_sample(f, &s_raw[offset], i, c));
+					if (out[i * channels + c] != v || fout[i * channels + c] != (float) v * f->scale)
+					{
+						printf("     width %u endian %u sign %u shift %u channels %u stride %u offset %u frames %u sample %u\n",
+						       f->width, f->endian, f->sign, f->shift, channels, f->stride, offset, frames,
+						       i * channels + c);
+					}
+					misaka_test_check(out[i * channels + c] == v);
+					misaka_test_check(fout[i * channels + c] == (float) v * f->scale);
+				}
+			}
+			for (i = n; i < n + TEST_GUARD; i++)
+			{
+				misaka_test_check(memcmp(&out[i], &guard, sizeof(guard)) == 0);
+				misaka_test_check(memcmp(&fout[i], &guard, sizeof(guard)) == 0);
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int test_decode_formats(void)
+{
+	static const uint8_t shifts[] = {0, 3, 7};
+	misaka_decode_format_t f;
+	uint8_t width, endian, sign, s, channels, layout;
+	uint32_t count = 0;
+
+	test_fill();
+	memset(&f, 0, sizeof(f));
+	f.scale = 0.001f;
+
+	for (width = 1; width <= 4; width++)
+	{
+		for (endian = 0; endian < 2; endian++)
+		{
+			for (sign = 0; sign < 2; sign++)
+			{
+				for (s = 0; s < sizeof(shifts); s++)
+				{
+					for (channels = 0; channels <= TEST_CHANNELS_MAX; channels++)
+					{
+						/** < 0:stride为0 1:stride为帧长 2:帧间有间隙（走标量路径） */
+						for (layout = 0; layout < 3; layout++)
+						{
+							f.width = width;
+							f.endian = endian;
+							f.sign = sign;
+							f.shift = shifts[s];
+							f.channels = channels;
+							f.stride = (uint16_t) (layout == 0 ? 0 : width * (channels ? channels : 1) +
+							                                         (layout == 2 ? TEST_PAD : 0));
+							misaka_test_check(test_format(&f) == 0);
+							count++;
+						}
+					}
+				}
+			}
+		}
+	}
+	printf("     %u formats\n", count);
+
+	return 0;
+}
+
+static int test_decode_inplace(void)
+{
+	static const uint8_t shifts[] = {0, 3, 7};
+	union
+	{
+		int16_t align;
+		uint8_t b[TEST_FRAMES_MAX * TEST_CHANNELS_MAX * 2 + 2 * TEST_GUARD + 1];
+	} buf;
+	misaka_decode_format_t f;
+	uint32_t frames, i, n;
+	uint8_t endian, s, channels;
+	int16_t *out;
+
+	test_fill();
+	memset(&f, 0, sizeof(f));
+	f.width = 2;
+	f.sign = 1;
+
+	for (endian = 0; endian < 2; endian++)
+	{
+		for (s = 0; s < sizeof(shifts); s++)
+		{
+			for (channels = 1; channels <= TEST_CHANNELS_MAX; channels++)
+			{
+				f.endian = endian;
+				f.shift = shifts[s];
+				f.channels = channels;
+				for (frames = 0; frames <= TEST_FRAMES_MAX; frames++)
+				{
+					n = frames * channels;
+					memcpy(buf.b, s_raw, sizeof(buf.b));
+					out = misaka_decode_int16_inplace(&f, buf.b, frames);
+					misaka_test_check(out == (int16_t *) buf.b);
+					for (i = 0; i < n; i++)
+					{
+						misaka_test_check(out[i] == test_reference(&f, &s_raw[i * 2]));
+					}
+					/** < 尾部之后保持原样 */
+					misaka_test_check(memcmp(&buf.b[n * 2], &s_raw[n * 2], 2 * TEST_GUARD) == 0);
+				}
+			}
+		}
+	}
+
+	/** < 不支持的格式与奇地址 */
+	misaka_test_check(misaka_decode_int16_inplace(&f, &buf.b[1], 4) == NULL);
+	f.stride = 8;
+	misaka_test_check(misaka_decode_int16_inplace(&f, buf.b, 4) == NULL);
+	f.stride = 0;
+	f.sign = 0;
+	misaka_test_check(misaka_decode_int16_inplace(&f, buf.b, 4) == NULL);
+	f.sign = 1;
+	f.width = 3;
+	misaka_test_check(misaka_decode_int16_inplace(&f, buf.b, 4) == NULL);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_decode_formats);
+	misaka_test_run(failures, test_decode_inplace);
+
+	return failures != 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test_i2c_linux.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * linux i2c-dev后端：以ioctl拦截函数代替内核，检查消息标志到i2c_msg标志的映射，
+ * 超过42条消息时分批且任何一批都不以NO_START开头，失败的批次整体不计，以及超过16位长度的消息不提交。
+ */
+
+#include <string.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "misaka_device/i2c_linux.h"
+#include "test.h"
+
+#define TEST_MESSAGE_NUM        100
+#define TEST_LOG_MAX            4
+
+struct test_rdwr_struct
+{
+	uint32_t num;/**< 本次I2C_RDWR的消息数 */
+	struct i2c_msg msgs[MISAKA_I2C_LINUX_MESSAGE_MAX];
+};
+
+static misaka_i2c_linux_t s_dev;
+static uint32_t s_fail_at;/**< 第几次I2C_RDWR失败，0为不失败 */
+static uint32_t s_calls;
+static struct test_rdwr_struct s_log[TEST_LOG_MAX];
+static misaka_soft_i2c_message s_msgs[TEST_MESSAGE_NUM];
+static uint8_t s_buf[TEST_MESSAGE_NUM];
+
+/**
+ * @brief 旧接口的错误回调由移植层提供，本测试不使用旧接口、也不链接仿真总线
+ */
+void misaka_soft_i2c_error_callback(const misaka_soft_i2c_t *ops)
+{
+	(void) ops;
+}
+
+/**
+ * @brief ioctl拦截函数：记录消息，按内核的规则拒绝超过42条的批次，另拒绝以NOSTART开头的批次
+ */
+static int test_ioctl(int fd, unsigned long request, void *arg)
+{
+	struct i2c_rdwr_ioctl_data *data = (struct i2c_rdwr_ioctl_data *) arg;
+
+	if (fd != 42 || request != I2C_RDWR)
+	{
+		return -1;
+	}
+
+	s_calls++;
+	if (s_calls <= TEST_LOG_MAX)
+	{
+		s_log[s_calls - 1].num = data->nmsgs;
+		if (data->nmsgs <= MISAKA_I2C_LINUX_MESSAGE_MAX)
+		{
+			memcpy(s_log[s_calls - 1].msgs, data->msgs, data->nmsgs * sizeof(struct i2c_msg));
+		}
+	}
+	if (s_calls == s_fail_at || data->nmsgs == 0 || data->nmsgs > MISAKA_I2C_LINUX_MESSAGE_MAX
+		|| (data->msgs[0].flags & I2C_M_NOSTART))
+	{
+		return -1;
+	}
+
+	return (int) data->nmsgs;
+}
+
+/**
+ * @brief 以拦截函数初始化设备，消息均为写入s_buf中的1字节
+ */
+static void test_setup(void)
+{
+	uint32_t i;
+
+	memset(&s_dev, 0, sizeof(s_dev));
+	s_dev.ioctl = test_ioctl;
+	misaka_i2c_linux_attach(&s_dev, 42);
+
+	for (i = 0; i < TEST_MESSAGE_NUM; i++)
+	{
+		s_msgs[i].addr = 0x50;
+		s_msgs[i].flags = MISAKA_SOFT_I2C_WR;
+		s_msgs[i].len = 1;
+		s_msgs[i].buf = &s_buf[i];
+	}
+	s_fail_at = 0;
+	s_calls = 0;
+	memset(s_log, 0, sizeof(s_log));
+}
+
+static int test_i2c_linux_flags(void)
+{
+	test_setup();
+	s_msgs[1].flags = MISAKA_SOFT_I2C_RD;
+	s_msgs[1].len = 7;
+	s_msgs[2].flags = MISAKA_SOFT_I2C_ADDR_10BIT;
+	s_msgs[2].addr = 0x2F0;
+	s_msgs[3].flags = MISAKA_SOFT_I2C_NO_START;
+	s_msgs[4].flags = MISAKA_SOFT_I2C_IGNORE_NACK;
+	s_msgs[5].flags = MISAKA_SOFT_I2C_RD | MISAKA_SOFT_I2C_NO_READ_ACK;
+
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, 6) == 6);
+	misaka_test_check(s_dev.ioctls == 1 && s_log[0].num == 6);
+	misaka_test_check(s_log[0].msgs[0].flags == 0);
+	misaka_test_check(s_log[0].msgs[1].flags == I2C_M_RD && s_log[0].msgs[1].len == 7);
+	misaka_test_check(s_log[0].msgs[2].flags == I2C_M_TEN && s_log[0].msgs[2].addr == 0x2F0);
+	misaka_test_check(s_log[0].msgs[3].flags == I2C_M_NOSTART);
+	misaka_test_check(s_log[0].msgs[4].flags == I2C_M_IGNORE_NAK);
+	misaka_test_check(s_log[0].msgs[5].flags == (I2C_M_RD | I2C_M_NO_RD_ACK));
+	misaka_test_check(s_log[0].msgs[5].buf == &s_buf[5] && s_log[0].msgs[5].addr == 0x50);
+
+	return 0;
+}
+
+static int test_i2c_linux_split(void)
+{
+	uint32_t i;
+
+	/** < 第42、43条为NO_START，接在第41条之后：第一批退到40条 */
+	test_setup();
+	s_msgs[41].flags = MISAKA_SOFT_I2C_NO_START;
+	s_msgs[42].flags = MISAKA_SOFT_I2C_NO_START;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, TEST_MESSAGE_NUM) == TEST_MESSAGE_NUM);
+	misaka_test_check(s_dev.ioctls == 3);
+	misaka_test_check(s_log[0].num == 40 && s_log[1].num == MISAKA_I2C_LINUX_MESSAGE_MAX && s_log[2].num == 18);
+	misaka_test_check(s_log[1].msgs[0].buf == &s_buf[40] && s_log[1].msgs[1].flags == I2C_M_NOSTART);
+	for (i = 0; i < 3; i++)
+	{
+		misaka_test_check(!(s_log[i].msgs[0].flags & I2C_M_NOSTART));
+	}
+
+	/** < 不超过42条时即使带NO_START也一次提交 */
+	test_setup();
+	s_msgs[41].flags = MISAKA_SOFT_I2C_NO_START;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, MISAKA_I2C_LINUX_MESSAGE_MAX) == MISAKA_I2C_LINUX_MESSAGE_MAX);
+	misaka_test_check(s_dev.ioctls == 1);
+
+	/** < 第1条之后全部NO_START，无处分批，不提交 */
+	test_setup();
+	for (i = 1; i <= MISAKA_I2C_LINUX_MESSAGE_MAX; i++)
+	{
+		s_msgs[i].flags = MISAKA_SOFT_I2C_NO_START;
+	}
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, MISAKA_I2C_LINUX_MESSAGE_MAX + 1) == 0);
+	misaka_test_check(s_dev.ioctls == 0);
+
+	return 0;
+}
+
+static int test_i2c_linux_failure(void)
+{
+	/** < 第二批失败：只计第一批，之后的批次不再提交 */
+	test_setup();
+	s_fail_at = 2;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, TEST_MESSAGE_NUM) == MISAKA_I2C_LINUX_MESSAGE_MAX);
+	misaka_test_check(s_dev.ioctls == 2);
+
+	/** < 第一批失败 */
+	test_setup();
+	s_fail_at = 1;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, 3) == 0);
+	misaka_test_check(s_dev.ioctls == 1);
+
+	return 0;
+}
+
+static int test_i2c_linux_len(void)
+{
+	/** < i2c_msg的长度为16位，超出的消息所在批次不提交，之前的批次照常完成 */
+	test_setup();
+	s_msgs[45].len = 0x10000;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, 50) == MISAKA_I2C_LINUX_MESSAGE_MAX);
+	misaka_test_check(s_dev.ioctls == 1);
+
+	test_setup();
+	s_msgs[1].len = 0x10000;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, 2) == 0);
+	misaka_test_check(s_dev.ioctls == 0);
+
+	/** < 0xffff仍可提交 */
+	test_setup();
+	s_msgs[1].len = 0xffff;
+	misaka_test_check(misaka_soft_i2c_bus_transfer(&s_dev.bus, s_msgs, 2) == 2);
+	misaka_test_check(s_log[0].msgs[1].len == 0xffff);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_i2c_linux_flags);
+	misaka_test_run(failures, test_i2c_linux_split);
+	misaka_test_run(failures, test_i2c_linux_failure);
+	misaka_test_run(failures, test_i2c_linux_len);
+
+	return failures != 0;
+}
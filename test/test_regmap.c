@@ -0,0 +1,348 @@
+/**
+ * @file test_regmap.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 寄存器映射：在地址自增的仿真寄存器器件上统计总线读写次数，检查缓存有效时按掩码修改省去读取，
+ * 连续读取时首尾之间的已缓存寄存器并入一次突发，突发读回时脏寄存器以缓存为准，
+ * 以及同步时连续的脏寄存器合并、间隔不大的干净寄存器作为填充一并写入；
+ * 另在仿真i2c从机上检查i2c后端的地址与数据在同一次传输中收发。
+ */
+
+#include <string.h>
+#include "misaka_device/regmap.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_MAX_REG            0x1F
+#define TEST_REG_VOLATILE       0x10
+#define TEST_REG_WRITE_ONLY     0x1E
+#define TEST_REG_READ_ONLY      0x1F
+#define TEST_LOG_SIZE           8
+#define TEST_I2C_ADDR           0x1D
+
+/**
+ * 一次总线传输
+ */
+struct test_xfer_struct
+{
+	uint8_t reg;
+	uint32_t len;
+};
+
+static uint8_t s_regs[TEST_MAX_REG + 1];/**< 仿真器件的寄存器 */
+static uint32_t s_reads;
+static uint32_t s_writes;
+static struct test_xfer_struct s_read_log[TEST_LOG_SIZE];
+static struct test_xfer_struct s_write_log[TEST_LOG_SIZE];
+
+static uint8_t s_cache[TEST_MAX_REG + 1];
+static uint8_t s_valid[TEST_MAX_REG / 8 + 1];
+static uint8_t s_dirty[TEST_MAX_REG / 8 + 1];
+static misaka_regmap_t s_map;
+
+static const misaka_regmap_range_t s_ranges[] = {
+	{TEST_REG_VOLATILE,   TEST_REG_VOLATILE,   MISAKA_REGMAP_VOLATILE},
+	{TEST_REG_WRITE_ONLY, TEST_REG_WRITE_ONLY, MISAKA_REGMAP_WRITE_ONLY},
+	{TEST_REG_READ_ONLY,  TEST_REG_READ_ONLY,  MISAKA_REGMAP_READ_ONLY},
+};
+
+static const misaka_regmap_default_t s_defaults[] = {
+	{0x01, 0x80},
+	{TEST_REG_WRITE_ONLY, 0x00},
+};
+
+/**
+ * @brief 仿真器件读：地址自增，只写寄存器读出0xEE
+ */
+static uint8_t test_read(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len)
+{
+	uint32_t i;
+
+	(void) map;
+	if (s_reads < TEST_LOG_SIZE)
+	{
+		s_read_log[s_reads].reg = reg[0];
+		s_read_log[s_reads].len = len;
+	}
+	s_reads++;
+
+	for (i = 0; i < len; i++)
+	{
+		buf[i] = reg[0] + i == TEST_REG_WRITE_ONLY ? 0xEE : s_regs[(reg[0] + i) & TEST_MAX_REG];
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 仿真器件写：地址自增
+ */
+static uint8_t test_write(misaka_regmap_t *map, uint8_t *reg, uint8_t *buf, uint32_t len)
+{
+	uint32_t i;
+
+	(void) map;
+	if (s_writes < TEST_LOG_SIZE)
+	{
+		s_write_log[s_writes].reg = reg[0];
+		s_write_log[s_writes].len = len;
+	}
+	s_writes++;
+
+	for (i = 0; i < len; i++)
+	{
+		s_regs[(reg[0] + i) & TEST_MAX_REG] = buf[i];
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 初始化仿真器件与寄存器映射，器件寄存器值为地址加0x40，寄存器1复位值0x80
+ * @param burst 1:地址自增
+ * @return 0:成功 1:失败
+ */
+static int test_setup(uint8_t burst)
+{
+	uint32_t i;
+
+	for (i = 0; i <= TEST_MAX_REG; i++)
+	{
+		s_regs[i] = (uint8_t) (i + 0x40);
+	}
+	s_regs[0x01] = 0x80;
+	s_reads = 0;
+	s_writes = 0;
+
+	memset(&s_map, 0, sizeof(s_map));
+	s_map.read = test_read;
+	s_map.write = test_write;
+	s_map.reg_bytes = 1;
+	s_map.val_bytes = 1;
+	s_map.endian = MISAKA_REGMAP_BIG_ENDIAN;
+	s_map.burst = burst;
+	s_map.max_reg = TEST_MAX_REG;
+	s_map.ranges = s_ranges;
+	s_map.range_num = sizeof(s_ranges) / sizeof(s_ranges[0]);
+	s_map.defaults = s_defaults;
+	s_map.default_num = sizeof(s_defaults) / sizeof(s_defaults[0]);
+	s_map.cache = s_cache;
+	s_map.valid = s_valid;
+	s_map.dirty = s_dirty;
+
+	return misaka_regmap_init(&s_map);
+}
+
+static int test_regmap_update_bits(void)
+{
+	uint32_t value;
+
+	misaka_test_check(test_setup(1) == 0);
+
+	/** < 复位值已在缓存中，只写不读 */
+	misaka_test_check(misaka_regmap_update_bits(&s_map, 0x01, 0x01, 0x01) == 0);
+	misaka_test_check(s_reads == 0 && s_writes == 1);
+	misaka_test_check(s_regs[0x01] == 0x81);
+
+	/** < 值不变，既不读也不写 */
+	misaka_test_check(misaka_regmap_update_bits(&s_map, 0x01, 0x81, 0x81) == 0);
+	misaka_test_check(s_reads == 0 && s_writes == 1);
+	misaka_test_check(s_map.writes_skipped == 1);
+
+	/** < 未缓存的寄存器先读一次，之后由缓存提供 */
+	misaka_test_check(misaka_regmap_update_bits(&s_map, 0x02, 0xF0, 0x10) == 0);
+	misaka_test_check(s_reads == 1 && s_writes == 2);
+	misaka_test_check(s_regs[0x02] == 0x12);
+	misaka_test_check(misaka_regmap_update_bits(&s_map, 0x02, 0x0F, 0x05) == 0);
+	misaka_test_check(s_reads == 1 && s_writes == 3);
+	misaka_test_check(misaka_regmap_read(&s_map, 0x02, &value) == 0 && value == 0x15);
+	misaka_test_check(s_reads == 1);
+
+	/** < 易变寄存器每次都读 */
+	misaka_test_check(misaka_regmap_update_bits(&s_map, TEST_REG_VOLATILE, 0x01, 0x01) == 0);
+	misaka_test_check(misaka_regmap_update_bits(&s_map, TEST_REG_VOLATILE, 0x01, 0x01) == 0);
+	misaka_test_check(s_reads == 3 && s_writes == 4);
+
+	/** < 只读寄存器不可写 */
+	misaka_test_check(misaka_regmap_update_bits(&s_map, TEST_REG_READ_ONLY, 0x01, 0x00) == 1);
+	misaka_test_check(s_writes == 4);
+
+	misaka_test_check(s_map.bus_reads == s_reads && s_map.bus_writes == s_writes);
+
+	return 0;
+}
+
+static int test_regmap_burst(void)
+{
+	uint32_t values[8], i;
+
+	misaka_test_check(test_setup(1) == 0);
+
+	/** < 寄存器5已缓存，3~7仍合并为一次突发读取 */
+	misaka_test_check(misaka_regmap_read(&s_map, 0x05, values) == 0);
+	misaka_test_check(s_reads == 1);
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x03, values, 5) == 0);
+	misaka_test_check(s_reads == 2);
+	misaka_test_check(s_read_log[1].reg == 0x03 && s_read_log[1].len == 5);
+	for (i = 0; i < 5; i++)
+	{
+		misaka_test_check(values[i] == 0x43 + i);
+	}
+
+	/** < 全部已缓存，不访问总线 */
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x03, values, 5) == 0);
+	misaka_test_check(s_reads == 2);
+	misaka_test_check(s_map.cache_hits == 5);
+
+	/** < 首尾未缓存，中间的已缓存寄存器一并读取 */
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x02, values, 7) == 0);
+	misaka_test_check(s_reads == 3);
+	misaka_test_check(s_read_log[2].reg == 0x02 && s_read_log[2].len == 7);
+
+	/** < 不支持自增时逐个读取未缓存的寄存器 */
+	misaka_test_check(test_setup(0) == 0);
+	misaka_test_check(misaka_regmap_read(&s_map, 0x05, values) == 0);
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x03, values, 5) == 0);
+	misaka_test_check(s_reads == 1 + 4);
+	misaka_test_check(values[2] == 0x45 && values[4] == 0x47);
+
+	return 0;
+}
+
+static int test_regmap_dirty_readback(void)
+{
+	uint32_t values[5];
+
+	misaka_test_check(test_setup(1) == 0);
+
+	/** < 仅缓存模式下写入，器件中仍为旧值 */
+	misaka_regmap_cache_only(&s_map, 1);
+	misaka_test_check(misaka_regmap_write(&s_map, 0x06, 0x66) == 0);
+	misaka_test_check(misaka_regmap_write(&s_map, TEST_REG_WRITE_ONLY, 0x5A) == 0);
+	misaka_test_check(s_writes == 0);
+	misaka_regmap_cache_only(&s_map, 0);
+
+	/** < 突发读回经过脏寄存器，以缓存为准且保持脏标记 */
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x04, values, 5) == 0);
+	misaka_test_check(s_reads == 1 && s_read_log[0].len == 5);
+	misaka_test_check(values[0] == 0x44 && values[2] == 0x66 && values[4] == 0x48);
+	misaka_test_check(s_regs[0x06] == 0x46);
+
+	/** < 只写寄存器夹在未缓存的寄存器之间，读回的内容无意义，以缓存为准 */
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x1D, values, 3) == 0);
+	misaka_test_check(s_reads == 2 && s_read_log[1].reg == 0x1D && s_read_log[1].len == 3);
+	misaka_test_check(values[0] == 0x5D && values[1] == 0x5A && values[2] == 0x5F);
+
+	/** < 同步后器件与缓存一致 */
+	misaka_test_check(misaka_regmap_cache_sync(&s_map) == 0);
+	misaka_test_check(s_regs[0x06] == 0x66 && s_regs[TEST_REG_WRITE_ONLY] == 0x5A);
+	misaka_test_check(misaka_regmap_cache_sync(&s_map) == 0);
+	misaka_test_check(s_writes == 2);
+
+	return 0;
+}
+
+static int test_regmap_sync(void)
+{
+	uint32_t values[8];
+
+	misaka_test_check(test_setup(1) == 0);
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x00, values, 8) == 0);
+	misaka_test_check(s_reads == 1);
+
+	misaka_regmap_cache_only(&s_map, 1);
+	misaka_test_check(misaka_regmap_write(&s_map, 0x00, 0xA0) == 0);
+	misaka_test_check(misaka_regmap_write(&s_map, 0x02, 0xA2) == 0);
+	misaka_test_check(misaka_regmap_write(&s_map, 0x07, 0xA7) == 0);
+	misaka_test_check(misaka_regmap_write(&s_map, 0x18, 0xB8) == 0);
+	misaka_test_check(misaka_regmap_write(&s_map, 0x1A, 0xBA) == 0);
+	misaka_test_check(s_writes == 0);
+	misaka_regmap_cache_only(&s_map, 0);
+
+	/**
+	 * < 0~2一次写入，干净的1作为填充；3~6共4个干净寄存器超过一次地址开销，7单独写入；
+	 *   0x19未缓存不能填充，0x18与0x1A分别写入
+	 */
+	misaka_test_check(misaka_regmap_cache_sync(&s_map) == 0);
+	misaka_test_check(s_writes == 4);
+	misaka_test_check(s_write_log[0].reg == 0x00 && s_write_log[0].len == 3);
+	misaka_test_check(s_write_log[1].reg == 0x07 && s_write_log[1].len == 1);
+	misaka_test_check(s_write_log[2].reg == 0x18 && s_write_log[2].len == 1);
+	misaka_test_check(s_write_log[3].reg == 0x1A && s_write_log[3].len == 1);
+	misaka_test_check(s_regs[0x00] == 0xA0 && s_regs[0x01] == 0x80 && s_regs[0x02] == 0xA2);
+	misaka_test_check(s_regs[0x07] == 0xA7 && s_regs[0x18] == 0xB8 && s_regs[0x1A] == 0xBA);
+	misaka_test_check(s_regs[0x19] == 0x59);
+
+	/** < 同步后没有脏寄存器 */
+	misaka_test_check(misaka_regmap_cache_sync(&s_map) == 0);
+	misaka_test_check(s_writes == 4);
+
+	/** < 器件复位：与复位值不同的缓存寄存器置脏，寄存器1仍为复位值，作为填充并入0~7的突发 */
+	misaka_regmap_cache_mark_dirty(&s_map);
+	misaka_test_check(misaka_regmap_cache_sync(&s_map) == 0);
+	misaka_test_check(s_writes == 4 + 3);
+	misaka_test_check(s_write_log[4].reg == 0x00 && s_write_log[4].len == 8);
+
+	return 0;
+}
+
+static int test_regmap_i2c(void)
+{
+	static uint8_t present[16];
+	misaka_sim_gpio_t gpio;
+	misaka_soft_i2c_bus_t bus;
+	uint32_t values[3] = {0x11, 0x22, 0x33};
+
+	memset(&gpio, 0, sizeof(gpio));
+	present[TEST_I2C_ADDR >> 3] |= 1u << (TEST_I2C_ADDR & 7);
+	gpio.present = present;
+	misaka_sim_i2c_bus_init(&bus, &gpio, 0);
+
+	misaka_test_check(test_setup(1) == 0);
+	s_map.bus = &bus;
+	s_map.addr = TEST_I2C_ADDR;
+	s_map.read = misaka_regmap_i2c_read;
+	s_map.write = misaka_regmap_i2c_write;
+
+	/** < 地址1字节与3个数据字节一次写入 */
+	misaka_test_check(misaka_regmap_bulk_write(&s_map, 0x04, values, 3) == 0);
+	misaka_test_check(gpio.slave_writes == 1 + 3 && s_map.bus_writes == 1);
+
+	/** < 写地址后重复起始读取，从机依次返回地址加序号 */
+	misaka_test_check(misaka_regmap_bulk_read(&s_map, 0x08, values, 2) == 0);
+	misaka_test_check(gpio.slave_writes == 1 + 3 + 1 && gpio.slave_reads == 2);
+	misaka_test_check(values[0] == TEST_I2C_ADDR && values[1] == TEST_I2C_ADDR + 1);
+
+	/** < 器件不应答 */
+	s_map.addr = TEST_I2C_ADDR + 1;
+	misaka_test_check(misaka_regmap_write(&s_map, 0x04, 0x00) == 1);
+	misaka_test_check(misaka_regmap_read(&s_map, 0x04, values) == 0 && values[0] == 0x11);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_regmap_update_bits);
+	misaka_test_run(failures, test_regmap_burst);
+	misaka_test_run(failures, test_regmap_dirty_readback);
+	misaka_test_run(failures, test_regmap_sync);
+	misaka_test_run(failures, test_regmap_i2c);
+
+	return failures != 0;
+}
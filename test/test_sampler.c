@@ -0,0 +1,268 @@
+/**
+ * @file test_sampler.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 采样调度：仿真gpio上的从机模型按地址应答，时钟由测试推进；检查合并批次中不存在的从机不写入旧数据、
+ * 提前窗口内的通道并入到期批次、落后超过一个周期时跳过错过的采样，以及环形缓冲区满时丢弃新样本。
+ */
+
+#include <string.h>
+#include "misaka_device/sampler.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_PRESENT            0x48                        /**< 应答的从机地址 */
+#define TEST_ABSENT             0x50                        /**< 不存在的从机地址 */
+#define TEST_RING_SIZE          4
+#define TEST_ARENA_SIZE         2
+#define TEST_MERGE_SIZE         8
+
+/**
+ * 一个通道及其事务、缓冲区
+ */
+struct test_channel_struct
+{
+	misaka_sampler_channel_t channel;
+	misaka_soft_i2c_transaction_t t;
+	misaka_soft_i2c_message arena[TEST_ARENA_SIZE];
+	uint8_t reg;
+	uint8_t data[2];
+	uint8_t ring[TEST_RING_SIZE * 2];
+	uint32_t stamps[TEST_RING_SIZE];
+};
+
+typedef struct test_channel_struct test_channel_t;
+
+static uint32_t s_now;
+static uint8_t s_present[16];
+static misaka_sim_gpio_t s_gpio;
+static misaka_soft_i2c_bus_t s_i2c;
+static misaka_soft_i2c_message s_merge[TEST_MERGE_SIZE];
+static misaka_sampler_bus_t s_bus;
+static misaka_sampler_t s_sampler;
+
+static uint32_t test_get_tick_us(void)
+{
+	return s_now;
+}
+
+/**
+ * @brief 初始化仿真总线与调度器，时钟归零
+ */
+static void test_setup(void)
+{
+	memset(s_present, 0, sizeof(s_present));
+	s_present[TEST_PRESENT >> 3] |= 1u << (TEST_PRESENT & 7);
+
+	memset(&s_gpio, 0, sizeof(s_gpio));
+	s_gpio.present = s_present;
+	misaka_sim_i2c_bus_init(&s_i2c, &s_gpio, 1);
+
+	s_now = 0;
+	s_sampler.get_tick_us = test_get_tick_us;
+	misaka_sampler_init(&s_sampler);
+	memset(&s_bus, 0, sizeof(s_bus));
+	s_bus.type = MISAKA_SAMPLER_BUS_I2C;
+	s_bus.i2c = &s_i2c;
+	s_bus.merge = s_merge;
+	s_bus.merge_size = TEST_MERGE_SIZE;
+	misaka_sampler_add_bus(&s_sampler, &s_bus);
+}
+
+/**
+ * @brief 构建通道并加入总线
+ * @param c 通道
+ * @param addr 从机地址
+ * @param write_read 1:先写寄存器地址再读（两条消息） 0:只读（一条消息）
+ * @param size 每个样本的字节数
+ * @param period_us 采样周期
+ * @param tolerance_us 允许提前采样的时间
+ * @return 0:成功 1:失败
+ */
+static int test_channel(test_channel_t *c, uint16_t addr, uint8_t write_read, uint16_t size, uint32_t period_us, uint32_t tolerance_us)
+{
+	memset(c, 0, sizeof(*c));
+	c->t.arena = c->arena;
+	c->t.size = TEST_ARENA_SIZE;
+	misaka_soft_i2c_transaction_init(&c->t);
+	if (write_read)
+	{
+		misaka_test_check(misaka_soft_i2c_transaction_write_read(&c->t, addr, &c->reg, 1, c->data, size) != NULL);
+	}
+	else
+	{
+		misaka_test_check(misaka_soft_i2c_transaction_read(&c->t, addr, c->data, size, 0) != NULL);
+	}
+	/** < 旧数据，不应进入环形缓冲区 */
+	memset(c->data, 0xEE, sizeof(c->data));
+
+	c->channel.i2c_transaction = &c->t;
+	c->channel.data = c->data;
+	c->channel.sample_size = size;
+	c->channel.period_us = period_us;
+	c->channel.tolerance_us = tolerance_us;
+	c->channel.ring = c->ring;
+	c->channel.stamps = c->stamps;
+	c->channel.ring_size = TEST_RING_SIZE;
+	misaka_test_check(misaka_sampler_add(&s_sampler, &s_bus, &c->channel) == 0);
+
+	return 0;
+}
+
+static int test_sampler_absent(void)
+{
+	test_channel_t absent, present;
+	uint8_t sample[2];
+	uint32_t stamp;
+
+	/** < 首个通道为只有一条读消息的不存在从机，合并传输在其地址处停止，两个通道均失败 */
+	test_setup();
+	misaka_test_check(test_channel(&absent, TEST_ABSENT, 0, 2, 1000, 0) == 0);
+	misaka_test_check(test_channel(&present, TEST_PRESENT, 1, 2, 1000, 0) == 0);
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 1000);
+	misaka_test_check(s_bus.transfers == 1);
+	misaka_test_check(absent.channel.failures == 1 && present.channel.failures == 1);
+	misaka_test_check(misaka_sampler_available(&absent.channel) == 0);
+	misaka_test_check(misaka_sampler_available(&present.channel) == 0);
+
+	/** < 存在的从机在前：其样本为新读出的数据，不存在的从机失败 */
+	test_setup();
+	misaka_test_check(test_channel(&present, TEST_PRESENT, 1, 2, 1000, 0) == 0);
+	misaka_test_check(test_channel(&absent, TEST_ABSENT, 0, 2, 1000, 0) == 0);
+	s_now = 5;
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 995);
+	misaka_test_check(s_bus.transfers == 1);
+	misaka_test_check(present.channel.failures == 0 && absent.channel.failures == 1);
+	misaka_test_check(misaka_sampler_available(&absent.channel) == 0);
+	misaka_test_check(misaka_sampler_read(&present.channel, &stamp, sample) == 0);
+	misaka_test_check(sample[0] == TEST_PRESENT && sample[1] == TEST_PRESENT + 1);
+	misaka_test_check(stamp == 5);
+	misaka_test_check(s_gpio.slave_writes == 1);
+
+	return 0;
+}
+
+static int test_sampler_batch(void)
+{
+	test_channel_t fast, slow;
+
+	test_setup();
+	misaka_test_check(test_channel(&fast, TEST_PRESENT, 0, 1, 1000, 0) == 0);
+	misaka_test_check(test_channel(&slow, TEST_PRESENT, 1, 2, 2500, 600) == 0);
+
+	/** < 同时到期，合并为一次传输 */
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 1000);
+	misaka_test_check(s_bus.batches == 1 && s_bus.transfers == 1);
+
+	/** < 未到期，不提交 */
+	s_now = 400;
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 600);
+	misaka_test_check(s_bus.batches == 1);
+
+	/** < 慢通道未进入提前窗口（1900us之后） */
+	s_now = 1000;
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 1000);
+	misaka_test_check(s_bus.batches == 2 && s_bus.transfers == 2);
+	misaka_test_check(fast.channel.samples == 2 && slow.channel.samples == 1);
+
+	/** < 慢通道提前500us并入快通道的批次 */
+	s_now = 2000;
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 1000);
+	misaka_test_check(s_bus.batches == 3 && s_bus.transfers == 3);
+	misaka_test_check(fast.channel.samples == 3 && slow.channel.samples == 2);
+	misaka_test_check(slow.channel.jitter_max_us == 500);
+	misaka_test_check(slow.channel.due == 5000);
+	misaka_test_check(fast.channel.jitter_max_us == 0);
+
+	return 0;
+}
+
+static int test_sampler_miss(void)
+{
+	test_channel_t c;
+
+	test_setup();
+	misaka_test_check(test_channel(&c, TEST_PRESENT, 0, 1, 1000, 0) == 0);
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 1000);
+
+	/** < 计划在1000us，3500us才调度：1000us的采样晚到，2000us与3000us的采样跳过 */
+	s_now = 3500;
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 500);
+	misaka_test_check(c.channel.samples == 2);
+	misaka_test_check(c.channel.misses == 2);
+	misaka_test_check(c.channel.jitter_max_us == 2500);
+	misaka_test_check(c.channel.due == 4000);
+
+	/** < 回到原有时间线 */
+	s_now = 4000;
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 1000);
+	misaka_test_check(c.channel.samples == 3 && c.channel.misses == 2);
+
+	return 0;
+}
+
+static int test_sampler_overrun(void)
+{
+	test_channel_t c;
+	uint8_t sample[1];
+	uint32_t stamp, i;
+
+	test_setup();
+	misaka_test_check(test_channel(&c, TEST_PRESENT, 0, 1, 100, 0) == 0);
+
+	/** < 样本数不为2的幂 */
+	c.channel.ring_size = 3;
+	misaka_test_check(misaka_sampler_add(&s_sampler, &s_bus, &c.channel) == 1);
+	c.channel.ring_size = TEST_RING_SIZE;
+
+	for (i = 0; i < TEST_RING_SIZE + 2; i++)
+	{
+		s_now = i * 100;
+		misaka_test_check(misaka_sampler_poll(&s_sampler) == 100);
+	}
+	misaka_test_check(c.channel.samples == TEST_RING_SIZE);
+	misaka_test_check(c.channel.overruns == 2);
+	misaka_test_check(misaka_sampler_available(&c.channel) == TEST_RING_SIZE);
+
+	/** < 保留最早的样本 */
+	for (i = 0; i < TEST_RING_SIZE; i++)
+	{
+		misaka_test_check(misaka_sampler_read(&c.channel, &stamp, sample) == 0);
+		misaka_test_check(stamp == i * 100);
+		misaka_test_check(sample[0] == TEST_PRESENT + i);
+	}
+	misaka_test_check(misaka_sampler_read(&c.channel, &stamp, sample) == 1);
+
+	/** < 读出后继续写入 */
+	s_now = (TEST_RING_SIZE + 2) * 100;
+	misaka_test_check(misaka_sampler_poll(&s_sampler) == 100);
+	misaka_test_check(misaka_sampler_read(&c.channel, &stamp, sample) == 0);
+	misaka_test_check(stamp == s_now);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_sampler_absent);
+	misaka_test_run(failures, test_sampler_batch);
+	misaka_test_run(failures, test_sampler_miss);
+	misaka_test_run(failures, test_sampler_overrun);
+
+	return failures != 0;
+}
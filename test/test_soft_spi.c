@@ -0,0 +1,160 @@
+/**
+ * @file test_soft_spi.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 软件spi模板：在仿真从机上验证模式0~3、高位/低位在前的收发，只发送时不读miso、只接收时不逐位驱动mosi，
+ * 以及传输结束后sck停在空闲电平。
+ */
+
+#include "sim_soft_spi.h"
+#include "test.h"
+
+static misaka_sim_spi_slave_t s_slave;
+
+#define MISAKA_SOFT_SPI_NAME            test_sim_spi
+#define MISAKA_SOFT_SPI_SET_SCK(s)      misaka_sim_spi_slave_set_sck(&s_slave, (uint8_t) (s))
+#define MISAKA_SOFT_SPI_SET_MOSI(s)     misaka_sim_spi_slave_set_mosi(&s_slave, (uint8_t) (s))
+#define MISAKA_SOFT_SPI_GET_MISO()      misaka_sim_spi_slave_get_miso(&s_slave)
+#include "misaka_device/soft_spi.h"
+
+#define TEST_LENGTH             37
+
+static misaka_spi_bus_t s_bus;
+static uint8_t s_master_tx[TEST_LENGTH];
+static uint8_t s_master_rx[TEST_LENGTH];
+static uint8_t s_slave_tx[TEST_LENGTH];
+static uint8_t s_slave_rx[TEST_LENGTH];
+
+static const uint8_t s_modes[] = {
+	MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB,
+	MISAKA_SPI_MODE_1 | MISAKA_SPI_MSB,
+	MISAKA_SPI_MODE_2 | MISAKA_SPI_MSB,
+	MISAKA_SPI_MODE_3 | MISAKA_SPI_MSB,
+	MISAKA_SPI_MODE_0 | MISAKA_SPI_LSB,
+	MISAKA_SPI_MODE_1 | MISAKA_SPI_LSB,
+	MISAKA_SPI_MODE_2 | MISAKA_SPI_LSB,
+	MISAKA_SPI_MODE_3 | MISAKA_SPI_LSB,
+};
+
+/**
+ * @brief 填充双方的发送数据，从机复位并切换主机模式
+ * @param mode 模式
+ * @return 0:成功 1:失败
+ */
+static uint8_t test_setup(uint8_t mode)
+{
+	misaka_spi_configuration_t cfg = {0};
+	uint32_t i;
+
+	for (i = 0; i < TEST_LENGTH; i++)
+	{
+		s_master_tx[i] = (uint8_t) (i * 73 + 5);
+		s_slave_tx[i] = (uint8_t) (i * 151 + 200);
+		s_master_rx[i] = 0;
+	}
+	/** < 非对称的位型，位序错误时必然不等 */
+	s_master_tx[0] = 0x01;
+	s_slave_tx[0] = 0x80;
+
+	misaka_sim_spi_slave_reset(&s_slave, mode, s_slave_tx, s_slave_rx, TEST_LENGTH);
+	cfg.mode = mode;
+	cfg.data_width = 8;
+
+	return s_bus.ops->configure(s_bus.ctx, NULL, &cfg);
+}
+
+static int test_soft_spi_send_recv(void)
+{
+	uint8_t m;
+
+	test_sim_spi_bus_init(&s_bus, NULL);
+	for (m = 0; m < sizeof(s_modes); m++)
+	{
+		misaka_test_check(test_setup(s_modes[m]) == 0);
+		misaka_test_check(s_bus.ops->send_recv(s_bus.ctx, s_master_tx, s_master_rx, TEST_LENGTH) == 0);
+		misaka_test_check(memcmp(s_slave_rx, s_master_tx, TEST_LENGTH) == 0);
+		misaka_test_check(memcmp(s_master_rx, s_slave_tx, TEST_LENGTH) == 0);
+		misaka_test_check(s_slave.sampled == TEST_LENGTH * 8);
+		misaka_test_check(s_slave.sck == ((s_modes[m] & MISAKA_SPI_CPOL) ? 1 : 0));
+	}
+
+	return 0;
+}
+
+static int test_soft_spi_send(void)
+{
+	uint8_t m;
+
+	test_sim_spi_bus_init(&s_bus, NULL);
+	for (m = 0; m < sizeof(s_modes); m++)
+	{
+		misaka_test_check(test_setup(s_modes[m]) == 0);
+		misaka_test_check(s_bus.ops->send(s_bus.ctx, s_master_tx, TEST_LENGTH) == 0);
+		misaka_test_check(memcmp(s_slave_rx, s_master_tx, TEST_LENGTH) == 0);
+		misaka_test_check(s_slave.miso_calls == 0);
+		misaka_test_check(s_slave.sck == ((s_modes[m] & MISAKA_SPI_CPOL) ? 1 : 0));
+	}
+
+	return 0;
+}
+
+static int test_soft_spi_recv(void)
+{
+	uint8_t m, i;
+
+	test_sim_spi_bus_init(&s_bus, NULL);
+	for (m = 0; m < sizeof(s_modes); m++)
+	{
+		misaka_test_check(test_setup(s_modes[m]) == 0);
+		misaka_test_check(s_bus.ops->recv(s_bus.ctx, s_master_rx, TEST_LENGTH) == 0);
+		misaka_test_check(memcmp(s_master_rx, s_slave_tx, TEST_LENGTH) == 0);
+		/** < mosi只在开始时拉高一次，从机收到的全为1 */
+		misaka_test_check(s_slave.mosi_calls == 1);
+		for (i = 0; i < TEST_LENGTH; i++)
+		{
+			misaka_test_check(s_slave_rx[i] == 0xFF);
+		}
+		misaka_test_check(s_slave.sck == ((s_modes[m] & MISAKA_SPI_CPOL) ? 1 : 0));
+	}
+
+	return 0;
+}
+
+static int test_soft_spi_configure(void)
+{
+	misaka_spi_configuration_t cfg = {0};
+
+	test_sim_spi_bus_init(&s_bus, NULL);
+	cfg.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	cfg.data_width = 16;
+	misaka_test_check(s_bus.ops->configure(s_bus.ctx, NULL, &cfg) == 1);
+	cfg.data_width = 0;
+	misaka_test_check(s_bus.ops->configure(s_bus.ctx, NULL, &cfg) == 0);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_soft_spi_send_recv);
+	misaka_test_run(failures, test_soft_spi_send);
+	misaka_test_run(failures, test_soft_spi_recv);
+	misaka_test_run(failures, test_soft_spi_configure);
+
+	return failures != 0;
+}
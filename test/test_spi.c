@@ -0,0 +1,301 @@
+/**
+ * @file test_spi.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * spi核心层：在仿真总线上检查消息链各段的返回值，空周期失败时即使段长度为0也返回失败、
+ * 不再传输数据且cs照常释放，失败不改写消息本身；仲裁时等待计数在临界区内更新，
+ * 没有更高优先级的设备获取过总线时整条提交，出现后按块提交，不仲裁时不维护等待计数；
+ * 移植层整条提交消息链时cs_active随链的首段cs_take与末段cs_release更新；
+ * 不带上下文的旧式函数经适配操作表接入后收发与cs行为不变，多线段因无多线操作而失败。
+ */
+
+#include <string.h>
+#include "sim_bus.h"
+#include "test.h"
+
+static misaka_sim_spi_t s_sim;
+static misaka_spi_bus_t s_bus;
+static misaka_spi_t s_spi;
+static misaka_spi_bus_ops_t s_ops;
+static uint8_t s_dummy_state;
+static uint32_t s_dummy_calls;
+static uint32_t s_send_calls;
+static uint32_t s_critical_calls;
+static uint8_t s_critical;
+
+static uint8_t test_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	s_send_calls++;
+
+	return misaka_sim_spi_ops.send(ctx, txbuf, length);
+}
+
+static void test_critical_enter(void *ctx)
+{
+	(void) ctx;
+
+	s_critical_calls++;
+	s_critical = 1;
+}
+
+static void test_critical_exit(void *ctx)
+{
+	(void) ctx;
+
+	s_critical = 0;
+}
+
+/**
+ * @brief 整条提交消息链，按各段cs_take/cs_release直接操作cs，不读写cs_active
+ */
+static uint8_t test_chain(void *ctx, misaka_spi_t *device, misaka_spi_message_t *message)
+{
+	uint8_t state = 0;
+
+	for (; message != NULL; message = message->next)
+	{
+		if (message->cs_take)
+		{
+			misaka_sim_spi_cs_ops.set_cs(device->cs_ctx, 0);
+		}
+		if (message->length != 0)
+		{
+			state |= misaka_sim_spi_ops.send(ctx, (uint8_t *) message->send_buf, message->length);
+		}
+		if (message->cs_release)
+		{
+			misaka_sim_spi_cs_ops.set_cs(device->cs_ctx, 1);
+		}
+	}
+
+	return state;
+}
+
+static uint8_t test_dummy(void *ctx, uint8_t cycles, uint8_t lines)
+{
+	(void) ctx;
+	(void) cycles;
+	(void) lines;
+
+	s_dummy_calls++;
+
+	return s_dummy_state;
+}
+
+/**
+ * @brief 仿真总线加上可控结果的空周期操作
+ */
+static void test_setup(void)
+{
+	memset(&s_sim, 0, sizeof(s_sim));
+	misaka_sim_spi_bus_init(&s_bus, &s_spi, &s_sim);
+	s_ops = misaka_sim_spi_ops;
+	s_ops.dummy = test_dummy;
+	s_ops.send = test_send;
+	s_ops.critical_enter = test_critical_enter;
+	s_ops.critical_exit = test_critical_exit;
+	s_bus.ops = &s_ops;
+	s_dummy_state = 0;
+	s_dummy_calls = 0;
+	s_send_calls = 0;
+	s_critical_calls = 0;
+	s_critical = 0;
+}
+
+/**
+ * @brief 初始化消息段
+ * @param message 消息
+ * @param txbuf 待发送数据
+ * @param length 数据长度
+ * @param dummy_cycles 空周期数
+ */
+static void test_segment(misaka_spi_message_t *message, uint8_t *txbuf, uint32_t length, uint8_t dummy_cycles)
+{
+	memset(message, 0, sizeof(*message));
+	message->send_buf = txbuf;
+	message->length = length;
+	message->lines = MISAKA_SPI_LINES_SINGLE;
+	message->dummy_cycles = dummy_cycles;
+	message->cs_take = 1;
+	message->cs_release = 1;
+}
+
+static int test_spi_dummy_only(void)
+{
+	misaka_spi_message_t message;
+
+	test_setup();
+	test_segment(&message, NULL, 0, 8);
+	misaka_test_check(misaka_spi_transfer_message(&s_spi, &message) == 0);
+	misaka_test_check(s_dummy_calls == 1);
+
+	s_dummy_state = 1;
+	misaka_test_check(misaka_spi_transfer_message(&s_spi, &message) == 1);
+	misaka_test_check(s_dummy_calls == 2);
+	misaka_test_check(s_sim.cs == 1);
+	misaka_test_check(s_spi.cs_active == 0);
+
+	return 0;
+}
+
+static int test_spi_dummy_chain(void)
+{
+	misaka_spi_message_t message[2];
+	uint8_t data[4] = {1, 2, 3, 4};
+
+	/** < 第一段只有空周期，失败时后续段不再传输 */
+	test_setup();
+	s_dummy_state = 1;
+	test_segment(&message[0], NULL, 0, 8);
+	test_segment(&message[1], data, sizeof(data), 0);
+	message[0].cs_release = 0;
+	message[1].cs_take = 0;
+	message[0].next = &message[1];
+	misaka_test_check(misaka_spi_transfer_message(&s_spi, message) == 1);
+	misaka_test_check(s_sim.bytes == 0);
+
+	/** < 带数据的段空周期失败：不传输数据，消息长度保持不变 */
+	test_setup();
+	s_dummy_state = 1;
+	test_segment(&message[0], data, sizeof(data), 8);
+	misaka_test_check(misaka_spi_transfer_message(&s_spi, message) == 1);
+	misaka_test_check(s_sim.bytes == 0);
+	misaka_test_check(message[0].length == sizeof(data));
+	misaka_test_check(s_sim.cs == 1);
+
+	return 0;
+}
+
+static int test_spi_arbitrate(void)
+{
+	uint8_t data[32] = {0};
+	misaka_spi_t high;
+
+	test_setup();
+	s_bus.chunk_size = 4;
+	s_spi.preemptible = 1;
+	high = s_spi;
+	high.priority = 2;
+
+	/** < 只有本设备获取过总线，不分块 */
+	misaka_test_check(misaka_spi_send(&s_spi, data, sizeof(data)) == 0);
+	misaka_test_check(s_send_calls == 1);
+	misaka_test_check(s_critical_calls == 2 && s_critical == 0);
+	misaka_test_check(s_bus.waiting[0] == 0);
+
+	/** < 更高优先级的设备获取过总线后按块提交，其自身仍整条提交 */
+	misaka_test_check(misaka_spi_send(&high, data, sizeof(data)) == 0);
+	misaka_test_check(s_send_calls == 2);
+	misaka_test_check(misaka_spi_send(&s_spi, data, sizeof(data)) == 0);
+	misaka_test_check(s_send_calls == 2 + sizeof(data) / 4);
+	misaka_test_check(s_sim.bytes == 3 * sizeof(data));
+	misaka_test_check(s_bus.priorities == ((1U << 0) | (1U << 2)));
+
+	return 0;
+}
+
+static int test_spi_no_arbitrate(void)
+{
+	uint8_t data[32] = {0};
+
+	test_setup();
+	s_ops.critical_enter = NULL;
+	s_ops.critical_exit = NULL;
+	s_spi.preemptible = 1;
+	misaka_test_check(misaka_spi_send(&s_spi, data, sizeof(data)) == 0);
+	misaka_test_check(s_send_calls == 1);
+	misaka_test_check(s_bus.priorities == 0);
+
+	return 0;
+}
+
+static int test_spi_chain_cs(void)
+{
+	misaka_spi_message_t message[2];
+	uint8_t data[4] = {1, 2, 3, 4};
+
+	test_setup();
+	s_ops.transfer_chain = test_chain;
+	test_segment(&message[0], data, sizeof(data), 0);
+	test_segment(&message[1], data, sizeof(data), 0);
+	message[0].cs_release = 0;
+	message[1].cs_take = 0;
+	message[1].cs_release = 0;
+	message[0].next = &message[1];
+
+	/** < 首段选中cs、末段不释放，会话关闭时才释放 */
+	misaka_test_check(misaka_spi_session_open(&s_spi) == 0);
+	misaka_test_check(misaka_spi_session_chain(&s_spi, message) == 0);
+	misaka_test_check(s_sim.cs == 0);
+	misaka_test_check(s_spi.cs_active == 1);
+	misaka_test_check(misaka_spi_session_close(&s_spi) == 0);
+	misaka_test_check(s_sim.cs == 1);
+	misaka_test_check(s_spi.cs_active == 0);
+
+	/** < 末段释放cs */
+	message[1].cs_release = 1;
+	misaka_test_check(misaka_spi_transfer_message(&s_spi, message) == 0);
+	misaka_test_check(s_sim.cs == 1);
+	misaka_test_check(s_spi.cs_active == 0);
+misaka_test_check(s_sim.bytes == 4 * sizeof(data));
+
+	return 0;
+}
+
+static int test_spi_legacy(void)
+{
+	misaka_spi_message_t message;
+	uint8_t tx[4] = {1, 2, 3, 4};
+	uint8_t rx[4];
+
+	memset(&s_sim, 0, sizeof(s_sim));
+	misaka_sim_spi_legacy_init(&s_bus, &s_spi, &s_sim);
+
+	/** < 互斥量两次、cs两次、发送与接收各一次 */
+	misaka_test_check(misaka_spi_send_then_recv(&s_spi, tx, 2, rx, 3) == 0);
+	misaka_test_check(rx[0] == 0xA5 && rx[2] == 0xA5);
+	misaka_test_check(s_sim.callbacks == 6 && s_sim.cs_toggles == 2 && s_sim.bytes == 5);
+	misaka_test_check(s_sim.cs == 1);
+
+	memset(rx, 0, sizeof(rx));
+	misaka_test_check(misaka_spi_transfer(&s_spi, tx, rx, sizeof(tx)) == 0);
+	misaka_test_check(memcmp(rx, tx, sizeof(tx)) == 0);
+
+	/** < 单线空周期以发送代替，四线段没有可用的操作 */
+	test_segment(&message, tx, sizeof(tx), 8);
+	misaka_test_check(misaka_spi_transfer_message(&s_spi, &message) == 0);
+	misaka_test_check(s_sim.bytes == 5 + 4 + 1 + 4);
+	message.lines = MISAKA_SPI_LINES_QUAD;
+	message.dummy_cycles = 0;
+	misaka_test_check(misaka_spi_transfer_message(&s_spi, &message) == 1);
+	misaka_test_check(s_sim.cs == 1 && s_spi.cs_active == 0);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_spi_dummy_only);
+	misaka_test_run(failures, test_spi_dummy_chain);
+	misaka_test_run(failures, test_spi_arbitrate);
+	misaka_test_run(failures, test_spi_no_arbitrate);
+	misaka_test_run(failures, test_spi_chain_cs);
+	misaka_test_run(failures, test_spi_legacy);
+
+	return failures != 0;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file test_spi_adc.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * spi adc：在回环的仿真spi总线上检查扫描表的每个通道各占一段并各自选中cs，接收帧按通道解码，
+ * 样本带扫描开始的时刻，环形缓冲区不足时丢弃整次扫描，传输失败后消息链不变、下一次扫描照常进行；
+ * 另检查MCP3208的命令帧与结果解码。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_adc.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_FRAME_SIZE         2
+#define TEST_RING_SIZE          8
+
+static uint32_t s_now;
+static uint8_t s_fail;/**< 1:下一次收发失败 */
+static misaka_sim_spi_t s_sim;
+static misaka_spi_bus_ops_t s_ops;
+static misaka_spi_bus_t s_bus;
+static misaka_spi_t s_spi;
+static misaka_spi_adc_sample_t s_ring[TEST_RING_SIZE];
+static misaka_spi_adc_t s_adc;
+
+static uint32_t test_get_tick_us(void)
+{
+	return s_now;
+}
+
+/**
+ * @brief 命令帧：通道号与其反码，回环后原样收回
+ * @param channel 通道
+ * @param frame 命令帧
+ */
+static void test_encode(uint8_t channel, uint8_t *frame)
+{
+	frame[0] = channel;
+	frame[1] = (uint8_t) ~channel;
+}
+
+static uint16_t test_decode(uint8_t channel, const uint8_t *frame)
+{
+	return (uint16_t) (((uint16_t) frame[0] << 8) | (uint8_t) (frame[1] ^ channel));
+}
+
+static uint8_t test_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	if (s_fail)
+	{
+		s_fail = 0;
+		return 1;
+	}
+
+	return misaka_sim_spi_ops.send_recv(ctx, txbuf, rxbuf, length);
+}
+
+/**
+ * @brief 初始化仿真总线与adc，收发可按需失败
+ * @param channels 扫描表
+ * @param num 通道数
+ * @return 0:成功 1:失败
+ */
+static int test_setup(const uint8_t *channels, uint8_t num)
+{
+	memset(&s_sim, 0, sizeof(s_sim));
+	misaka_sim_spi_bus_init(&s_bus, &s_spi, &s_sim);
+	s_ops = misaka_sim_spi_ops;
+	s_ops.send_recv = test_send_recv;
+	s_bus.ops = &s_ops;
+	s_fail = 0;
+	s_now = 0;
+
+	memset(&s_adc, 0, sizeof(s_adc));
+	s_adc.spi = &s_spi;
+	s_adc.get_tick_us = test_get_tick_us;
+	s_adc.encode = test_encode;
+	s_adc.decode = test_decode;
+	s_adc.frame_size = TEST_FRAME_SIZE;
+	s_adc.channel_num = num;
+	memcpy(s_adc.channels, channels, num);
+	s_adc.ring = s_ring;
+	s_adc.ring_size = TEST_RING_SIZE;
+
+	return misaka_spi_adc_init(&s_adc);
+}
+
+static int test_spi_adc_frame(void)
+{
+	const uint8_t channels[3] = {5, 0, 7};
+	misaka_spi_adc_sample_t samples[TEST_RING_SIZE];
+	uint32_t i;
+
+	misaka_test_check(test_setup(channels, 3) == 0);
+
+	/** < 每个通道一段，命令帧按扫描表顺序排列 */
+	for (i = 0; i < 3; i++)
+	{
+		misaka_test_check(s_adc.message[i].length == TEST_FRAME_SIZE);
+		misaka_test_check(s_adc.message[i].cs_take && s_adc.message[i].cs_release);
+		misaka_test_check(s_adc.message[i].send_buf == &s_adc.tx[i * TEST_FRAME_SIZE]);
+		misaka_test_check(s_adc.tx[i * TEST_FRAME_SIZE] == channels[i]);
+	}
+	misaka_test_check(s_adc.message[2].next == NULL);
+
+	/** < 一次扫描：每个通道选中、释放cs各一次 */
+	s_now = 1234;
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 0);
+	misaka_test_check(s_sim.cs_toggles == 3 * 2);
+	misaka_test_check(s_sim.bytes == 3 * TEST_FRAME_SIZE);
+	misaka_test_check(s_adc.scans == 1);
+
+	misaka_test_check(misaka_spi_adc_available(&s_adc) == 3);
+	misaka_test_check(misaka_spi_adc_read(&s_adc, samples, TEST_RING_SIZE) == 3);
+	for (i = 0; i < 3; i++)
+	{
+		misaka_test_check(samples[i].channel == channels[i]);
+		misaka_test_check(samples[i].value == (((uint16_t) channels[i] << 8) | 0xFF));
+		misaka_test_check(samples[i].tick == 1234);
+	}
+	misaka_test_check(misaka_spi_adc_available(&s_adc) == 0);
+
+	/** < 扫描表与缓冲区不合法 */
+	misaka_test_check(test_setup(channels, 0) == 1);
+	s_adc.channel_num = 3;
+	s_adc.ring_size = 6;
+	misaka_test_check(misaka_spi_adc_init(&s_adc) == 1);
+	s_adc.ring_size = 2;
+	misaka_test_check(misaka_spi_adc_init(&s_adc) == 1);
+
+	return 0;
+}
+
+static int test_spi_adc_overrun(void)
+{
+	const uint8_t channels[3] = {1, 2, 3};
+	misaka_spi_adc_sample_t samples[TEST_RING_SIZE];
+
+	misaka_test_check(test_setup(channels, 3) == 0);
+
+	/** < 8个样本的缓冲区容纳两次扫描，第三次整次丢弃 */
+	s_now = 100;
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 0);
+	s_now = 200;
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 0);
+	s_now = 300;
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 0);
+	misaka_test_check(s_adc.scans == 2 && s_adc.overruns == 1);
+	misaka_test_check(misaka_spi_adc_available(&s_adc) == 6);
+
+	/** < 读出一个样本后空间恰好够一次扫描，写入跨过缓冲区末尾 */
+	misaka_test_check(misaka_spi_adc_read(&s_adc, samples, 1) == 1);
+	misaka_test_check(samples[0].tick == 100 && samples[0].channel == 1);
+	s_now = 400;
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 0);
+	misaka_test_check(s_adc.scans == 3 && s_adc.overruns == 1);
+	misaka_test_check(misaka_spi_adc_available(&s_adc) == TEST_RING_SIZE);
+
+	/** < 缓冲区满 */
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 0);
+	misaka_test_check(s_adc.overruns == 2);
+
+	misaka_test_check(misaka_spi_adc_read(&s_adc, samples, TEST_RING_SIZE) == TEST_RING_SIZE);
+	misaka_test_check(samples[0].tick == 100 && samples[0].channel == 2);
+	misaka_test_check(samples[2].tick == 200 && samples[2].channel == 1);
+	misaka_test_check(samples[5].tick == 400 && samples[5].channel == 1);
+	misaka_test_check(samples[7].tick == 400 && samples[7].channel == 3);
+	misaka_test_check(samples[7].value == ((3u << 8) | 0xFF));
+
+	return 0;
+}
+
+static int test_spi_adc_failure(void)
+{
+	const uint8_t channels[2] = {4, 6};
+	misaka_spi_adc_sample_t samples[TEST_RING_SIZE];
+
+	misaka_test_check(test_setup(channels, 2) == 0);
+
+	/** < 失败的扫描不写入样本，消息链保持不变 */
+	s_fail = 1;
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 1);
+	misaka_test_check(s_adc.failures == 1 && s_adc.scans == 0);
+	misaka_test_check(misaka_spi_adc_available(&s_adc) == 0);
+	misaka_test_check(s_adc.message[0].length == TEST_FRAME_SIZE && s_adc.message[0].next == &s_adc.message[1]);
+	misaka_test_check(s_adc.message[1].length == TEST_FRAME_SIZE && s_adc.message[1].next == NULL);
+
+	s_now = 10;
+	misaka_test_check(misaka_spi_adc_scan(&s_adc) == 0);
+	misaka_test_check(misaka_spi_adc_read(&s_adc, samples, TEST_RING_SIZE) == 2);
+	misaka_test_check(samples[0].channel == 4 && samples[0].value == ((4u << 8) | 0xFF));
+	misaka_test_check(samples[1].channel == 6 && samples[1].value == ((6u << 8) | 0xFF));
+	misaka_test_check(samples[1].tick == 10);
+
+	return 0;
+}
+
+static int test_spi_adc_mcp3208(void)
+{
+	uint8_t frame[3];
+	const uint8_t result[3] = {0xFF, 0xE5, 0x3C};
+
+	/** < 起始位、单端与通道号D2，D1 D0在第二字节高位 */
+	misaka_spi_adc_mcp3208_encode(5, frame);
+	misaka_test_check(frame[0] == 0x07 && frame[1] == 0x40 && frame[2] == 0x00);
+	misaka_spi_adc_mcp3208_encode(2, frame);
+	misaka_test_check(frame[0] == 0x06 && frame[1] == 0x80 && frame[2] == 0x00);
+
+	/** < 第二字节低4位与第三字节为12位结果 */
+	misaka_test_check(misaka_spi_adc_mcp3208_decode(5, result) == 0x53C);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_spi_adc_frame);
+	misaka_test_run(failures, test_spi_adc_overrun);
+	misaka_test_run(failures, test_spi_adc_failure);
+	misaka_test_run(failures, test_spi_adc_mcp3208);
+
+	return failures != 0;
+}
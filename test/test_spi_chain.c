@@ -0,0 +1,201 @@
+/**
+ * @file test_spi_chain.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * spi级联链：在仿真spi总线上记录发出的字节，检查序号0的器件最后移出、没有变化时不发送、
+ * 多次更新合并为一帧且只有一次cs选中，以及发送失败后保持脏标记并在下次刷新时重发。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_chain.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_DEVICE_NUM         3
+#define TEST_DEVICE_SIZE        2
+#define TEST_FRAME_SIZE         (TEST_DEVICE_NUM * TEST_DEVICE_SIZE)
+
+static uint8_t s_fail;/**< 1:下一次发送失败 */
+static uint8_t s_wire[TEST_FRAME_SIZE * 2];/**< 最近一次发出的字节 */
+static uint32_t s_wire_len;
+static uint32_t s_sends;
+static misaka_sim_spi_t s_sim;
+static misaka_spi_bus_ops_t s_ops;
+static misaka_spi_bus_t s_bus;
+static misaka_spi_t s_spi;
+static uint8_t s_frame[TEST_FRAME_SIZE];
+static misaka_spi_chain_t s_chain;
+
+static uint8_t test_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	s_sends++;
+	if (s_fail)
+	{
+		s_fail = 0;
+		return 1;
+	}
+	s_wire_len = length < sizeof(s_wire) ? length : sizeof(s_wire);
+	memcpy(s_wire, txbuf, s_wire_len);
+
+	return misaka_sim_spi_ops.send(ctx, txbuf, length);
+}
+
+/**
+ * @brief 初始化仿真总线与级联链，并清除初始化后首次刷新的全0帧
+ * @return 0:成功 1:失败
+ */
+static int test_setup(void)
+{
+	memset(&s_sim, 0, sizeof(s_sim));
+	misaka_sim_spi_bus_init(&s_bus, &s_spi, &s_sim);
+	s_ops = misaka_sim_spi_ops;
+	s_ops.send = test_send;
+	s_bus.ops = &s_ops;
+	s_fail = 0;
+
+	memset(&s_chain, 0, sizeof(s_chain));
+	memset(s_frame, 0xEE, sizeof(s_frame));
+	s_chain.spi = &s_spi;
+	s_chain.frame = s_frame;
+	s_chain.device_num = TEST_DEVICE_NUM;
+	s_chain.device_size = TEST_DEVICE_SIZE;
+	misaka_test_check(misaka_spi_chain_init(&s_chain) == 0);
+	misaka_test_check(s_chain.dirty == 1);
+
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+	misaka_test_check(s_wire_len == TEST_FRAME_SIZE);
+	misaka_test_check(s_wire[0] == 0 && s_wire[TEST_FRAME_SIZE - 1] == 0);
+
+	s_sends = 0;
+	s_sim.cs_toggles = 0;
+	s_wire_len = 0;
+
+	return 0;
+}
+
+static int test_spi_chain_order(void)
+{
+	const uint8_t d0[TEST_DEVICE_SIZE] = {0x01, 0x02};
+	const uint8_t d1[TEST_DEVICE_SIZE] = {0x11, 0x12};
+	const uint8_t d2[TEST_DEVICE_SIZE] = {0x21, 0x22};
+
+	misaka_test_check(test_setup() == 0);
+	misaka_test_check(misaka_spi_chain_write(&s_chain, 0, d0) == 0);
+	misaka_test_check(misaka_spi_chain_write(&s_chain, 1, d1) == 0);
+	misaka_test_check(misaka_spi_chain_write(&s_chain, 2, d2) == 0);
+	misaka_test_check(misaka_spi_chain_write(&s_chain, TEST_DEVICE_NUM, d0) == 1);
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+
+	/** < 最远的器件最先移入，序号0（MOSI直连）最后发送 */
+	misaka_test_check(s_wire_len == TEST_FRAME_SIZE);
+	misaka_test_check(memcmp(&s_wire[0], d2, TEST_DEVICE_SIZE) == 0);
+	misaka_test_check(memcmp(&s_wire[TEST_DEVICE_SIZE], d1, TEST_DEVICE_SIZE) == 0);
+	misaka_test_check(memcmp(&s_wire[2 * TEST_DEVICE_SIZE], d0, TEST_DEVICE_SIZE) == 0);
+	misaka_test_check(misaka_spi_chain_state(&s_chain, 0) == &s_frame[2 * TEST_DEVICE_SIZE]);
+
+	/** < 输出位按器件序号连续编号：第9位为器件0第1字节的位1 */
+	misaka_test_check(misaka_spi_chain_write_pin(&s_chain, 9, 0) == 0);
+	misaka_test_check(misaka_spi_chain_write_pin(&s_chain, 16, 0) == 0);
+	misaka_test_check(misaka_spi_chain_write_pin(&s_chain, TEST_FRAME_SIZE * 8, 1) == 1);
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+	misaka_test_check(s_wire[2 * TEST_DEVICE_SIZE + 1] == 0x00);
+	misaka_test_check(s_wire[TEST_DEVICE_SIZE] == 0x10);
+
+	return 0;
+}
+
+static int test_spi_chain_clean(void)
+{
+	const uint8_t d1[TEST_DEVICE_SIZE] = {0, 0};
+
+	misaka_test_check(test_setup() == 0);
+
+	/** < 没有更新 */
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+	misaka_test_check(s_sends == 0 && s_sim.cs_toggles == 0);
+
+	/** < 更新的内容与影子状态相同，不置脏 */
+	misaka_test_check(misaka_spi_chain_write(&s_chain, 1, d1) == 0);
+	misaka_test_check(misaka_spi_chain_update(&s_chain, 2, 1, 0xF0, 0x00) == 0);
+	misaka_test_check(misaka_spi_chain_write_pin(&s_chain, 3, 0) == 0);
+	misaka_test_check(s_chain.dirty == 0 && s_chain.updates == 0);
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+	misaka_test_check(s_sends == 0 && s_sim.cs_toggles == 0);
+	misaka_test_check(s_chain.frames == 1);
+
+	return 0;
+}
+
+static int test_spi_chain_batch(void)
+{
+	uint32_t pin;
+
+	misaka_test_check(test_setup() == 0);
+
+	/** < 多次更新合并为一帧，一次cs选中与释放 */
+	for (pin = 0; pin < 8; pin++)
+	{
+		misaka_test_check(misaka_spi_chain_write_pin(&s_chain, pin, 1) == 0);
+	}
+	misaka_test_check(misaka_spi_chain_update(&s_chain, 2, 0, 0x0F, 0x05) == 0);
+	misaka_spi_chain_state(&s_chain, 1)[1] = 0x80;
+	misaka_spi_chain_mark(&s_chain);
+	misaka_test_check(s_chain.updates == 10);
+
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+	misaka_test_check(s_sends == 1);
+	misaka_test_check(s_sim.cs_toggles == 2 && s_sim.cs == 1);
+	misaka_test_check(s_chain.frames == 2 && s_chain.dirty == 0);
+	misaka_test_check(s_wire[0] == 0x05 && s_wire[3] == 0x80 && s_wire[4] == 0xFF);
+
+	return 0;
+}
+
+static int test_spi_chain_failure(void)
+{
+	misaka_test_check(test_setup() == 0);
+
+	/** < 发送失败保持脏标记 */
+	misaka_test_check(misaka_spi_chain_write_pin(&s_chain, 0, 1) == 0);
+	s_fail = 1;
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 1);
+	misaka_test_check(s_chain.dirty == 1);
+	misaka_test_check(s_chain.failures == 1 && s_chain.frames == 1);
+
+	/** < 下次刷新重发，失败期间的更新一并发出 */
+	misaka_test_check(misaka_spi_chain_write_pin(&s_chain, 8, 1) == 0);
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+	misaka_test_check(s_sends == 2);
+	misaka_test_check(s_chain.dirty == 0 && s_chain.frames == 2);
+	misaka_test_check(s_wire[4] == 0x01 && s_wire[5] == 0x01);
+
+	misaka_test_check(misaka_spi_chain_flush(&s_chain) == 0);
+	misaka_test_check(s_sends == 2);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_spi_chain_order);
+	misaka_test_run(failures, test_spi_chain_clean);
+	misaka_test_run(failures, test_spi_chain_batch);
+	misaka_test_run(failures, test_spi_chain_failure);
+
+	return failures != 0;
+}
@@ -0,0 +1,266 @@
+/**
+ * @file test_spi_flash.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * spi flash：在仿真flash上检查sfdp解析出的容量、页、擦除类型与读指令，控制器不支持多线时退回单线快速读，
+ * 四线与单线读出的数据，跨页写入按页拆分，编程后先等待典型时间再查询状态，以及擦除选用最大的对齐擦除块。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_flash.h"
+#include "test.h"
+
+#define TEST_FLASH_SIZE         (256UL * 1024UL)
+
+static uint8_t s_mem[TEST_FLASH_SIZE];
+static uint8_t s_buf[1024];
+static misaka_spi_bus_t s_single_bus;
+static misaka_spi_bus_ops_t s_single_ops;
+static misaka_spi_t s_spi;
+static misaka_spi_flash_t s_flash;
+static uint32_t s_delay_us;
+static uint32_t s_delay_calls;
+
+static void test_delay_us(uint32_t us)
+{
+	s_delay_us += us;
+	s_delay_calls++;
+}
+
+/**
+ * @brief 初始化仿真flash与驱动
+ * @param busy_polls 编程或擦除后状态寄存器保持忙的读取次数
+ * @param single 1:控制器只支持单线 0:支持双线/四线
+ * @return 0:成功 1:失败
+ */
+static int test_setup(uint32_t busy_polls, uint8_t single)
+{
+	misaka_spi_bus_t *bus = misaka_spi_flash_sim_init(s_mem, TEST_FLASH_SIZE, busy_polls);
+
+	if (single)
+	{
+		s_single_ops = *bus->ops;
+		s_single_ops.send_lines = NULL;
+		s_single_ops.recv_lines = NULL;
+		s_single_bus = *bus;
+		s_single_bus.ops = &s_single_ops;
+		bus = &s_single_bus;
+	}
+
+	memset(&s_spi, 0, sizeof(s_spi));
+	s_spi.cs_ops = &misaka_spi_flash_sim_cs_ops;
+	s_spi.bus = bus;
+	s_spi.config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	s_spi.config.data_width = 8;
+
+	memset(&s_flash, 0, sizeof(s_flash));
+	s_flash.spi = &s_spi;
+	s_delay_us = 0;
+	s_delay_calls = 0;
+
+	return misaka_spi_flash_init(&s_flash);
+}
+
+/**
+ * @brief 检查一段存储空间是否全为value
+ * @param addr 地址
+ * @param len 长度
+ * @param value 数据
+ * @return 1:是 0:否
+ */
+static int test_mem_is(uint32_t addr, uint32_t len, uint8_t value)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		if (s_mem[addr + i] != value)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int test_spi_flash_sfdp(void)
+{
+	misaka_test_check(test_setup(0, 0) == 0);
+	misaka_test_check(s_flash.jedec_id[0] == 0xEF && s_flash.jedec_id[1] == 0x40 && s_flash.jedec_id[2] == 18);
+	misaka_test_check(s_flash.capacity == TEST_FLASH_SIZE);
+	misaka_test_check(s_flash.addr_bytes == 3);
+	misaka_test_check(s_flash.page_size == 256);
+	misaka_test_check(s_flash.program_typ_us == 320);
+
+	/** < 擦除类型按块大小从小到大排列 */
+	misaka_test_check(s_flash.erase[0].opcode == 0x20 && s_flash.erase[0].size == 4096 && s_flash.erase[0].typ_us == 48000);
+	misaka_test_check(s_flash.erase[1].opcode == 0x52 && s_flash.erase[1].size == 32768 && s_flash.erase[1].typ_us == 128000);
+	misaka_test_check(s_flash.erase[2].opcode == 0xD8 && s_flash.erase[2].size == 65536 && s_flash.erase[2].typ_us == 384000);
+	misaka_test_check(s_flash.erase[3].size == 0);
+
+	/** < 1-1-4快速读 */
+	misaka_test_check(s_flash.read_opcode == 0x6B);
+	misaka_test_check(s_flash.read_dummy == 8);
+	misaka_test_check(s_flash.read_lines == MISAKA_SPI_LINES_QUAD);
+
+	/** < 控制器只支持单线，退回0x0B快速读，其余参数仍来自sfdp */
+	misaka_test_check(test_setup(0, 1) == 0);
+	misaka_test_check(s_flash.read_opcode == 0x0B);
+	misaka_test_check(s_flash.read_dummy == 8);
+	misaka_test_check(s_flash.read_lines == MISAKA_SPI_LINES_SINGLE);
+	misaka_test_check(s_flash.erase[1].size == 32768);
+
+	return 0;
+}
+
+static int test_spi_flash_read(void)
+{
+	uint32_t i, cs, bytes, cs0, bytes0;
+
+	for (i = 0; i < TEST_FLASH_SIZE; i++)
+	{
+		s_mem[i] = (uint8_t) (i * 7 + (i >> 8));
+	}
+
+	/** < 四线：指令与地址4字节，8个空周期按四线为4字节 */
+	misaka_test_check(test_setup(0, 0) == 0);
+	misaka_spi_flash_sim_stat(&cs0, NULL, &bytes0);
+	memset(s_buf, 0, sizeof(s_buf));
+	misaka_test_check(misaka_spi_flash_read(&s_flash, 0x1234, s_buf, 300) == 0);
+	misaka_test_check(memcmp(s_buf, &s_mem[0x1234], 300) == 0);
+	misaka_spi_flash_sim_stat(&cs, NULL, &bytes);
+	misaka_test_check(cs - cs0 == 1);
+	misaka_test_check(bytes - bytes0 == 4 + 4 + 300);
+
+	/** < 单线快速读：空周期为1字节 */
+	misaka_test_check(test_setup(0, 1) == 0);
+	misaka_spi_flash_sim_stat(&cs0, NULL, &bytes0);
+	memset(s_buf, 0, sizeof(s_buf));
+	misaka_test_check(misaka_spi_flash_read(&s_flash, TEST_FLASH_SIZE - 100, s_buf, 100) == 0);
+	misaka_test_check(memcmp(s_buf, &s_mem[TEST_FLASH_SIZE - 100], 100) == 0);
+	misaka_spi_flash_sim_stat(&cs, NULL, &bytes);
+	misaka_test_check(cs - cs0 == 1);
+	misaka_test_check(bytes - bytes0 == 4 + 1 + 100);
+
+	return 0;
+}
+
+static int test_spi_flash_program(void)
+{
+	uint32_t i, cs, status, cs0, status0;
+
+	for (i = 0; i < sizeof(s_buf); i++)
+	{
+		s_buf[i] = (uint8_t) (i * 13 + 5);
+	}
+	memset(s_mem, 0xFF, sizeof(s_mem));
+
+	/** < 0x1F0起600字节跨越4页：16+256+256+72，仿真flash在页内回绕，未拆分时数据错位 */
+	misaka_test_check(test_setup(0, 0) == 0);
+	misaka_spi_flash_sim_stat(&cs0, &status0, NULL);
+	misaka_test_check(misaka_spi_flash_write(&s_flash, 0x1F0, s_buf, 600) == 0);
+	misaka_test_check(s_flash.busy == 1);
+	misaka_test_check(misaka_spi_flash_sync(&s_flash) == 0);
+	misaka_test_check(s_flash.busy == 0);
+	misaka_spi_flash_sim_stat(&cs, &status, NULL);
+
+	/** < 每页写使能与页编程各一次，每页之后查询一次状态 */
+	misaka_test_check(status - status0 == 4);
+	misaka_test_check(cs - cs0 == 4 * 2 + 4);
+	misaka_test_check(memcmp(&s_mem[0x1F0], s_buf, 600) == 0);
+	misaka_test_check(test_mem_is(0, 0x1F0, 0xFF));
+	misaka_test_check(test_mem_is(0x1F0 + 600, 0x1000, 0xFF));
+
+	return 0;
+}
+
+static int test_spi_flash_wip(void)
+{
+	uint32_t status, status0;
+
+	memset(s_mem, 0xFF, sizeof(s_mem));
+	misaka_test_check(test_setup(3, 0) == 0);
+	s_flash.delay_us = test_delay_us;
+	misaka_spi_flash_sim_stat(NULL, &status0, NULL);
+
+	/** < 第二页之前先等待典型时间320us，之后每40us查询一次，忙3次后空闲 */
+	misaka_test_check(misaka_spi_flash_write(&s_flash, 0, s_buf, 512) == 0);
+	misaka_spi_flash_sim_stat(NULL, &status, NULL);
+	misaka_test_check(status - status0 == 4);
+	misaka_test_check(s_delay_us == 320 + 3 * 40);
+	misaka_test_check(s_delay_calls == 4);
+
+	/** < 同步不等待典型时间，以1us为间隔查询 */
+	misaka_test_check(misaka_spi_flash_sync(&s_flash) == 0);
+	misaka_spi_flash_sim_stat(NULL, &status, NULL);
+	misaka_test_check(status - status0 == 8);
+	misaka_test_check(s_delay_us == 320 + 3 * 40 + 3);
+	misaka_test_check(memcmp(s_mem, s_buf, 512) == 0);
+
+	/** < 忙时仿真flash忽略读指令，读之前需等待 */
+	misaka_test_check(misaka_spi_flash_write(&s_flash, 512, s_buf, 16) == 0);
+	memset(s_buf + 512, 0, 16);
+	misaka_test_check(misaka_spi_flash_read(&s_flash, 512, s_buf + 512, 16) == 0);
+	misaka_test_check(memcmp(s_buf + 512, s_buf, 16) == 0);
+	misaka_test_check(s_flash.busy == 0);
+
+	return 0;
+}
+
+static int test_spi_flash_erase(void)
+{
+	uint32_t cs, status, cs0, status0;
+
+	memset(s_mem, 0x00, sizeof(s_mem));
+	misaka_test_check(test_setup(1, 0) == 0);
+
+	/** < 4K起124K：7个4K，32K处1个32K，64K处1个64K */
+	misaka_spi_flash_sim_stat(&cs0, &status0, NULL);
+	misaka_test_check(misaka_spi_flash_erase(&s_flash, 0x1000, 0x1F000) == 0);
+	misaka_test_check(misaka_spi_flash_sync(&s_flash) == 0);
+	misaka_spi_flash_sim_stat(&cs, &status, NULL);
+	misaka_test_check((cs - cs0) - (status - status0) == 9 * 2);
+	misaka_test_check(test_mem_is(0, 0x1000, 0x00));
+	misaka_test_check(test_mem_is(0x1000, 0x1F000, 0xFF));
+	misaka_test_check(test_mem_is(0x20000, 0x1000, 0x00));
+
+	/** < 未按最小擦除块对齐 */
+	misaka_test_check(misaka_spi_flash_erase(&s_flash, 0x800, 0x1000) == 1);
+	misaka_test_check(misaka_spi_flash_erase(&s_flash, 0x1000, 0x800) == 1);
+
+	/** < 整片 */
+	misaka_spi_flash_sim_stat(&cs0, &status0, NULL);
+	misaka_test_check(misaka_spi_flash_erase(&s_flash, 0, TEST_FLASH_SIZE) == 0);
+	misaka_test_check(misaka_spi_flash_sync(&s_flash) == 0);
+	misaka_spi_flash_sim_stat(&cs, &status, NULL);
+	misaka_test_check((cs - cs0) - (status - status0) == 2);
+	misaka_test_check(test_mem_is(0, TEST_FLASH_SIZE, 0xFF));
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_spi_flash_sfdp);
+	misaka_test_run(failures, test_spi_flash_read);
+	misaka_test_run(failures, test_spi_flash_program);
+	misaka_test_run(failures, test_spi_flash_wip);
+	misaka_test_run(failures, test_spi_flash_erase);
+
+	return failures != 0;
+}
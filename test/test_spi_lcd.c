@@ -0,0 +1,240 @@
+/**
+ * @file test_spi_lcd.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * spi屏幕刷新：仿真控制器按D/C区分命令与数据，cs释放即结束RAMWR；检查超过一条消息链的矩形
+ * 只选中一次cs且控制器收到全部像素，以及只需一条消息链的矩形不使用会话。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_lcd.h"
+#include "test.h"
+
+#define TEST_WIDTH              64
+#define TEST_HEIGHT             64
+
+/**
+ * 仿真控制器：记录cs选中次数与RAMWR之后收到的像素字节
+ */
+struct test_panel_struct
+{
+	uint8_t cs;/**< cs电平 */
+	uint8_t dc;/**< D/C电平，1为数据 */
+	uint8_t cmd;/**< 当前命令，cs释放后清零 */
+	uint32_t cs_asserts;/**< cs选中次数 */
+	uint32_t pixel_bytes;/**< RAMWR之后收到的字节数 */
+	uint8_t pixels[TEST_WIDTH * TEST_HEIGHT * 2];/**< RAMWR之后收到的字节 */
+};
+
+typedef struct test_panel_struct test_panel_t;
+
+static test_panel_t s_panel;
+static uint16_t s_framebuffer[TEST_WIDTH * TEST_HEIGHT];
+static misaka_spi_bus_t s_bus;
+static misaka_spi_t s_spi;
+static misaka_spi_lcd_t s_lcd;
+
+static uint8_t test_panel_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	test_panel_t *panel = (test_panel_t *) ctx;
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		if (!panel->dc)
+		{
+			panel->cmd = txbuf[i];
+		}
+		else if (panel->cmd == MISAKA_SPI_LCD_CMD_RAMWR && panel->pixel_bytes < sizeof(panel->pixels))
+		{
+			panel->pixels[panel->pixel_bytes++] = txbuf[i];
+		}
+	}
+
+	return 0;
+}
+
+static uint8_t test_panel_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	memset(rxbuf, 0, length);
+
+	return test_panel_send(ctx, txbuf, length);
+}
+
+static uint8_t test_panel_recv(void *ctx, uint8_t *rxbuf, uint32_t length)
+{
+	(void) ctx;
+
+	memset(rxbuf, 0, length);
+
+	return 0;
+}
+
+static void test_panel_nop(void *ctx)
+{
+	(void) ctx;
+}
+
+static void test_panel_set_cs(void *ctx, uint8_t state)
+{
+	test_panel_t *panel = (test_panel_t *) ctx;
+
+	if (panel->cs && !state)
+	{
+		panel->cs_asserts++;
+	}
+	else if (!panel->cs && state)
+	{
+		panel->cmd = 0;
+	}
+	panel->cs = state;
+}
+
+static void test_panel_set_dc(void *ctx, uint8_t state)
+{
+	((test_panel_t *) ctx)->dc = state;
+}
+
+static const misaka_spi_bus_ops_t s_panel_ops = {
+	test_panel_send_recv,
+	test_panel_send,
+	test_panel_recv,
+	test_panel_nop,
+	test_panel_nop,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+
+static const misaka_spi_cs_ops_t s_panel_cs_ops = {
+	test_panel_set_cs,
+	test_panel_set_dc,
+};
+
+static void test_delay_ms(uint32_t ms)
+{
+	(void) ms;
+}
+
+/**
+ * @brief 初始化屏幕并清空仿真控制器的记录
+ * @return 0:成功 1:失败
+ */
+static int test_setup(void)
+{
+	uint32_t i;
+
+	memset(&s_panel, 0, sizeof(s_panel));
+	s_panel.cs = 1;
+
+	memset(&s_bus, 0, sizeof(s_bus));
+	s_bus.ops = &s_panel_ops;
+	s_bus.ctx = &s_panel;
+	memset(&s_spi, 0, sizeof(s_spi));
+	s_spi.bus = &s_bus;
+	s_spi.cs_ops = &s_panel_cs_ops;
+	s_spi.cs_ctx = &s_panel;
+	s_spi.config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	s_spi.config.data_width = 8;
+
+	for (i = 0; i < TEST_WIDTH * TEST_HEIGHT; i++)
+	{
+		s_framebuffer[i] = (uint16_t) (i * 2654435761U >> 16);
+	}
+
+	memset(&s_lcd, 0, sizeof(s_lcd));
+	s_lcd.spi = &s_spi;
+	s_lcd.delay_ms = test_delay_ms;
+	s_lcd.framebuffer = s_framebuffer;
+	s_lcd.width = TEST_WIDTH;
+	s_lcd.height = TEST_HEIGHT;
+	misaka_test_check(misaka_spi_lcd_init(&s_lcd) == 0);
+	misaka_test_check(misaka_spi_lcd_flush(&s_lcd) == 0);
+
+	s_panel.cs_asserts = 0;
+	s_panel.pixel_bytes = 0;
+	s_lcd.chains = 0;
+
+	return 0;
+}
+
+/**
+ * @brief 刷新一个矩形，检查只选中一次cs且控制器按行收到显存中的全部像素
+ * @param x 列
+ * @param y 行
+ * @param w 宽度
+ * @param h 高度
+ * @param chains 预期的消息链数
+ * @return 0:通过 1:失败
+ */
+static int test_flush(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint32_t chains)
+{
+	uint16_t row;
+
+	misaka_test_check(test_setup() == 0);
+	misaka_spi_lcd_invalidate(&s_lcd, x, y, w, h);
+	misaka_test_check(misaka_spi_lcd_flush(&s_lcd) == 0);
+
+	misaka_test_check(s_lcd.chains == chains);
+	misaka_test_check(s_panel.cs_asserts == 1);
+	misaka_test_check(s_panel.cs == 1);
+	misaka_test_check(s_panel.pixel_bytes == (uint32_t) w * h * 2);
+	for (row = 0; row < h; row++)
+	{
+		misaka_test_check(memcmp(&s_panel.pixels[row * w * 2], &s_framebuffer[(y + row) * TEST_WIDTH + x], w * 2) == 0);
+	}
+	misaka_test_check(s_spi.session == 0);
+
+	return 0;
+}
+
+static int test_spi_lcd_tall(void)
+{
+	/** < 5段窗口命令 + 60行，分为3条消息链 */
+	return test_flush(10, 2, 4, 60, 3);
+}
+
+static int test_spi_lcd_exact(void)
+{
+	/** < 恰好装满一条消息链 */
+	return test_flush(0, 0, 8, MISAKA_SPI_LCD_SEGMENT_MAX - 5, 1);
+}
+
+static int test_spi_lcd_small(void)
+{
+	return test_flush(3, 5, 7, 3, 1);
+}
+
+static int test_spi_lcd_full_width(void)
+{
+	return test_flush(0, 1, TEST_WIDTH, TEST_HEIGHT - 1, 1);
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_spi_lcd_tall);
+	misaka_test_run(failures, test_spi_lcd_exact);
+	misaka_test_run(failures, test_spi_lcd_small);
+	misaka_test_run(failures, test_spi_lcd_full_width);
+
+	return failures != 0;
+}
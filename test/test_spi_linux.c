@@ -0,0 +1,336 @@
+/**
+ * @file test_spi_linux.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * linux spidev后端：以ioctl拦截函数代替内核，检查下发的模式、位宽与速率，
+ * 消息链到spi_ioc_transfer的转换（cs_change、分批、空周期、多线），
+ * 并按内核的规则拒绝未打开SPI_TX/RX_DUAL/QUAD的多线传输。
+ */
+
+#include <string.h>
+#include <linux/spi/spidev.h>
+#include "misaka_device/spi_linux.h"
+#include "test.h"
+
+#define TEST_LOG_MAX            8
+
+struct test_message_struct
+{
+	uint32_t num;/**< 本次SPI_IOC_MESSAGE的传输数 */
+	struct spi_ioc_transfer xfer[MISAKA_SPI_LINUX_TRANSFER_MAX];
+};
+
+static misaka_spi_linux_t s_dev;
+static uint32_t s_mode;/**< 内核中的模式 */
+static uint8_t s_bits;
+static uint32_t s_speed;
+static uint32_t s_mode_writes;
+static int s_fail;/**< 为1时SPI_IOC_MESSAGE失败 */
+static struct test_message_struct s_log[TEST_LOG_MAX];
+static uint32_t s_log_num;
+
+/**
+ * @brief 按内核spi_validate的规则检查线宽
+ * @param nbits tx_nbits或rx_nbits
+ * @param dual SPI_TX_DUAL或SPI_RX_DUAL
+ * @param quad SPI_TX_QUAD或SPI_RX_QUAD
+ * @return 0:合法 1:非法
+ */
+static int test_nbits_invalid(uint8_t nbits, uint32_t dual, uint32_t quad)
+{
+	if (nbits == 2)
+	{
+		return !(s_mode & (dual | quad));
+	}
+	if (nbits == 4)
+	{
+		return !(s_mode & quad);
+	}
+
+	return nbits > 1;
+}
+
+/**
+ * @brief ioctl拦截函数：记录配置与消息，收发同时存在时回环
+ */
+static int test_ioctl(int fd, unsigned long request, void *arg)
+{
+	struct spi_ioc_transfer *xfer = (struct spi_ioc_transfer *) arg;
+	uint32_t i, num;
+
+	if (fd != 42)
+	{
+		return -1;
+	}
+
+	if (request == SPI_IOC_WR_MODE32)
+	{
+		s_mode = *(uint32_t *) arg;
+		s_mode_writes++;
+		return 0;
+	}
+	if (request == SPI_IOC_WR_MODE)
+	{
+		/** < 8位接口只覆盖低8位 */
+		s_mode = (s_mode & ~0xFFU) | *(uint8_t *) arg;
+		s_mode_writes++;
+		return 0;
+	}
+	if (request == SPI_IOC_WR_BITS_PER_WORD)
+	{
+		s_bits = *(uint8_t *) arg;
+		return 0;
+	}
+	if (request == SPI_IOC_WR_MAX_SPEED_HZ)
+	{
+		s_speed = *(uint32_t *) arg;
+		return 0;
+	}
+
+	if (_IOC_TYPE(request) != SPI_IOC_MAGIC || _IOC_NR(request) != 0 || _IOC_DIR(request) != _IOC_WRITE)
+	{
+		return -1;
+	}
+	num = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+	if (s_fail || num == 0 || num > MISAKA_SPI_LINUX_TRANSFER_MAX)
+	{
+		return -1;
+	}
+	for (i = 0; i < num; i++)
+	{
+		if (test_nbits_invalid(xfer[i].tx_nbits, SPI_TX_DUAL, SPI_TX_QUAD)
+			|| test_nbits_invalid(xfer[i].rx_nbits, SPI_RX_DUAL, SPI_RX_QUAD))
+		{
+			return -1;
+		}
+	}
+
+	if (s_log_num < TEST_LOG_MAX)
+	{
+		s_log[s_log_num].num = num;
+		memcpy(s_log[s_log_num].xfer, xfer, num * sizeof(struct spi_ioc_transfer));
+		s_log_num++;
+	}
+	for (i = 0; i < num; i++)
+	{
+		if (xfer[i].tx_buf != 0 && xfer[i].rx_buf != 0)
+		{
+			memcpy((void *) (uintptr_t) xfer[i].rx_buf, (const void *) (uintptr_t) xfer[i].tx_buf, xfer[i].len);
+		}
+		else if (xfer[i].rx_buf != 0)
+		{
+			memset((void *) (uintptr_t) xfer[i].rx_buf, 0xA5, xfer[i].len);
+		}
+	}
+
+	return (int) num;
+}
+
+/**
+ * @brief 以拦截函数初始化设备
+ * @param mode 模式
+ */
+static void test_setup(uint8_t mode)
+{
+	misaka_spi_configuration_t cfg = {0};
+
+	cfg.mode = mode;
+	cfg.data_width = 8;
+	cfg.max_hz = 1000000;
+
+	memset(&s_dev, 0, sizeof(s_dev));
+	s_dev.ioctl = test_ioctl;
+	misaka_spi_linux_attach(&s_dev, 42, &cfg);
+
+	s_mode = 0;
+	s_bits = 0;
+	s_speed = 0;
+	s_mode_writes = 0;
+	s_fail = 0;
+	s_log_num = 0;
+}
+
+static int test_spi_linux_configure(void)
+{
+	uint8_t tx[4] = {1, 2, 3, 4}, rx[4] = {0};
+
+	test_setup(MISAKA_SPI_MODE_3 | MISAKA_SPI_LSB);
+	misaka_test_check(misaka_spi_transfer(&s_dev.device, tx, rx, sizeof(tx)) == 0);
+	misaka_test_check(s_mode == (SPI_CPHA | SPI_CPOL | SPI_LSB_FIRST));
+	misaka_test_check(s_bits == 8);
+	misaka_test_check(s_speed == 1000000);
+	misaka_test_check(memcmp(tx, rx, sizeof(tx)) == 0);
+
+	/** < 配置不变时不重复下发 */
+	misaka_test_check(misaka_spi_transfer(&s_dev.device, tx, rx, sizeof(tx)) == 0);
+	misaka_test_check(s_mode_writes == 1);
+	misaka_test_check(s_log_num == 2);
+	misaka_test_check(s_log[0].num == 1 && s_log[0].xfer[0].cs_change == 0);
+	misaka_test_check(s_log[0].xfer[0].tx_nbits == 0 && s_log[0].xfer[0].rx_nbits == 0);
+
+	return 0;
+}
+
+static int test_spi_linux_send_then_recv(void)
+{
+	uint8_t cmd[2] = {0x9F, 0x00}, id[3] = {0};
+
+	test_setup(MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB);
+	misaka_test_check(misaka_spi_send_then_recv(&s_dev.device, cmd, sizeof(cmd), id, sizeof(id)) == 0);
+	misaka_test_check(s_mode == 0);
+	misaka_test_check(s_log_num == 1 && s_log[0].num == 2);
+	misaka_test_check(s_log[0].xfer[0].tx_buf == (uintptr_t) cmd && s_log[0].xfer[0].rx_buf == 0);
+	misaka_test_check(s_log[0].xfer[1].tx_buf == 0 && s_log[0].xfer[1].rx_buf == (uintptr_t) id);
+	misaka_test_check(s_log[0].xfer[0].cs_change == 0 && s_log[0].xfer[1].cs_change == 0);
+	misaka_test_check(id[0] == 0xA5 && id[2] == 0xA5);
+
+	return 0;
+}
+
+/**
+ * @brief 四线快速读：单线命令与地址、8个四线空周期、四线接收
+ */
+static int test_spi_linux_quad(void)
+{
+	uint8_t cmd[4] = {0xEB, 0x00, 0x10, 0x00}, data[16] = {0};
+	misaka_spi_configuration_t cfg;
+	misaka_spi_message_t message[2];
+
+	test_setup(MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB);
+	memset(message, 0, sizeof(message));
+	message[0].send_buf = cmd;
+	message[0].length = sizeof(cmd);
+	message[0].cs_take = 1;
+	message[0].next = &message[1];
+	message[1].recv_buf = data;
+	message[1].length = sizeof(data);
+	message[1].lines = MISAKA_SPI_LINES_QUAD;
+	message[1].dummy_cycles = 8;
+	message[1].cs_release = 1;
+
+	misaka_test_check(misaka_spi_transfer_message(&s_dev.device, message) == 0);
+	misaka_test_check((s_mode & (SPI_TX_QUAD | SPI_RX_QUAD)) == (SPI_TX_QUAD | SPI_RX_QUAD));
+	misaka_test_check((s_mode & (SPI_TX_DUAL | SPI_RX_DUAL)) == 0);
+	misaka_test_check(s_log_num == 1 && s_log[0].num == 3);
+	/** < 8个四线空周期为4字节 */
+	misaka_test_check(s_log[0].xfer[1].len == 4 && s_log[0].xfer[1].tx_nbits == 4);
+	misaka_test_check(s_log[0].xfer[2].rx_nbits == 4 && s_log[0].xfer[2].tx_nbits == 0);
+	misaka_test_check(data[0] == 0xA5 && data[15] == 0xA5);
+
+	/** < 模式位已打开，之后不再重复下发；重新配置后保留 */
+	misaka_test_check(misaka_spi_transfer_message(&s_dev.device, message) == 0);
+	misaka_test_check(s_mode_writes == 2);
+	cfg.mode = MISAKA_SPI_MODE_1 | MISAKA_SPI_MSB;
+	cfg.data_width = 8;
+	cfg.max_hz = 2000000;
+	misaka_test_check(misaka_spi_configure(&s_dev.device, &cfg) == 0);
+	misaka_test_check(misaka_spi_transfer_message(&s_dev.device, message) == 0);
+	misaka_test_check(s_mode == (SPI_CPHA | SPI_TX_QUAD | SPI_RX_QUAD));
+	misaka_test_check(s_mode_writes == 3);
+	misaka_test_check(s_log_num == 3);
+
+	return 0;
+}
+
+static int test_spi_linux_dual_send(void)
+{
+	uint8_t data[8] = {0};
+	misaka_spi_message_t message;
+
+	test_setup(MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB);
+	memset(&message, 0, sizeof(message));
+	message.send_buf = data;
+	message.length = sizeof(data);
+	message.lines = MISAKA_SPI_LINES_DUAL;
+	message.cs_take = 1;
+	message.cs_release = 1;
+
+	misaka_test_check(misaka_spi_transfer_message(&s_dev.device, &message) == 0);
+	misaka_test_check((s_mode & (SPI_TX_DUAL | SPI_TX_QUAD | SPI_RX_DUAL | SPI_RX_QUAD)) == SPI_TX_DUAL);
+	misaka_test_check(s_log[0].xfer[0].tx_nbits == 2 && s_log[0].xfer[0].rx_nbits == 0);
+
+	/** < 多线时不能同时收发 */
+	message.recv_buf = data;
+	misaka_test_check(misaka_spi_transfer_message(&s_dev.device, &message) == 1);
+
+	return 0;
+}
+
+/**
+ * @brief 超过MISAKA_SPI_LINUX_TRANSFER_MAX段时分批，批次之间cs保持；中途释放cs的段置cs_change
+ */
+static int test_spi_linux_batch(void)
+{
+	static misaka_spi_message_t message[MISAKA_SPI_LINUX_TRANSFER_MAX + 8];
+	static uint8_t data[MISAKA_SPI_LINUX_TRANSFER_MAX + 8];
+	uint32_t i, num = MISAKA_SPI_LINUX_TRANSFER_MAX + 8;
+
+	test_setup(MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB);
+	memset(message, 0, sizeof(message));
+	for (i = 0; i < num; i++)
+	{
+		message[i].send_buf = &data[i];
+		message[i].length = 1;
+		message[i].next = i + 1 < num ? &message[i + 1] : NULL;
+	}
+	message[0].cs_take = 1;
+	message[3].cs_release = 1;
+	message[4].cs_take = 1;
+	message[num - 1].cs_release = 1;
+
+	misaka_test_check(misaka_spi_transfer_message(&s_dev.device, message) == 0);
+	misaka_test_check(s_log_num == 2);
+	misaka_test_check(s_log[0].num == MISAKA_SPI_LINUX_TRANSFER_MAX && s_log[1].num == 8);
+	misaka_test_check(s_log[0].xfer[3].cs_change == 1);
+	misaka_test_check(s_log[0].xfer[4].cs_change == 0);
+	misaka_test_check(s_log[0].xfer[MISAKA_SPI_LINUX_TRANSFER_MAX - 1].cs_change == 1);
+	misaka_test_check(s_log[1].xfer[7].cs_change == 0);
+
+	return 0;
+}
+
+static int test_spi_linux_failure(void)
+{
+	uint8_t tx[4] = {0}, rx[4];
+
+	test_setup(MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB);
+	s_fail = 1;
+	misaka_test_check(misaka_spi_transfer(&s_dev.device, tx, rx, sizeof(tx)) == 1);
+	s_fail = 0;
+	misaka_test_check(misaka_spi_transfer(&s_dev.device, tx, rx, sizeof(tx)) == 0);
+
+	/** < 文件描述符无效时配置失败 */
+	test_setup(MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB);
+	s_dev.fd = 7;
+	misaka_test_check(misaka_spi_transfer(&s_dev.device, tx, rx, sizeof(tx)) == 1);
+	misaka_test_check(s_log_num == 0);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_spi_linux_configure);
+	misaka_test_run(failures, test_spi_linux_send_then_recv);
+	misaka_test_run(failures, test_spi_linux_quad);
+	misaka_test_run(failures, test_spi_linux_dual_send);
+	misaka_test_run(failures, test_spi_linux_batch);
+	misaka_test_run(failures, test_spi_linux_failure);
+
+	return failures != 0;
+}
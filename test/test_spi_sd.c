@@ -0,0 +1,314 @@
+/**
+ * @file test_spi_sd.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * spi sd卡：在仿真sd卡上检查初始化的命令序列、卡类型、容量与时钟切换，CMD17/CMD18单块与多块读，
+ * CMD24单块写与ACMD23预擦除后的CMD25多块写，以及开启与关闭crc时总线上数据出错的表现。
+ * 另以MISAKA_SPI_SD_USING_CRC_TABLE编译一份，查表与逐位计算的crc须一致。
+ */
+
+#include <string.h>
+#include "misaka_device/spi_sd.h"
+#include "test.h"
+
+#define TEST_SD_BLOCKS          1024
+#define TEST_INIT_HZ            400000UL
+#define TEST_MAX_HZ             25000000UL
+
+static uint8_t s_mem[TEST_SD_BLOCKS * MISAKA_SPI_SD_BLOCK_SIZE];
+static uint8_t s_buf[4 * MISAKA_SPI_SD_BLOCK_SIZE];
+static misaka_spi_bus_t *s_sim_bus;
+static misaka_spi_bus_t s_bus;
+static misaka_spi_bus_ops_t s_ops;
+static misaka_spi_t s_spi;
+static misaka_spi_sd_t s_sd;
+static uint32_t s_delay_ms;
+static uint32_t s_hz[4];
+static uint32_t s_configures;
+static uint8_t s_corrupt;/**< 1:下一个数据块在总线上翻转一位 */
+
+static void test_delay_ms(uint32_t ms)
+{
+	s_delay_ms += ms;
+}
+
+/**
+ * @brief 翻转数据块中的一位：读取时数据块的前几个字节可能已随轮询读入预读缓冲，按长度超过一次轮询判断
+ * @param buf 数据
+ * @param length 数据长度
+ */
+static void test_corrupt(uint8_t *buf, uint32_t length)
+{
+	if (s_corrupt && length > MISAKA_SPI_SD_POLL_BURST * 2)
+	{
+		s_corrupt = 0;
+		buf[0] ^= 0x01;
+	}
+}
+
+static uint8_t test_send_recv(void *ctx, uint8_t *txbuf, uint8_t *rxbuf, uint32_t length)
+{
+	uint8_t result = s_sim_bus->ops->send_recv(ctx, txbuf, rxbuf, length);
+
+	test_corrupt(rxbuf, length);
+
+	return result;
+}
+
+static uint8_t test_send(void *ctx, uint8_t *txbuf, uint32_t length)
+{
+	static uint8_t data[MISAKA_SPI_SD_BLOCK_SIZE];
+
+	if (s_corrupt && length == MISAKA_SPI_SD_BLOCK_SIZE)
+	{
+		memcpy(data, txbuf, length);
+		test_corrupt(data, length);
+		txbuf = data;
+	}
+
+	return s_sim_bus->ops->send(ctx, txbuf, length);
+}
+
+static uint8_t test_configure(void *ctx, misaka_spi_t *device, misaka_spi_configuration_t *cfg)
+{
+	(void) ctx;
+	(void) device;
+	s_hz[s_configures++ & 3] = cfg->max_hz;
+
+	return 0;
+}
+
+/**
+ * @brief 初始化仿真sd卡与驱动，总线在仿真总线外记录时钟配置并可在数据块上注入错误
+ * @param use_crc 1:开启crc
+ * @return 0:成功 1:失败
+ */
+static int test_setup(uint8_t use_crc)
+{
+	s_sim_bus = misaka_spi_sd_sim_init(s_mem, TEST_SD_BLOCKS, 4);
+	s_ops = *s_sim_bus->ops;
+	s_ops.send_recv = test_send_recv;
+	s_ops.send = test_send;
+	s_ops.configure = test_configure;
+	s_bus = *s_sim_bus;
+	s_bus.ops = &s_ops;
+
+	memset(&s_spi, 0, sizeof(s_spi));
+	s_spi.cs_ops = &misaka_spi_sd_sim_cs_ops;
+	s_spi.bus = &s_bus;
+	s_spi.config.mode = MISAKA_SPI_MODE_0 | MISAKA_SPI_MSB;
+	s_spi.config.data_width = 8;
+
+	memset(&s_sd, 0, sizeof(s_sd));
+	s_sd.spi = &s_spi;
+	s_sd.delay_ms = test_delay_ms;
+	s_sd.init_hz = TEST_INIT_HZ;
+	s_sd.max_hz = TEST_MAX_HZ;
+	s_sd.use_crc = use_crc;
+	s_delay_ms = 0;
+	s_configures = 0;
+	s_corrupt = 0;
+
+	return misaka_spi_sd_init(&s_sd);
+}
+
+/**
+ * @brief 读取仿真sd卡收到的命令数
+ * @return uint32_t @c 命令数
+ */
+static uint32_t test_commands(void)
+{
+	uint32_t commands;
+
+	misaka_spi_sd_sim_stat(&commands, NULL);
+
+	return commands;
+}
+
+/**
+ * @brief 检查一个块是否全为value
+ * @param block 块号
+ * @param value 数据
+ * @return 1:是 0:否
+ */
+static int test_block_is(uint32_t block, uint8_t value)
+{
+	uint32_t i;
+
+	for (i = 0; i < MISAKA_SPI_SD_BLOCK_SIZE; i++)
+	{
+		if (s_mem[block * MISAKA_SPI_SD_BLOCK_SIZE + i] != value)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int test_spi_sd_crc(void)
+{
+	uint8_t cmd0[5] = {0x40, 0x00, 0x00, 0x00, 0x00};
+	uint8_t cmd8[5] = {0x48, 0x00, 0x00, 0x01, 0xAA};
+	uint8_t block[MISAKA_SPI_SD_BLOCK_SIZE];
+
+	misaka_test_check((misaka_spi_sd_crc7(cmd0, 5) | 0x01) == 0x95);
+	misaka_test_check((misaka_spi_sd_crc7(cmd8, 5) | 0x01) == 0x87);
+	memset(block, 0xFF, sizeof(block));
+	misaka_test_check(misaka_spi_sd_crc16(block, sizeof(block)) == 0x7FA1);
+	misaka_test_check(misaka_spi_sd_crc16((const uint8_t *) "123456789", 9) == 0x31C3);
+
+	return 0;
+}
+
+static int test_spi_sd_init(void)
+{
+	/** < CMD0、CMD8、4次CMD55+ACMD41（仿真卡前3次保持空闲）、CMD58、CMD9 */
+	misaka_test_check(test_setup(0) == 0);
+	misaka_test_check(s_sd.type == MISAKA_SPI_SD_TYPE_SDHC);
+	misaka_test_check(s_sd.block_num == TEST_SD_BLOCKS);
+	misaka_test_check(s_sd.commands == 1 + 1 + 4 * 2 + 1 + 1);
+	misaka_test_check(test_commands() == s_sd.commands);
+	misaka_test_check(s_delay_ms == 3);
+
+	/** < 初始化以init_hz进行，完成后在下一次传输时切换到max_hz */
+	misaka_test_check(s_configures == 1 && s_hz[0] == TEST_INIT_HZ);
+	misaka_test_check(s_spi.config.max_hz == TEST_MAX_HZ);
+	misaka_test_check(misaka_spi_sd_sync(&s_sd) == 0);
+	misaka_test_check(s_configures == 2 && s_hz[1] == TEST_MAX_HZ);
+
+	/** < 开启crc多一条CMD59 */
+	misaka_test_check(test_setup(1) == 0);
+	misaka_test_check(s_sd.commands == 1 + 1 + 1 + 4 * 2 + 1 + 1);
+	misaka_test_check(s_sd.crc_errors == 0);
+
+	return 0;
+}
+
+static int test_spi_sd_read(void)
+{
+	uint32_t i, commands;
+
+	for (i = 0; i < sizeof(s_mem); i++)
+	{
+		s_mem[i] = (uint8_t) (i * 11 + (i >> 9));
+	}
+	misaka_test_check(test_setup(1) == 0);
+
+	/** < CMD17 */
+	commands = test_commands();
+	misaka_test_check(misaka_spi_sd_read(&s_sd, 7, s_buf, 1) == 0);
+	misaka_test_check(memcmp(s_buf, &s_mem[7 * MISAKA_SPI_SD_BLOCK_SIZE], MISAKA_SPI_SD_BLOCK_SIZE) == 0);
+	misaka_test_check(test_commands() - commands == 1);
+
+	/** < CMD18与CMD12，CMD12之后的填充字节被丢弃 */
+	commands = test_commands();
+	memset(s_buf, 0, sizeof(s_buf));
+	misaka_test_check(misaka_spi_sd_read(&s_sd, TEST_SD_BLOCKS - 4, s_buf, 4) == 0);
+	misaka_test_check(memcmp(s_buf, &s_mem[(TEST_SD_BLOCKS - 4) * MISAKA_SPI_SD_BLOCK_SIZE], sizeof(s_buf)) == 0);
+	misaka_test_check(test_commands() - commands == 2);
+
+	/** < 超出容量 */
+	commands = test_commands();
+	misaka_test_check(misaka_spi_sd_read(&s_sd, TEST_SD_BLOCKS - 1, s_buf, 2) == 1);
+	misaka_test_check(test_commands() == commands);
+	misaka_test_check(s_sd.crc_errors == 0);
+
+	return 0;
+}
+
+static int test_spi_sd_write(void)
+{
+	uint32_t i, commands;
+
+	for (i = 0; i < sizeof(s_buf); i++)
+	{
+		s_buf[i] = (uint8_t) (i * 29 + 3);
+	}
+	memset(s_mem, 0, sizeof(s_mem));
+	misaka_test_check(test_setup(1) == 0);
+
+	/** < CMD24 */
+	commands = test_commands();
+	misaka_test_check(misaka_spi_sd_write(&s_sd, 3, s_buf, 1) == 0);
+	misaka_test_check(memcmp(&s_mem[3 * MISAKA_SPI_SD_BLOCK_SIZE], s_buf, MISAKA_SPI_SD_BLOCK_SIZE) == 0);
+	misaka_test_check(test_commands() - commands == 1);
+
+	/** < CMD55+ACMD23预擦除，CMD25连续写入，上一次写入的忙状态在命令前等待 */
+	commands = test_commands();
+	misaka_test_check(misaka_spi_sd_write(&s_sd, 10, s_buf, 4) == 0);
+	misaka_test_check(memcmp(&s_mem[10 * MISAKA_SPI_SD_BLOCK_SIZE], s_buf, sizeof(s_buf)) == 0);
+	misaka_test_check(test_commands() - commands == 3);
+	misaka_test_check(misaka_spi_sd_sync(&s_sd) == 0);
+
+	/** < 写入后读回 */
+	memset(s_buf, 0, sizeof(s_buf));
+	misaka_test_check(misaka_spi_sd_read(&s_sd, 10, s_buf, 4) == 0);
+	misaka_test_check(memcmp(s_buf, &s_mem[10 * MISAKA_SPI_SD_BLOCK_SIZE], sizeof(s_buf)) == 0);
+	misaka_test_check(test_block_is(9, 0));
+	misaka_test_check(s_sd.crc_errors == 0);
+
+	return 0;
+}
+
+static int test_spi_sd_crc_error(void)
+{
+	uint8_t block[MISAKA_SPI_SD_BLOCK_SIZE];
+
+	memset(block, 0x3C, sizeof(block));
+	memset(s_mem, 0, sizeof(s_mem));
+
+	/** < 开启crc：读出的数据块出错时驱动校验失败，写入的数据块出错时卡返回crc错误的数据响应 */
+	misaka_test_check(test_setup(1) == 0);
+	s_corrupt = 1;
+	misaka_test_check(misaka_spi_sd_read(&s_sd, 0, s_buf, 1) == 1);
+	misaka_test_check(s_sd.crc_errors == 1);
+	s_corrupt = 1;
+	misaka_test_check(misaka_spi_sd_write(&s_sd, 1, block, 1) == 1);
+	misaka_test_check(s_sd.crc_errors == 2);
+	misaka_test_check(test_block_is(1, 0));
+
+	/** < 出错后可继续读写 */
+	misaka_test_check(misaka_spi_sd_write(&s_sd, 1, block, 1) == 0);
+	misaka_test_check(misaka_spi_sd_read(&s_sd, 1, s_buf, 1) == 0);
+	misaka_test_check(memcmp(s_buf, block, sizeof(block)) == 0);
+
+	/** < 关闭crc：错误的数据不被发现 */
+	misaka_test_check(test_setup(0) == 0);
+	s_corrupt = 1;
+	misaka_test_check(misaka_spi_sd_read(&s_sd, 1, s_buf, 1) == 0);
+	misaka_test_check(memcmp(s_buf, block, sizeof(block)) != 0);
+	s_corrupt = 1;
+	misaka_test_check(misaka_spi_sd_write(&s_sd, 2, block, 1) == 0);
+	misaka_test_check(misaka_spi_sd_sync(&s_sd) == 0);
+	misaka_test_check(s_mem[2 * MISAKA_SPI_SD_BLOCK_SIZE] == (0x3C ^ 0x01));
+	misaka_test_check(s_sd.crc_errors == 0);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_spi_sd_crc);
+	misaka_test_run(failures, test_spi_sd_init);
+	misaka_test_run(failures, test_spi_sd_read);
+	misaka_test_run(failures, test_spi_sd_write);
+	misaka_test_run(failures, test_spi_sd_crc_error);
+
+	return failures != 0;
+}
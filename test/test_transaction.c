@@ -0,0 +1,141 @@
+/**
+ * @file test_transaction.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ *
+ * 事务：仿真i2c总线上没有从机应答时，只有一条消息的事务与分段提交的事务均返回失败，
+ * 时序引擎返回已完成的消息数；spi事务保持cs的步骤只选中一次cs，延时步骤在会话中执行。
+ */
+
+#include <string.h>
+#include "misaka_device/transaction.h"
+#include "sim_bus.h"
+#include "test.h"
+
+#define TEST_ARENA_SIZE         8
+
+static misaka_soft_i2c_message s_i2c_arena[TEST_ARENA_SIZE];
+static misaka_spi_message_t s_spi_arena[TEST_ARENA_SIZE];
+static uint32_t s_delay_us;
+
+static void test_delay_us(uint32_t us)
+{
+	s_delay_us += us;
+}
+
+/**
+ * @brief 初始化i2c事务与仿真总线
+ * @param t 事务
+ * @param bus i2c总线
+ * @param gpio 仿真gpio
+ * @param sda_in 从机应答时为0，没有从机时为1
+ */
+static void test_i2c_setup(misaka_soft_i2c_transaction_t *t, misaka_soft_i2c_bus_t *bus, misaka_sim_gpio_t *gpio, uint8_t sda_in)
+{
+	memset(gpio, 0, sizeof(*gpio));
+	gpio->sda_in = sda_in;
+	misaka_sim_i2c_bus_init(bus, gpio, 1);
+
+	memset(t, 0, sizeof(*t));
+	t->arena = s_i2c_arena;
+	t->size = TEST_ARENA_SIZE;
+	t->delay_us = test_delay_us;
+	misaka_soft_i2c_transaction_init(t);
+	s_delay_us = 0;
+}
+
+static int test_transaction_i2c_nack(void)
+{
+	misaka_soft_i2c_transaction_t t;
+	misaka_soft_i2c_bus_t bus;
+	misaka_sim_gpio_t gpio;
+	uint8_t data[2];
+
+	/** < 只有一条读消息，地址未应答 */
+	test_i2c_setup(&t, &bus, &gpio, 1);
+	misaka_test_check(misaka_soft_i2c_bus_master_recv(&bus, 0x50, 0, data, sizeof(data)) == 0);
+	misaka_test_check(misaka_soft_i2c_transaction_read(&t, 0x50, data, sizeof(data), 0) != NULL);
+	misaka_test_check(misaka_soft_i2c_transaction_issue(&t, &bus) == 1);
+
+	/** < 延时分段提交 */
+	misaka_test_check(misaka_soft_i2c_transaction_delay(&t, 10) != NULL);
+	misaka_test_check(misaka_soft_i2c_transaction_read(&t, 0x50, data, sizeof(data), 0) != NULL);
+	misaka_test_check(misaka_soft_i2c_transaction_issue(&t, &bus) == 1);
+	misaka_test_check(s_delay_us == 0);
+
+	/** < 从机应答 */
+	test_i2c_setup(&t, &bus, &gpio, 0);
+	misaka_test_check(misaka_soft_i2c_bus_master_recv(&bus, 0x50, 0, data, sizeof(data)) == 1);
+	misaka_test_check(misaka_soft_i2c_transaction_read(&t, 0x50, data, sizeof(data), 0) != NULL);
+	misaka_test_check(misaka_soft_i2c_transaction_issue(&t, &bus) == 0);
+	misaka_test_check(misaka_soft_i2c_transaction_delay(&t, 10) != NULL);
+	misaka_test_check(misaka_soft_i2c_transaction_read(&t, 0x50, data, sizeof(data), 0) != NULL);
+	misaka_test_check(misaka_soft_i2c_transaction_issue(&t, &bus) == 0);
+	misaka_test_check(s_delay_us == 10);
+
+	return 0;
+}
+
+static int test_transaction_spi(void)
+{
+	misaka_spi_transaction_t t;
+	misaka_sim_spi_t sim = {0};
+	misaka_spi_bus_t bus;
+	misaka_spi_t spi;
+	uint8_t cmd[2] = {0x9F, 0x03}, rx[4];
+
+	misaka_sim_spi_bus_init(&bus, &spi, &sim);
+	memset(&t, 0, sizeof(t));
+	t.arena = s_spi_arena;
+	t.size = TEST_ARENA_SIZE;
+	t.delay_us = test_delay_us;
+	misaka_spi_transaction_init(&t);
+	s_delay_us = 0;
+
+	/** < 写与读之间保持cs，延时后再选中一次 */
+	misaka_test_check(misaka_spi_transaction_write(&t, cmd, 1, MISAKA_TRANSACTION_CS_HOLD) != NULL);
+	misaka_test_check(misaka_spi_transaction_read(&t, rx, sizeof(rx), 0) != NULL);
+	misaka_test_check(misaka_spi_transaction_delay(&t, 20) != NULL);
+	misaka_test_check(misaka_spi_transaction_write_read(&t, &cmd[1], 1, rx, sizeof(rx), 0) != NULL);
+	misaka_test_check(t.overflow == 0);
+
+	misaka_test_check(misaka_spi_transaction_issue(&t, &spi) == 0);
+	misaka_test_check(sim.cs_toggles == 4);
+	misaka_test_check(sim.cs == 1);
+	misaka_test_check(sim.bytes == 2 + 2 * sizeof(rx));
+	misaka_test_check(s_delay_us == 20);
+	misaka_test_check(spi.session == 0);
+
+	/** < 消息区不足 */
+	while (t.num + 2 <= TEST_ARENA_SIZE)
+	{
+		misaka_test_check(misaka_spi_transaction_read(&t, rx, sizeof(rx), 0) != NULL);
+	}
+	misaka_test_check(misaka_spi_transaction_write_read(&t, cmd, 1, rx, sizeof(rx), 0) == NULL);
+	misaka_test_check(t.overflow == 1);
+	misaka_test_check(misaka_spi_transaction_issue(&t, &spi) == 1);
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	misaka_test_run(failures, test_transaction_i2c_nack);
+	misaka_test_run(failures, test_transaction_spi);
+
+	return failures != 0;
+}
@@ -0,0 +1,458 @@
+/**
+ * @file transaction.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+/**
+ * spi：消息在消息区中连续存放，追加时与上一条消息链接，延时标记处断开，因此没有延时步骤时消息区首条消息
+ * 即整条消息链。步骤的首条消息cs_take、末条消息cs_release，上一步带MISAKA_TRANSACTION_CS_HOLD时
+ * 本步不再cs_take，cs保持有效。
+ * i2c：消息区即消息数组，延时标记处分段提交。
+ */
+
+#include "misaka_device/transaction.h"
+
+/**
+ * @brief 从消息区分配消息并填充默认值
+ * @param t 事务
+ * @param num 消息数
+ * @param link 1: 与上一条消息链接
+ * @return misaka_spi_message_t* @c 首条消息，NULL为消息区不足
+ */
+static misaka_spi_message_t *misaka_spi_transaction_alloc(misaka_spi_transaction_t *t, uint16_t num, uint8_t link)
+{
+	misaka_spi_message_t *message;
+	uint16_t i;
+
+	if (t->overflow || t->size - t->num < num)
+	{
+		t->overflow = 1;
+		return NULL;
+	}
+
+	message = &t->arena[t->num];
+	for (i = 0; i < num; i++)
+	{
+		message[i].send_buf = NULL;
+		message[i].recv_buf = NULL;
+		message[i].length = 0;
+		message[i].next = i + 1 < num ? &message[i + 1] : NULL;
+		message[i].cs_take = 0;
+		message[i].cs_release = 0;
+		message[i].lines = MISAKA_SPI_LINES_SINGLE;
+		message[i].dummy_cycles = 0;
+		message[i].dc = MISAKA_SPI_DC_NONE;
+	}
+
+	if (link && t->num > 0 && t->arena[t->num - 1].lines != MISAKA_SPI_TRANSACTION_DELAY)
+	{
+		t->arena[t->num - 1].next = message;
+	}
+	t->num += num;
+
+	return message;
+}
+
+/**
+ * @brief 设置步骤的cs边界
+ * @param t 事务
+ * @param first 步骤首条消息
+ * @param last 步骤末条消息
+ * @param flags MISAKA_TRANSACTION_CS_HOLD或0
+ */
+static void misaka_spi_transaction_frame(misaka_spi_transaction_t *t, misaka_spi_message_t *first, misaka_spi_message_t *last, uint8_t flags)
+{
+	first->cs_take = !t->hold;
+	last->cs_release = !(flags & MISAKA_TRANSACTION_CS_HOLD);
+	t->hold = (flags & MISAKA_TRANSACTION_CS_HOLD) ? 1 : 0;
+}
+
+/**
+ * @brief 清空事务，开始构建
+ * @param t 事务
+ */
+void misaka_spi_transaction_init(misaka_spi_transaction_t *t)
+{
+	misaka_spi_assert(t != NULL);
+	misaka_spi_assert(t->arena != NULL);
+
+	t->num = 0;
+	t->delays = 0;
+	t->hold = 0;
+	t->overflow = 0;
+}
+
+/**
+ * @brief 追加写步骤
+ * @param t 事务
+ * @param buf 待发送数据
+ * @param len 数据长度
+ * @param flags MISAKA_TRANSACTION_CS_HOLD或0
+ * @return misaka_spi_message_t* @c 该步的消息，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_write(misaka_spi_transaction_t *t, uint8_t *buf, uint32_t len, uint8_t flags)
+{
+	misaka_spi_message_t *message;
+
+	misaka_spi_assert(t != NULL);
+
+	message = misaka_spi_transaction_alloc(t, 1, 1);
+	if (message == NULL)
+	{
+		return NULL;
+	}
+	message->send_buf = buf;
+	message->length = len;
+	misaka_spi_transaction_frame(t, message, message, flags);
+
+	return message;
+}
+
+/**
+ * @brief 追加读步骤
+ * @param t 事务
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @param flags MISAKA_TRANSACTION_CS_HOLD或0
+ * @return misaka_spi_message_t* @c 该步的消息，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_read(misaka_spi_transaction_t *t, uint8_t *buf, uint32_t len, uint8_t flags)
+{
+	misaka_spi_message_t *message;
+
+	misaka_spi_assert(t != NULL);
+
+	message = misaka_spi_transaction_alloc(t, 1, 1);
+	if (message == NULL)
+	{
+		return NULL;
+	}
+	message->recv_buf = buf;
+	message->length = len;
+	misaka_spi_transaction_frame(t, message, message, flags);
+
+	return message;
+}
+
+/**
+ * @brief 追加先写后读步骤，两段处于同一次cs选中内
+ * @param t 事务
+ * @param txbuf 待发送数据
+ * @param txlen 发送数据长度
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @param flags MISAKA_TRANSACTION_CS_HOLD或0
+ * @return misaka_spi_message_t* @c 写消息，读消息为其next，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_write_read(misaka_spi_transaction_t *t, uint8_t *txbuf, uint32_t txlen,
+                                                        uint8_t *rxbuf, uint32_t rxlen, uint8_t flags)
+{
+	misaka_spi_message_t *message;
+
+	misaka_spi_assert(t != NULL);
+
+	message = misaka_spi_transaction_alloc(t, 2, 1);
+	if (message == NULL)
+	{
+		return NULL;
+	}
+	message[0].send_buf = txbuf;
+	message[0].length = txlen;
+	message[1].recv_buf = rxbuf;
+	message[1].length = rxlen;
+	misaka_spi_transaction_frame(t, &message[0], &message[1], flags);
+
+	return message;
+}
+
+/**
+ * @brief 追加延时步骤，上一步保持cs时延时期间cs保持有效
+ * @param t 事务
+ * @param us 延时
+ * @return misaka_spi_message_t* @c 延时标记，length为延时us，NULL为消息区不足
+ */
+misaka_spi_message_t *misaka_spi_transaction_delay(misaka_spi_transaction_t *t, uint32_t us)
+{
+	misaka_spi_message_t *message;
+
+	misaka_spi_assert(t != NULL);
+
+	message = misaka_spi_transaction_alloc(t, 1, 0);
+	if (message == NULL)
+	{
+		return NULL;
+	}
+	message->lines = MISAKA_SPI_TRANSACTION_DELAY;
+	message->length = us;
+	t->delays++;
+
+	return message;
+}
+
+/**
+ * @brief 提交事务：没有延时步骤且末步释放cs时为一次misaka_spi_transfer_message，否则在会话中逐段提交
+ * @param t 事务
+ * @param spi spi设备
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_spi_transaction_issue(misaka_spi_transaction_t *t, misaka_spi_t *spi)
+{
+	misaka_spi_message_t *message;
+	uint16_t i;
+	uint8_t result = 0;
+
+	misaka_spi_assert(t != NULL);
+	misaka_spi_assert(spi != NULL);
+
+	if (t->overflow)
+	{
+		return 1;
+	}
+	if (t->num == 0)
+	{
+		return 0;
+	}
+	if (t->delays == 0 && !t->hold)
+	{
+		return misaka_spi_transfer_message(spi, t->arena);
+	}
+
+	/** < 会话在延时期间占有总线，末步保持cs时由关闭会话释放 */
+	if (misaka_spi_session_open(spi) != 0)
+	{
+		return 1;
+	}
+	for (i = 0; i < t->num && result == 0; i++)
+	{
+		message = &t->arena[i];
+		if (message->lines == MISAKA_SPI_TRANSACTION_DELAY)
+		{
+			t->delay_us(message->length);
+			continue;
+		}
+
+		result = misaka_spi_session_chain(spi, message);
+		while (t->arena[i].next != NULL)
+		{
+			i++;
+		}
+	}
+	if (misaka_spi_session_close(spi) != 0)
+	{
+		result = 1;
+	}
+
+	return result;
+}
+
+/**
+ * @brief 从消息区分配消息
+ * @param t 事务
+ * @param num 消息数
+ * @return misaka_soft_i2c_message* @c 首条消息，NULL为消息区不足
+ */
+static misaka_soft_i2c_message *misaka_soft_i2c_transaction_alloc(misaka_soft_i2c_transaction_t *t, uint16_t num)
+{
+	misaka_soft_i2c_message *msg;
+
+	if (t->overflow || t->size - t->num < num)
+	{
+		t->overflow = 1;
+		return NULL;
+	}
+
+	msg = &t->arena[t->num];
+	t->num += num;
+
+	return msg;
+}
+
+/**
+ * @brief 清空事务，开始构建
+ * @param t 事务
+ */
+void misaka_soft_i2c_transaction_init(misaka_soft_i2c_transaction_t *t)
+{
+	misaka_soft_i2c_assert(t != NULL);
+	misaka_soft_i2c_assert(t->arena != NULL);
+
+	t->num = 0;
+	t->delays = 0;
+	t->overflow = 0;
+}
+
+/**
+ * @brief 追加写消息
+ * @param t 事务
+ * @param addr 地址
+ * @param buf 待发送数据
+ * @param len 数据长度
+ * @param flags MISAKA_SOFT_I2C_x标志，如MISAKA_SOFT_I2C_NO_START
+ * @return misaka_soft_i2c_message* @c 该步的消息，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_write(misaka_soft_i2c_transaction_t *t, uint16_t addr, uint8_t *buf, uint32_t len, uint16_t flags)
+{
+	misaka_soft_i2c_message *msg;
+
+	misaka_soft_i2c_assert(t != NULL);
+
+	msg = misaka_soft_i2c_transaction_alloc(t, 1);
+	if (msg == NULL)
+	{
+		return NULL;
+	}
+	msg->addr = addr;
+	msg->flags = (flags & ~(MISAKA_SOFT_I2C_RD | MISAKA_SOFT_I2C_TRANSACTION_DELAY)) | MISAKA_SOFT_I2C_WR;
+	msg->buf = buf;
+	msg->len = len;
+
+	return msg;
+}
+
+/**
+ * @brief 追加读消息
+ * @param t 事务
+ * @param addr 地址
+ * @param buf 待接收数据
+ * @param len 数据长度
+ * @param flags MISAKA_SOFT_I2C_x标志
+ * @return misaka_soft_i2c_message* @c 该步的消息，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_read(misaka_soft_i2c_transaction_t *t, uint16_t addr, uint8_t *buf, uint32_t len, uint16_t flags)
+{
+	misaka_soft_i2c_message *msg;
+
+	misaka_soft_i2c_assert(t != NULL);
+
+	msg = misaka_soft_i2c_transaction_alloc(t, 1);
+	if (msg == NULL)
+	{
+		return NULL;
+	}
+	msg->addr = addr;
+	msg->flags = (flags & ~MISAKA_SOFT_I2C_TRANSACTION_DELAY) | MISAKA_SOFT_I2C_RD;
+	msg->buf = buf;
+	msg->len = len;
+
+	return msg;
+}
+
+/**
+ * @brief 追加先写后读（重复起始）
+ * @param t 事务
+ * @param addr 地址
+ * @param txbuf 待发送数据
+ * @param txlen 发送数据长度
+ * @param rxbuf 待接收数据
+ * @param rxlen 接收数据长度
+ * @return misaka_soft_i2c_message* @c 写消息，读消息紧随其后，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_write_read(misaka_soft_i2c_transaction_t *t, uint16_t addr, uint8_t *txbuf, uint32_t txlen,
+                                                                uint8_t *rxbuf, uint32_t rxlen)
+{
+	misaka_soft_i2c_message *msg;
+
+	misaka_soft_i2c_assert(t != NULL);
+
+	msg = misaka_soft_i2c_transaction_alloc(t, 2);
+	if (msg == NULL)
+	{
+		return NULL;
+	}
+	msg[0].addr = addr;
+	msg[0].flags = MISAKA_SOFT_I2C_WR;
+	msg[0].buf = txbuf;
+	msg[0].len = txlen;
+	msg[1].addr = addr;
+	msg[1].flags = MISAKA_SOFT_I2C_RD;
+	msg[1].buf = rxbuf;
+	msg[1].len = rxlen;
+
+	return msg;
+}
+
+/**
+ * @brief 追加延时步骤，之前的消息以停止信号结束，延时后以起始信号继续
+ * @param t 事务
+ * @param us 延时
+ * @return misaka_soft_i2c_message* @c 延时标记，len为延时us，NULL为消息区不足
+ */
+misaka_soft_i2c_message *misaka_soft_i2c_transaction_delay(misaka_soft_i2c_transaction_t *t, uint32_t us)
+{
+	misaka_soft_i2c_message *msg;
+
+	misaka_soft_i2c_assert(t != NULL);
+
+	msg = misaka_soft_i2c_transaction_alloc(t, 1);
+	if (msg == NULL)
+	{
+		return NULL;
+	}
+	msg->addr = 0;
+	msg->flags = MISAKA_SOFT_I2C_TRANSACTION_DELAY;
+	msg->buf = NULL;
+	msg->len = us;
+	t->delays++;
+
+	return msg;
+}
+
+/**
+ * @brief 提交事务：没有延时步骤时为一次misaka_soft_i2c_bus_transfer，否则按延时分段提交
+ * @param t 事务
+ * @param bus i2c总线
+ * @return 0:成功 1:失败
+ */
+uint8_t misaka_soft_i2c_transaction_issue(misaka_soft_i2c_transaction_t *t, const misaka_soft_i2c_bus_t *bus)
+{
+	uint16_t i, start = 0;
+
+	misaka_soft_i2c_assert(t != NULL);
+	misaka_soft_i2c_assert(bus != NULL);
+
+	if (t->overflow)
+	{
+		return 1;
+	}
+	if (t->num == 0)
+	{
+		return 0;
+	}
+	if (t->delays == 0)
+	{
+		return misaka_soft_i2c_bus_transfer(bus, t->arena, t->num) == t->num ? 0 : 1;
+	}
+
+	for (i = 0; i <= t->num; i++)
+	{
+		if (i < t->num && !(t->arena[i].flags & MISAKA_SOFT_I2C_TRANSACTION_DELAY))
+		{
+			continue;
+		}
+
+		if (i > start && misaka_soft_i2c_bus_transfer(bus, &t->arena[start], i - start) != (uint32_t) (i - start))
+		{
+			return 1;
+		}
+		if (i < t->num)
+		{
+			t->delay_us(t->arena[i].len);
+		}
+		start = i + 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file transaction_port.c
+ * @brief
+ * @author xqyjlj (xqyjlj@126.com)
+ * @version 0.0
+ * @date 2026-10-19
+ * @copyright Copyright © 2021-2026 xqyjlj<xqyjlj@126.com>
+ * @SPDX-License-Identifier: Apache-2.0
+ *
+ * ********************************************************************************
+ * @par ChangeLog:
+ * <table>
+ * <tr><th>Date       <th>Version <th>Author  <th>Description
+ * <tr><td>2026-10-19 <td>0.0     <td>xqyjlj  <td>内容
+ * </table>
+ * ********************************************************************************
+ */
+
+#include "misaka_device/transaction.h"
+
+#define TRANSACTION_MESSAGE_NUM     8
+
+static misaka_spi_message_t s_spi_transaction_arena[TRANSACTION_MESSAGE_NUM];
+static misaka_spi_transaction_t s_misaka_spi_transaction_obj;
+misaka_spi_transaction_t *misaka_spi_transaction_obj = NULL;
+
+static uint8_t s_cmd[4];
+static uint8_t s_status[2];
+static misaka_spi_message_t *s_data;
+
+/**
+ * @brief 延时us
+ * @param us 延时
+ */
+static void delay_us(uint32_t us)
+{
+
+}
+
+/**
+ * 启动转换、等待、读取结果只构建一次，周期任务中直接提交；换用其他缓冲区时修改s_data->recv_buf与length即可
+ */
+static int misaka_transaction_port_init(uint8_t *buf, uint32_t len)
+{
+	s_misaka_spi_transaction_obj.arena = s_spi_transaction_arena;
+	s_misaka_spi_transaction_obj.size = TRANSACTION_MESSAGE_NUM;
+	s_misaka_spi_transaction_obj.delay_us = delay_us;
+	misaka_spi_transaction_init(&s_misaka_spi_transaction_obj);
+
+	misaka_spi_transaction_write(&s_misaka_spi_transaction_obj, &s_cmd[0], 1, 0);
+	misaka_spi_transaction_delay(&s_misaka_spi_transaction_obj, 100);
+	misaka_spi_transaction_write_read(&s_misaka_spi_transaction_obj, &s_cmd[1], 1, s_status, sizeof(s_status), 0);
+	s_data = misaka_spi_transaction_write(&s_misaka_spi_transaction_obj, &s_cmd[2], 2, MISAKA_TRANSACTION_CS_HOLD);
+	s_data = misaka_spi_transaction_read(&s_misaka_spi_transaction_obj, buf, len, 0);
+	if (s_misaka_spi_transaction_obj.overflow)
+	{
+		return 0;
+	}
+	misaka_spi_transaction_obj = &s_misaka_spi_transaction_obj;
+
+	return 1;
+}